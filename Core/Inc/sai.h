@@ -45,9 +45,11 @@ HAL_StatusTypeDef MX_SAI3_DeinitBlockA(void);
 HAL_StatusTypeDef MX_SAI3_DeinitBlockB(void);
 HAL_StatusTypeDef MX_SAI2_DeinitBlockA(void);
 
-HAL_StatusTypeDef MX_SAI3_InitBlockA(int mode);
-HAL_StatusTypeDef MX_SAI3_InitBlockB(int mode);
-HAL_StatusTypeDef MX_SAI2_InitBlockA(int mode);
+HAL_StatusTypeDef MX_SAI_ConfigKernelClock(uint32_t frequency);
+
+HAL_StatusTypeDef MX_SAI3_InitBlockA(int mode, uint32_t frequency);
+HAL_StatusTypeDef MX_SAI3_InitBlockB(int mode, uint32_t frequency);
+HAL_StatusTypeDef MX_SAI2_InitBlockA(int mode, uint32_t frequency);
 /* USER CODE END Prototypes */
 
 #ifdef __cplusplus
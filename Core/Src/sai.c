@@ -37,6 +37,39 @@ HAL_StatusTypeDef MX_SAI2_DeinitBlockA(void)
 {
   return HAL_SAI_DeInit(&hsai_BlockA2);
 }
+
+/**
+ * Sets the SAI2/SAI3 kernel clock (PLL3 P) for the family of the sampling rate, from the 12.288 MHz HSE:
+ * 24.576 MHz (VCO 196.608 MHz / 8) for the 48 kHz family, 22.5792 MHz (VCO 361.2672 MHz / 16) for the 44.1 kHz family.
+ * The SAI blocks must be stopped, as PLL3 is disabled while it is reconfigured.
+ */
+HAL_StatusTypeDef MX_SAI_ConfigKernelClock(uint32_t frequency)
+{
+  RCC_PeriphCLKInitTypeDef PeriphClkInitStruct = { 0 };
+
+  PeriphClkInitStruct.PeriphClockSelection = RCC_PERIPHCLK_SAI3 | RCC_PERIPHCLK_SAI2;
+  PeriphClkInitStruct.PLL3.PLL3M = 1;
+  PeriphClkInitStruct.PLL3.PLL3Q = 2;
+  PeriphClkInitStruct.PLL3.PLL3R = 2;
+  PeriphClkInitStruct.PLL3.PLL3RGE = RCC_PLL3VCIRANGE_3;
+  PeriphClkInitStruct.PLL3.PLL3VCOSEL = RCC_PLL3VCOWIDE;
+
+  if ((frequency % SAI_AUDIO_FREQUENCY_11K) == 0)
+  {
+    PeriphClkInitStruct.PLL3.PLL3N = 29;
+    PeriphClkInitStruct.PLL3.PLL3P = 16;
+    PeriphClkInitStruct.PLL3.PLL3FRACN = 3277;
+  }
+  else
+  {
+    PeriphClkInitStruct.PLL3.PLL3N = 16;
+    PeriphClkInitStruct.PLL3.PLL3P = 8;
+    PeriphClkInitStruct.PLL3.PLL3FRACN = 0;
+  }
+
+  PeriphClkInitStruct.Sai23ClockSelection = RCC_SAI23CLKSOURCE_PLL3;
+  return HAL_RCCEx_PeriphCLKConfig(&PeriphClkInitStruct);
+}
 /* USER CODE END 0 */
 
 SAI_HandleTypeDef hsai_BlockA2;
@@ -46,7 +79,7 @@ DMA_HandleTypeDef hdma_sai2_a;
 DMA_HandleTypeDef hdma_sai3_a;
 DMA_HandleTypeDef hdma_sai3_b;
 
-static void configureSaiMode(SAI_HandleTypeDef *handle, int saiMode)
+static void configureSaiMode(SAI_HandleTypeDef *handle, int saiMode, uint32_t frequency)
 {
   handle->Init.Protocol = SAI_FREE_PROTOCOL;
   handle->Init.DataSize = SAI_DATASIZE_16;
@@ -80,7 +113,7 @@ static void configureSaiMode(SAI_HandleTypeDef *handle, int saiMode)
       handle->Init.FIFOThreshold = SAI_FIFOTHRESHOLD_EMPTY;
       handle->Init.MckOutput = SAI_MCK_OUTPUT_ENABLE;
       handle->Init.NoDivider = SAI_MASTERDIVIDER_ENABLE;
-      handle->Init.AudioFrequency = SAI_AUDIO_FREQUENCY_48K;
+      handle->Init.AudioFrequency = frequency;
       handle->Init.Mckdiv = 0;
       handle->Init.MckOverSampling = SAI_MCK_OVERSAMPLING_DISABLE;
       break;
@@ -121,27 +154,27 @@ static void configureSaiMode(SAI_HandleTypeDef *handle, int saiMode)
 }
 
 /* SAI2 init function */
-HAL_StatusTypeDef MX_SAI2_InitBlockA(int saiMode)
+HAL_StatusTypeDef MX_SAI2_InitBlockA(int saiMode, uint32_t frequency)
 {
   hsai_BlockA2.Instance = SAI2_Block_A;
-  configureSaiMode(&hsai_BlockA2, saiMode);
+  configureSaiMode(&hsai_BlockA2, saiMode, frequency);
 
   return HAL_SAI_Init(&hsai_BlockA2);
 }
 
 /* SAI3 init function */
-HAL_StatusTypeDef MX_SAI3_InitBlockA(int saiMode)
+HAL_StatusTypeDef MX_SAI3_InitBlockA(int saiMode, uint32_t frequency)
 {
   hsai_BlockA3.Instance = SAI3_Block_A;
-  configureSaiMode(&hsai_BlockA3, saiMode);
+  configureSaiMode(&hsai_BlockA3, saiMode, frequency);
 
   return HAL_SAI_Init(&hsai_BlockA3);
 }
 
-HAL_StatusTypeDef MX_SAI3_InitBlockB(int saiMode)
+HAL_StatusTypeDef MX_SAI3_InitBlockB(int saiMode, uint32_t frequency)
 {
   hsai_BlockB3.Instance = SAI3_Block_B;
-  configureSaiMode(&hsai_BlockB3, saiMode);
+  configureSaiMode(&hsai_BlockB3, saiMode, frequency);
 
   return HAL_SAI_Init(&hsai_BlockB3);
 }
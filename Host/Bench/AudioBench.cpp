@@ -0,0 +1,1201 @@
+//====================================================================
+//
+// COPYRIGHT 2026 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: Host benchmark of the AudioFilters pipeline. It reports the processing cost
+//              per audio block against the real-time deadline of the audio data out task.
+//  Filename: AudioBench.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+#include "Controllers/Audio/src/AudioFilters.hpp"
+#include "Controllers/Audio/src/DoubleBufferedFilters.hpp"
+#include "Controllers/Audio/src/SilenceDetector.hpp"
+#include "Utilities/MathUtils.hpp"
+#include "BenchPresets.hpp"
+#include "WavFile.hpp"
+
+#define DEFAULT_BUFFERING_TIME_MS   4
+#define DEFAULT_SAMPLE_RATE         48000
+#define TEST_SIGNAL_DURATION_S      20
+
+using BenchClock = std::chrono::steady_clock;
+
+/**
+ * The pipeline stages, in the same order as AudioFilters::run
+ */
+enum BenchStage
+{
+  STAGE_MASTER_EQ,
+  STAGE_MASTER_FIR,
+  STAGE_LEVELER_DRC,
+  STAGE_LIMITER_DRC,
+  STAGE_XOVER_SPLIT,
+  STAGE_XOVER_WOOFER,
+  STAGE_XOVER_TWEETER,
+  STAGE_DELAY,
+  STAGE_PEAK_LIMITER,
+  STAGE_ALA,
+  MAX_BENCH_STAGES
+};
+
+static const char *stageNames[MAX_BENCH_STAGES] = {
+    "master eq",
+    "master fir",
+    "leveler drc",
+    "limiter drc",
+    "xover split",
+    "xover woofer",
+    "xover tweeter",
+    "delay",
+    "peak limiter",
+    "ala"
+};
+
+static const char *engineNames[System::FilterEngine::MAX_FILTER_ENGINES] = {
+    "df1",
+    "df2t",
+    "q31"
+};
+
+struct BenchOptions
+{
+public:
+  std::string inputFile;
+  std::string outputPrefix;
+  uint32_t blockSize = DEFAULT_SAMPLE_RATE * DEFAULT_BUFFERING_TIME_MS / 1000;
+  uint32_t sampleRate = DEFAULT_SAMPLE_RATE;
+  uint32_t repeat = 1;
+  bool stages = true;
+  std::vector<std::string> presets;
+  std::vector<std::string> configFiles;
+  std::vector<System::FilterEngine> engines;
+  std::vector<uint32_t> drcIntervals;
+  uint32_t swapInterval = 0;
+  bool graphCheck = false;
+  uint32_t volume = DIGITAL_VOLUME_LEVELS - 1;
+  uint32_t silenceSeconds = 0;
+  uint32_t musicFrames = 0;           //!< Frames of the input before the appended silence
+  bool flushToZero = true;
+  bool silenceBypass = false;         //!< Skip the filters on silence, like the audio task
+};
+
+/**
+ * One run of a configuration, with the engine and the DRC control interval overridden
+ */
+struct BenchVariant
+{
+public:
+  System::FilterEngine engine;
+  uint32_t drcInterval;
+  std::string name;
+};
+
+struct BenchResult
+{
+public:
+  std::vector<double> blockNs;
+  std::vector<double> musicNs;        //!< blockNs split at the appended silence
+  std::vector<double> silenceNs;
+  double stageNs[MAX_BENCH_STAGES] = { };
+  bool stageActive[MAX_BENCH_STAGES] = { };
+  double stagesTotalNs = 0.0;
+  uint32_t peakLimiterBytes = 0;
+  uint32_t peakLimiterLatency = 0;
+  uint32_t delayBytes = 0;
+  float32_t delays[DELAY_LINES] = { };
+  uint32_t planStages = 0;
+  bool graphCompiled = false;
+  bool outputMixed = false;
+  uint32_t bypassedBlocks = 0;
+  uint32_t firstBypassedBlock = 0;    //!< First block that was bypassed
+};
+
+static double elapsedNs(BenchClock::time_point start, BenchClock::time_point end)
+{
+  return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+static void usage(const char *name)
+{
+  printf("usage: %s [options] [config.bin ...]\n", name);
+  printf("  -i <file.wav>     16bit PCM input (default: %us generated test signal)\n", TEST_SIGNAL_DURATION_S);
+  printf("  -p <preset>       built-in configuration: passthrough, xover, lr4, fir-xover, full, full-lr4, full-peak, full-fir,\n");
+  printf("                    full-delay, full-graph (default: full)\n");
+  printf("  -b <frames>       frames per block (default: %u, %u ms @ %u Hz)\n", DEFAULT_SAMPLE_RATE * DEFAULT_BUFFERING_TIME_MS / 1000,
+  DEFAULT_BUFFERING_TIME_MS, DEFAULT_SAMPLE_RATE);
+  printf("  -f <rate>         sampling rate of the generated test signal (default: %u Hz). The filters run at the\n", DEFAULT_SAMPLE_RATE);
+  printf("                    rate of the input, with the EQ coefficients remapped from the rate they were designed for\n");
+  printf("  -r <count>        number of passes over the input (default: 1)\n");
+  printf("  -o <prefix>       write <prefix>-tweeter.wav and <prefix>-woofer.wav\n");
+  printf("  -s                skip the per-stage measurement\n");
+  printf("  -g                compare against the default order of the stages, written as an explicit\n");
+  printf("                    stage graph with the nodes listed backwards\n");
+  printf("  -e <engine>       filter engine: df1, df2t, q31 (default: as configured). When repeated, the\n");
+  printf("                    outputs of each engine are compared against the first one\n");
+  printf("  -d <samples>      DRC control interval (default: as configured). When repeated, the outputs\n");
+  printf("                    are compared against the first one, and the DRC gain trajectories of\n");
+  printf("                    intervals above 1 are compared against the per-sample calculation\n");
+  printf("  -w <blocks>       reconfigure the filters every <blocks> blocks, in place and through the\n");
+  printf("                    double-buffered chains, and compare against the uninterrupted output\n");
+  printf("  -v <level>        digital volume, 0 (mute) to 255 (0 dB, the default) in %.1f dB steps\n", DIGITAL_VOLUME_STEP_DB);
+  printf("  -z <seconds>      append digital silence to the input, and time the music and the silence separately\n");
+  printf("  -n                leave the flush-to-zero mode off, so that only the filters keep the denormals away\n");
+  printf("  -q                skip the filters on silence once their output has decayed, like the audio task\n");
+  printf("                    (silenceConfig), and time the blocks with the silence detection\n");
+  printf("  config.bin        bson filter configuration, as stored in /usound/config-N.bin\n");
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions &options)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    bool hasValue = (i + 1) < argc;
+
+    if (arg == "-i" && hasValue)
+    {
+      options.inputFile = argv[++i];
+    }
+    else if (arg == "-p" && hasValue)
+    {
+      options.presets.push_back(argv[++i]);
+    }
+    else if (arg == "-b" && hasValue)
+    {
+      options.blockSize = strtoul(argv[++i], nullptr, 0);
+    }
+    else if (arg == "-f" && hasValue)
+    {
+      options.sampleRate = strtoul(argv[++i], nullptr, 0);
+    }
+    else if (arg == "-r" && hasValue)
+    {
+      options.repeat = strtoul(argv[++i], nullptr, 0);
+    }
+    else if (arg == "-o" && hasValue)
+    {
+      options.outputPrefix = argv[++i];
+    }
+    else if (arg == "-s")
+    {
+      options.stages = false;
+    }
+    else if (arg == "-g")
+    {
+      options.graphCheck = true;
+    }
+    else if (arg == "-e" && hasValue)
+    {
+      std::string engine = argv[++i];
+      uint32_t num = 0;
+
+      while (num < System::FilterEngine::MAX_FILTER_ENGINES && engine != engineNames[num])
+      {
+        num++;
+      }
+
+      if (num == System::FilterEngine::MAX_FILTER_ENGINES)
+      {
+        return false;
+      }
+      options.engines.push_back((System::FilterEngine) num);
+    }
+    else if (arg == "-d" && hasValue)
+    {
+      uint32_t interval = strtoul(argv[++i], nullptr, 0);
+      if (interval == 0)
+      {
+        return false;
+      }
+      options.drcIntervals.push_back(interval);
+    }
+    else if (arg == "-v" && hasValue)
+    {
+      options.volume = strtoul(argv[++i], nullptr, 0);
+      if (options.volume >= DIGITAL_VOLUME_LEVELS)
+      {
+        return false;
+      }
+    }
+    else if (arg == "-w" && hasValue)
+    {
+      options.swapInterval = strtoul(argv[++i], nullptr, 0);
+    }
+    else if (arg == "-z" && hasValue)
+    {
+      options.silenceSeconds = strtoul(argv[++i], nullptr, 0);
+    }
+    else if (arg == "-n")
+    {
+      options.flushToZero = false;
+    }
+    else if (arg == "-q")
+    {
+      options.silenceBypass = true;
+    }
+    else if (arg[0] == '-')
+    {
+      return false;
+    }
+    else
+    {
+      options.configFiles.push_back(arg);
+    }
+  }
+
+  if (options.presets.empty() && options.configFiles.empty())
+  {
+    options.presets.push_back("full");
+  }
+
+  return (options.blockSize > 0) && (options.repeat > 0) && (options.sampleRate > 0);
+}
+
+/**
+ * Times AudioFilters::run for every block of the input
+ */
+static void benchPipeline(System::FilterConfiguration config, const BenchOptions &options, const Host::WavFile &input, BenchResult &result,
+    Host::WavFile *tweeterOut, Host::WavFile *wooferOut)
+{
+  uint32_t blockSize = options.blockSize;
+  uint32_t blocks = input.getFrameCount() / blockSize;
+  std::vector<int16_t> dataIn(blockSize * 2);
+  std::vector<int16_t> tweeter(blockSize * 2);
+  std::vector<int16_t> woofer(blockSize * 2);
+  int16_t *dataOut[STREAM_ID::MAX_STREAM_COUNT] = { tweeter.data(), woofer.data() };
+
+  AudioFilters audioFilters(&config, blockSize);
+  DigitalVolume volume;
+  SilenceDetector silenceDetector(&config.silenceConfig);
+  audioFilters.setSampleRate(input.sampleRate, blockSize);
+  audioFilters.init();
+  volume.setLevel(options.volume);
+  result.planStages = audioFilters.getPlanStages();
+  result.graphCompiled = audioFilters.isGraphCompiled();
+  result.outputMixed = audioFilters.isOutputMixed();
+
+  result.blockNs.reserve(blocks * options.repeat);
+
+  for (uint32_t pass = 0; pass < options.repeat; pass++)
+  {
+    for (uint32_t block = 0; block < blocks; block++)
+    {
+      // The pipeline may work in place, so it gets a fresh copy of the input like the audio task does
+      memcpy(dataIn.data(), &input.samples[block * blockSize * 2], blockSize * 2 * sizeof(int16_t));
+
+      auto start = BenchClock::now();
+      bool bypassed = options.silenceBypass && silenceDetector.processInput(dataIn.data(), blockSize, (float32_t) input.sampleRate);
+
+      if (!bypassed)
+      {
+        float32_t gain;
+        float32_t gainStep;
+        volume.nextBlock(blockSize, gain, gainStep);
+        audioFilters.setOutputGain(gain, gainStep);
+        audioFilters.run(dataIn.data(), dataOut);
+
+        if (options.silenceBypass)
+        {
+          silenceDetector.processOutput(dataOut, blockSize);
+        }
+      }
+      auto end = BenchClock::now();
+
+      if (pass == 0 && bypassed)
+      {
+        result.firstBypassedBlock = (result.bypassedBlocks == 0) ? block : result.firstBypassedBlock;
+        result.bypassedBlocks++;
+      }
+
+      result.blockNs.push_back(elapsedNs(start, end));
+      if (options.silenceSeconds > 0)
+      {
+        bool silent = (block * blockSize) >= options.musicFrames;
+        (silent ? result.silenceNs : result.musicNs).push_back(elapsedNs(start, end));
+      }
+
+      if (pass == 0 && tweeterOut && wooferOut)
+      {
+        tweeterOut->samples.insert(tweeterOut->samples.end(), tweeter.begin(), tweeter.end());
+        wooferOut->samples.insert(wooferOut->samples.end(), woofer.begin(), woofer.end());
+      }
+    }
+  }
+}
+
+/**
+ * How the filters are reconfigured during the hot-swap measurement
+ */
+enum SwapMode
+{
+  SWAP_IN_PLACE,                    //!< AudioFilters::init on the running chain
+  SWAP_DOUBLE_BUFFERED,             //!< DoubleBufferedFilters, switching at a block boundary
+  SWAP_CROSSFADE,                   //!< DoubleBufferedFilters, crossfading over one block
+  MAX_SWAP_MODES
+};
+
+static const char *swapModeNames[MAX_SWAP_MODES] = {
+    "in place",
+    "double-buffered",
+    "crossfade"
+};
+
+/**
+ * Runs the pipeline with the same configuration reloaded every options.swapInterval blocks.
+ * Any difference to the uninterrupted output is caused by the reconfiguration.
+ */
+static void benchHotSwap(System::FilterConfiguration config, const BenchOptions &options, const Host::WavFile &input, SwapMode mode,
+    std::vector<double> &swapNs, Host::WavFile &tweeterOut, Host::WavFile &wooferOut)
+{
+  uint32_t blockSize = options.blockSize;
+  uint32_t blocks = input.getFrameCount() / blockSize;
+  std::vector<int16_t> dataIn(blockSize * 2);
+  std::vector<int16_t> tweeter(blockSize * 2);
+  std::vector<int16_t> woofer(blockSize * 2);
+  int16_t *dataOut[STREAM_ID::MAX_STREAM_COUNT] = { tweeter.data(), woofer.data() };
+
+  AudioFilters audioFilters(&config, blockSize);
+  DoubleBufferedFilters doubleBufferedFilters(&config, blockSize, mode == SWAP_CROSSFADE);
+  DigitalVolume volume;
+  audioFilters.setSampleRate(input.sampleRate, blockSize);
+  doubleBufferedFilters.setSampleRate(input.sampleRate, blockSize);
+  audioFilters.init();
+  doubleBufferedFilters.init();
+  doubleBufferedFilters.setVolume(options.volume);
+  volume.setLevel(options.volume);
+
+  tweeterOut.sampleRate = input.sampleRate;
+  wooferOut.sampleRate = input.sampleRate;
+
+  for (uint32_t block = 0; block < blocks; block++)
+  {
+    bool swap = (block > 0) && (block % options.swapInterval == 0);
+
+    memcpy(dataIn.data(), &input.samples[block * blockSize * 2], blockSize * 2 * sizeof(int16_t));
+
+    auto start = BenchClock::now();
+    if (mode == SWAP_IN_PLACE)
+    {
+      float32_t gain;
+      float32_t gainStep;
+      volume.nextBlock(blockSize, gain, gainStep);
+      audioFilters.setOutputGain(gain, gainStep);
+
+      if (swap)
+      {
+        audioFilters.init();
+      }
+      audioFilters.run(dataIn.data(), dataOut);
+    }
+    else
+    {
+      if (swap)
+      {
+        doubleBufferedFilters.reconfigure();
+      }
+      doubleBufferedFilters.run(dataIn.data(), dataOut);
+    }
+    auto end = BenchClock::now();
+
+    if (swap)
+    {
+      swapNs.push_back(elapsedNs(start, end));
+    }
+
+    tweeterOut.samples.insert(tweeterOut.samples.end(), tweeter.begin(), tweeter.end());
+    wooferOut.samples.insert(wooferOut.samples.end(), woofer.begin(), woofer.end());
+  }
+}
+
+/**
+ * Runs the FIR stage the way AudioFilters does: each channel to pDst, or the x-over split when pAux is given
+ */
+static void runFir(FirConvolver &convolver, float32_t *pDst[2], float32_t *pAux[2], uint32_t stride)
+{
+  convolver.writeInput(PcmChannel::LEFT, pDst[PcmChannel::LEFT], stride);
+  convolver.writeInput(PcmChannel::RIGHT, pDst[PcmChannel::RIGHT], stride);
+
+  for (uint32_t filter = 0; filter < convolver.getFilters(); filter++)
+  {
+    // Woofer filters have even indices in the x-over placement
+    uint32_t channel = pAux ? filter >> 1 : filter;
+    float32_t *pOut = (pAux && !(filter & 1)) ? pAux[channel] : pDst[channel];
+
+    convolver.readOutput(filter, pOut, stride);
+  }
+
+  convolver.nextBlock();
+}
+
+/**
+ * Runs the FIR stage on an interleaved Q31 buffer, the way AudioFilters does
+ */
+static void runFirQ31(FirConvolver &convolver, q31_t *pDst, q31_t *pAux, float32_t scale)
+{
+  const float32_t fullScale = 1.0f / scale;
+
+  convolver.writeInput(PcmChannel::LEFT, pDst, 2, scale);
+  convolver.writeInput(PcmChannel::RIGHT, pDst + 1, 2, scale);
+
+  for (uint32_t filter = 0; filter < convolver.getFilters(); filter++)
+  {
+    uint32_t channel = pAux ? filter >> 1 : filter;
+    q31_t *pOut = (pAux && !(filter & 1)) ? pAux : pDst;
+
+    convolver.readOutput(filter, pOut + channel, 2, fullScale);
+  }
+
+  convolver.nextBlock();
+}
+
+/**
+ * Delays the tweeters in pDst and the woofers in pAux, as AudioFilters::runDelay does
+ */
+static void runDelay(DelayAlignment &delayAlignment, float32_t *pDst[2], float32_t *pAux[2], uint32_t stride)
+{
+  float32_t *pSamples[DELAY_LINES] = { pAux[0], pDst[0], pAux[1], pDst[1] };
+
+  for (uint32_t line = 0; line < DELAY_LINES; line++)
+  {
+    delayAlignment.writeInput(line, pSamples[line], stride);
+    delayAlignment.readOutput(line, pSamples[line], stride);
+  }
+
+  delayAlignment.nextBlock();
+}
+
+/**
+ * Delays the interleaved Q31 tweeters in pDst and woofers in pAux, as AudioFilters::runDelayQ31 does
+ */
+static void runDelayQ31(DelayAlignment &delayAlignment, q31_t *pDst, q31_t *pAux, float32_t scale)
+{
+  q31_t *pSamples[DELAY_LINES] = { pAux, pDst, pAux + 1, pDst + 1 };
+
+  for (uint32_t line = 0; line < DELAY_LINES; line++)
+  {
+    delayAlignment.writeInput(line, pSamples[line], 2, scale);
+    delayAlignment.readOutput(line, pSamples[line], 2, 1.0f / scale);
+  }
+
+  delayAlignment.nextBlock();
+}
+
+/**
+ * Runs the pipeline stages individually, in the order of AudioFilters::run, and times each one of them
+ */
+static void benchStages(System::FilterConfiguration config, const BenchOptions &options, const Host::WavFile &input, BenchResult &result)
+{
+  uint32_t blockSize = options.blockSize;
+  uint32_t blocks = input.getFrameCount() / blockSize;
+  std::vector<float32_t> left(blockSize), right(blockSize), leftWoofer(blockSize), rightWoofer(blockSize);
+  std::vector<float32_t> samples(blockSize * 2), wooferSamples(blockSize * 2);
+  std::vector<q31_t> q31Samples(blockSize * 2), q31WooferSamples(blockSize * 2);
+  const float32_t q31Scale = 1.0f / (float32_t) (1u << (31 - Q31_HEADROOM_BITS));
+
+  BiquadFilters masterEqFilters(config.masterEqCoeffs[System::MasterEqCoeffcientType::LEFT],
+      config.masterEqCoeffs[System::MasterEqCoeffcientType::RIGHT], blockSize);
+  BiquadFilters xoverTweeterFilters(config.xoverEqCoeffs[System::XoverEqCoeffcientType::LEFT_TWEETER],
+      config.xoverEqCoeffs[System::XoverEqCoeffcientType::RIGHT_TWEETER], blockSize);
+  BiquadFilters xoverWooferFilters(config.xoverEqCoeffs[System::XoverEqCoeffcientType::LEFT_WOOFER],
+      config.xoverEqCoeffs[System::XoverEqCoeffcientType::RIGHT_WOOFER], blockSize);
+  Drc levelerDrc(&config.levelerDrcConfig, blockSize);
+  Drc limiterDrc(&config.limiterDrcConfig, blockSize);
+  Crossover crossover(&config.xoverConfig, blockSize);
+  PeakLimiter peakLimiter(&config.peakLimiterConfig, blockSize);
+  FirConvolver firConvolver(&config.firConfig, blockSize);
+  DelayAlignment delayAlignment(&config.delayConfig, blockSize);
+
+  masterEqFilters.setSampleRate(config.eqSampleRateHz, input.sampleRate);
+  xoverTweeterFilters.setSampleRate(config.eqSampleRateHz, input.sampleRate);
+  xoverWooferFilters.setSampleRate(config.eqSampleRateHz, input.sampleRate);
+  masterEqFilters.init(config.filterEngine);
+  xoverTweeterFilters.init(config.filterEngine);
+  xoverWooferFilters.init(config.filterEngine);
+  levelerDrc.init();
+  limiterDrc.init();
+  crossover.init();
+  peakLimiter.init();
+  firConvolver.init();
+  delayAlignment.init();
+
+  // With the complementary crossover or the FIR split, the woofer cascades work in place on the split woofer band
+  bool firCrossover = !firConvolver.isBypassed() && config.firConfig.placement == System::FirPlacement::FIR_PLACEMENT_CROSSOVER;
+  bool complementary = (config.xoverConfig.type == System::CrossoverType::CROSSOVER_LR4) || firCrossover;
+  float32_t *wooferInLeft = complementary ? leftWoofer.data() : left.data();
+  float32_t *wooferInRight = complementary ? rightWoofer.data() : right.data();
+  float32_t *wooferIn = complementary ? wooferSamples.data() : samples.data();
+  q31_t *q31WooferIn = complementary ? q31WooferSamples.data() : q31Samples.data();
+
+  // Without the x-over, the woofers share the buffers with the tweeters and the limiter runs on the tweeters only
+  float32_t *limiterWooferLeft = config.xoverEqEnabled ? leftWoofer.data() : nullptr;
+  float32_t *limiterWooferRight = config.xoverEqEnabled ? rightWoofer.data() : nullptr;
+  float32_t *limiterWoofer = config.xoverEqEnabled ? wooferSamples.data() : nullptr;
+  q31_t *q31LimiterWoofer = config.xoverEqEnabled ? q31WooferSamples.data() : nullptr;
+
+  result.stageActive[STAGE_MASTER_EQ] = config.masterEqEnabled;
+  result.stageActive[STAGE_MASTER_FIR] = !firConvolver.isBypassed() && !firCrossover;
+  result.stageActive[STAGE_LEVELER_DRC] = config.levelerDrcConfig.enabled;
+  result.stageActive[STAGE_LIMITER_DRC] = config.limiterDrcConfig.enabled && !config.peakLimiterConfig.enabled;
+  result.stageActive[STAGE_XOVER_SPLIT] = config.xoverEqEnabled && complementary;
+  result.stageActive[STAGE_XOVER_WOOFER] = config.xoverEqEnabled;
+  result.stageActive[STAGE_XOVER_TWEETER] = config.xoverEqEnabled;
+  result.stageActive[STAGE_DELAY] = !delayAlignment.isBypassed();
+  result.stageActive[STAGE_PEAK_LIMITER] = config.peakLimiterConfig.enabled;
+  result.peakLimiterBytes = peakLimiter.getMemorySize();
+  result.peakLimiterLatency = peakLimiter.getLatency();
+  result.delayBytes = delayAlignment.getMemorySize();
+
+  for (uint32_t line = 0; line < DELAY_LINES; line++)
+  {
+    result.delays[line] = delayAlignment.getDelay(line);
+  }
+
+#if ALA_MODULE_ENABLED == 1
+  USoundAla ala(&config.alaConfig, blockSize);
+  ala.init();
+  result.stageActive[STAGE_ALA] = config.alaConfig.enabled;
+#endif
+
+  // The stages of each engine, as they are called by AudioFilters
+  std::function<void()> stages[MAX_BENCH_STAGES];
+  std::function<void(const int16_t*)> convertInput;
+
+  switch (config.filterEngine)
+  {
+  case System::FilterEngine::FILTER_ENGINE_STEREO_DF2T:
+    convertInput = [&](const int16_t *pcm)
+    {
+      for (uint32_t i = 0; i < blockSize * 2; i++)
+      {
+        samples[i] = (float32_t) pcm[i] / (1 << 15);
+      }
+    };
+    stages[STAGE_MASTER_EQ] = [&]() { masterEqFilters.runStereo(samples.data(), samples.data()); };
+    stages[STAGE_MASTER_FIR] = [&]()
+    {
+      float32_t *pDst[2] = { samples.data(), samples.data() + 1 };
+      runFir(firConvolver, pDst, nullptr, 2);
+    };
+    stages[STAGE_LEVELER_DRC] = [&]() { levelerDrc.runInterleaved(samples.data()); };
+    stages[STAGE_LIMITER_DRC] = [&]() { limiterDrc.runInterleaved(samples.data()); };
+    stages[STAGE_XOVER_SPLIT] = [&]()
+    {
+      float32_t *pDst[2] = { samples.data(), samples.data() + 1 };
+      float32_t *pAux[2] = { wooferSamples.data(), wooferSamples.data() + 1 };
+
+      if (firCrossover)
+      {
+        runFir(firConvolver, pDst, pAux, 2);
+      }
+      else
+      {
+        crossover.runInterleaved(samples.data(), wooferSamples.data(), samples.data());
+      }
+    };
+    stages[STAGE_XOVER_WOOFER] = [&]() { xoverWooferFilters.runStereo(wooferIn, wooferSamples.data()); };
+    stages[STAGE_XOVER_TWEETER] = [&]() { xoverTweeterFilters.runStereo(samples.data(), samples.data()); };
+    stages[STAGE_DELAY] = [&]()
+    {
+      float32_t *pDst[2] = { samples.data(), samples.data() + 1 };
+      float32_t *pAux[2] = { wooferSamples.data(), wooferSamples.data() + 1 };
+      runDelay(delayAlignment, pDst, pAux, 2);
+    };
+    stages[STAGE_PEAK_LIMITER] = [&]()
+    {
+      peakLimiter.run(samples.data(), samples.data() + 1, limiterWoofer, limiterWoofer ? limiterWoofer + 1 : nullptr, 2);
+    };
+    break;
+
+  case System::FilterEngine::FILTER_ENGINE_Q31:
+    convertInput = [&](const int16_t *pcm)
+    {
+      for (uint32_t i = 0; i < blockSize * 2; i++)
+      {
+        q31Samples[i] = (q31_t) pcm[i] << (16 - Q31_HEADROOM_BITS);
+      }
+    };
+    stages[STAGE_MASTER_EQ] = [&]() { masterEqFilters.runStereoQ31(q31Samples.data(), q31Samples.data()); };
+    stages[STAGE_MASTER_FIR] = [&]() { runFirQ31(firConvolver, q31Samples.data(), nullptr, q31Scale); };
+    stages[STAGE_LEVELER_DRC] = [&]() { levelerDrc.runInterleavedQ31(q31Samples.data(), q31Scale); };
+    stages[STAGE_LIMITER_DRC] = [&]() { limiterDrc.runInterleavedQ31(q31Samples.data(), q31Scale); };
+    stages[STAGE_XOVER_SPLIT] = [&]()
+    {
+      if (firCrossover)
+      {
+        runFirQ31(firConvolver, q31Samples.data(), q31WooferSamples.data(), q31Scale);
+      }
+      else
+      {
+        crossover.runInterleavedQ31(q31Samples.data(), q31WooferSamples.data(), q31Samples.data());
+      }
+    };
+    stages[STAGE_XOVER_WOOFER] = [&]() { xoverWooferFilters.runStereoQ31(q31WooferIn, q31WooferSamples.data()); };
+    stages[STAGE_XOVER_TWEETER] = [&]() { xoverTweeterFilters.runStereoQ31(q31Samples.data(), q31Samples.data()); };
+    stages[STAGE_DELAY] = [&]() { runDelayQ31(delayAlignment, q31Samples.data(), q31WooferSamples.data(), q31Scale); };
+    stages[STAGE_PEAK_LIMITER] = [&]() { peakLimiter.runInterleavedQ31(q31Samples.data(), q31LimiterWoofer, q31Scale); };
+    break;
+
+  default:
+    convertInput = [&](const int16_t *pcm)
+    {
+      for (uint32_t i = 0; i < blockSize; i++)
+      {
+        left[i] = (float32_t) pcm[2 * i] / (1 << 15);
+        right[i] = (float32_t) pcm[2 * i + 1] / (1 << 15);
+      }
+    };
+    stages[STAGE_MASTER_EQ] = [&]()
+    {
+      masterEqFilters.run(PcmChannel::LEFT, left.data(), left.data());
+      masterEqFilters.run(PcmChannel::RIGHT, right.data(), right.data());
+    };
+    stages[STAGE_MASTER_FIR] = [&]()
+    {
+      float32_t *pDst[2] = { left.data(), right.data() };
+      runFir(firConvolver, pDst, nullptr, 1);
+    };
+    stages[STAGE_LEVELER_DRC] = [&]() { levelerDrc.run(left.data(), right.data()); };
+    stages[STAGE_LIMITER_DRC] = [&]() { limiterDrc.run(left.data(), right.data()); };
+    stages[STAGE_XOVER_SPLIT] = [&]()
+    {
+      float32_t *pDst[2] = { left.data(), right.data() };
+      float32_t *pAux[2] = { leftWoofer.data(), rightWoofer.data() };
+
+      if (firCrossover)
+      {
+        runFir(firConvolver, pDst, pAux, 1);
+      }
+      else
+      {
+        crossover.run(left.data(), right.data(), leftWoofer.data(), rightWoofer.data(), left.data(), right.data());
+      }
+    };
+    stages[STAGE_XOVER_WOOFER] = [&]()
+    {
+      xoverWooferFilters.run(PcmChannel::LEFT, wooferInLeft, leftWoofer.data());
+      xoverWooferFilters.run(PcmChannel::RIGHT, wooferInRight, rightWoofer.data());
+    };
+    stages[STAGE_XOVER_TWEETER] = [&]()
+    {
+      xoverTweeterFilters.run(PcmChannel::LEFT, left.data(), left.data());
+      xoverTweeterFilters.run(PcmChannel::RIGHT, right.data(), right.data());
+    };
+    stages[STAGE_DELAY] = [&]()
+    {
+      float32_t *pDst[2] = { left.data(), right.data() };
+      float32_t *pAux[2] = { leftWoofer.data(), rightWoofer.data() };
+      runDelay(delayAlignment, pDst, pAux, 1);
+    };
+    stages[STAGE_PEAK_LIMITER] = [&]() { peakLimiter.run(left.data(), right.data(), limiterWooferLeft, limiterWooferRight, 1); };
+    break;
+  }
+
+  stages[STAGE_ALA] = [&]()
+  {
+#if ALA_MODULE_ENABLED == 1
+    // The interleaved chains split the channels for ALA, which is part of the stage cost
+    for (uint32_t i = 0; config.filterEngine == System::FilterEngine::FILTER_ENGINE_STEREO_DF2T && i < blockSize; i++)
+    {
+      left[i] = samples[2 * i];
+      right[i] = samples[2 * i + 1];
+    }
+
+    for (uint32_t i = 0; config.filterEngine == System::FilterEngine::FILTER_ENGINE_Q31 && i < blockSize; i++)
+    {
+      left[i] = (float32_t) q31Samples[2 * i] * q31Scale;
+      right[i] = (float32_t) q31Samples[2 * i + 1] * q31Scale;
+    }
+
+    ala.run(left.data(), right.data());
+#endif
+  };
+
+  for (uint32_t pass = 0; pass < options.repeat; pass++)
+  {
+    for (uint32_t block = 0; block < blocks; block++)
+    {
+      BenchClock::time_point ts[MAX_BENCH_STAGES + 1];
+
+      convertInput(&input.samples[block * blockSize * 2]);
+
+      for (uint32_t stage = 0; stage < MAX_BENCH_STAGES; stage++)
+      {
+        ts[stage] = BenchClock::now();
+        if (result.stageActive[stage])
+        {
+          stages[stage]();
+        }
+      }
+      ts[MAX_BENCH_STAGES] = BenchClock::now();
+
+      for (uint32_t stage = 0; stage < MAX_BENCH_STAGES; stage++)
+      {
+        double ns = elapsedNs(ts[stage], ts[stage + 1]);
+        result.stageNs[stage] += ns;
+        result.stagesTotalNs += ns;
+      }
+    }
+  }
+
+  uint32_t runs = blocks * options.repeat;
+  for (uint32_t stage = 0; stage < MAX_BENCH_STAGES; stage++)
+  {
+    result.stageNs[stage] /= runs;
+  }
+  result.stagesTotalNs /= runs;
+}
+
+/**
+ * Prints the mean and median of a part of the block times
+ */
+static void printBlockTimes(const char *part, std::vector<double> blockNs)
+{
+  if (blockNs.empty())
+  {
+    return;
+  }
+
+  std::sort(blockNs.begin(), blockNs.end());
+
+  double mean = 0.0;
+  for (double ns : blockNs)
+  {
+    mean += ns;
+  }
+  mean /= blockNs.size();
+
+  printf("    %-16s mean %.0f ns/block, median %.0f, %zu blocks\n", part, mean, blockNs[blockNs.size() / 2], blockNs.size());
+}
+
+static void printReport(const std::string &name, const BenchOptions &options, const Host::WavFile &input, BenchResult &result)
+{
+  std::vector<double> sorted = result.blockNs;
+  std::sort(sorted.begin(), sorted.end());
+
+  double mean = 0.0;
+  for (double ns : sorted)
+  {
+    mean += ns;
+  }
+  mean /= sorted.size();
+
+  double median = sorted[sorted.size() / 2];
+  double p99 = sorted[std::min(sorted.size() - 1, (size_t) (sorted.size() * 0.99))];
+  double deadlineNs = 1e9 * options.blockSize / input.sampleRate;
+
+  printf("\n%s\n", name.c_str());
+  printf("  block:            %u frames (%.3f ms @ %u Hz), %zu blocks\n", options.blockSize, deadlineNs / 1e6, input.sampleRate, sorted.size());
+  printf("  AudioFilters::run mean %.0f ns/block, median %.0f, p99 %.0f, max %.0f\n", mean, median, p99, sorted.back());
+  printf("  realtime factor:  %.1fx (%.2f%% of the block deadline)\n", deadlineNs / mean, 100.0 * mean / deadlineNs);
+  printf("  execution plan:   %u stages%s\n", result.planStages, result.graphCompiled ? ", stage graph" : "");
+  printf("  output routing:   %s\n", result.outputMixed ? "mixed (sum of the weighted sources per slot)" : "routed (one source per slot)");
+
+  if (options.silenceSeconds > 0)
+  {
+    printf("  music and silence (flush-to-zero %s):\n", options.flushToZero ? "on" : "off");
+    printBlockTimes("music", result.musicNs);
+    printBlockTimes("silence", result.silenceNs);
+  }
+
+  if (options.silenceBypass)
+  {
+    printf("  silence bypass:   %u blocks bypassed", result.bypassedBlocks);
+    if (result.bypassedBlocks > 0)
+    {
+      printf(", from %.3f s into the silence", (double) ((int64_t) result.firstBypassedBlock * options.blockSize - options.musicFrames) / input.sampleRate);
+    }
+    printf("\n");
+  }
+
+  if (!options.stages)
+  {
+    return;
+  }
+
+  printf("  per stage (mean ns/block):\n");
+  for (uint32_t stage = 0; stage < MAX_BENCH_STAGES; stage++)
+  {
+    printf("    %-16s %8.0f%s\n", stageNames[stage], result.stageNs[stage], result.stageActive[stage] ? "" : "   (disabled)");
+  }
+  printf("    %-16s %8.0f   (format conversion and overhead)\n", "remainder", std::max(0.0, mean - result.stagesTotalNs));
+
+  if (result.stageActive[STAGE_DELAY])
+  {
+    printf("  delay:            %u bytes, woofer %.2f/%.2f, tweeter %.2f/%.2f samples (left/right)\n", result.delayBytes,
+        result.delays[System::XoverEqCoeffcientType::LEFT_WOOFER], result.delays[System::XoverEqCoeffcientType::RIGHT_WOOFER],
+        result.delays[System::XoverEqCoeffcientType::LEFT_TWEETER], result.delays[System::XoverEqCoeffcientType::RIGHT_TWEETER]);
+  }
+
+  if (result.stageActive[STAGE_PEAK_LIMITER])
+  {
+    printf("  peak limiter:     %u bytes, %u frames lookahead (%.2f ms)\n", result.peakLimiterBytes, result.peakLimiterLatency,
+        1e3 * result.peakLimiterLatency / input.sampleRate);
+  }
+}
+
+/**
+ * Prints the peak level of a 16bit output and the number of samples at full scale, which are likely clipped
+ */
+static void printOutputPeak(const char *stream, const Host::WavFile &output)
+{
+  int32_t peak = 0;
+  size_t clipped = 0;
+
+  for (int16_t sample : output.samples)
+  {
+    peak = std::max(peak, std::abs((int32_t) sample));
+    clipped += (sample == INT16_MAX || sample == INT16_MIN);
+  }
+
+  printf("    %-8s peak %6.2f dBFS, %zu samples at full scale\n", stream, 20.0 * log10(std::max(peak, 1) / 32768.0), clipped);
+}
+
+/**
+ * Prints the largest and the RMS difference between two 16bit outputs, in LSBs
+ */
+static void printDifference(const char *stream, const Host::WavFile &reference, const Host::WavFile &output)
+{
+  size_t count = std::min(reference.samples.size(), output.samples.size());
+  int32_t maxDiff = 0;
+  double sumSquares = 0.0;
+
+  for (size_t i = 0; i < count; i++)
+  {
+    int32_t diff = std::abs((int32_t) output.samples[i] - (int32_t) reference.samples[i]);
+    maxDiff = std::max(maxDiff, diff);
+    sumSquares += (double) diff * diff;
+  }
+
+  printf("    %-16s max %d LSB, rms %.4f LSB\n", stream, maxDiff, count ? sqrt(sumSquares / count) : 0.0);
+}
+
+/**
+ * Writes the default order of AudioFilters as an explicit stage graph, with the nodes listed backwards,
+ * so that the plan only comes out the same if the graph is sorted and its references are followed correctly
+ * @param config
+ */
+static void setReversedDefaultGraph(System::FilterConfiguration &config)
+{
+  System::StageGraphConfiguration forward;
+  System::StageGraphConfiguration &graph = config.stageGraph;
+
+  int32_t last = Host::addStageNode(forward, System::StageType::STAGE_TYPE_MASTER_EQ, STAGE_INPUT, 0);
+  last = Host::addStageNode(forward, System::StageType::STAGE_TYPE_MASTER_FIR, last, 0);
+  last = Host::addStageNode(forward, System::StageType::STAGE_TYPE_LEVELER_DRC, last, 0);
+
+  if (!config.peakLimiterConfig.enabled)
+  {
+    last = Host::addStageNode(forward, System::StageType::STAGE_TYPE_LIMITER_DRC, last, 0);
+  }
+
+  const int32_t split = Host::addStageNode(forward, System::StageType::STAGE_TYPE_XOVER_SPLIT, last, 0);
+  const int32_t woofer = Host::addStageNode(forward, System::StageType::STAGE_TYPE_WOOFER_EQ, split, 1);
+  const int32_t tweeter = Host::addStageNode(forward, System::StageType::STAGE_TYPE_TWEETER_EQ, split, 0);
+  const int32_t delay = Host::addStageNode(forward, System::StageType::STAGE_TYPE_DELAY, tweeter, 0);
+  const int32_t limiter = Host::addStageNode(forward, System::StageType::STAGE_TYPE_PEAK_LIMITER, delay, 0);
+  const int32_t ala = Host::addStageNode(forward, System::StageType::STAGE_TYPE_ALA, limiter, 0);
+
+  forward.nodes[delay].aux.node = woofer;
+  forward.nodes[limiter].aux.node = delay;
+  forward.nodes[limiter].aux.band = 1;
+
+  auto reverse = [&forward](System::StageReference ref)
+  {
+    ref.node = (ref.node >= 0) ? (int32_t) forward.nodeCount - 1 - ref.node : ref.node;
+    return ref;
+  };
+
+  graph = System::StageGraphConfiguration();
+  graph.nodeCount = forward.nodeCount;
+
+  for (uint32_t i = 0; i < forward.nodeCount; i++)
+  {
+    System::StageNodeConfiguration &node = graph.nodes[forward.nodeCount - 1 - i];
+
+    node.type = forward.nodes[i].type;
+    node.input = reverse(forward.nodes[i].input);
+    node.aux = reverse(forward.nodes[i].aux);
+  }
+
+  graph.tweeter.node = forward.nodeCount - 1 - ala;
+  graph.woofer.node = forward.nodeCount - 1 - limiter;
+  graph.woofer.band = 1;
+}
+
+/**
+ * Runs one DRC with the given control interval against the per-sample calculation, on the same input,
+ * and prints how far the gain trajectories are apart, in dB
+ */
+static void compareDrcGain(const char *drcName, const System::DrcConfiguration &drcConfig, uint32_t interval,
+    const BenchOptions &options, const Host::WavFile &input)
+{
+  uint32_t blockSize = options.blockSize;
+  uint32_t blocks = input.getFrameCount() / blockSize;
+  System::DrcConfiguration referenceConfig = drcConfig;
+  System::DrcConfiguration testConfig = drcConfig;
+  std::vector<float32_t> referenceSamples(blockSize * 2), testSamples(blockSize * 2);
+  double maxDiff = 0.0;
+  double sumSquares = 0.0;
+
+  referenceConfig.controlInterval = 1;
+  testConfig.controlInterval = interval;
+
+  Drc reference(&referenceConfig, blockSize);
+  Drc test(&testConfig, blockSize);
+  reference.init();
+  test.init();
+
+  for (uint32_t block = 0; block < blocks; block++)
+  {
+    for (uint32_t i = 0; i < blockSize * 2; i++)
+    {
+      referenceSamples[i] = (float32_t) input.samples[block * blockSize * 2 + i] / (1 << 15);
+      testSamples[i] = referenceSamples[i];
+    }
+
+    reference.runInterleaved(referenceSamples.data());
+    test.runInterleaved(testSamples.data());
+
+    for (uint32_t i = 0; i < blockSize; i++)
+    {
+      double diff = std::fabs(20.0 * log10(test.getGain()[i] / reference.getGain()[i]));
+      maxDiff = std::max(maxDiff, diff);
+      sumSquares += diff * diff;
+    }
+  }
+
+  printf("    %-16s max %.3f dB, rms %.4f dB\n", drcName, maxDiff, sqrt(sumSquares / (blocks * blockSize)));
+}
+
+/**
+ * Runs the benchmark for every requested filter engine and DRC control interval.
+ * The outputs of each variant are compared against the first one.
+ */
+static bool runBench(const std::string &name, System::FilterConfiguration config, const BenchOptions &options, const Host::WavFile &input)
+{
+  std::vector<System::FilterEngine> engines = options.engines;
+  std::vector<uint32_t> drcIntervals = options.drcIntervals;
+  std::vector<BenchVariant> variants;
+  Host::WavFile referenceTweeter, referenceWoofer;
+
+  if (engines.empty())
+  {
+    engines.push_back(config.filterEngine);
+  }
+
+  // The stages run at the rate of the input, as AudioFilters::init does for the audio sampling rate
+  config.levelerDrcConfig.sampleRateHz = input.sampleRate;
+  config.limiterDrcConfig.sampleRateHz = input.sampleRate;
+  config.peakLimiterConfig.sampleRateHz = input.sampleRate;
+  config.xoverConfig.sampleRateHz = input.sampleRate;
+  config.delayConfig.sampleRateHz = input.sampleRate;
+
+  for (auto engine : engines)
+  {
+    if (drcIntervals.empty())
+    {
+      variants.push_back({ engine, config.levelerDrcConfig.controlInterval, engineNames[engine] });
+    }
+
+    for (auto interval : drcIntervals)
+    {
+      variants.push_back({ engine, interval, std::string(engineNames[engine]) + "-drc" + std::to_string(interval) });
+    }
+  }
+
+  for (size_t num = 0; num < variants.size(); num++)
+  {
+    BenchResult result;
+    Host::WavFile tweeterOut, wooferOut;
+    const BenchVariant &variant = variants[num];
+    std::string outputPrefix = options.outputPrefix + ((variants.size() > 1) ? "-" + variant.name : "");
+
+    config.filterEngine = variant.engine;
+    if (!drcIntervals.empty())
+    {
+      config.levelerDrcConfig.controlInterval = variant.drcInterval;
+      config.limiterDrcConfig.controlInterval = variant.drcInterval;
+    }
+
+    tweeterOut.sampleRate = input.sampleRate;
+    wooferOut.sampleRate = input.sampleRate;
+
+    benchPipeline(config, options, input, result, &tweeterOut, &wooferOut);
+    if (options.stages)
+    {
+      benchStages(config, options, input, result);
+    }
+
+    printReport(name + ", engine: " + engineNames[variant.engine] + ", drc interval: "
+        + std::to_string(config.levelerDrcConfig.controlInterval) + "/" + std::to_string(config.limiterDrcConfig.controlInterval),
+        options, input, result);
+
+    printf("  output:\n");
+    printOutputPeak("tweeter", tweeterOut);
+    printOutputPeak("woofer", wooferOut);
+
+    if (num == 0)
+    {
+      referenceTweeter = tweeterOut;
+      referenceWoofer = wooferOut;
+    }
+    else
+    {
+      printf("  difference to %s:\n", variants[0].name.c_str());
+      printDifference("tweeter", referenceTweeter, tweeterOut);
+      printDifference("woofer", referenceWoofer, wooferOut);
+    }
+
+    if (options.graphCheck)
+    {
+      System::FilterConfiguration graphConfig = config;
+      BenchOptions graphOptions = options;
+      BenchResult graphResult;
+      Host::WavFile graphTweeter, graphWoofer;
+
+      graphOptions.repeat = 1;
+      setReversedDefaultGraph(graphConfig);
+      benchPipeline(graphConfig, graphOptions, input, graphResult, &graphTweeter, &graphWoofer);
+      printf("  default order as a stage graph (%u stages%s):\n", graphResult.planStages,
+          graphResult.graphCompiled ? "" : ", not compiled");
+      printDifference("tweeter", graphTweeter, tweeterOut);
+      printDifference("woofer", graphWoofer, wooferOut);
+    }
+
+    for (uint32_t mode = 0; options.swapInterval > 0 && mode < MAX_SWAP_MODES; mode++)
+    {
+      std::vector<double> swapNs;
+      Host::WavFile swapTweeter, swapWoofer;
+
+      benchHotSwap(config, options, input, (SwapMode) mode, swapNs, swapTweeter, swapWoofer);
+
+      double maxNs = swapNs.empty() ? 0.0 : *std::max_element(swapNs.begin(), swapNs.end());
+      printf("  reconfiguration every %u blocks, %s: %zu swaps, max %.0f ns/block incl. the reconfiguration\n", options.swapInterval,
+          swapModeNames[mode], swapNs.size(), maxNs);
+      printDifference("tweeter", tweeterOut, swapTweeter);
+      printDifference("woofer", wooferOut, swapWoofer);
+    }
+
+    if (!drcIntervals.empty() && variant.drcInterval > 1)
+    {
+      printf("  drc gain difference to the per-sample calculation:\n");
+      if (config.levelerDrcConfig.enabled)
+      {
+        compareDrcGain("leveler drc", config.levelerDrcConfig, variant.drcInterval, options, input);
+      }
+      if (config.limiterDrcConfig.enabled)
+      {
+        compareDrcGain("limiter drc", config.limiterDrcConfig, variant.drcInterval, options, input);
+      }
+    }
+
+    if (!options.outputPrefix.empty())
+    {
+      if (!tweeterOut.save(outputPrefix + "-tweeter.wav") || !wooferOut.save(outputPrefix + "-woofer.wav"))
+      {
+        fprintf(stderr, "failed to write %s-*.wav\n", outputPrefix.c_str());
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  BenchOptions options;
+  Host::WavFile input;
+
+  if (!parseOptions(argc, argv, options))
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  if (options.inputFile.empty())
+  {
+    Host::generateTestSignal(input, options.sampleRate, TEST_SIGNAL_DURATION_S);
+  }
+  else if (!input.load(options.inputFile))
+  {
+    fprintf(stderr, "cannot load %s (16bit PCM wav expected)\n", options.inputFile.c_str());
+    return 1;
+  }
+
+  if (input.getFrameCount() < options.blockSize)
+  {
+    fprintf(stderr, "the input is shorter than one block\n");
+    return 1;
+  }
+
+  options.musicFrames = input.getFrameCount();
+  input.samples.resize(input.samples.size() + options.silenceSeconds * input.sampleRate * 2, 0);
+
+  // As the audio task does
+  if (options.flushToZero)
+  {
+    enable_flush_to_zero();
+  }
+
+  bool result = true;
+  System::FilterConfiguration config;
+
+  for (auto &preset : options.presets)
+  {
+    if (!Host::loadPreset(preset, config))
+    {
+      fprintf(stderr, "unknown preset %s\n", preset.c_str());
+      return 1;
+    }
+
+    result &= runBench("preset: " + preset, config, options, input);
+  }
+
+  for (auto &configFile : options.configFiles)
+  {
+    if (!Host::loadConfigFile(configFile, config))
+    {
+      fprintf(stderr, "cannot load %s\n", configFile.c_str());
+      return 1;
+    }
+
+    result &= runBench("config: " + configFile + (config.name.empty() ? "" : " (" + config.name + ")"), config, options, input);
+  }
+
+  return result ? 0 : 1;
+}
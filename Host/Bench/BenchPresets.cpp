@@ -0,0 +1,484 @@
+//====================================================================
+//
+// COPYRIGHT 2026 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: Filter configurations and test signals used by the host benchmark
+//  Filename: BenchPresets.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#include "BenchPresets.hpp"
+#include "Controllers/System/pub/FilterConfigParser.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#define BENCH_SAMPLE_RATE       48000.0f
+#define BENCH_XOVER_FREQUENCY   2500.0f
+#define BENCH_FIR_TAPS          1023        //!< Linear-phase crossover of the FIR presets (10.6 ms of delay at 48 kHz)
+#define BUTTERWORTH_Q           0.70710678f
+#define BENCH_SPEED_OF_SOUND    343.0f      //!< m/s
+
+namespace Host
+{
+
+/**
+ * Stores a normalised biquad in the CMSIS layout {b0, b1, b2, -a1, -a2}
+ */
+static void storeBiquad(float32_t *coeffs, double b0, double b1, double b2, double a0, double a1, double a2)
+{
+  coeffs[0] = b0 / a0;
+  coeffs[1] = b1 / a0;
+  coeffs[2] = b2 / a0;
+  coeffs[3] = -a1 / a0;
+  coeffs[4] = -a2 / a0;
+}
+
+/**
+ * Peaking EQ section (RBJ audio EQ cookbook)
+ */
+void designPeaking(float32_t *coeffs, float32_t sampleRate, float32_t frequency, float32_t q, float32_t gainDb)
+{
+  double a = pow(10.0, gainDb / 40.0);
+  double w0 = 2.0 * M_PI * frequency / sampleRate;
+  double alpha = sin(w0) / (2.0 * q);
+
+  storeBiquad(coeffs, 1.0 + alpha * a, -2.0 * cos(w0), 1.0 - alpha * a, 1.0 + alpha / a, -2.0 * cos(w0), 1.0 - alpha / a);
+}
+
+/**
+ * 2nd order low pass section (RBJ audio EQ cookbook)
+ */
+void designLowPass(float32_t *coeffs, float32_t sampleRate, float32_t frequency, float32_t q)
+{
+  double w0 = 2.0 * M_PI * frequency / sampleRate;
+  double alpha = sin(w0) / (2.0 * q);
+  double cosw0 = cos(w0);
+
+  storeBiquad(coeffs, (1.0 - cosw0) / 2.0, 1.0 - cosw0, (1.0 - cosw0) / 2.0, 1.0 + alpha, -2.0 * cosw0, 1.0 - alpha);
+}
+
+/**
+ * 2nd order high pass section (RBJ audio EQ cookbook)
+ */
+void designHighPass(float32_t *coeffs, float32_t sampleRate, float32_t frequency, float32_t q)
+{
+  double w0 = 2.0 * M_PI * frequency / sampleRate;
+  double alpha = sin(w0) / (2.0 * q);
+  double cosw0 = cos(w0);
+
+  storeBiquad(coeffs, (1.0 + cosw0) / 2.0, -(1.0 + cosw0), (1.0 + cosw0) / 2.0, 1.0 + alpha, -2.0 * cosw0, 1.0 - alpha);
+}
+
+/**
+ * Pass-through section, as used by the firmware to mark unused stages
+ */
+void designIdentity(float32_t *coeffs)
+{
+  storeBiquad(coeffs, 1.0, 0.0, 0.0, 1.0, 0.0, 0.0);
+}
+
+/**
+ * Linear-phase crossover: a Blackman windowed sinc low pass for the woofers, and its complement (a delayed
+ * impulse minus the low pass) for the tweeters, so that both bands sum to a pure delay of (taps - 1) / 2 frames
+ * @param firConfig the placement is set to FIR_PLACEMENT_CROSSOVER
+ * @param taps an odd number of taps
+ * @param sampleRate
+ * @param frequency the -6 dB point of both bands
+ */
+void designFirCrossover(System::FirConfiguration &firConfig, uint32_t taps, float32_t sampleRate, float32_t frequency)
+{
+  const uint32_t filterCount = System::XoverEqCoeffcientType::MAX_XOVER_EQ_COEFF_TYPES;
+  const double cutoff = frequency / sampleRate;
+  const int32_t center = (int32_t) (taps - 1) / 2;
+  float32_t *coefficients = new float32_t[filterCount * taps];
+
+  for (uint32_t i = 0; i < taps; i++)
+  {
+    double n = (double) ((int32_t) i - center);
+    double sinc = (n == 0.0) ? 2.0 * cutoff : sin(2.0 * M_PI * cutoff * n) / (M_PI * n);
+    double phase = 2.0 * M_PI * i / (taps - 1);
+    double window = 0.42 - 0.5 * cos(phase) + 0.08 * cos(2.0 * phase);
+    double lowPass = sinc * window;
+    double highPass = (((int32_t) i == center) ? 1.0 : 0.0) - lowPass;
+
+    coefficients[System::XoverEqCoeffcientType::LEFT_WOOFER * taps + i] = (float32_t) lowPass;
+    coefficients[System::XoverEqCoeffcientType::RIGHT_WOOFER * taps + i] = (float32_t) lowPass;
+    coefficients[System::XoverEqCoeffcientType::LEFT_TWEETER * taps + i] = (float32_t) highPass;
+    coefficients[System::XoverEqCoeffcientType::RIGHT_TWEETER * taps + i] = (float32_t) highPass;
+  }
+
+  firConfig.placement = System::FirPlacement::FIR_PLACEMENT_CROSSOVER;
+  firConfig.coefficients = std::shared_ptr<const float32_t>(coefficients, std::default_delete<const float32_t[]>());
+  firConfig.taps = taps;
+  firConfig.fileName.clear();
+  firConfig.enabled = true;
+}
+
+static void resetConfig(System::FilterConfiguration &config, const char *name)
+{
+  config = System::FilterConfiguration();
+  config.name = name;
+  config.masterEqEnabled = false;
+  config.xoverEqEnabled = false;
+
+  for (uint32_t i = 0; i < MASTER_EQ_STAGES; i++)
+  {
+    designIdentity(&config.masterEqCoeffs[System::MasterEqCoeffcientType::LEFT][i * 5]);
+    designIdentity(&config.masterEqCoeffs[System::MasterEqCoeffcientType::RIGHT][i * 5]);
+  }
+
+  for (uint32_t type = 0; type < System::XoverEqCoeffcientType::MAX_XOVER_EQ_COEFF_TYPES; type++)
+  {
+    for (uint32_t i = 0; i < XOVER_EQ_STAGES; i++)
+    {
+      designIdentity(&config.xoverEqCoeffs[type][i * 5]);
+    }
+  }
+
+#if ALA_MODULE_ENABLED == 1
+  config.alaConfig.enabled = false;
+#endif
+}
+
+/**
+ * Linkwitz-Riley 4th order crossover (two cascaded Butterworth sections per band)
+ */
+static void addCrossover(System::FilterConfiguration &config)
+{
+  config.xoverEqEnabled = true;
+
+  for (uint32_t i = 0; i < 2; i++)
+  {
+    designLowPass(&config.xoverEqCoeffs[System::XoverEqCoeffcientType::LEFT_WOOFER][i * 5], BENCH_SAMPLE_RATE, BENCH_XOVER_FREQUENCY, BUTTERWORTH_Q);
+    designLowPass(&config.xoverEqCoeffs[System::XoverEqCoeffcientType::RIGHT_WOOFER][i * 5], BENCH_SAMPLE_RATE, BENCH_XOVER_FREQUENCY, BUTTERWORTH_Q);
+    designHighPass(&config.xoverEqCoeffs[System::XoverEqCoeffcientType::LEFT_TWEETER][i * 5], BENCH_SAMPLE_RATE, BENCH_XOVER_FREQUENCY, BUTTERWORTH_Q);
+    designHighPass(&config.xoverEqCoeffs[System::XoverEqCoeffcientType::RIGHT_TWEETER][i * 5], BENCH_SAMPLE_RATE, BENCH_XOVER_FREQUENCY, BUTTERWORTH_Q);
+  }
+}
+
+/**
+ * Linkwitz-Riley 4th order crossover, computed by the complementary crossover stage
+ */
+static void addComplementaryCrossover(System::FilterConfiguration &config)
+{
+  config.xoverEqEnabled = true;
+  config.xoverConfig.type = System::CrossoverType::CROSSOVER_LR4;
+  config.xoverConfig.frequencyHz = BENCH_XOVER_FREQUENCY;
+  config.xoverConfig.sampleRateHz = BENCH_SAMPLE_RATE;
+}
+
+/**
+ * Worst case tuning: every biquad stage is in use, both DRCs and the ALA are enabled
+ * @param complementary true to split the bands with the complementary crossover stage, instead of the raw coefficients
+ */
+static void addFullLoad(System::FilterConfiguration &config, bool complementary)
+{
+  static const float32_t eqFrequencies[MASTER_EQ_STAGES] = { 60.0f, 150.0f, 400.0f, 900.0f, 2000.0f, 4500.0f, 8000.0f, 14000.0f };
+  uint32_t firstBandEqStage = complementary ? 0 : 2;
+
+  if (complementary)
+  {
+    addComplementaryCrossover(config);
+  }
+  else
+  {
+    addCrossover(config);
+  }
+  config.masterEqEnabled = true;
+
+  for (uint32_t i = 0; i < MASTER_EQ_STAGES; i++)
+  {
+    float32_t gainDb = (i & 1) ? -3.0f : 2.0f;
+    designPeaking(&config.masterEqCoeffs[System::MasterEqCoeffcientType::LEFT][i * 5], BENCH_SAMPLE_RATE, eqFrequencies[i], 1.4f, gainDb);
+    designPeaking(&config.masterEqCoeffs[System::MasterEqCoeffcientType::RIGHT][i * 5], BENCH_SAMPLE_RATE, eqFrequencies[i], 1.4f, gainDb);
+  }
+
+  for (uint32_t i = 2; i < XOVER_EQ_STAGES; i++)
+  {
+    for (uint32_t type = 0; type < System::XoverEqCoeffcientType::MAX_XOVER_EQ_COEFF_TYPES; type++)
+    {
+      designPeaking(&config.xoverEqCoeffs[type][(i - 2 + firstBandEqStage) * 5], BENCH_SAMPLE_RATE, 200.0f * i * (type + 1), 2.0f, -1.5f);
+    }
+  }
+
+  config.levelerDrcConfig.enabled = true;
+  config.levelerDrcConfig.attackDuration = 0.05f;
+  config.levelerDrcConfig.releaseDuration = 0.5f;
+  config.levelerDrcConfig.compressionThresholdFullScaleDb = -24.0f;
+  config.levelerDrcConfig.compressionRatio = 3.0f;
+
+  config.limiterDrcConfig.enabled = true;
+  config.limiterDrcConfig.attackDuration = 0.002f;
+  config.limiterDrcConfig.releaseDuration = 0.1f;
+  config.limiterDrcConfig.compressionThresholdFullScaleDb = -3.0f;
+  config.limiterDrcConfig.compressionRatio = 10.0f;
+
+#if ALA_MODULE_ENABLED == 1
+  config.alaConfig.enabled = true;
+#endif
+}
+
+/**
+ * Appends a node to a stage graph
+ * @param graph
+ * @param type
+ * @param input the node of the input, STAGE_INPUT for the input of the chain
+ * @param band 1 for the woofer band of the input node
+ * @return the index of the node
+ */
+int32_t addStageNode(System::StageGraphConfiguration &graph, System::StageType type, int32_t input, uint32_t band)
+{
+  System::StageNodeConfiguration &node = graph.nodes[graph.nodeCount];
+
+  node.type = type;
+  node.input.node = input;
+  node.input.band = band;
+  node.aux.node = STAGE_NONE;
+  node.aux.band = 0;
+  return (int32_t) graph.nodeCount++;
+}
+
+/**
+ * Fills in one of the built-in configurations
+ * @param name passthrough, xover, lr4, fir-xover, full, full-lr4, full-peak, full-fir, full-delay or full-graph
+ * @param config
+ * @return false if the preset is unknown
+ */
+bool loadPreset(const std::string &name, System::FilterConfiguration &config)
+{
+  resetConfig(config, name.c_str());
+
+  if (name == "passthrough")
+  {
+    return true;
+  }
+  else if (name == "xover")
+  {
+    addCrossover(config);
+    return true;
+  }
+  else if (name == "lr4")
+  {
+    addComplementaryCrossover(config);
+    return true;
+  }
+  else if (name == "fir-xover")
+  {
+    config.xoverEqEnabled = true;
+    designFirCrossover(config.firConfig, BENCH_FIR_TAPS, BENCH_SAMPLE_RATE, BENCH_XOVER_FREQUENCY);
+    return true;
+  }
+  else if (name == "full")
+  {
+    addFullLoad(config, false);
+    return true;
+  }
+  else if (name == "full-lr4")
+  {
+    addFullLoad(config, true);
+    return true;
+  }
+  else if (name == "full-peak")
+  {
+    // The lookahead peak limiter in place of the limiter DRC
+    addFullLoad(config, true);
+    config.peakLimiterConfig.enabled = true;
+    config.peakLimiterConfig.thresholdFullScaleDb = -1.0f;
+    config.peakLimiterConfig.lookaheadDuration = 0.0015f;
+    config.peakLimiterConfig.releaseDuration = 0.05f;
+    return true;
+  }
+  else if (name == "full-fir")
+  {
+    // The linear-phase FIR crossover in place of the LR4 split
+    addFullLoad(config, true);
+    designFirCrossover(config.firConfig, BENCH_FIR_TAPS, BENCH_SAMPLE_RATE, BENCH_XOVER_FREQUENCY);
+    return true;
+  }
+  else if (name == "full-delay")
+  {
+    // full-peak with the tweeters, whose acoustic centres are 10 and 7 cm in front of the woofers, delayed to match
+    loadPreset("full-peak", config);
+    config.name = name;
+    config.delayConfig.enabled = true;
+    config.delayConfig.delayDuration[System::XoverEqCoeffcientType::LEFT_TWEETER] = 0.10f / BENCH_SPEED_OF_SOUND;
+    config.delayConfig.delayDuration[System::XoverEqCoeffcientType::RIGHT_TWEETER] = 0.07f / BENCH_SPEED_OF_SOUND;
+    return true;
+  }
+  else if (name == "full-graph")
+  {
+    // The full-lr4 stages in another order: the leveler ahead of the master EQ, and the limiter DRC on the woofers only
+    System::StageGraphConfiguration &graph = config.stageGraph;
+
+    addFullLoad(config, true);
+
+    int32_t last = addStageNode(graph, System::StageType::STAGE_TYPE_LEVELER_DRC, STAGE_INPUT, 0);
+    last = addStageNode(graph, System::StageType::STAGE_TYPE_MASTER_EQ, last, 0);
+
+    const int32_t split = addStageNode(graph, System::StageType::STAGE_TYPE_XOVER_SPLIT, last, 0);
+    last = addStageNode(graph, System::StageType::STAGE_TYPE_WOOFER_EQ, split, 1);
+    graph.woofer.node = addStageNode(graph, System::StageType::STAGE_TYPE_LIMITER_DRC, last, 0);
+    last = addStageNode(graph, System::StageType::STAGE_TYPE_TWEETER_EQ, split, 0);
+    graph.tweeter.node = addStageNode(graph, System::StageType::STAGE_TYPE_ALA, last, 0);
+    return true;
+  }
+
+  return false;
+}
+
+/**
+ * Loads a bson filter configuration, as stored on the sdcard (/usound/config-N.bin)
+ * @param fileName
+ * @param config
+ * @return
+ */
+bool loadConfigFile(const std::string &fileName, System::FilterConfiguration &config)
+{
+  FILE *file = fopen(fileName.c_str(), "rb");
+  if (!file)
+  {
+    return false;
+  }
+
+  std::vector<uint8_t> content;
+  uint8_t buffer[4096];
+  size_t len;
+
+  while ((len = fread(buffer, 1, sizeof(buffer), file)) > 0)
+  {
+    content.insert(content.end(), buffer, buffer + len);
+  }
+  fclose(file);
+
+  if (content.size() < 5)
+  {
+    return false;
+  }
+
+  resetConfig(config, fileName.c_str());
+  config.name.clear();
+
+  System::FilterConfigParser filterParser(&config);
+  filterParser.extractConfig(content.data());
+
+  // The FIR taps file is named by its path on the sdcard. It is looked up as it is, then next to the configuration.
+  const std::string &firFile = config.firConfig.fileName;
+
+  if (!firFile.empty() && !config.firConfig.coefficients && !loadFirFile(firFile, config.firConfig))
+  {
+    size_t separator = fileName.find_last_of('/');
+    std::string directory = (separator != std::string::npos) ? fileName.substr(0, separator + 1) : "";
+
+    if (!loadFirFile(directory + firFile.substr(firFile.find_last_of('/') + 1), config.firConfig))
+    {
+      fprintf(stderr, "%s: FIR taps file %s not found\n", fileName.c_str(), firFile.c_str());
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Loads the taps of the FIR filters, in the format of the sdcard files: little endian float32 taps,
+ * all the taps of one filter after the other, in the order of the placement
+ * @param fileName
+ * @param firConfig the placement selects the number of filters
+ * @return false if the file does not exist or its size does not fit the placement
+ */
+bool loadFirFile(const std::string &fileName, System::FirConfiguration &firConfig)
+{
+  FILE *file = fopen(fileName.c_str(), "rb");
+  if (!file)
+  {
+    return false;
+  }
+
+  std::vector<float32_t> content;
+  float32_t buffer[1024];
+  size_t len;
+
+  while ((len = fread(buffer, sizeof(float32_t), 1024, file)) > 0)
+  {
+    content.insert(content.end(), buffer, buffer + len);
+  }
+  fclose(file);
+
+  const uint32_t filterCount = firConfig.getFilterCount();
+  const uint32_t taps = content.size() / filterCount;
+
+  if (taps == 0 || taps > FIR_MAX_TAPS || taps * filterCount != content.size())
+  {
+    return false;
+  }
+
+  float32_t *coefficients = new float32_t[content.size()];
+  std::copy(content.begin(), content.end(), coefficients);
+
+  firConfig.coefficients = std::shared_ptr<const float32_t>(coefficients, std::default_delete<const float32_t[]>());
+  firConfig.taps = taps;
+  return true;
+}
+
+/**
+ * Generates a deterministic programme-like signal: a logarithmic sweep on the left channel
+ * and a sweep mixed with noise on the right channel, with level changes that exercise the DRCs.
+ */
+void generateTestSignal(WavFile &wav, uint32_t sampleRate, uint32_t seconds)
+{
+  uint32_t frames = sampleRate * seconds;
+  double phase = 0.0;
+  uint32_t noise = 0x12345678;
+
+  wav.sampleRate = sampleRate;
+  wav.samples.resize(frames * 2);
+
+  for (uint32_t i = 0; i < frames; i++)
+  {
+    double t = (double) i / frames;
+    double frequency = 20.0 * pow(1000.0, t);
+    double envelope = (i / sampleRate) & 1 ? 0.9 : 0.1;
+
+    phase += 2.0 * M_PI * frequency / sampleRate;
+    if (phase > 2.0 * M_PI)
+    {
+      phase -= 2.0 * M_PI;
+    }
+
+    noise = noise * 1664525u + 1013904223u;
+    double white = ((int32_t) noise) / 2147483648.0;
+
+    double left = envelope * sin(phase);
+    double right = envelope * (0.6 * sin(phase) + 0.3 * white);
+
+    wav.samples[2 * i] = (int16_t) lrint(left * 32767.0);
+    wav.samples[2 * i + 1] = (int16_t) lrint(right * 32767.0);
+  }
+}
+
+}
@@ -0,0 +1,55 @@
+//====================================================================
+//
+// COPYRIGHT 2026 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: Filter configurations and test signals used by the host benchmark
+//  Filename: BenchPresets.hpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#pragma once
+
+#include <string>
+#include "Controllers/System/pub/FilterConfiguration.hpp"
+#include "WavFile.hpp"
+
+namespace Host
+{
+
+bool loadPreset(const std::string &name, System::FilterConfiguration &config);
+bool loadConfigFile(const std::string &fileName, System::FilterConfiguration &config);
+bool loadFirFile(const std::string &fileName, System::FirConfiguration &firConfig);
+int32_t addStageNode(System::StageGraphConfiguration &graph, System::StageType type, int32_t input, uint32_t band);
+void generateTestSignal(WavFile &wav, uint32_t sampleRate, uint32_t seconds);
+
+void designPeaking(float32_t *coeffs, float32_t sampleRate, float32_t frequency, float32_t q, float32_t gainDb);
+void designLowPass(float32_t *coeffs, float32_t sampleRate, float32_t frequency, float32_t q);
+void designHighPass(float32_t *coeffs, float32_t sampleRate, float32_t frequency, float32_t q);
+void designIdentity(float32_t *coeffs);
+void designFirCrossover(System::FirConfiguration &firConfig, uint32_t taps, float32_t sampleRate, float32_t frequency);
+
+}
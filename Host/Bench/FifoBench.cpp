@@ -0,0 +1,858 @@
+//====================================================================
+//
+// COPYRIGHT 2026 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: Host stress test and throughput benchmark of the lock-free SpscFifo. A producer
+//              and a consumer thread move a numbered sequence through it, by copy and in place,
+//              and check every sample. It also tests the BroadcastFifo with readers that fall
+//              behind, and measures the bulk copies of Fifo
+//  Filename: FifoBench.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <time.h>
+#include "Utilities/Fifo/pub/BroadcastFifo.hpp"
+#include "Utilities/Fifo/pub/Fifo.hpp"
+#include "Utilities/Fifo/pub/SpscFifo.hpp"
+
+#define BLOCK_SIZE      192             // 4 ms of 48 kHz stereo, as read by the audio task
+#define TIMING_SAMPLES  (1u << 24)
+#define COPY_FIFO_LEN   8191            // Not a multiple of the chunks, which then wrap at changing offsets
+
+using BenchClock = std::chrono::steady_clock;
+
+/**
+ * A fifo whose indices start at a given value, to run the stress test across the 2^32 wrap of the indices
+ */
+template<typename T>
+class OffsetFifo: public SpscFifo<T>
+{
+public:
+  OffsetFifo(T *data, uint32_t size, uint32_t startIndex) :
+      SpscFifo<T>(data, size)
+  {
+    this->wr.store(startIndex);
+    this->rd.store(startIndex);
+  }
+};
+
+/**
+ * A Fifo with the per-sample copies Fifo::popBuffer and Fifo::transferFromFifo used before the bulk copies,
+ * as the reference of their measurement
+ */
+template<typename T>
+class ElementFifo: public Fifo<T>
+{
+public:
+  ElementFifo(T *data, uint32_t size) :
+      Fifo<T>(data, size)
+  {
+  }
+
+  uint32_t popBufferPerSample(T *dstBuffer, uint32_t requestedSamples)
+  {
+    uint32_t fifoDataLen = this->getSampleCount();
+
+    if (fifoDataLen < requestedSamples)
+    {
+      requestedSamples = fifoDataLen;
+    }
+
+    for (uint32_t i = 0; i < requestedSamples; i++)
+    {
+      dstBuffer[i] = this->data[this->rd++];
+      if (this->rd >= this->maxSamples)
+      {
+        this->rd = 0;
+      }
+    }
+
+    return requestedSamples;
+  }
+
+  uint32_t transferPerSample(Fifo<T> *srcFifo, uint32_t len)
+  {
+    while (len)
+    {
+      if (srcFifo->getSampleCount() > 0)
+      {
+        this->push(srcFifo->pop());
+        len--;
+      }
+      else
+      {
+        break;
+      }
+    }
+
+    return len;
+  }
+};
+
+/**
+ * A stress run: the fifo length, the largest chunk pushed or popped at once and the index the fifo starts at
+ */
+struct StressRun
+{
+public:
+  uint32_t bufferLen;
+  uint32_t maxChunk;
+  uint32_t startIndex;
+};
+
+/**
+ * Result of a stress run
+ */
+struct StressResult
+{
+public:
+  uint64_t errors = 0;                  //!< Samples out of sequence, or counts out of range
+  uint64_t fullEvents = 0;              //!< Pushes that did not fit completely
+  uint64_t emptyEvents = 0;             //!< Pops that got less than requested
+  uint64_t dropped = 0;                 //!< Samples skipped by consumeBuffer
+  double seconds = 0.0;
+};
+
+/**
+ * A reader of the broadcast test: the largest chunk it reads at once and the pause after each read
+ */
+struct BroadcastRun
+{
+public:
+  const char *name;
+  uint32_t maxChunk;
+  uint32_t pauseUs;                     //!< 0 yields
+};
+
+/**
+ * Result of one reader of the broadcast test
+ */
+struct BroadcastResult
+{
+public:
+  uint64_t received = 0;
+  uint64_t errors = 0;                  //!< Samples that are not the ones at their index
+  BroadcastReader reader;
+};
+
+struct BenchOptions
+{
+public:
+  uint64_t stressSamples = 10000000;
+};
+
+static uint32_t nextRandom(uint32_t &state)
+{
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+static void usage(const char *name)
+{
+  printf("usage: %s [options]\n", name);
+  printf("  -n <millions>     samples moved through the fifo in each stress run (default: 10)\n");
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions &options)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    bool hasValue = (i + 1) < argc;
+
+    if (arg == "-n" && hasValue)
+    {
+      options.stressSamples = (uint64_t) (atof(argv[++i]) * 1000000.0);
+      if (options.stressSamples == 0)
+      {
+        return false;
+      }
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Single threaded checks of the fill level at the edges: a fifo takes exactly its size, a buffer that is not a power
+ * of two is rounded down, and the samples come out in order across the end of the buffer
+ */
+static bool checkEdges()
+{
+  bool passed = true;
+  std::vector<uint32_t> buffer(100), values(300), output(300);
+
+  for (uint32_t i = 0; i < values.size(); i++)
+  {
+    values[i] = i;
+  }
+
+  SpscFifo<uint32_t> fifo(buffer.data(), (uint32_t) buffer.size());
+  passed &= (fifo.getSize() == 64);
+  passed &= (SpscFifo<uint32_t>::roundSize(100) == 128) && (SpscFifo<uint32_t>::roundSize(64) == 64);
+
+  // Full without a wasted slot
+  passed &= (fifo.pushBuffer(values.data(), 100) == 64);
+  passed &= (fifo.getSampleCount() == 64) && (fifo.getCapacity() == 0);
+  passed &= !fifo.push(1000);
+
+  // Empty
+  passed &= (fifo.popBuffer(output.data(), 100) == 64);
+  passed &= (fifo.getSampleCount() == 0) && (fifo.getCapacity() == 64);
+  uint32_t sample;
+  passed &= !fifo.pop(sample);
+
+  for (uint32_t i = 0; i < 64; i++)
+  {
+    passed &= (output[i] == i);
+  }
+
+  // Wrapped around the end of the buffer
+  passed &= (fifo.pushBuffer(values.data(), 40) == 40);
+  passed &= (fifo.consumeBuffer(50) == 40);
+  passed &= (fifo.pushBuffer(values.data(), 50) == 50);
+  passed &= (fifo.popBuffer(output.data(), 50) == 50);
+
+  for (uint32_t i = 0; i < 50; i++)
+  {
+    passed &= (output[i] == i);
+  }
+
+  // In place, across the end of the buffer: 20 slots to the end, then 44 from the beginning
+  fifo.reset(nullptr, 0);
+  passed &= (fifo.pushBuffer(values.data(), 44) == 44) && (fifo.consumeBuffer(44) == 44);
+  FifoSpan<uint32_t> writeSpan = fifo.acquireWrite(100);
+  passed &= (writeSpan.length[0] == 20) && (writeSpan.length[1] == 44) && (writeSpan.data[1] == buffer.data());
+
+  for (uint32_t i = 0; i < writeSpan.getLength(); i++)
+  {
+    writeSpan.data[i < 20 ? 0 : 1][i < 20 ? i : i - 20] = i;
+  }
+
+  passed &= (fifo.getSampleCount() == 0);
+  fifo.commitWrite(30);
+  passed &= (fifo.getSampleCount() == 30) && (fifo.getCapacity() == 34);
+
+  FifoSpan<uint32_t> readSpan = fifo.acquireRead(100);
+  passed &= (readSpan.length[0] == 20) && (readSpan.length[1] == 10) && (readSpan.data[1][9] == 29);
+  fifo.release(25);
+  passed &= (fifo.getSampleCount() == 5) && (fifo.popBuffer(output.data(), 100) == 5) && (output[4] == 29);
+
+  // Indices wrapping at 2^32
+  OffsetFifo<uint32_t> offsetFifo(buffer.data(), 64, 0xFFFFFFF0u);
+  passed &= (offsetFifo.pushBuffer(values.data(), 64) == 64) && (offsetFifo.getSampleCount() == 64);
+  passed &= (offsetFifo.getCapacity() == 0);
+  passed &= (offsetFifo.popBuffer(output.data(), 64) == 64) && (offsetFifo.getSampleCount() == 0);
+
+  for (uint32_t i = 0; i < 64; i++)
+  {
+    passed &= (output[i] == i);
+  }
+
+  return passed;
+}
+
+/**
+ * A producer thread pushes a numbered sequence in chunks of random length, while the consumer pops chunks of random
+ * length, or now and then drops some, and checks that every sample it gets is the next one of the sequence
+ */
+static StressResult runStress(const StressRun &run, uint64_t totalSamples)
+{
+  std::vector<uint32_t> buffer(run.bufferLen);
+  OffsetFifo<uint32_t> fifo(buffer.data(), run.bufferLen, run.startIndex);
+  uint32_t size = fifo.getSize();
+  StressResult result;
+  std::atomic<uint64_t> producerErrors(0);
+
+  auto start = BenchClock::now();
+
+  std::thread producer([&]()
+  {
+    std::vector<uint32_t> chunk(run.maxChunk);
+    uint32_t seed = 0x12345678;
+    uint64_t sent = 0;
+
+    while (sent < totalSamples)
+    {
+      uint32_t len = (nextRandom(seed) % run.maxChunk) + 1;
+      if (len > totalSamples - sent)
+      {
+        len = (uint32_t) (totalSamples - sent);
+      }
+
+      uint32_t freeSlots = fifo.getCapacity();
+      uint32_t pushed;
+
+      if (nextRandom(seed) & 1)
+      {
+        // In place, publishing all of the span or all of it but the last sample
+        FifoSpan<uint32_t> span = fifo.acquireWrite(len);
+
+        for (uint32_t i = 0; i < span.getLength(); i++)
+        {
+          uint32_t part = (i < span.length[0]) ? 0 : 1;
+          span.data[part][i - part * span.length[0]] = (uint32_t) (sent + i);
+        }
+
+        pushed = span.getLength();
+        producerErrors += (freeSlots > size) || (pushed > len) || (pushed < std::min(len, freeSlots));
+
+        if ((pushed > 1) && (nextRandom(seed) & 1))
+        {
+          pushed--;
+          len--;
+        }
+
+        fifo.commitWrite(pushed);
+      }
+      else
+      {
+        for (uint32_t i = 0; i < len; i++)
+        {
+          chunk[i] = (uint32_t) (sent + i);
+        }
+
+        pushed = fifo.pushBuffer(chunk.data(), len);
+        producerErrors += (freeSlots > size) || (pushed > len) || (pushed < std::min(len, freeSlots));
+      }
+
+      if (pushed < len)
+      {
+        result.fullEvents++;
+        std::this_thread::yield();
+      }
+
+      sent += pushed;
+    }
+  });
+
+  std::vector<uint32_t> chunk(run.maxChunk);
+  uint32_t seed = 0x9ABCDEF0;
+  uint64_t expected = 0;
+
+  while (expected < totalSamples)
+  {
+    uint32_t len = (nextRandom(seed) % run.maxChunk) + 1;
+    uint32_t stored = fifo.getSampleCount();
+
+    if (stored > size)
+    {
+      result.errors++;
+    }
+
+    if ((nextRandom(seed) & 63) == 0)
+    {
+      uint32_t consumed = fifo.consumeBuffer(len);
+
+      result.errors += (consumed > len) || (consumed < std::min(len, stored));
+      result.dropped += consumed;
+      expected += consumed;
+      continue;
+    }
+
+    uint32_t popped;
+
+    if (nextRandom(seed) & 1)
+    {
+      // In place, releasing all of the span or all of it but the last sample
+      FifoSpan<uint32_t> span = fifo.acquireRead(len);
+      popped = span.getLength();
+
+      for (uint32_t i = 0; i < popped; i++)
+      {
+        uint32_t part = (i < span.length[0]) ? 0 : 1;
+        result.errors += (span.data[part][i - part * span.length[0]] != (uint32_t) (expected + i));
+      }
+
+      result.errors += (popped > len) || (popped < std::min(len, stored));
+
+      if ((popped > 1) && (nextRandom(seed) & 1))
+      {
+        popped--;
+        len--;
+      }
+
+      fifo.release(popped);
+    }
+    else
+    {
+      popped = fifo.popBuffer(chunk.data(), len);
+
+      if ((popped > len) || (popped < std::min(len, stored)))
+      {
+        result.errors++;
+      }
+
+      for (uint32_t i = 0; i < popped; i++)
+      {
+        result.errors += (chunk[i] != (uint32_t) (expected + i));
+      }
+    }
+
+    if (popped < len)
+    {
+      result.emptyEvents++;
+      std::this_thread::yield();
+    }
+
+    expected += popped;
+  }
+
+  producer.join();
+
+  result.seconds = std::chrono::duration<double>(BenchClock::now() - start).count();
+  result.errors += producerErrors + (expected != totalSamples) + (fifo.getSampleCount() != 0);
+
+  return result;
+}
+
+/**
+ * Single threaded checks of the broadcast fifo: every reader gets every sample while it keeps up, a reader that
+ * falls behind loses the oldest samples and gets the newest ones, and a reader that attaches late starts at the end
+ */
+static bool checkBroadcastEdges()
+{
+  bool passed = true;
+  std::vector<uint32_t> buffer(64), values(300), output(300);
+
+  for (uint32_t i = 0; i < values.size(); i++)
+  {
+    values[i] = i;
+  }
+
+  BroadcastFifo<uint32_t> fifo(buffer.data(), 64);
+  BroadcastReader fast, lagging, late;
+
+  fifo.attach(fast);
+  fifo.attach(lagging);
+  passed &= fifo.hasReaders();
+
+  // The fast reader reads each chunk, the lagging one none of them
+  for (uint32_t i = 0; i < 5; i++)
+  {
+    passed &= (fifo.pushBuffer(&values[i * 40], 40) == 40);
+    passed &= (fifo.read(fast, output.data(), 100) == 40) && (output[0] == i * 40) && (output[39] == i * 40 + 39);
+  }
+
+  passed &= (fast.overruns == 0) && (fifo.getSampleCount(fast) == 0);
+  passed &= (fifo.getSampleCount(lagging) == 64);
+
+  // 200 samples written, the last 64 are left
+  passed &= (fifo.read(lagging, output.data(), 100) == 64) && (output[0] == 136) && (output[63] == 199);
+  passed &= (lagging.overruns == 1) && (lagging.lostSamples == 136) && (lagging.rd == 200);
+
+  fifo.attach(late);
+  passed &= (fifo.read(late, output.data(), 100) == 0);
+  passed &= (fifo.pushBuffer(&values[200], 10) == 10);
+  passed &= (fifo.read(late, output.data(), 100) == 10) && (output[0] == 200);
+
+  // A write that is acquired but not committed yet makes the oldest samples unreadable: the lagging reader
+  // is 64 samples behind, and the 8 oldest ones are about to be written over
+  passed &= (fifo.read(fast, output.data(), 100) == 10);
+  passed &= (fifo.pushBuffer(&values[210], 54) == 54);
+  FifoSpan<uint32_t> span = fifo.acquireWrite(8);
+  passed &= (fifo.read(lagging, output.data(), 100) == 56) && (output[0] == 208) && (output[55] == 263);
+  passed &= (lagging.overruns == 2) && (lagging.lostSamples == 144);
+  memcpy(span.data[0], &values[264], span.length[0] * sizeof(uint32_t));
+  memcpy(span.data[1], &values[264 + span.length[0]], span.length[1] * sizeof(uint32_t));
+  fifo.commitWrite(span.getLength());
+  passed &= (fifo.read(fast, output.data(), 100) == 62) && (output[61] == 271) && (fast.overruns == 0);
+
+  fifo.detach(fast);
+  fifo.detach(lagging);
+  fifo.detach(late);
+  passed &= !fifo.hasReaders();
+
+  return passed;
+}
+
+/**
+ * Returns the CPU time of the calling thread, so that the time of the writer does not include the readers
+ */
+static double threadSeconds()
+{
+  timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return now.tv_sec + now.tv_nsec * 1.0e-9;
+}
+
+/**
+ * A writer thread publishes a numbered sequence in 4 ms blocks into a broadcast fifo, with or without readers. Each
+ * reader reads at its own pace and checks that every sample it gets is the one at its index, and that the samples
+ * it got and lost add up to the sequence.
+ * @return the CPU time of the writer per sample
+ */
+static double runBroadcast(const std::vector<BroadcastRun> &runs, std::vector<BroadcastResult> &results, uint64_t totalSamples)
+{
+  std::vector<uint32_t> buffer(4096);
+  BroadcastFifo<uint32_t> fifo(buffer.data(), (uint32_t) buffer.size());
+  std::atomic<bool> writerDone(false);
+  std::vector<std::thread> readers;
+  double writerSeconds = 0.0;
+
+  results.assign(runs.size(), BroadcastResult());
+
+  for (uint32_t i = 0; i < runs.size(); i++)
+  {
+    fifo.attach(results[i].reader);
+  }
+
+  for (uint32_t i = 0; i < runs.size(); i++)
+  {
+    readers.emplace_back([&, i]()
+    {
+      const BroadcastRun &run = runs[i];
+      BroadcastResult &result = results[i];
+      std::vector<uint32_t> chunk(run.maxChunk);
+
+      while (true)
+      {
+        bool done = writerDone.load();
+        uint32_t len = fifo.read(result.reader, chunk.data(), run.maxChunk);
+
+        for (uint32_t j = 0; j < len; j++)
+        {
+          result.errors += (chunk[j] != result.reader.rd - len + j);
+        }
+
+        result.received += len;
+
+        if (done && (fifo.getSampleCount(result.reader) == 0))
+        {
+          break;
+        }
+
+        if (run.pauseUs > 0)
+        {
+          std::this_thread::sleep_for(std::chrono::microseconds(run.pauseUs));
+        }
+        else
+        {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  std::thread writer([&]()
+  {
+    std::vector<uint32_t> block(BLOCK_SIZE);
+    double start = threadSeconds();
+
+    for (uint64_t sent = 0; sent < totalSamples; sent += BLOCK_SIZE)
+    {
+      for (uint32_t i = 0; i < BLOCK_SIZE; i++)
+      {
+        block[i] = (uint32_t) (sent + i);
+      }
+
+      if (fifo.hasReaders() || runs.empty())
+      {
+        fifo.pushBuffer(block.data(), BLOCK_SIZE);
+      }
+
+      std::this_thread::yield();
+    }
+
+    writerSeconds = threadSeconds() - start;
+    writerDone.store(true);
+  });
+
+  writer.join();
+
+  for (auto &reader : readers)
+  {
+    reader.join();
+  }
+
+  for (uint32_t i = 0; i < runs.size(); i++)
+  {
+    fifo.detach(results[i].reader);
+    results[i].errors += (results[i].received + results[i].reader.lostSamples != totalSamples);
+  }
+
+  return writerSeconds * 1.0e9 / totalSamples;
+}
+
+/**
+ * Returns the samples per second a producer and a consumer thread move through a fifo of int16_t samples,
+ * both pushing and popping chunks of the same length
+ */
+static double measureThroughput(uint32_t bufferLen, uint32_t chunkLen)
+{
+  std::vector<int16_t> buffer(bufferLen);
+  SpscFifo<int16_t> fifo(buffer.data(), bufferLen);
+
+  auto start = BenchClock::now();
+
+  std::thread producer([&]()
+  {
+    std::vector<int16_t> chunk(chunkLen, 1);
+
+    for (uint32_t sent = 0; sent < TIMING_SAMPLES;)
+    {
+      uint32_t pushed = fifo.pushBuffer(chunk.data(), std::min(chunkLen, TIMING_SAMPLES - sent));
+
+      if (pushed == 0)
+      {
+        std::this_thread::yield();
+      }
+
+      sent += pushed;
+    }
+  });
+
+  std::vector<int16_t> chunk(chunkLen);
+  for (uint32_t received = 0; received < TIMING_SAMPLES;)
+  {
+    uint32_t popped = fifo.popBuffer(chunk.data(), chunkLen);
+
+    if (popped == 0)
+    {
+      std::this_thread::yield();
+    }
+
+    received += popped;
+  }
+
+  producer.join();
+
+  return TIMING_SAMPLES / std::chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+/**
+ * Returns the mean time per sample of pushing and popping BLOCK_SIZE samples in one thread,
+ * i.e. the cost of the copies and the index updates without any contention
+ */
+template<typename F>
+static double measureBlockCost(F &fifo)
+{
+  std::vector<int16_t> input(BLOCK_SIZE, 1), output(BLOCK_SIZE);
+  volatile int16_t sink = 0;
+  const uint32_t blocks = TIMING_SAMPLES / BLOCK_SIZE;
+
+  auto start = BenchClock::now();
+  for (uint32_t block = 0; block < blocks; block++)
+  {
+    fifo.pushBuffer(input.data(), BLOCK_SIZE);
+    fifo.popBuffer(output.data(), BLOCK_SIZE);
+    sink = sink + output[block % BLOCK_SIZE];
+  }
+  auto end = BenchClock::now();
+
+  return std::chrono::duration<double, std::nano>(end - start).count() / ((double) blocks * BLOCK_SIZE);
+}
+
+/**
+ * Times Fifo::popBuffer and Fifo::transferFromFifo against the per-sample copies they replace, in a fifo of
+ * COPY_FIFO_LEN samples, so that the chunks wrap around its end at changing offsets. Both are checked against the
+ * pushed samples first.
+ * @return false if a copy loses or reorders samples
+ */
+static bool benchFifoCopies(uint32_t chunkLen)
+{
+  std::vector<int16_t> srcBuffer(COPY_FIFO_LEN), dstBuffer(COPY_FIFO_LEN), input(chunkLen), output(chunkLen);
+  ElementFifo<int16_t> src(srcBuffer.data(), COPY_FIFO_LEN);
+  ElementFifo<int16_t> dst(dstBuffer.data(), COPY_FIFO_LEN);
+  const uint32_t iterations = std::max<uint32_t>(TIMING_SAMPLES / 4 / chunkLen, 1);
+  const uint32_t checkIterations = 2 * COPY_FIFO_LEN / chunkLen + 2;
+  bool passed = true;
+
+  for (uint32_t i = 0; i < checkIterations; i++)
+  {
+    for (uint32_t j = 0; j < chunkLen; j++)
+    {
+      input[j] = (int16_t) (i * 7919 + j);
+    }
+
+    src.pushBuffer(input.data(), chunkLen);
+    passed &= (src.popBuffer(output.data(), chunkLen) == chunkLen) && (output == input);
+
+    src.pushBuffer(input.data(), chunkLen);
+    passed &= (dst.transferFromFifo(&src, chunkLen + 1) == 1) && (src.getSampleCount() == 0);
+    passed &= (dst.popBuffer(output.data(), chunkLen) == chunkLen) && (output == input) && (dst.getSampleCount() == 0);
+  }
+
+  // The best of three runs, so the push cost subtracted below is not inflated by a preemption
+  auto timePerSample = [&](const std::function<void()> &copy)
+  {
+    double best = 0;
+    for (uint32_t run = 0; run < 3; run++)
+    {
+      auto start = BenchClock::now();
+      for (uint32_t i = 0; i < iterations; i++)
+      {
+        copy();
+      }
+      double ns = std::chrono::duration<double, std::nano>(BenchClock::now() - start).count() / ((double) iterations * chunkLen);
+      best = ((run == 0) || (ns < best)) ? ns : best;
+    }
+    return best;
+  };
+
+  double pushNs = timePerSample([&]()
+  {
+    src.pushBuffer(input.data(), chunkLen);
+    src.consumeBuffer(chunkLen);
+  });
+  double popElementNs = timePerSample([&]()
+  {
+    src.pushBuffer(input.data(), chunkLen);
+    src.popBufferPerSample(output.data(), chunkLen);
+  }) - pushNs;
+  double popNs = timePerSample([&]()
+  {
+    src.pushBuffer(input.data(), chunkLen);
+    src.popBuffer(output.data(), chunkLen);
+  }) - pushNs;
+  double transferElementNs = timePerSample([&]()
+  {
+    src.pushBuffer(input.data(), chunkLen);
+    dst.transferPerSample(&src, chunkLen);
+    dst.consumeBuffer(chunkLen);
+  }) - pushNs;
+  double transferNs = timePerSample([&]()
+  {
+    src.pushBuffer(input.data(), chunkLen);
+    dst.transferFromFifo(&src, chunkLen);
+    dst.consumeBuffer(chunkLen);
+  }) - pushNs;
+
+  printf("  %-8u %10.3f %10.3f %7.1fx %10.3f %10.3f %7.1fx %s\n", chunkLen, popElementNs, popNs, popElementNs / popNs,
+      transferElementNs, transferNs, transferElementNs / transferNs, passed ? "" : "FAILED");
+
+  return passed;
+}
+
+int main(int argc, char **argv)
+{
+  BenchOptions options;
+
+  if (!parseOptions(argc, argv, options))
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  bool passed = checkEdges();
+  printf("edge checks: %s\n\n", passed ? "passed" : "FAILED");
+
+  const StressRun runs[] = {
+      { 4, 3, 0 },
+      { 64, 64, 0 },
+      { 256, 96, 0xFFFF0000u },
+      { 1000, 192, 0 },
+      { 4096, 1024, 0xFFFFFF00u }
+  };
+
+  printf("%-6s %-6s %-11s %12s %10s %10s %10s %8s\n", "size", "chunk", "start", "Msamples/s", "full", "empty", "dropped",
+      "errors");
+
+  for (auto &run : runs)
+  {
+    StressResult result = runStress(run, options.stressSamples);
+
+    printf("%-6u %-6u 0x%08X  %12.1f %10llu %10llu %10llu %8llu %s\n", SpscFifo<uint32_t>::roundSize(run.bufferLen + 1) / 2,
+        run.maxChunk, run.startIndex, options.stressSamples / result.seconds / 1.0e6, (unsigned long long) result.fullEvents,
+        (unsigned long long) result.emptyEvents, (unsigned long long) result.dropped, (unsigned long long) result.errors,
+        result.errors ? "FAILED" : "");
+
+    passed &= (result.errors == 0);
+  }
+
+  bool broadcastPassed = checkBroadcastEdges();
+  printf("\nbroadcast edge checks: %s\n", broadcastPassed ? "passed" : "FAILED");
+  passed &= broadcastPassed;
+
+  const std::vector<BroadcastRun> broadcastRuns = {
+      { "fast", 4096, 0 },
+      { "block", BLOCK_SIZE, 0 },
+      { "lagging", 64, 200 }
+  };
+  std::vector<BroadcastResult> broadcastResults;
+  uint64_t broadcastSamples = (options.stressSamples / BLOCK_SIZE) * BLOCK_SIZE;
+
+  double aloneNs = runBroadcast({}, broadcastResults, broadcastSamples);
+  double sharedNs = runBroadcast(broadcastRuns, broadcastResults, broadcastSamples);
+
+  printf("broadcast of %llu samples in %u sample blocks to %u readers, 4096 sample fifo:\n",
+      (unsigned long long) broadcastSamples, BLOCK_SIZE, (uint32_t) broadcastRuns.size());
+  printf("  %-8s %6s %8s %12s %12s %10s %8s\n", "reader", "chunk", "pause", "received", "lost", "overruns", "errors");
+
+  for (uint32_t i = 0; i < broadcastRuns.size(); i++)
+  {
+    const BroadcastResult &result = broadcastResults[i];
+
+    printf("  %-8s %6u %6u us %12llu %12u %10u %8llu %s\n", broadcastRuns[i].name, broadcastRuns[i].maxChunk,
+        broadcastRuns[i].pauseUs, (unsigned long long) result.received, result.reader.lostSamples, result.reader.overruns,
+        (unsigned long long) result.errors, result.errors ? "FAILED" : "");
+
+    passed &= (result.errors == 0);
+  }
+
+  printf("  writer CPU time: %.3f ns/sample alone, %.3f ns/sample with the readers\n", aloneNs, sharedNs);
+
+  printf("\nthroughput of int16_t samples between two threads, 4096 sample fifo:\n");
+  printf("  %-8s %12s\n", "chunk", "Msamples/s");
+
+  for (uint32_t chunkLen : { 1u, 16u, 96u, (uint32_t) BLOCK_SIZE, 1024u })
+  {
+    printf("  %-8u %12.1f\n", chunkLen, measureThroughput(4096, chunkLen) / 1.0e6);
+  }
+
+  std::vector<int16_t> fifoBuffer(1024), spscBuffer(1024);
+  Fifo<int16_t> fifo(fifoBuffer.data(), 1000);
+  SpscFifo<int16_t> spscFifo(spscBuffer.data(), 1024);
+
+  printf("\npush and pop of %u samples in one thread:\n", BLOCK_SIZE);
+  printf("  %-10s %10.3f ns/sample\n", "Fifo", measureBlockCost(fifo));
+  printf("  %-10s %10.3f ns/sample\n", "SpscFifo", measureBlockCost(spscFifo));
+
+  printf("\nFifo copies of int16_t samples against the per-sample loops, ns/sample:\n");
+  printf("  %-8s %10s %10s %8s %10s %10s %8s\n", "chunk", "pop loop", "popBuffer", "speedup", "xfer loop",
+      "transfer", "speedup");
+
+  for (uint32_t chunkLen : { 16u, 64u, (uint32_t) BLOCK_SIZE, 384u, 960u, 1920u, 4096u })
+  {
+    passed &= benchFifoCopies(chunkLen);
+  }
+
+  return passed ? 0 : 1;
+}
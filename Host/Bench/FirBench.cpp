@@ -0,0 +1,523 @@
+//====================================================================
+//
+// COPYRIGHT 2026 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: Host benchmark of the FIR convolution stage. It checks the FFT and the convolution against
+//              double precision references, and measures the cost per block versus the tap count
+//  Filename: FirBench.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "Controllers/Audio/src/AudioFilters.hpp"
+#include "Controllers/Audio/src/FirConvolver.hpp"
+#include "Controllers/Audio/src/RealFft.hpp"
+#include "BenchPresets.hpp"
+
+#define BENCH_RATE              48000
+#define MEASURE_TIME_S          0.2         //!< Minimum time measured per configuration
+#define CHECK_TAPS              1000
+#define CHECK_BLOCKS            24
+#define PIPELINE_BLOCK_FRAMES   192         //!< 4 ms at 48 kHz
+#define PIPELINE_DELAY          37          //!< Delay of the impulse of the pipeline check, in frames
+
+using BenchClock = std::chrono::steady_clock;
+
+static const char *engineNames[System::FilterEngine::MAX_FILTER_ENGINES] = {
+    "df1",
+    "df2t",
+    "q31"
+};
+
+struct BenchOptions
+{
+public:
+  std::vector<uint32_t> blockFrames;
+  std::vector<uint32_t> taps;
+  std::string firFile;
+  System::FirPlacement placement = System::FirPlacement::FIR_PLACEMENT_MASTER;
+  uint32_t sampleRate = BENCH_RATE;
+};
+
+static uint64_t readCycleCounter()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static void usage(const char *name)
+{
+  printf("usage: %s [options]\n", name);
+  printf("  -b <frames>       frames per block (default: 1, 2, 4 and 10 ms at the rate). Can be repeated\n");
+  printf("  -t <taps>         taps per filter (default: 128 to 4096). Can be repeated\n");
+  printf("  -c                crossover placement: 4 filters, instead of 2 master filters\n");
+  printf("  -F <file>         taps file, as stored on the sdcard, instead of random taps\n");
+  printf("  -r <rate>         sampling rate of the block budget (default: 48000)\n");
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions &options)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    bool hasValue = (i + 1) < argc;
+
+    if (arg == "-b" && hasValue)
+    {
+      options.blockFrames.push_back(strtoul(argv[++i], nullptr, 0));
+    }
+    else if (arg == "-t" && hasValue)
+    {
+      options.taps.push_back(strtoul(argv[++i], nullptr, 0));
+    }
+    else if (arg == "-c")
+    {
+      options.placement = System::FirPlacement::FIR_PLACEMENT_CROSSOVER;
+    }
+    else if (arg == "-F" && hasValue)
+    {
+      options.firFile = argv[++i];
+    }
+    else if (arg == "-r" && hasValue)
+    {
+      options.sampleRate = strtoul(argv[++i], nullptr, 0);
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  if (options.sampleRate == 0)
+  {
+    return false;
+  }
+
+  if (options.blockFrames.empty())
+  {
+    for (uint32_t ms : { 1, 2, 4, 10 })
+    {
+      options.blockFrames.push_back((options.sampleRate * ms + 999) / 1000);
+    }
+  }
+
+  if (options.taps.empty())
+  {
+    for (uint32_t taps = 128; taps <= FIR_MAX_TAPS; taps *= 2)
+    {
+      options.taps.push_back(taps);
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Fills the configuration with random taps, decaying like a room response
+ */
+static void generateTaps(System::FirConfiguration &firConfig, uint32_t taps, uint32_t seed)
+{
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float32_t> distribution(-1.0f, 1.0f);
+  const uint32_t count = firConfig.getFilterCount() * taps;
+  float32_t *coefficients = new float32_t[count];
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    coefficients[i] = distribution(generator) * expf(-4.0f * (float32_t) (i % taps) / (float32_t) taps) / sqrtf((float32_t) taps);
+  }
+
+  firConfig.coefficients = std::shared_ptr<const float32_t>(coefficients, std::default_delete<const float32_t[]>());
+  firConfig.taps = taps;
+  firConfig.enabled = true;
+}
+
+/**
+ * Compares the real FFT with a double precision DFT, in the packing of arm_rfft_fast_f32,
+ * and the inverse transform with the input
+ */
+static bool checkFft()
+{
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<float32_t> distribution(-1.0f, 1.0f);
+  bool result = true;
+
+  printf("real FFT against a double precision DFT\n");
+  printf("  %6s %14s %14s\n", "length", "forward error", "inverse error");
+
+  for (uint32_t length = REAL_FFT_MIN_LENGTH; length <= REAL_FFT_MAX_LENGTH; length *= 2)
+  {
+    RealFft fft;
+    fft.init(length);
+
+    std::vector<float32_t> input(length);
+    std::vector<float32_t> work(length);
+    std::vector<float32_t> spectrum(length);
+    std::vector<float32_t> output(length);
+
+    for (auto &sample : input)
+    {
+      sample = distribution(generator);
+    }
+
+    work = input;
+    fft.transform(work.data(), spectrum.data(), false);
+
+    double forwardError = 0.0;
+    double peak = 0.0;
+
+    for (uint32_t k = 0; k <= length / 2; k++)
+    {
+      double re = 0.0;
+      double im = 0.0;
+
+      for (uint32_t n = 0; n < length; n++)
+      {
+        double angle = 2.0 * M_PI * (double) ((uint64_t) k * n % length) / length;
+        re += input[n] * cos(angle);
+        im -= input[n] * sin(angle);
+      }
+
+      double packedRe = (k == 0) ? spectrum[0] : ((k == length / 2) ? spectrum[1] : spectrum[k * 2]);
+      double packedIm = (k == 0 || k == length / 2) ? 0.0 : spectrum[k * 2 + 1];
+
+      forwardError = std::max(forwardError, std::hypot(packedRe - re, packedIm - im));
+      peak = std::max(peak, std::hypot(re, im));
+    }
+
+    fft.transform(spectrum.data(), output.data(), true);
+
+    double inverseError = 0.0;
+    for (uint32_t n = 0; n < length; n++)
+    {
+      inverseError = std::max(inverseError, (double) fabsf(output[n] - input[n]));
+    }
+
+    double forwardDb = 20.0 * log10(forwardError / peak);
+    double inverseDb = 20.0 * log10(inverseError);
+    printf("  %6u %11.1f dB %11.1f dB\n", length, forwardDb, inverseDb);
+
+    result &= (forwardDb < -100.0) && (inverseDb < -100.0);
+  }
+
+  return result;
+}
+
+/**
+ * Compares the partitioned convolution with a direct convolution in double precision, for block sizes
+ * shorter and longer than the filter, over several blocks so that every partition is exercised
+ */
+static bool checkConvolution(System::FirPlacement placement)
+{
+  std::mt19937 generator(2);
+  std::uniform_real_distribution<float32_t> distribution(-0.5f, 0.5f);
+  bool result = true;
+
+  printf("\nconvolution of %u taps against a direct convolution\n", CHECK_TAPS);
+  printf("  %6s %6s %6s %14s\n", "block", "fft", "parts", "max error");
+
+  for (uint32_t blockFrames : { 48u, 177u, 192u, 480u, 1500u })
+  {
+    System::FirConfiguration firConfig;
+    firConfig.placement = placement;
+    generateTaps(firConfig, CHECK_TAPS, blockFrames);
+
+    FirConvolver convolver(&firConfig, blockFrames);
+    convolver.init();
+
+    const uint32_t frames = blockFrames * CHECK_BLOCKS;
+    const uint32_t filterCount = convolver.getFilters();
+    std::vector<float32_t> input(frames * 2);
+    std::vector<float32_t> output(frames * filterCount);
+
+    for (auto &sample : input)
+    {
+      sample = distribution(generator);
+    }
+
+    for (uint32_t block = 0; block < CHECK_BLOCKS; block++)
+    {
+      for (uint32_t channel = 0; channel < FIR_INPUTS; channel++)
+      {
+        convolver.writeInput(channel, &input[block * blockFrames * 2 + channel], 2);
+      }
+
+      for (uint32_t filter = 0; filter < filterCount; filter++)
+      {
+        convolver.readOutput(filter, &output[block * blockFrames * filterCount + filter], filterCount);
+      }
+
+      convolver.nextBlock();
+    }
+
+    const float32_t *pTaps = firConfig.coefficients.get();
+    const uint32_t inputShift = (placement == System::FirPlacement::FIR_PLACEMENT_CROSSOVER) ? 1 : 0;
+    double maxError = 0.0;
+
+    for (uint32_t filter = 0; filter < filterCount; filter++)
+    {
+      const float32_t *pFilter = pTaps + filter * CHECK_TAPS;
+      const uint32_t channel = filter >> inputShift;
+
+      for (uint32_t n = 0; n < frames; n++)
+      {
+        double sum = 0.0;
+
+        for (uint32_t tap = 0; tap < CHECK_TAPS && tap <= n; tap++)
+        {
+          sum += (double) pFilter[tap] * input[(n - tap) * 2 + channel];
+        }
+
+        maxError = std::max(maxError, fabs(sum - output[n * filterCount + filter]));
+      }
+    }
+
+    double errorDb = 20.0 * log10(maxError);
+    printf("  %6u %6u %6u %11.1f dB\n", blockFrames, convolver.getFftLength(), convolver.getPartitions(), errorDb);
+
+    result &= errorDb < -100.0;
+  }
+
+  return result;
+}
+
+/**
+ * Returns the floating point operations of one block: a forward transform per input, the products
+ * with the partitions and an inverse transform per filter
+ */
+static double getBlockFlops(const FirConvolver &convolver)
+{
+  const double length = convolver.getFftLength();
+  const double transformFlops = 5.0 * (length / 2.0) * log2(length / 2.0) + 6.0 * length;
+
+  return FIR_INPUTS * transformFlops
+      + convolver.getFilters() * (convolver.getPartitions() * 4.0 * length + transformFlops + length);
+}
+
+/**
+ * Measures the cost of one configuration per block
+ */
+static void benchConfiguration(const System::FirConfiguration &firConfig, uint32_t blockFrames, uint32_t sampleRate)
+{
+  FirConvolver convolver(&firConfig, blockFrames);
+
+  if (!convolver.init())
+  {
+    printf("  %6u %6u   not supported\n", blockFrames, firConfig.taps);
+    return;
+  }
+
+  std::mt19937 generator(3);
+  std::uniform_real_distribution<float32_t> distribution(-0.5f, 0.5f);
+  std::vector<float32_t> input(blockFrames * 2);
+  std::vector<float32_t> output(blockFrames * 2);
+  const uint32_t filterCount = convolver.getFilters();
+
+  for (auto &sample : input)
+  {
+    sample = distribution(generator);
+  }
+
+  uint32_t blocks = 0;
+  uint64_t cycles = 0;
+  auto start = BenchClock::now();
+  std::chrono::duration<double> elapsed(0.0);
+
+  while (elapsed.count() < MEASURE_TIME_S)
+  {
+    uint64_t startCycles = readCycleCounter();
+
+    convolver.writeInput(PcmChannel::LEFT, &input[0], 2);
+    convolver.writeInput(PcmChannel::RIGHT, &input[1], 2);
+
+    for (uint32_t filter = 0; filter < filterCount; filter++)
+    {
+      convolver.readOutput(filter, &output[filter & 1], 2);
+    }
+
+    convolver.nextBlock();
+
+    cycles += readCycleCounter() - startCycles;
+    blocks++;
+    elapsed = BenchClock::now() - start;
+  }
+
+  const double nsPerBlock = elapsed.count() * 1e9 / blocks;
+  const double blockNs = 1e9 * blockFrames / sampleRate;
+  const double flops = getBlockFlops(convolver);
+
+  printf("  %6u %6u %7u %6u %6u %10.0f %10.0f %7.2f%% %9.1f %8u\n", blockFrames, firConfig.taps, filterCount,
+      convolver.getFftLength(), convolver.getPartitions(), nsPerBlock, (double) cycles / blocks, 100.0 * nsPerBlock / blockNs,
+      flops * sampleRate / blockFrames * 1e-6, (convolver.getMemorySize() + 1023) / 1024);
+}
+
+/**
+ * Runs a delayed impulse through the FIR stage of the AudioFilters pipeline with each engine.
+ * The output streams must be the input delayed, within one LSB.
+ */
+static bool checkPipeline(System::FirPlacement placement)
+{
+  std::mt19937 generator(4);
+  std::uniform_int_distribution<int32_t> distribution(-16000, 16000);
+  const uint32_t blocks = 16;
+  const uint32_t frames = PIPELINE_BLOCK_FRAMES * blocks;
+  bool result = true;
+
+  std::vector<int16_t> input(frames * 2);
+  for (auto &sample : input)
+  {
+    sample = (int16_t) distribution(generator);
+  }
+
+  printf("\npipeline check: impulse delayed by %u frames, %s placement\n", PIPELINE_DELAY,
+      (placement == System::FirPlacement::FIR_PLACEMENT_CROSSOVER) ? "crossover" : "master");
+
+  for (uint32_t engine = 0; engine < System::FilterEngine::MAX_FILTER_ENGINES; engine++)
+  {
+    System::FilterConfiguration config;
+    Host::loadPreset("passthrough", config);
+    config.filterEngine = (System::FilterEngine) engine;
+    config.xoverEqEnabled = true;
+    config.firConfig.placement = placement;
+    config.firConfig.taps = PIPELINE_DELAY + 1;
+    config.firConfig.enabled = true;
+
+    // Impulse at PIPELINE_DELAY for every filter
+    const uint32_t filterCount = config.firConfig.getFilterCount();
+    float32_t *coefficients = new float32_t[filterCount * (PIPELINE_DELAY + 1)]();
+
+    for (uint32_t filter = 0; filter < filterCount; filter++)
+    {
+      coefficients[filter * (PIPELINE_DELAY + 1) + PIPELINE_DELAY] = 1.0f;
+    }
+    config.firConfig.coefficients = std::shared_ptr<const float32_t>(coefficients, std::default_delete<const float32_t[]>());
+
+    AudioFilters filters(&config, PIPELINE_BLOCK_FRAMES);
+    filters.init();
+
+    std::vector<int16_t> tweeter(frames * 2);
+    std::vector<int16_t> woofer(frames * 2);
+
+    for (uint32_t block = 0; block < blocks; block++)
+    {
+      int16_t *pDst[2] = { &tweeter[block * PIPELINE_BLOCK_FRAMES * 2], &woofer[block * PIPELINE_BLOCK_FRAMES * 2] };
+      filters.run(&input[block * PIPELINE_BLOCK_FRAMES * 2], pDst);
+    }
+
+    int32_t maxError = 0;
+
+    for (uint32_t i = PIPELINE_DELAY * 2; i < frames * 2; i++)
+    {
+      // The streams may have the channels swapped, and the channels may be inverted
+      int32_t expected = input[i - PIPELINE_DELAY * 2];
+      int32_t tweeterError = std::min(std::min(abs(tweeter[i] - expected), abs(tweeter[i ^ 1] - expected)),
+          std::min(abs(tweeter[i] + expected), abs(tweeter[i ^ 1] + expected)));
+      int32_t wooferError = std::min(std::min(abs(woofer[i] - expected), abs(woofer[i ^ 1] - expected)),
+          std::min(abs(woofer[i] + expected), abs(woofer[i ^ 1] + expected)));
+
+      maxError = std::max(maxError, std::max(tweeterError, wooferError));
+    }
+
+    printf("  %-5s %u stages, max error %d LSB\n", engineNames[engine], filters.getPlanStages(), maxError);
+    result &= (maxError <= 1) && (filters.getPlanStages() == 1);
+  }
+
+  return result;
+}
+
+int main(int argc, char **argv)
+{
+  BenchOptions options;
+
+  if (!parseOptions(argc, argv, options))
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  bool result = checkFft();
+  result &= checkConvolution(options.placement);
+
+  if (!options.firFile.empty())
+  {
+    System::FirConfiguration firConfig;
+    firConfig.placement = options.placement;
+    firConfig.enabled = true;
+
+    if (!Host::loadFirFile(options.firFile, firConfig))
+    {
+      fprintf(stderr, "cannot load %s for %u filters\n", options.firFile.c_str(), firConfig.getFilterCount());
+      return 1;
+    }
+
+    options.taps.assign(1, firConfig.taps);
+  }
+
+  printf("\ncost per block at %u Hz (the block budget is the block duration)\n", options.sampleRate);
+  printf("  %6s %6s %7s %6s %6s %10s %10s %8s %9s %8s\n", "block", "taps", "filters", "fft", "parts", "ns/block", "cyc/block",
+      "budget", "Mflop/s", "KiB");
+
+  for (auto blockFrames : options.blockFrames)
+  {
+    for (auto taps : options.taps)
+    {
+      System::FirConfiguration firConfig;
+      firConfig.placement = options.placement;
+
+      if (!options.firFile.empty())
+      {
+        firConfig.enabled = true;
+        Host::loadFirFile(options.firFile, firConfig);
+      }
+      else
+      {
+        generateTaps(firConfig, taps, taps);
+      }
+
+      benchConfiguration(firConfig, blockFrames, options.sampleRate);
+    }
+  }
+
+  result &= checkPipeline(System::FirPlacement::FIR_PLACEMENT_MASTER);
+  result &= checkPipeline(System::FirPlacement::FIR_PLACEMENT_CROSSOVER);
+
+  printf("\n%s\n", result ? "PASS" : "FAIL");
+  return result ? 0 : 1;
+}
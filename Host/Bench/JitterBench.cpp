@@ -0,0 +1,310 @@
+//====================================================================
+//
+// COPYRIGHT 2026 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: Host simulation of the jitter buffer of the SAI and USB inputs. It runs an input and the audio
+//              task on their own clocks, with drift, arrival jitter, a dropout and a stalled reader, and reports
+//              the fill level, the depth and the concealment
+//  Filename: JitterBench.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 17-October-2026
+//
+//====================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Interfaces/AudioLocal/pub/JitterBuffer.hpp"
+
+#define SAMPLE_RATE             48000
+#define BLOCK_FRAMES            192                   //!< 4 ms blocks of the audio task
+#define MAX_BLOCK_FRAMES        384                   //!< 4 ms at 96 kHz, which sizes the buffer
+#define CLOCK_HZ                1000000               //!< The timestamps are in us
+#define TONE_FREQUENCY          1000.0
+#define TONE_LEVEL              (0.5 * 32767.0)       //!< -6 dBFS
+#define CLICK_RATIO             2.0                   //!< Largest step between two output samples, against the steepest step of the tone
+#define EVENT_TIME_S            10.0                  //!< When the dropout and the stall happen
+#define TAIL_TIME_S             10.0                  //!< The end of each run, when the depth has settled
+#define SPIKE_PROBABILITY       0.001                 //!< Share of the notifications that are late by up to the spike
+
+/**
+ * The input and the reader of one run
+ */
+struct JitterScenario
+{
+public:
+  const char *name;
+  uint32_t notificationFrames;    //!< Frames per notification: 48 (1 ms) like the USB, 192 like a SAI DMA half
+  double driftPpm;                //!< Clock offset of the input against the reader
+  double jitterMs;                //!< The notifications are late by up to this, uniformly distributed
+  double spikeMs;                 //!< A few notifications are late by up to this, e.g. behind a higher priority task
+  bool adaptive;
+  double dropoutMs;               //!< The input stops for this long at EVENT_TIME_S
+  double stallMs;                 //!< The reader stops for this long at EVENT_TIME_S
+};
+
+static const JitterScenario scenarios[] = {
+    { "usb",              48,   0.0, 0.0, 0.0, true,  0.0,  0.0 },
+    { "usb +100 ppm",     48, 100.0, 0.0, 0.0, true,  0.0,  0.0 },
+    { "usb -100 ppm",     48,-100.0, 0.0, 0.0, true,  0.0,  0.0 },
+    { "usb 1 ms jitter",  48,  20.0, 1.0, 0.0, true,  0.0,  0.0 },
+    { "usb 2 ms spikes",  48,  20.0, 0.1, 2.0, true,  0.0,  0.0 },
+    { "usb 2 ms fixed",   48,  20.0, 0.1, 2.0, false, 0.0,  0.0 },
+    { "sai +50 ppm",     192,  50.0, 0.1, 0.0, true,  0.0,  0.0 },
+    { "sai -50 ppm",     192, -50.0, 0.1, 0.0, true,  0.0,  0.0 },
+    { "usb dropout",      48,  20.0, 0.1, 0.0, true, 50.0,  0.0 },
+    { "usb stalled",      48,  20.0, 0.1, 0.0, true,  0.0, 60.0 },
+};
+
+struct JitterResult
+{
+public:
+  System::JitterBufferStats stats;
+  uint32_t tailUnderflows = 0;    //!< Underflows in the last TAIL_TIME_S
+  uint32_t slips = 0;             //!< Frames repeated and merged to keep the depth, after the start
+  double maxStepRatio = 0.0;      //!< Largest step of the output against the steepest step of the tone
+  double latencyMs = 0.0;         //!< Average fill before a read at the end, in ms
+};
+
+struct BenchOptions
+{
+public:
+  double durationS = 60.0;
+  uint32_t seed = 1;
+};
+
+static void usage(const char *name)
+{
+  printf("usage: %s [options]\n", name);
+  printf("  -t <seconds>      length of each run (default: 60)\n");
+  printf("  -s <seed>         seed of the arrival jitter (default: 1)\n");
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions &options)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    bool hasValue = (i + 1) < argc;
+
+    if (arg == "-t" && hasValue)
+    {
+      options.durationS = atof(argv[++i]);
+    }
+    else if (arg == "-s" && hasValue)
+    {
+      options.seed = strtoul(argv[++i], nullptr, 0);
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  return options.durationS > 2 * TAIL_TIME_S;
+}
+
+/**
+ * Runs the input and the reader of a scenario through a jitter buffer, event by event in simulated time
+ */
+static JitterResult runScenario(const JitterScenario &scenario, const BenchOptions &options)
+{
+  System::JitterBufferConfiguration config;
+  config.adaptive = scenario.adaptive;
+  config.targetDepth = scenario.adaptive ? config.targetDepth : 0.001f;
+
+  JitterBuffer jitterBuffer(&config);
+  jitterBuffer.init(MAX_BLOCK_FRAMES, 96000);
+  jitterBuffer.reset(SAMPLE_RATE, CLOCK_HZ);
+
+  std::mt19937 random(options.seed);
+  std::uniform_real_distribution<double> jitter(0.0, scenario.jitterMs * 1.0e-3);
+  std::uniform_real_distribution<double> spike(0.0, scenario.spikeMs * 1.0e-3);
+  std::bernoulli_distribution spiking(SPIKE_PROBABILITY);
+  std::vector<int16_t> notification(scenario.notificationFrames * 2), block(BLOCK_FRAMES * 2);
+
+  const double notificationPeriod = scenario.notificationFrames / (SAMPLE_RATE * (1.0 + scenario.driftPpm * 1.0e-6));
+  const double blockPeriod = (double) BLOCK_FRAMES / SAMPLE_RATE;
+  const double phaseStep = 2.0 * M_PI * TONE_FREQUENCY / SAMPLE_RATE;
+  const double toneStep = TONE_LEVEL * phaseStep;
+
+  JitterResult result;
+  System::JitterBufferStats tailStats;
+  bool tailTaken = false;
+  uint64_t notifications = 0, blocks = 0, inputFrames = 0;
+  double lastArrival = 0.0;
+  int16_t lastSample[2] = { 0, 0 };
+
+  while (true)
+  {
+    double arrival = notifications * notificationPeriod + jitter(random) + (spiking(random) ? spike(random) : 0.0);
+    double readTime = blocks * blockPeriod;
+
+    // The input pauses during the dropout and the notifications of that time are lost
+    if ((scenario.dropoutMs > 0.0) && (arrival >= EVENT_TIME_S) && (arrival < EVENT_TIME_S + scenario.dropoutMs * 1.0e-3))
+    {
+      notifications++;
+      inputFrames += scenario.notificationFrames;
+      continue;
+    }
+
+    // The reader misses the blocks of the stall, like a sink that underruns, and the input piles up meanwhile
+    bool stalled = (scenario.stallMs > 0.0) && (readTime >= EVENT_TIME_S)
+        && (readTime < EVENT_TIME_S + scenario.stallMs * 1.0e-3);
+
+    if (std::min(arrival, readTime) >= options.durationS)
+    {
+      break;
+    }
+
+    if (arrival <= readTime)
+    {
+      // A late notification holds the next ones up, as the bus delivers them in order
+      arrival = std::max(arrival, lastArrival);
+      lastArrival = arrival;
+
+      for (uint32_t i = 0; i < scenario.notificationFrames; i++)
+      {
+        int16_t sample = (int16_t) lrint(TONE_LEVEL * sin(phaseStep * (double) (inputFrames + i)));
+        notification[2 * i] = sample;
+        notification[2 * i + 1] = (int16_t) -sample;
+      }
+
+      FifoSpan<int16_t> span = jitterBuffer.acquireWrite(scenario.notificationFrames * 2);
+      memcpy(span.data[0], notification.data(), span.length[0] * sizeof(int16_t));
+      memcpy(span.data[1], &notification[span.length[0]], span.length[1] * sizeof(int16_t));
+      jitterBuffer.commitWrite(span.getLength(), scenario.notificationFrames * 2 - span.getLength(),
+          (uint32_t) llrint(arrival * CLOCK_HZ));
+
+      notifications++;
+      inputFrames += scenario.notificationFrames;
+      continue;
+    }
+
+    if (!tailTaken && (readTime >= options.durationS - TAIL_TIME_S))
+    {
+      jitterBuffer.getStats(tailStats);
+      tailTaken = true;
+    }
+
+    blocks++;
+    if (stalled)
+    {
+      continue;
+    }
+
+    jitterBuffer.read(block.data(), BLOCK_FRAMES);
+
+    for (uint32_t i = 0; i < BLOCK_FRAMES * 2; i++)
+    {
+      double step = fabs((double) block[i] - (double) lastSample[i & 1]);
+      result.maxStepRatio = std::max(result.maxStepRatio, step / toneStep);
+      lastSample[i & 1] = block[i];
+    }
+  }
+
+  jitterBuffer.getStats(result.stats);
+  result.tailUnderflows = result.stats.underflows - tailStats.underflows;
+  result.slips = result.stats.concealedFrames + result.stats.droppedFrames;
+  result.latencyMs = result.stats.averageFill * 1000.0 / SAMPLE_RATE;
+
+  return result;
+}
+
+/**
+ * Checks a run against what its scenario should give
+ */
+static bool checkScenario(const JitterScenario &scenario, const JitterResult &result, const BenchOptions &options)
+{
+  const System::JitterBufferStats &stats = result.stats;
+  bool passed = (result.maxStepRatio < CLICK_RATIO) && (stats.overflows == 0 || scenario.stallMs > 0.0);
+
+  // A fixed depth of 1 ms is too short for the spikes, and the run shows how often it conceals
+  if (!scenario.adaptive)
+  {
+    return passed;
+  }
+
+  passed &= (result.tailUnderflows == 0);
+
+  if ((scenario.jitterMs == 0.0) && (scenario.dropoutMs == 0.0) && (scenario.stallMs == 0.0))
+  {
+    // Without jitter, the buffer only slips the frames of the drift
+    double driftFrames = fabs(scenario.driftPpm) * 1.0e-6 * SAMPLE_RATE * options.durationS;
+    passed &= (stats.underflows == 0) && (result.slips <= driftFrames * 1.5 + 2 * BLOCK_FRAMES);
+  }
+
+  if (scenario.dropoutMs > 0.0)
+  {
+    passed &= (stats.underflows <= 2) && (stats.concealedFrames >= BLOCK_FRAMES);
+  }
+
+  if (scenario.stallMs > 0.0)
+  {
+    passed &= (stats.droppedFrames >= (uint32_t) (scenario.stallMs * 1.0e-3 * SAMPLE_RATE / 2));
+  }
+
+  return passed;
+}
+
+int main(int argc, char **argv)
+{
+  BenchOptions options;
+
+  if (!parseOptions(argc, argv, options))
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  bool passed = true;
+
+  printf("%u Hz, %u frame blocks, %.0f s runs, fill and depth in frames, steps against the steepest step of the tone\n",
+      SAMPLE_RATE, BLOCK_FRAMES, options.durationS);
+  printf("  %-16s %6s %6s %17s %8s %10s %10s %9s %8s %9s %6s\n", "scenario", "depth", "jitter", "min/avg/max fill",
+      "latency", "underflows", "tail underf", "concealed", "dropped", "overflows", "step");
+
+  for (const JitterScenario &scenario : scenarios)
+  {
+    JitterResult result = runScenario(scenario, options);
+    bool scenarioPassed = checkScenario(scenario, result, options);
+    char fill[32];
+
+    snprintf(fill, sizeof(fill), "%u/%u/%u", result.stats.minFill, result.stats.averageFill, result.stats.maxFill);
+    printf("  %-16s %6u %6u %17s %5.2f ms %10u %11u %9u %8u %9u %5.2f %s\n", scenario.name, result.stats.targetDepth,
+        result.stats.arrivalJitter, fill, result.latencyMs, result.stats.underflows, result.tailUnderflows,
+        result.stats.concealedFrames, result.stats.droppedFrames, result.stats.overflows, result.maxStepRatio,
+        scenarioPassed ? "" : "FAILED");
+
+    passed &= scenarioPassed;
+  }
+
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+//====================================================================
+//
+// COPYRIGHT 2026 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: Host check and microbenchmark of the MathUtils block functions. It verifies
+//              the documented error bounds and compares the cost against the scalar functions
+//  Filename: MathBench.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <vector>
+#include "Utilities/MathUtils.hpp"
+
+#define BLOCK_SIZE      192
+#define TIMING_BLOCKS   20000
+
+using BenchClock = std::chrono::steady_clock;
+using BlockFunction = std::function<void(const float32_t*, float32_t*, uint32_t)>;
+
+/**
+ * A block function, its exact reference and the input range of its documented error bound
+ */
+struct MathCheck
+{
+public:
+  const char *name;
+  BlockFunction function;
+  BlockFunction scalarFunction;       //!< The per-sample function it replaces
+  const char *scalarName;
+  double (*reference)(double);
+  double minInput;
+  double maxInput;
+  bool logarithmic;                   //!< Sweep the inputs on a logarithmic scale
+  bool relative;                      //!< The bound is a relative error
+  double maxError;
+};
+
+static double referenceLog10(double x)
+{
+  return log10(x);
+}
+
+static double referencePow10(double x)
+{
+  return pow(10.0, x);
+}
+
+static double referenceDbToLin(double x)
+{
+  return pow(10.0, x / 20.0);
+}
+
+/**
+ * Runs a block function over a dense sweep of the input range of the check and returns the largest error
+ */
+static double measureError(const BlockFunction &function, const MathCheck &check)
+{
+  const uint32_t points = 2000000;
+  std::vector<float32_t> input(points), output(points);
+
+  for (uint32_t i = 0; i < points; i++)
+  {
+    double pos = (double) i / (points - 1);
+    input[i] = check.logarithmic ?
+        (float32_t) exp(log(check.minInput) + pos * (log(check.maxInput) - log(check.minInput))) :
+        (float32_t) (check.minInput + pos * (check.maxInput - check.minInput));
+  }
+
+  function(input.data(), output.data(), points);
+
+  double maxError = 0.0;
+  for (uint32_t i = 0; i < points; i++)
+  {
+    double exact = check.reference(input[i]);
+    double error = fabs(output[i] - exact);
+    maxError = std::max(maxError, check.relative ? error / fabs(exact) : error);
+  }
+
+  return maxError;
+}
+
+/**
+ * Returns the mean time per sample of a block function, over blocks of BLOCK_SIZE samples
+ */
+static double measureTime(const BlockFunction &function, const MathCheck &check)
+{
+  std::vector<float32_t> input(BLOCK_SIZE), output(BLOCK_SIZE);
+  volatile float32_t sink = 0.0f;
+
+  for (uint32_t i = 0; i < BLOCK_SIZE; i++)
+  {
+    double pos = (double) i / (BLOCK_SIZE - 1);
+    input[i] = check.logarithmic ? (float32_t) (check.minInput * pow(check.maxInput / check.minInput, pos)) :
+        (float32_t) (check.minInput + pos * (check.maxInput - check.minInput));
+  }
+
+  auto start = BenchClock::now();
+  for (uint32_t block = 0; block < TIMING_BLOCKS; block++)
+  {
+    function(input.data(), output.data(), BLOCK_SIZE);
+    sink = sink + output[block % BLOCK_SIZE];
+  }
+  auto end = BenchClock::now();
+
+  return std::chrono::duration<double, std::nano>(end - start).count() / ((double) TIMING_BLOCKS * BLOCK_SIZE);
+}
+
+int main()
+{
+  const MathCheck checks[] = {
+      {
+          "log10f_block", log10f_block,
+          [](const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+          {
+            for (uint32_t i = 0; i < blockSize; i++)
+            {
+              pDst[i] = log10fApprox(pSrc[i]);
+            }
+          },
+          "log10fApprox", referenceLog10, 1.0e-37, 1.0e37, true, false, LOG10F_BLOCK_MAX_ABS_ERROR
+      },
+      {
+          "pow10f_block", pow10f_block,
+          [](const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+          {
+            for (uint32_t i = 0; i < blockSize; i++)
+            {
+              pDst[i] = pow10f(pSrc[i]);
+            }
+          },
+          "pow10f (expf)", referencePow10, -30.0, 30.0, false, true, POW10F_BLOCK_MAX_REL_ERROR
+      },
+      {
+          "db_to_lin_block", db_to_lin_block,
+          [](const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+          {
+            for (uint32_t i = 0; i < blockSize; i++)
+            {
+              pDst[i] = pow10f(pSrc[i] / 20.0f);
+            }
+          },
+          "pow10f(x / 20)", referenceDbToLin, -200.0, 200.0, false, true, DB_TO_LIN_BLOCK_MAX_REL_ERROR
+      }
+  };
+
+  bool passed = true;
+
+  printf("%-16s %12s %12s %10s   %-16s %12s %10s %8s\n", "function", "max error", "bound", "ns/sample",
+      "replaces", "max error", "ns/sample", "speedup");
+
+  for (auto &check : checks)
+  {
+    double error = measureError(check.function, check);
+    double scalarError = measureError(check.scalarFunction, check);
+    double blockNs = measureTime(check.function, check);
+    double scalarNs = measureTime(check.scalarFunction, check);
+    bool withinBound = error <= check.maxError;
+
+    printf("%-16s %12.3e %12.3e %10.2f   %-16s %12.3e %10.2f %7.1fx %s\n", check.name, error, check.maxError, blockNs,
+        check.scalarName, scalarError, scalarNs, scalarNs / blockNs, withinBound ? "" : "FAILED");
+
+    passed &= withinBound;
+  }
+
+  return passed ? 0 : 1;
+}
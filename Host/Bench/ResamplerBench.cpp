@@ -0,0 +1,518 @@
+//====================================================================
+//
+// COPYRIGHT 2026 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: Host benchmark of the sample-rate converter. It measures the cost per output frame
+//              and the THD+N of sine tones for each quality, and the lock of the drift tracking
+//  Filename: ResamplerBench.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "Controllers/Audio/src/Resampler.hpp"
+
+#define BLOCK_TIME_MS           4
+#define TONE_DURATION_S         4
+#define TONE_LEVEL              (0.5 * 32767.0)       //!< -6 dBFS
+#define SETTLE_TIME_S           0.1
+#define DRIFT_DURATION_S        60
+#define DRIFT_MEASURE_TIME_S    10                    //!< The end of the drift run, after the lock
+#define DRIFT_NOTIFICATION_MS   1                     //!< The source delivers 1 ms of frames at a time, like the USB input
+
+using BenchClock = std::chrono::steady_clock;
+
+static const char *qualityNames[System::ResamplerQuality::MAX_RESAMPLER_QUALITIES] = {
+    "low",
+    "medium",
+    "high"
+};
+
+/**
+ * A conversion between two rates
+ */
+struct BenchConversion
+{
+public:
+  uint32_t inputRate;
+  uint32_t outputRate;
+};
+
+static const BenchConversion conversions[] = {
+    { 44100, 48000 },
+    { 48000, 44100 },
+    { 44100, 96000 },
+    { 22050, 48000 },
+    { 32000, 44100 }
+};
+
+struct BenchOptions
+{
+public:
+  std::vector<System::ResamplerQuality> qualities;
+  std::vector<uint32_t> taps;
+  double driftPpm = 100.0;
+};
+
+static uint32_t getBlockFrames(uint32_t rate)
+{
+  return (rate * BLOCK_TIME_MS + 999) / 1000;
+}
+
+static uint64_t readCycleCounter()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static void usage(const char *name)
+{
+  printf("usage: %s [options]\n", name);
+  printf("  -q <quality>      low, medium or high (default: all of them). Can be repeated\n");
+  printf("  -t <taps>         taps per phase, instead of the length of the quality. Can be repeated\n");
+  printf("  -d <ppm>          clock offset of the source in the drift tracking run (default: 100)\n");
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions &options)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    bool hasValue = (i + 1) < argc;
+
+    if (arg == "-q" && hasValue)
+    {
+      std::string quality = argv[++i];
+      uint32_t num = 0;
+
+      while (num < System::ResamplerQuality::MAX_RESAMPLER_QUALITIES && quality != qualityNames[num])
+      {
+        num++;
+      }
+
+      if (num == System::ResamplerQuality::MAX_RESAMPLER_QUALITIES)
+      {
+        return false;
+      }
+      options.qualities.push_back((System::ResamplerQuality) num);
+    }
+    else if (arg == "-t" && hasValue)
+    {
+      options.taps.push_back(strtoul(argv[++i], nullptr, 0));
+    }
+    else if (arg == "-d" && hasValue)
+    {
+      options.driftPpm = strtod(argv[++i], nullptr);
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  if (options.qualities.empty())
+  {
+    for (uint32_t num = 0; num < System::ResamplerQuality::MAX_RESAMPLER_QUALITIES; num++)
+    {
+      options.qualities.push_back((System::ResamplerQuality) num);
+    }
+  }
+
+  if (options.taps.empty())
+  {
+    options.taps.push_back(0);
+  }
+
+  return true;
+}
+
+/**
+ * Returns the THD+N of the left channel in dB: the residual after a least-squares fit of the tone
+ * (sine, cosine and DC), relative to the fitted tone
+ */
+static double measureThdN(const std::vector<int16_t> &samples, uint32_t first, uint32_t count, double frequency, double rate)
+{
+  double sums[3][3] = { };
+  double rhs[3] = { };
+  const double omega = 2.0 * M_PI * frequency / rate;
+
+  for (uint32_t i = first; i < first + count; i++)
+  {
+    double basis[3] = { sin(omega * i), cos(omega * i), 1.0 };
+    double y = samples[2 * i];
+
+    for (uint32_t r = 0; r < 3; r++)
+    {
+      for (uint32_t c = 0; c < 3; c++)
+      {
+        sums[r][c] += basis[r] * basis[c];
+      }
+      rhs[r] += basis[r] * y;
+    }
+  }
+
+  // Gaussian elimination of the 3x3 normal equations
+  for (uint32_t pivot = 0; pivot < 3; pivot++)
+  {
+    for (uint32_t r = pivot + 1; r < 3; r++)
+    {
+      double factor = sums[r][pivot] / sums[pivot][pivot];
+
+      for (uint32_t c = pivot; c < 3; c++)
+      {
+        sums[r][c] -= factor * sums[pivot][c];
+      }
+      rhs[r] -= factor * rhs[pivot];
+    }
+  }
+
+  double fit[3];
+  for (int32_t r = 2; r >= 0; r--)
+  {
+    double value = rhs[r];
+
+    for (uint32_t c = r + 1; c < 3; c++)
+    {
+      value -= sums[r][c] * fit[c];
+    }
+    fit[r] = value / sums[r][r];
+  }
+
+  double residual = 0.0;
+  for (uint32_t i = first; i < first + count; i++)
+  {
+    double error = samples[2 * i] - (fit[0] * sin(omega * i) + fit[1] * cos(omega * i) + fit[2]);
+    residual += error * error;
+  }
+
+  double toneRms = sqrt((fit[0] * fit[0] + fit[1] * fit[1]) / 2.0);
+  return 20.0 * log10(sqrt(residual / count) / toneRms);
+}
+
+/**
+ * Returns the THD+N over windows of 100 ms, averaged in power. Each window gets its own fit of the tone,
+ * with the frequency searched within +-maxPpm: the ratio of a drift-tracking conversion moves slowly
+ * with the fill level, which a single fit at the nominal frequency would count as noise.
+ */
+static double measureWindowedThdN(const std::vector<int16_t> &samples, uint32_t first, uint32_t count, double frequency, double rate,
+    double maxPpm)
+{
+  const uint32_t window = (uint32_t) (rate / 10.0);
+  const double goldenRatio = (sqrt(5.0) - 1.0) / 2.0;
+  double power = 0.0;
+  uint32_t windows = 0;
+
+  for (uint32_t start = first; start + window <= first + count; start += window)
+  {
+    // Golden section search of the frequency with the lowest residual
+    double low = frequency * (1.0 - maxPpm * 1e-6);
+    double high = frequency * (1.0 + maxPpm * 1e-6);
+    double lower = high - goldenRatio * (high - low);
+    double upper = low + goldenRatio * (high - low);
+    double lowerThdN = measureThdN(samples, start, window, lower, rate);
+    double upperThdN = measureThdN(samples, start, window, upper, rate);
+
+    for (uint32_t iteration = 0; iteration < 24; iteration++)
+    {
+      if (lowerThdN < upperThdN)
+      {
+        high = upper;
+        upper = lower;
+        upperThdN = lowerThdN;
+        lower = high - goldenRatio * (high - low);
+        lowerThdN = measureThdN(samples, start, window, lower, rate);
+      }
+      else
+      {
+        low = lower;
+        lower = upper;
+        lowerThdN = upperThdN;
+        upper = low + goldenRatio * (high - low);
+        upperThdN = measureThdN(samples, start, window, upper, rate);
+      }
+    }
+
+    power += pow(10.0, std::min(lowerThdN, upperThdN) / 10.0);
+    windows++;
+  }
+
+  return 10.0 * log10(power / windows);
+}
+
+/**
+ * Generates a stereo sine tone, rounded to int16_t
+ */
+static std::vector<int16_t> generateTone(double frequency, double rate, uint32_t frames)
+{
+  std::vector<int16_t> samples(frames * 2);
+
+  for (uint32_t i = 0; i < frames; i++)
+  {
+    samples[2 * i] = (int16_t) lrint(TONE_LEVEL * sin(2.0 * M_PI * frequency * i / rate));
+    samples[2 * i + 1] = samples[2 * i];
+  }
+
+  return samples;
+}
+
+/**
+ * Resamples a tone block by block, the way the audio service does, and returns the time spent per output frame
+ */
+static void resampleTone(Resampler &resampler, const BenchConversion &conversion, const std::vector<int16_t> &input,
+    std::vector<int16_t> &output, double &nsPerFrame, double &cyclesPerFrame)
+{
+  uint32_t chunkFrames = getBlockFrames(conversion.inputRate);
+  uint32_t blockFrames = getBlockFrames(conversion.outputRate);
+  uint32_t inputFrames = input.size() / 2;
+  uint32_t readFrames = 0;
+  double elapsedNs = 0.0;
+  uint64_t cycles = 0;
+
+  output.clear();
+
+  while (true)
+  {
+    uint32_t missing = resampler.getMissingFrames(blockFrames);
+    bool finished = false;
+
+    while (missing > 0 && !finished)
+    {
+      finished = readFrames + chunkFrames > inputFrames;
+      if (!finished)
+      {
+        resampler.write(&input[readFrames * 2], chunkFrames);
+        readFrames += chunkFrames;
+        missing = resampler.getMissingFrames(blockFrames);
+      }
+    }
+
+    if (finished)
+    {
+      break;
+    }
+
+    size_t offset = output.size();
+    output.resize(offset + blockFrames * 2);
+
+    auto start = BenchClock::now();
+    uint64_t startCycles = readCycleCounter();
+    resampler.run(&output[offset], blockFrames);
+    cycles += readCycleCounter() - startCycles;
+    elapsedNs += std::chrono::duration<double, std::nano>(BenchClock::now() - start).count();
+  }
+
+  nsPerFrame = elapsedNs / (output.size() / 2);
+  cyclesPerFrame = (double) cycles / (output.size() / 2);
+}
+
+/**
+ * Prints the cost and the THD+N of one configuration at every conversion
+ */
+static void benchConfiguration(const System::ResamplerConfiguration &config)
+{
+  for (const auto &conversion : conversions)
+  {
+    Resampler resampler(&config, getBlockFrames(96000));
+    uint32_t inputFrames = conversion.inputRate * TONE_DURATION_S;
+    double tones[2] = { 1000.0, floor(0.3 * std::min(conversion.inputRate, conversion.outputRate) / 100.0) * 100.0 };
+    double thdN[2];
+    double nsPerFrame = 0.0;
+    double cyclesPerFrame = 0.0;
+
+    resampler.init(conversion.inputRate, conversion.outputRate, false);
+
+    for (uint32_t num = 0; num < 2; num++)
+    {
+      std::vector<int16_t> input = generateTone(tones[num], conversion.inputRate, inputFrames);
+      std::vector<int16_t> output;
+
+      resampler.reset();
+      resampleTone(resampler, conversion, input, output, nsPerFrame, cyclesPerFrame);
+
+      uint32_t first = (uint32_t) (SETTLE_TIME_S * conversion.outputRate);
+      thdN[num] = measureThdN(output, first, output.size() / 2 - first, tones[num], conversion.outputRate);
+    }
+
+    printf("  %5u -> %5u  %-12s %8.1f %10.1f %7.1f dB (%5.0f Hz) %7.1f dB (%5.0f Hz) %7u %8u\n", conversion.inputRate,
+        conversion.outputRate, resampler.isInterpolated() ? "interpolated" : "rational", nsPerFrame, cyclesPerFrame,
+        thdN[0], tones[0], thdN[1], tones[1], resampler.getLatency(), resampler.getMemorySize());
+  }
+}
+
+/**
+ * Runs 44.1 to 48 kHz with a source clock that is off by driftPpm, through a fifo that is filled in 1 ms
+ * notifications and read in chunks, like the USB and SAI inputs. The drift tracking has to find the offset
+ * without the fifo running empty or full.
+ */
+static void benchDrift(const System::ResamplerConfiguration &config, double driftPpm)
+{
+  const BenchConversion conversion = { 44100, 48000 };
+  const double trueRate = conversion.inputRate * (1.0 + driftPpm * 1e-6);
+  const uint32_t chunkFrames = getBlockFrames(conversion.inputRate);
+  const uint32_t blockFrames = getBlockFrames(conversion.outputRate);
+  const uint32_t fifoFrames = 4 * chunkFrames;
+  const double tone = 1000.0;
+  Resampler resampler(&config, getBlockFrames(96000));
+  std::deque<int16_t> fifo;
+  std::vector<int16_t> output;
+  std::vector<int16_t> chunk(chunkFrames * 2);
+  uint32_t underruns = 0;
+  uint32_t overruns = 0;
+  uint64_t sourceFrames = 0;
+  double sourceTime = 0.0;
+  double fillTarget = -1.0;
+  double minPpm = 1e9;
+  double maxPpm = -1e9;
+  double maxFillError = 0.0;
+
+  resampler.init(conversion.inputRate, conversion.outputRate, true);
+
+  // The source starts with three blocks buffered
+  auto produce = [&](double untilTime)
+  {
+    while (sourceTime + DRIFT_NOTIFICATION_MS / 1000.0 <= untilTime)
+    {
+      sourceTime += DRIFT_NOTIFICATION_MS / 1000.0;
+      uint64_t target = (uint64_t) (sourceTime * trueRate);
+
+      for (; sourceFrames < target; sourceFrames++)
+      {
+        int16_t sample = (int16_t) lrint(TONE_LEVEL * sin(2.0 * M_PI * tone * sourceFrames / trueRate));
+
+        if (fifo.size() >= fifoFrames * 2)
+        {
+          overruns++;
+          continue;
+        }
+        fifo.push_back(sample);
+        fifo.push_back(sample);
+      }
+    }
+  };
+
+  uint32_t blocks = DRIFT_DURATION_S * conversion.outputRate / blockFrames;
+  uint32_t measureStart = blocks - DRIFT_MEASURE_TIME_S * conversion.outputRate / blockFrames;
+
+  produce(3.0 * BLOCK_TIME_MS / 1000.0);
+
+  for (uint32_t block = 0; block < blocks; block++)
+  {
+    produce((block + 3.0) * blockFrames / conversion.outputRate);
+
+    while (resampler.getMissingFrames(blockFrames) > 0)
+    {
+      if (fifo.size() < chunkFrames * 2)
+      {
+        // Like AudioLocalIn, an empty source reads as one chunk of silence
+        underruns++;
+        std::fill(chunk.begin(), chunk.end(), 0);
+      }
+      else
+      {
+        std::copy(fifo.begin(), fifo.begin() + chunkFrames * 2, chunk.begin());
+        fifo.erase(fifo.begin(), fifo.begin() + chunkFrames * 2);
+      }
+      resampler.write(chunk.data(), chunkFrames);
+    }
+
+    double buffered = fifo.size() / 2.0 + resampler.getBufferedFrames();
+    if (fillTarget < 0.0)
+    {
+      fillTarget = buffered;
+    }
+    resampler.trackFillLevel((float32_t) (buffered - fillTarget), blockFrames);
+
+    size_t offset = output.size();
+    output.resize(offset + blockFrames * 2);
+    resampler.run(&output[offset], blockFrames);
+
+    if (block >= measureStart)
+    {
+      minPpm = std::min(minPpm, (double) resampler.getDriftPpm());
+      maxPpm = std::max(maxPpm, (double) resampler.getDriftPpm());
+      maxFillError = std::max(maxFillError, fabs(buffered - fillTarget));
+    }
+  }
+
+  // The tone is generated in the time of the output clock, so a locked conversion plays it at its frequency
+  uint32_t first = measureStart * blockFrames;
+  double thdN = measureWindowedThdN(output, first, output.size() / 2 - first, tone, conversion.outputRate, RESAMPLER_MAX_DRIFT_PPM);
+
+  printf("  %5u -> %5u  source %+.0f ppm: correction %+.1f to %+.1f ppm, max fill error %.0f frames, "
+      "%u underruns, %u overruns, THD+N %.1f dB (%.0f Hz), over the last %u s of %u s\n", conversion.inputRate,
+      conversion.outputRate, driftPpm, minPpm, maxPpm, maxFillError, underruns, overruns, thdN, tone, DRIFT_MEASURE_TIME_S,
+      DRIFT_DURATION_S);
+}
+
+int main(int argc, char **argv)
+{
+  BenchOptions options;
+
+  if (!parseOptions(argc, argv, options))
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  // The int16_t input and output limit any THD+N measurement at -6 dBFS to about -92 dB
+  std::vector<int16_t> reference = generateTone(1000.0, 48000.0, 48000 * TONE_DURATION_S);
+  printf("int16_t floor of a -6 dBFS tone: %.1f dB\n", measureThdN(reference, 0, reference.size() / 2, 1000.0, 48000.0));
+
+  for (auto quality : options.qualities)
+  {
+    for (auto taps : options.taps)
+    {
+      System::ResamplerConfiguration config;
+      config.quality = quality;
+      config.taps = taps;
+
+      Resampler probe(&config, getBlockFrames(96000));
+      probe.init(48000, 48000, false);
+
+      printf("\nquality: %s, %u taps per phase, %u ms blocks\n", qualityNames[quality], probe.getTaps(), BLOCK_TIME_MS);
+      printf("  %-14s %-12s %8s %10s %25s %25s %7s %8s\n", "conversion", "table", "ns/frame", "cyc/frame", "THD+N", "THD+N",
+          "latency", "bytes");
+
+      benchConfiguration(config);
+      benchDrift(config, options.driftPpm);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,183 @@
+//====================================================================
+//
+// COPYRIGHT 2026 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: Minimal wav file reader/writer for the host tools
+//  Filename: WavFile.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#include "WavFile.hpp"
+#include <cstdio>
+#include <cstring>
+
+namespace Host
+{
+
+static uint32_t readLe32(const uint8_t *data)
+{
+  return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t) data[3] << 24);
+}
+
+static uint16_t readLe16(const uint8_t *data)
+{
+  return data[0] | (data[1] << 8);
+}
+
+static void writeLe32(uint8_t *data, uint32_t value)
+{
+  data[0] = value;
+  data[1] = value >> 8;
+  data[2] = value >> 16;
+  data[3] = value >> 24;
+}
+
+static void writeLe16(uint8_t *data, uint16_t value)
+{
+  data[0] = value;
+  data[1] = value >> 8;
+}
+
+/**
+ * Loads a 16bit PCM wav file (mono or stereo). The chunks are walked, so files with
+ * extra metadata chunks before the data chunk are also supported.
+ * @param fileName
+ * @return false if the file cannot be read or it is not a 16bit PCM file
+ */
+bool WavFile::load(const std::string &fileName)
+{
+  FILE *file = fopen(fileName.c_str(), "rb");
+  if (!file)
+  {
+    return false;
+  }
+
+  std::vector<uint8_t> content;
+  uint8_t buffer[4096];
+  size_t len;
+
+  while ((len = fread(buffer, 1, sizeof(buffer), file)) > 0)
+  {
+    content.insert(content.end(), buffer, buffer + len);
+  }
+  fclose(file);
+
+  if ((content.size() < 12) || memcmp(&content[0], "RIFF", 4) || memcmp(&content[8], "WAVE", 4))
+  {
+    return false;
+  }
+
+  uint32_t channels = 0;
+  uint32_t offset = 12;
+
+  while (offset + 8 <= content.size())
+  {
+    const uint8_t *chunk = &content[offset];
+    uint32_t chunkLen = readLe32(&chunk[4]);
+
+    if ((offset + 8 + chunkLen) > content.size())
+    {
+      chunkLen = content.size() - offset - 8;
+    }
+
+    if (!memcmp(chunk, "fmt ", 4) && (chunkLen >= 16))
+    {
+      uint16_t format = readLe16(&chunk[8]);
+      uint16_t bitsPerSample = readLe16(&chunk[22]);
+
+      channels = readLe16(&chunk[10]);
+      sampleRate = readLe32(&chunk[12]);
+
+      if ((format != 1 && format != 0xFFFE) || (bitsPerSample != 16) || (channels < 1) || (channels > 2))
+      {
+        return false;
+      }
+    }
+    else if (!memcmp(chunk, "data", 4) && channels)
+    {
+      const uint8_t *pcm = &chunk[8];
+      uint32_t frames = chunkLen / (2 * channels);
+
+      samples.resize(frames * 2);
+      for (uint32_t i = 0; i < frames; i++)
+      {
+        samples[2 * i] = (int16_t) readLe16(&pcm[2 * channels * i]);
+        samples[2 * i + 1] = (int16_t) readLe16(&pcm[2 * channels * i + 2 * (channels - 1)]);
+      }
+
+      return true;
+    }
+
+    offset += 8 + chunkLen + (chunkLen & 1);
+  }
+
+  return false;
+}
+
+/**
+ * Stores the stream as a 16bit stereo PCM wav file
+ * @param fileName
+ * @return
+ */
+bool WavFile::save(const std::string &fileName) const
+{
+  FILE *file = fopen(fileName.c_str(), "wb");
+  if (!file)
+  {
+    return false;
+  }
+
+  uint32_t dataLen = samples.size() * sizeof(int16_t);
+  uint8_t header[44];
+
+  memcpy(&header[0], "RIFF", 4);
+  writeLe32(&header[4], 36 + dataLen);
+  memcpy(&header[8], "WAVEfmt ", 8);
+  writeLe32(&header[16], 16);
+  writeLe16(&header[20], 1);
+  writeLe16(&header[22], 2);
+  writeLe32(&header[24], sampleRate);
+  writeLe32(&header[28], sampleRate * 4);
+  writeLe16(&header[32], 4);
+  writeLe16(&header[34], 16);
+  memcpy(&header[36], "data", 4);
+  writeLe32(&header[40], dataLen);
+
+  bool result = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+  for (size_t i = 0; result && (i < samples.size()); i++)
+  {
+    uint8_t sample[2];
+    writeLe16(sample, (uint16_t) samples[i]);
+    result = fwrite(sample, 1, 2, file) == 2;
+  }
+
+  fclose(file);
+  return result;
+}
+
+}
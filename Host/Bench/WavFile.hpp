@@ -0,0 +1,61 @@
+//====================================================================
+//
+// COPYRIGHT 2026 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: Minimal wav file reader/writer for the host tools
+//  Filename: WavFile.hpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Host
+{
+
+/**
+ * Holds a 16bit PCM stream. Samples are always stored as interleaved stereo, mono files are upmixed when loaded.
+ */
+struct WavFile
+{
+public:
+  uint32_t sampleRate = 48000;
+  std::vector<int16_t> samples;     //!< Interleaved left/right samples
+
+  uint32_t getFrameCount() const
+  {
+    return samples.size() / 2;
+  }
+
+  bool load(const std::string &fileName);
+  bool save(const std::string &fileName) const;
+};
+
+}
@@ -0,0 +1,59 @@
+//====================================================================
+//
+// COPYRIGHT 2026 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: Host stand-in for the ALA library (the library is only available for the Cortex-M7)
+//  Filename: AlaStub.c
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#include <string.h>
+#include "Ala-Helike-Public.h"
+
+/*
+ * The ALA library is delivered as a Cortex-M7 binary only. On the host, the algorithm is replaced by
+ * a pass-through that touches the same buffers, so that the benchmark still accounts for the memory traffic.
+ */
+
+void InitAlaCoefficients(uint8_t* coefficientBuffer)
+{
+  (void) coefficientBuffer;
+}
+
+void InitAlaChannelBuffer(uint8_t* channelBuffer)
+{
+  memset(channelBuffer, 0, 432);   // CHANNEL_BUFFER_SIZE in USoundAla.hpp
+}
+
+void ApplyAla(float* signal, uint8_t* channelBuffer, uint8_t* globalBuffer, uint8_t* coefficientBuffer, int length)
+{
+  (void) channelBuffer;
+  (void) coefficientBuffer;
+
+  memcpy(globalBuffer, signal, length * sizeof(float));
+  memcpy(signal, globalBuffer, length * sizeof(float));
+}
@@ -36,10 +36,13 @@
 #include "Controllers/Service/pub/Services.hpp"
 #include "Controllers/System/pub/SystemConfiguration.hpp"
 #include "Utilities/Fifo/pub/Fifo.hpp"
+#include "Utilities/Fifo/pub/BroadcastFifo.hpp"
 #include "cmsis_os2.h"
 
-class AudioFilters;
+class DoubleBufferedFilters;
 class Drc;
+class Resampler;
+class SilenceDetector;
 
 namespace System
 {
@@ -51,6 +54,21 @@ enum AudioChangeSrc
   ACS_AUDIO_ENGINE
 };
 
+/**
+ * The processing load of the audio data out task, measured over about one second
+ */
+struct AudioLoadStats
+{
+public:
+  uint32_t averageLoad = 0;         //!< Share of the block period spent processing, in 0.01 %
+  uint32_t peakLoad = 0;            //!< Largest share of the block period taken by one block, in 0.01 %
+  uint32_t blocks = 0;              //!< Blocks of the measurement
+  uint32_t bypassedBlocks = 0;      //!< Blocks of silence played out without running the filters
+  bool standby = false;             //!< The output stages are in standby
+  uint32_t wakeUpTime = 0;          //!< From the first block of audio to the output stages being up, at the last wake-up, in us
+  uint32_t wakeLatency = 0;         //!< Delay added to the audio by the last wake-up, before it was drained again, in us
+};
+
 /**
  * This service is responsible for the control and data plane of the system audio
  */
@@ -66,7 +84,7 @@ private:
   AudioSource<uint16_t> *audioSrc = nullptr;
   AudioSink<uint16_t> *audioSink = nullptr;
 
-  AudioFilters *audioFilters = nullptr;
+  DoubleBufferedFilters *audioFilters = nullptr;
 
   AudioMode audioMode = AudioMode::AM_MP3;
   osTimerId_t detectI2sStop = nullptr;      //!< This timer is used in I2S slave mode to detect that the host has stopped sending audio
@@ -75,6 +93,33 @@ private:
   SystemAudioSink systemAudioSink = SystemAudioSink::AUDIO_SINK_NONE;
 
   uint32_t audioOutCycles = 0;
+  uint32_t requestedFrequency = 0;          //!< The last sampling rate requested by the data out task
+  uint32_t frequencyRetryBlocks = 0;        //!< Blocks since the data out task last requested the sampling rate
+
+  Resampler *resampler = nullptr;           //!< Allocated for the first source that is resampled
+  AudioSource<uint16_t> *resamplerSrc = nullptr;  //!< The source the resampler is set up for
+  volatile bool resamplerReady = false;     //!< Set by the control task when the resampler is set up
+  bool resamplerRequested = false;          //!< Set by the data out task until the resampler is set up for the source
+  uint32_t resamplerRetryBlocks = 0;        //!< Blocks since the data out task last requested the resampler
+  float32_t resamplerFillTarget = -1.0f;    //!< Buffered frames the drift tracking keeps, -1 until the first block
+
+  SilenceDetector *silenceDetector = nullptr;
+  volatile bool standbyRequested = false;   //!< Set by the data out task while the input is silent for the standby delay
+  volatile bool outputStandby = false;      //!< The sink is in standby, set by the control task once the output stages are switched
+  uint32_t standbyRetryBlocks = 0;          //!< Blocks since the data out task last sent the standby request
+  volatile bool standbyReset = false;       //!< Set by the control task when the sink is started or stopped, cleared by the data out task
+  SpscFifo<int16_t> *wakeHold[2] = { nullptr, nullptr };  //!< The tweeter and woofer blocks held back while the outputs wake up, by STREAM_ID
+  bool waking = false;                      //!< The data out task holds the audio back until the outputs are up
+  uint32_t wakeStartCycles = 0;             //!< Cycle counter at the first block of audio after the standby
+
+  BroadcastFifo<int16_t> *outputTaps[2] = { nullptr, nullptr };  //!< The tweeter and woofer streams as played out, by SaiInterface
+
+  AudioLoadStats audioLoad;                 //!< Published by the data out task at the end of each measurement
+  uint64_t loadCycles = 0;                  //!< Processing cycles of the current measurement
+  uint64_t loadPeriodCycles = 0;            //!< Block period cycles of the current measurement
+  uint32_t loadPeak = 0;
+  uint32_t loadBlocks = 0;
+  uint32_t loadBypassedBlocks = 0;
 
 private:
   static void timeoutEventCb(void *arg);
@@ -85,6 +130,12 @@ private:
   void taskDataInLoop();
   void timeoutEvent();
   void initFilters();
+  void configureResampler();
+  int16_t* resampleData(int16_t *pDst, uint32_t length);
+  void updateStandby();
+  void enqueueOutput(int16_t *pSrc[2], uint32_t length, int16_t *pHeld[2], uint32_t frequency);
+  void publishOutput(int16_t *pSrc[2], uint32_t length);
+  void updateAudioLoad(uint32_t startCycles, uint32_t frames, uint32_t frequency, bool bypassed);
   bool isAudioCommandSupportedInCurrentMode(AudioChangeSrc acs);
 
   static void taskDataOutEntry(void *argument);
@@ -100,11 +151,13 @@ public:
   void togglePlay(AudioChangeSrc acs);
   void volUpDown(int32_t level, AudioChangeSrc acs);
   void setVolume(uint32_t level, AudioChangeSrc acs);
+  void setUsbVolume(int16_t usbVolume);
   void setMute(bool mute, AudioChangeSrc acs);
   void nextTrack(AudioChangeSrc acs);
   void prevTrack(AudioChangeSrc acs);
   void reconfigureFilters();
   void reconfigureSink();
+  bool setFrequency(uint32_t frequency);
 
   void notifyMoreDataNeeded();
   void notifyMoreDataAvailable();
@@ -112,7 +165,26 @@ public:
   SystemAudioSource selectAudioSource(SystemAudioSource audioSrc);
   SystemAudioSink selectAudioSink(SystemAudioSink audioSink);
 
-  uint32_t getAudioOutCycles(bool resetCounter);
+  uint32_t getAudioOutFrames(bool resetCounter);
+
+  /**
+   * Returns the broadcast fifo of an output stream (tweeter or woofer), for readers that tap the audio as it is
+   * played out, e.g. a level meter. The data out task only fills it while a reader is attached. It holds at least
+   * OUTPUT_TAP_TIME (20 ms) of audio, so a reader has to read more often than that not to lose samples.
+   */
+  BroadcastFifo<int16_t>* getOutputTap(SaiInterface output)
+  {
+    return outputTaps[output];
+  }
+
+  /**
+   * Returns the processing load of the audio path over the last second. The fields are updated
+   * by the audio task, so they may come from two consecutive measurements.
+   */
+  AudioLoadStats getAudioLoad() const
+  {
+    return audioLoad;
+  }
 };
 
 }
@@ -33,12 +33,27 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+#include <cmath>
 #include "AudioFilters.hpp"
 #include "Drc.hpp"
 #include "Controllers/System/pub/ModuleConfig.hpp"
 
-#define STREAMS   4
-#define XOVER_SAMPLES 2
+#define INITIAL_POOL_BUFFERS      2      //!< Pool buffers allocated by the constructor, enough for the default order
+#define GRAPH_VALUES              (2 * System::StageType::MAX_STAGE_TYPES + 1)   //!< Both bands of each node, then the input
+#define GRAPH_INPUT_VALUE         (GRAPH_VALUES - 1)
+#define Q31_VOLUME_FRACTION_BITS  30     //!< The digital volume of the fixed-point output conversion is in Q2.30
+#define ROUTING_MAX_GAIN          1.99526f   //!< Limit of the output routing gains (+6 dB), so that the Q2.30 gains cannot overflow
+
+static const float32_t q31SampleScale = 1.0f / (float32_t) (1u << (31 - Q31_HEADROOM_BITS));    //!< Q31 chain sample to float
+
+//! Delay line of the tweeter left/right and woofer left/right samples of the delay stage
+static const uint32_t delayLines[MAX_CHANNELS * MAX_STREAM_COUNT] = {
+    System::XoverEqCoeffcientType::LEFT_TWEETER,
+    System::XoverEqCoeffcientType::RIGHT_TWEETER,
+    System::XoverEqCoeffcientType::LEFT_WOOFER,
+    System::XoverEqCoeffcientType::RIGHT_WOOFER
+};
 
 
 
@@ -49,6 +64,7 @@
  * @param number of samples to process as a block
  */
 AudioFilters::AudioFilters(System::FilterConfiguration *filterConfig, uint32_t blockSize) :
+    maxBlockSize(blockSize),
     blockSize(blockSize),
 
     masterEqFilters(
@@ -69,6 +85,10 @@ AudioFilters::AudioFilters(System::FilterConfiguration *filterConfig, uint32_t b
         blockSize
         ),
 
+    crossover(&filterConfig->xoverConfig, blockSize),
+    firConvolver(&filterConfig->firConfig, blockSize),
+    delayAlignment(&filterConfig->delayConfig, blockSize),
+
 #if ALA_MODULE_ENABLED == 1
     ala(
         &filterConfig->alaConfig,
@@ -78,118 +98,1356 @@ AudioFilters::AudioFilters(System::FilterConfiguration *filterConfig, uint32_t b
 
     levelerDrc(&filterConfig->levelerDrcConfig, blockSize),
     limiterDrc(&filterConfig->limiterDrcConfig, blockSize),
+    peakLimiter(&filterConfig->peakLimiterConfig, blockSize),
     filterConfig(filterConfig)
 {
-  channelSamples[0] = new float32_t[blockSize];
-  channelSamples[1] = new float32_t[blockSize];
-  channelSamples[2] = new float32_t[blockSize];
-  channelSamples[3] = new float32_t[blockSize];
+  for (; poolBuffers < INITIAL_POOL_BUFFERS; poolBuffers++)
+  {
+    poolSamples[poolBuffers] = new float32_t[2 * blockSize];
+    q31PoolSamples[poolBuffers] = new q31_t[2 * blockSize];
+  }
+
+#if ALA_MODULE_ENABLED == 1
+  alaSamples[PcmChannel::LEFT] = new float32_t[blockSize];
+  alaSamples[PcmChannel::RIGHT] = new float32_t[blockSize];
+#endif
+
+  filterEngine = filterConfig->filterEngine;
+}
+
+/**
+ * Sets the sampling rate and the block size the chain runs at. It takes effect on the next init().
+ * The rates of the DRCs, the peak limiter, the x-over and the delay in the configuration are replaced by the sampling rate,
+ * and the EQ coefficients are remapped from the rate they were designed for.
+ * @param sampleRateHz the audio sampling rate, 0 to run at the rates of the configuration
+ * @param frames number of samples to process as a block, up to the block size given to the constructor
+ */
+void AudioFilters::setSampleRate(float32_t sampleRateHz, uint32_t frames)
+{
+  sampleRate = sampleRateHz;
+  blockSize = std::min(frames, maxBlockSize);
 }
 
 void AudioFilters::init()
 {
-  masterEqFilters.init();
-  xoverTweeterFilters.init();
-  xoverWooferFilters.init();
+  filterEngine = filterConfig->filterEngine;
+
+  if (sampleRate > 0.0f)
+  {
+    filterConfig->levelerDrcConfig.sampleRateHz = sampleRate;
+    filterConfig->limiterDrcConfig.sampleRateHz = sampleRate;
+    filterConfig->peakLimiterConfig.sampleRateHz = sampleRate;
+    filterConfig->xoverConfig.sampleRateHz = sampleRate;
+    filterConfig->delayConfig.sampleRateHz = sampleRate;
+  }
+
+  masterEqFilters.setSampleRate(filterConfig->eqSampleRateHz, sampleRate);
+  xoverTweeterFilters.setSampleRate(filterConfig->eqSampleRateHz, sampleRate);
+  xoverWooferFilters.setSampleRate(filterConfig->eqSampleRateHz, sampleRate);
+
+  masterEqFilters.setBlockSize(blockSize);
+  xoverTweeterFilters.setBlockSize(blockSize);
+  xoverWooferFilters.setBlockSize(blockSize);
+  crossover.setBlockSize(blockSize);
+  firConvolver.setBlockSize(blockSize);
+  delayAlignment.setBlockSize(blockSize);
+  levelerDrc.setBlockSize(blockSize);
+  limiterDrc.setBlockSize(blockSize);
+  peakLimiter.setBlockSize(blockSize);
+
+#if ALA_MODULE_ENABLED == 1
+  ala.setBlockSize(blockSize);
+#endif
+
+  masterEqFilters.init(filterEngine);
+  xoverTweeterFilters.init(filterEngine);
+  xoverWooferFilters.init(filterEngine);
+  crossover.init();
+  firConvolver.init();
+  delayAlignment.init();
 
   levelerDrc.init();
   limiterDrc.init();
+  peakLimiter.init();
 
 #if ALA_MODULE_ENABLED == 1
   ala.init();
 #endif
+
+  compilePlan();
 }
 
 /**
- * Converts an interleaved stream of uint16_t samples into a contiguous stream
+ * Converts a float32_t sample to int16_t. Samples beyond full scale are saturated instead of wrapping around.
+ * @param value the sample, already scaled to the int16_t range
+ */
+static inline int16_t toPcm16(float32_t value)
+{
+  int32_t sample = (int32_t) roundf(value);
+
+  sample = (sample > INT16_MAX) ? INT16_MAX : sample;
+  sample = (sample < INT16_MIN) ? INT16_MIN : sample;
+  return (int16_t) sample;
+}
+
+/**
+ * Converts an interleaved stereo stream of int16_t samples into float32_t samples, in a single pass
  * @param pSrc
- * @param pDst
- * @param stride
+ * @param pDstLeft
+ * @param pDstRight
+ * @param stride distance between consecutive samples of a channel at the destination (1 for separate buffers, 2 for interleaved)
  */
-void AudioFilters::deinterlace16Tof32(const int16_t *pSrc, float32_t *pDst, uint32_t stride)
+void AudioFilters::deinterlace16Tof32(const int16_t *pSrc, float32_t *pDstLeft, float32_t *pDstRight, uint32_t stride)
 {
+  const float32_t scale = 1.0f / (1 << 15);
+
   for (uint32_t i = 0; i < blockSize; i++)
   {
-    pDst[i] = (float32_t) *pSrc / (1 << 15);
-    pSrc = &pSrc[stride];
+    pDstLeft[i * stride] = (float32_t) pSrc[0] * scale;
+    pDstRight[i * stride] = (float32_t) pSrc[1] * scale;
+    pSrc += 2;
   }
 }
 
 /**
- * Converts an contiguous audio stream (single channel) of float32_t samples into an interleaved stream
- * @param pSrc
- * @param pDst
- * @param stride
+ * Writes silence to the tweeter and woofer output buffers, the output of a plan that could not be compiled
+ * @param pDst the tweeter and woofer output buffers
  */
-void AudioFilters::interlacef32To16(const float32_t *pSrc, int16_t *pDst, uint32_t stride, bool invert)
+void AudioFilters::muteStreams(int16_t *pDst[2])
 {
+  memset(pDst[STREAM_ID::STREAM_TWEETER], 0, 2 * blockSize * sizeof(int16_t));
+  memset(pDst[STREAM_ID::STREAM_WOOFER], 0, 2 * blockSize * sizeof(int16_t));
+}
+
+/**
+ * Converts the tweeter and woofer float32_t streams into their interleaved int16_t output buffers, in a single pass.
+ * Each output slot takes its only source of the routing matrix, with the gain and polarity of the routing.
+ * @param pDst the tweeter and woofer output buffers
+ */
+void AudioFilters::routeStreamsf32To16(int16_t *pDst[2])
+{
+  const float32_t *pSrc[System::MAX_ROUTING_CHANNELS];
+  uint32_t stride[System::MAX_ROUTING_CHANNELS];
+  float32_t scale[System::MAX_ROUTING_CHANNELS];
+  int16_t *pTweeter = pDst[STREAM_ID::STREAM_TWEETER];
+  int16_t *pWoofer = pDst[STREAM_ID::STREAM_WOOFER];
+  float32_t gain = outputGain;
+
+  for (uint32_t output = 0; output < System::MAX_ROUTING_CHANNELS; output++)
+  {
+    const uint32_t source = routingSource[output];
+
+    pSrc[output] = routingSamples[source];
+    stride[output] = routingStride[source];
+    scale[output] = routingGains[output][source] * 32768.0f;
+  }
+
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    pTweeter[0] = toPcm16(pSrc[0][i * stride[0]] * scale[0] * gain);
+    pTweeter[1] = toPcm16(pSrc[1][i * stride[1]] * scale[1] * gain);
+    pWoofer[0] = toPcm16(pSrc[2][i * stride[2]] * scale[2] * gain);
+    pWoofer[1] = toPcm16(pSrc[3][i * stride[3]] * scale[3] * gain);
+    pTweeter += 2;
+    pWoofer += 2;
+    gain += outputGainStep;
+  }
+}
+
+/**
+ * Converts the tweeter and woofer float32_t streams into their interleaved int16_t output buffers, in a single pass.
+ * Each output slot is the sum of all the sources, weighted by the routing matrix.
+ * @param pDst the tweeter and woofer output buffers
+ */
+void AudioFilters::mixStreamsf32To16(int16_t *pDst[2])
+{
+  float32_t scale[System::MAX_ROUTING_CHANNELS][System::MAX_ROUTING_CHANNELS];
+  int16_t *pOutput[System::MAX_ROUTING_CHANNELS] = {
+      pDst[STREAM_ID::STREAM_TWEETER],
+      pDst[STREAM_ID::STREAM_TWEETER] + 1,
+      pDst[STREAM_ID::STREAM_WOOFER],
+      pDst[STREAM_ID::STREAM_WOOFER] + 1
+  };
+  float32_t gain = outputGain;
+
+  for (uint32_t output = 0; output < System::MAX_ROUTING_CHANNELS; output++)
+  {
+    for (uint32_t source = 0; source < System::MAX_ROUTING_CHANNELS; source++)
+    {
+      scale[output][source] = routingGains[output][source] * 32768.0f;
+    }
+  }
+
   for (uint32_t i = 0; i < blockSize; i++)
   {
-    int16_t value = (int16_t) (roundf(pSrc[i] * (1 << 15)));
-    if (invert)
+    float32_t sample[System::MAX_ROUTING_CHANNELS];
+
+    for (uint32_t source = 0; source < System::MAX_ROUTING_CHANNELS; source++)
+    {
+      sample[source] = routingSamples[source][i * routingStride[source]];
+    }
+
+    for (uint32_t output = 0; output < System::MAX_ROUTING_CHANNELS; output++)
     {
-      value = -value;
+      const float32_t value = sample[0] * scale[output][0] + sample[1] * scale[output][1]
+          + sample[2] * scale[output][2] + sample[3] * scale[output][3];
+
+      pOutput[output][i * 2] = toPcm16(value * gain);
     }
 
-    *pDst = value;
-    pDst = &pDst[stride];
+    gain += outputGainStep;
   }
 }
 
 /**
- * Runs all the EQ and DRC filters
+ * Converts a Q31 sample of the fixed-point chain to int16_t, with rounding and saturation
+ * @param value the sample
+ * @param gain the digital volume and routing gain in Q2.30
+ * @param sign the polarity of the routing, -1, 0 (unrouted output) or 1
+ */
+static inline int16_t q31ToPcm16(q31_t value, q31_t gain, int32_t sign)
+{
+  const uint32_t shift = 16 - Q31_HEADROOM_BITS + Q31_VOLUME_FRACTION_BITS;
+  int32_t sample = sign * (int32_t) (((q63_t) value * gain + (1ll << (shift - 1))) >> shift);
+
+  sample = (sample > INT16_MAX) ? INT16_MAX : sample;
+  sample = (sample < INT16_MIN) ? INT16_MIN : sample;
+  return (int16_t) sample;
+}
+
+/**
+ * Converts the interleaved Q31 tweeter and woofer streams into their interleaved int16_t output buffers, in a single pass.
+ * Each output slot takes its only source of the routing matrix. The magnitude of the routing gain is folded into
+ * the Q2.30 volume of the slot, and the polarity is applied after the rounding, as a multiplication by the sign.
+ * @param pDst the tweeter and woofer output buffers
+ */
+void AudioFilters::routeStreamsQ31To16(int16_t *pDst[2])
+{
+  const float32_t gainScale = (float32_t) (1u << Q31_VOLUME_FRACTION_BITS);
+  const q31_t *pSrc[System::MAX_ROUTING_CHANNELS];
+  int32_t sign[System::MAX_ROUTING_CHANNELS];
+  q31_t gain[System::MAX_ROUTING_CHANNELS];
+  q31_t gainStep[System::MAX_ROUTING_CHANNELS];
+  int16_t *pTweeter = pDst[STREAM_ID::STREAM_TWEETER];
+  int16_t *pWoofer = pDst[STREAM_ID::STREAM_WOOFER];
+
+  for (uint32_t output = 0; output < System::MAX_ROUTING_CHANNELS; output++)
+  {
+    const uint32_t source = routingSource[output];
+    const float32_t routingGain = routingGains[output][source];
+    const float32_t magnitude = fabsf(routingGain);
+
+    pSrc[output] = q31RoutingSamples[source];
+    sign[output] = (routingGain > 0.0f) - (routingGain < 0.0f);
+    gain[output] = (q31_t) roundf(outputGain * magnitude * gainScale);
+    gainStep[output] = (q31_t) roundf(outputGainStep * magnitude * gainScale);
+  }
+
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    pTweeter[0] = q31ToPcm16(pSrc[0][i * 2], gain[0], sign[0]);
+    pTweeter[1] = q31ToPcm16(pSrc[1][i * 2], gain[1], sign[1]);
+    pWoofer[0] = q31ToPcm16(pSrc[2][i * 2], gain[2], sign[2]);
+    pWoofer[1] = q31ToPcm16(pSrc[3][i * 2], gain[3], sign[3]);
+    pTweeter += 2;
+    pWoofer += 2;
+    gain[0] += gainStep[0];
+    gain[1] += gainStep[1];
+    gain[2] += gainStep[2];
+    gain[3] += gainStep[3];
+  }
+}
+
+/**
+ * Converts the interleaved Q31 tweeter and woofer streams into their interleaved int16_t output buffers, in a single pass.
+ * Each output slot is the sum of all the sources, weighted by the routing matrix folded into signed Q2.30 gains.
+ * The products are accumulated in 64 bits with 2 bits of headroom for the sum of the four sources.
+ * @param pDst the tweeter and woofer output buffers
+ */
+void AudioFilters::mixStreamsQ31To16(int16_t *pDst[2])
+{
+  const uint32_t shift = 16 - Q31_HEADROOM_BITS + Q31_VOLUME_FRACTION_BITS - 2;
+  const float32_t gainScale = (float32_t) (1u << Q31_VOLUME_FRACTION_BITS);
+  q31_t gain[System::MAX_ROUTING_CHANNELS][System::MAX_ROUTING_CHANNELS];
+  q31_t gainStep[System::MAX_ROUTING_CHANNELS][System::MAX_ROUTING_CHANNELS];
+  int16_t *pOutput[System::MAX_ROUTING_CHANNELS] = {
+      pDst[STREAM_ID::STREAM_TWEETER],
+      pDst[STREAM_ID::STREAM_TWEETER] + 1,
+      pDst[STREAM_ID::STREAM_WOOFER],
+      pDst[STREAM_ID::STREAM_WOOFER] + 1
+  };
+
+  for (uint32_t output = 0; output < System::MAX_ROUTING_CHANNELS; output++)
+  {
+    for (uint32_t source = 0; source < System::MAX_ROUTING_CHANNELS; source++)
+    {
+      gain[output][source] = (q31_t) roundf(outputGain * routingGains[output][source] * gainScale);
+      gainStep[output][source] = (q31_t) roundf(outputGainStep * routingGains[output][source] * gainScale);
+    }
+  }
+
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    q31_t sample[System::MAX_ROUTING_CHANNELS];
+
+    for (uint32_t source = 0; source < System::MAX_ROUTING_CHANNELS; source++)
+    {
+      sample[source] = q31RoutingSamples[source][i * 2];
+    }
+
+    for (uint32_t output = 0; output < System::MAX_ROUTING_CHANNELS; output++)
+    {
+      q63_t acc = 1ll << (shift - 1);
+
+      for (uint32_t source = 0; source < System::MAX_ROUTING_CHANNELS; source++)
+      {
+        acc += ((q63_t) sample[source] * gain[output][source]) >> 2;
+        gain[output][source] += gainStep[output][source];
+      }
+
+      int32_t value = (int32_t) (acc >> shift);
+
+      value = (value > INT16_MAX) ? INT16_MAX : value;
+      value = (value < INT16_MIN) ? INT16_MIN : value;
+      pOutput[output][i * 2] = (int16_t) value;
+    }
+  }
+}
+
+/**
+ * Sets the digital volume ramp of the next block, which is applied by the int16_t output conversion
+ * @param gain the gain of the first frame
+ * @param gainStep the change of the gain per frame
+ */
+void AudioFilters::setOutputGain(float32_t gain, float32_t gainStep)
+{
+  outputGain = gain;
+  outputGainStep = gainStep;
+}
+
+/**
+ * Compiles the active configuration into the execution plan, so that run() only calls the stages in use,
+ * without checking the configuration per block. The plan follows the stage graph of the configuration,
+ * or the default order when there is none or when it cannot be compiled.
+ */
+void AudioFilters::compilePlan()
+{
+#if ALA_MODULE_ENABLED == 1
+  bufferSamples[BUFFER_ALA][PcmChannel::LEFT] = alaSamples[PcmChannel::LEFT];
+  bufferSamples[BUFFER_ALA][PcmChannel::RIGHT] = alaSamples[PcmChannel::RIGHT];
+#else
+  bufferSamples[BUFFER_ALA][PcmChannel::LEFT] = nullptr;
+  bufferSamples[BUFFER_ALA][PcmChannel::RIGHT] = nullptr;
+#endif
+  bufferStride[BUFFER_ALA] = 1;
+  q31BufferSamples[BUFFER_ALA] = nullptr;
+
+  graphCompiled = (filterConfig->stageGraph.nodeCount > 0) && compileGraph(filterConfig->stageGraph);
+
+  if (!graphCompiled)
+  {
+    System::StageGraphConfiguration defaultGraph;
+
+    buildDefaultGraph(defaultGraph);
+
+    // The default order always fits the pool. Should it ever fail to compile, the half-built plan is dropped
+    // and the outputs are muted, rather than the unfiltered full-range input sent to the tweeters.
+    if (!compileGraph(defaultGraph))
+    {
+      planStages = 0;
+      outputBuffer[STREAM_ID::STREAM_TWEETER] = BUFFER_MAIN;
+      outputBuffer[STREAM_ID::STREAM_WOOFER] = BUFFER_MAIN;
+      compileOutput();
+      outputKernel = &AudioFilters::muteStreams;
+      return;
+    }
+  }
+
+  compileOutput();
+}
+
+/**
+ * Binds the output routing to the buffers holding the tweeter and woofer streams at the end of the plan,
+ * and selects the output conversion: the routed kernels when each output slot has a single source
+ * (channel order and polarity only), the mixing kernels otherwise. The gains are clamped to ROUTING_MAX_GAIN.
+ */
+void AudioFilters::compileOutput()
+{
+  const PlanBuffer tweeter = outputBuffer[STREAM_ID::STREAM_TWEETER];
+  const PlanBuffer woofer = outputBuffer[STREAM_ID::STREAM_WOOFER];
+  bool routed = true;
+
+  routingSamples[System::ROUTING_TWEETER_LEFT] = bufferSamples[tweeter][PcmChannel::LEFT];
+  routingSamples[System::ROUTING_TWEETER_RIGHT] = bufferSamples[tweeter][PcmChannel::RIGHT];
+  routingSamples[System::ROUTING_WOOFER_LEFT] = bufferSamples[woofer][PcmChannel::LEFT];
+  routingSamples[System::ROUTING_WOOFER_RIGHT] = bufferSamples[woofer][PcmChannel::RIGHT];
+  routingStride[System::ROUTING_TWEETER_LEFT] = bufferStride[tweeter];
+  routingStride[System::ROUTING_TWEETER_RIGHT] = bufferStride[tweeter];
+  routingStride[System::ROUTING_WOOFER_LEFT] = bufferStride[woofer];
+  routingStride[System::ROUTING_WOOFER_RIGHT] = bufferStride[woofer];
+
+  q31RoutingSamples[System::ROUTING_TWEETER_LEFT] = q31BufferSamples[tweeter];
+  q31RoutingSamples[System::ROUTING_TWEETER_RIGHT] = (q31BufferSamples[tweeter] != nullptr) ? q31BufferSamples[tweeter] + 1 : nullptr;
+  q31RoutingSamples[System::ROUTING_WOOFER_LEFT] = q31BufferSamples[woofer];
+  q31RoutingSamples[System::ROUTING_WOOFER_RIGHT] = (q31BufferSamples[woofer] != nullptr) ? q31BufferSamples[woofer] + 1 : nullptr;
+
+  for (uint32_t output = 0; output < System::MAX_ROUTING_CHANNELS; output++)
+  {
+    uint32_t sources = 0;
+
+    routingSource[output] = 0;
+
+    for (uint32_t source = 0; source < System::MAX_ROUTING_CHANNELS; source++)
+    {
+      float32_t gain = filterConfig->outputRouting.gains[output][source];
+
+      gain = (gain > ROUTING_MAX_GAIN) ? ROUTING_MAX_GAIN : gain;
+      gain = (gain < -ROUTING_MAX_GAIN) ? -ROUTING_MAX_GAIN : gain;
+      routingGains[output][source] = gain;
+
+      if (gain != 0.0f)
+      {
+        routingSource[output] = source;
+        sources++;
+      }
+    }
+
+    routed = routed && (sources <= 1);
+  }
+
+  if (filterEngine == System::FilterEngine::FILTER_ENGINE_Q31)
+  {
+    outputKernel = routed ? &AudioFilters::routeStreamsQ31To16 : &AudioFilters::mixStreamsQ31To16;
+  }
+  else
+  {
+    outputKernel = routed ? &AudioFilters::routeStreamsf32To16 : &AudioFilters::mixStreamsf32To16;
+  }
+}
+
+/**
+ * Describes the default order as a stage graph: master EQ, master FIR, leveler, limiter, x-over split,
+ * woofer and tweeter EQ, peak limiter and ALA. The limiter DRC is left out when the peak limiter is enabled.
+ * @param graph
+ */
+void AudioFilters::buildDefaultGraph(System::StageGraphConfiguration &graph) const
+{
+  uint32_t count = 0;
+  auto addNode = [&graph, &count](System::StageType type, int32_t input, uint32_t band)
+  {
+    System::StageNodeConfiguration &node = graph.nodes[count];
+
+    node.type = type;
+    node.input.node = input;
+    node.input.band = band;
+    node.aux.node = STAGE_NONE;
+    node.aux.band = 0;
+    return (int32_t) count++;
+  };
+
+  int32_t last = STAGE_INPUT;
+
+  last = addNode(System::StageType::STAGE_TYPE_MASTER_EQ, last, 0);
+  last = addNode(System::StageType::STAGE_TYPE_MASTER_FIR, last, 0);
+  last = addNode(System::StageType::STAGE_TYPE_LEVELER_DRC, last, 0);
+
+  if (!filterConfig->peakLimiterConfig.enabled)
+  {
+    last = addNode(System::StageType::STAGE_TYPE_LIMITER_DRC, last, 0);
+  }
+
+  const int32_t split = addNode(System::StageType::STAGE_TYPE_XOVER_SPLIT, last, 0);
+  const int32_t woofer = addNode(System::StageType::STAGE_TYPE_WOOFER_EQ, split, 1);
+  const int32_t tweeter = addNode(System::StageType::STAGE_TYPE_TWEETER_EQ, split, 0);
+  const int32_t delay = addNode(System::StageType::STAGE_TYPE_DELAY, tweeter, 0);
+  const int32_t limiter = addNode(System::StageType::STAGE_TYPE_PEAK_LIMITER, delay, 0);
+
+  graph.nodes[delay].aux.node = woofer;
+  graph.nodes[limiter].aux.node = delay;
+  graph.nodes[limiter].aux.band = 1;
+  last = addNode(System::StageType::STAGE_TYPE_ALA, limiter, 0);
+
+  graph.nodeCount = count;
+  graph.tweeter.node = last;
+  graph.tweeter.band = 0;
+  graph.woofer.node = limiter;
+  graph.woofer.band = 1;
+}
+
+/**
+ * Tells if a stage type runs with the active configuration. The nodes of the other stages pass their input through.
+ * @param type
+ */
+bool AudioFilters::isStageActive(System::StageType type) const
+{
+  const bool firEnabled = !firConvolver.isBypassed();
+  const bool firCrossover = (filterConfig->firConfig.placement == System::FirPlacement::FIR_PLACEMENT_CROSSOVER);
+
+  switch (type)
+  {
+    case System::StageType::STAGE_TYPE_MASTER_EQ:
+      return filterConfig->masterEqEnabled && !masterEqFilters.isBypassed();
+
+    case System::StageType::STAGE_TYPE_MASTER_FIR:
+      return firEnabled && !firCrossover;
+
+    case System::StageType::STAGE_TYPE_LEVELER_DRC:
+      return filterConfig->levelerDrcConfig.enabled;
+
+    case System::StageType::STAGE_TYPE_LIMITER_DRC:
+      return filterConfig->limiterDrcConfig.enabled;
+
+    case System::StageType::STAGE_TYPE_XOVER_SPLIT:
+      return filterConfig->xoverEqEnabled &&
+          ((firEnabled && firCrossover) || (filterConfig->xoverConfig.type == System::CrossoverType::CROSSOVER_LR4));
+
+    case System::StageType::STAGE_TYPE_WOOFER_EQ:
+      return filterConfig->xoverEqEnabled && !xoverWooferFilters.isBypassed();
+
+    case System::StageType::STAGE_TYPE_TWEETER_EQ:
+      return filterConfig->xoverEqEnabled && !xoverTweeterFilters.isBypassed();
+
+    case System::StageType::STAGE_TYPE_PEAK_LIMITER:
+      return filterConfig->peakLimiterConfig.enabled;
+
+    case System::StageType::STAGE_TYPE_DELAY:
+      return !delayAlignment.isBypassed();
+
+    case System::StageType::STAGE_TYPE_ALA:
+#if ALA_MODULE_ENABLED == 1
+      return filterConfig->alaConfig.enabled;
+#else
+      return false;
+#endif
+
+    default:
+      return false;
+  }
+}
+
+/**
+ * Allocates the buffers of the pool up to the given one, if they are not allocated yet, and binds the buffer
+ * to the layout of the engine. The pool only grows in init(), so run() never allocates.
+ * @param buffer
+ * @return false if the pool has no such buffer
+ */
+bool AudioFilters::bindPoolBuffer(uint32_t buffer)
+{
+  if (buffer >= PLAN_POOL_BUFFERS)
+  {
+    return false;
+  }
+
+  for (; poolBuffers <= buffer; poolBuffers++)
+  {
+    poolSamples[poolBuffers] = new float32_t[2 * maxBlockSize];
+    q31PoolSamples[poolBuffers] = new q31_t[2 * maxBlockSize];
+  }
+
+  const bool separate = (filterEngine == System::FilterEngine::FILTER_ENGINE_DF1);
+  float32_t *samples = poolSamples[buffer];
+
+  bufferSamples[buffer][PcmChannel::LEFT] = samples;
+  bufferSamples[buffer][PcmChannel::RIGHT] = separate ? samples + blockSize : samples + 1;
+  bufferStride[buffer] = separate ? 1 : 2;
+  q31BufferSamples[buffer] = q31PoolSamples[buffer];
+  return true;
+}
+
+/**
+ * Returns the slot of a node output (or of the chain input) in the per-value tables of compileGraph()
+ * @param ref
+ */
+static inline uint32_t graphValue(const System::StageReference &ref)
+{
+  return (ref.node == STAGE_INPUT) ? GRAPH_INPUT_VALUE : (uint32_t) ref.node * 2 + ref.band;
+}
+
+/**
+ * Tells if a reference points to the input, to a node of the graph, or (for the aux inputs) nowhere
+ * @param ref
+ * @param nodeCount
+ * @param optional true if STAGE_NONE is allowed
+ */
+static bool isValidReference(const System::StageReference &ref, uint32_t nodeCount, bool optional)
+{
+  const bool node = (ref.node >= 0) && ((uint32_t) ref.node < nodeCount);
+
+  return (node || (ref.node == STAGE_INPUT) || (optional && (ref.node == STAGE_NONE))) && (ref.band <= 1);
+}
+
+/**
+ * Tells if a stage type takes the woofers from its aux input, and has them on band 1 of its output
+ * @param type
+ */
+static inline bool hasWooferInput(System::StageType type)
+{
+  return (type == System::StageType::STAGE_TYPE_PEAK_LIMITER) || (type == System::StageType::STAGE_TYPE_DELAY);
+}
+
+/**
+ * Compiles a stage graph into the execution plan.
+ *
+ * The nodes of inactive stages are removed first: their references are forwarded to their input, so the woofer
+ * band of a removed split is its input as well. The nodes are then ordered topologically, taking the lowest
+ * index among the ready nodes, so that nodes listed in order run in that order.
+ *
+ * The buffers are assigned by liveness: each output of a node lives in a buffer of the pool until its last
+ * reader has run. A stage writes over its input when it is the last reader and the input is not one of the
+ * output streams, otherwise it takes a free buffer of the pool. The DRCs, the delay and the peak limiter only run in place,
+ * so a copy stage is added in front of them in that case. A delay without an aux input delays its input on both bands. ALA writes to the separate channel ALA buffers in the
+ * interleaved float chain, so there its output can only feed the output streams.
+ *
+ * @param graph
+ * @return false if the graph is invalid (unknown or repeated stage types, references out of the graph or cycles)
+ * or needs more buffers than the pool has. The plan is then incomplete and has to be compiled again.
+ */
+bool AudioFilters::compileGraph(const System::StageGraphConfiguration &graph)
+{
+  typedef void (AudioFilters::*StageFunction)(const FilterStage &stage);
+
+  const uint32_t nodeCount = graph.nodeCount;
+  const bool separate = (filterEngine == System::FilterEngine::FILTER_ENGINE_DF1);
+  const bool q31 = (filterEngine == System::FilterEngine::FILTER_ENGINE_Q31);
+
+  planStages = 0;
+  outputBuffer[STREAM_ID::STREAM_TWEETER] = BUFFER_MAIN;
+  outputBuffer[STREAM_ID::STREAM_WOOFER] = BUFFER_MAIN;
+  bindPoolBuffer(BUFFER_MAIN);
+
+  if (nodeCount > System::StageType::MAX_STAGE_TYPES)
+  {
+    return false;
+  }
+
+  bool active[System::StageType::MAX_STAGE_TYPES];
+  uint32_t usedTypes = 0;
+  int32_t limiterNode = STAGE_NONE;
+
+  for (uint32_t i = 0; i < nodeCount; i++)
+  {
+    const System::StageNodeConfiguration &node = graph.nodes[i];
+    const uint32_t typeMask = 1u << (uint32_t) node.type;
+
+    if (((uint32_t) node.type >= System::StageType::MAX_STAGE_TYPES) || ((usedTypes & typeMask) != 0) ||
+        !isValidReference(node.input, nodeCount, false) || !isValidReference(node.aux, nodeCount, true))
+    {
+      return false;
+    }
+
+    usedTypes |= typeMask;
+    active[i] = isStageActive(node.type);
+
+    if (node.type == System::StageType::STAGE_TYPE_PEAK_LIMITER)
+    {
+      limiterNode = (int32_t) i;
+    }
+  }
+
+  if (!isValidReference(graph.tweeter, nodeCount, false) || !isValidReference(graph.woofer, nodeCount, false))
+  {
+    return false;
+  }
+
+  bool limiterSingle = true;     // The peak limiter has no woofer input of its own, its woofer band is its output
+
+  // Forwards a reference through the inactive nodes, and to band 0 for the nodes without a woofer band
+  auto resolve = [&](System::StageReference ref) -> System::StageReference
+  {
+    for (uint32_t hop = 0; (hop < nodeCount) && (ref.node >= 0) && !active[ref.node]; hop++)
+    {
+      const System::StageNodeConfiguration &node = graph.nodes[ref.node];
+      const bool aux = (ref.band == 1) && hasWooferInput(node.type) && (node.aux.node != STAGE_NONE);
+
+      ref = aux ? node.aux : node.input;
+    }
+
+    if ((ref.node >= 0) && !active[ref.node])
+    {
+      ref.node = STAGE_NONE;
+    }
+    else if ((ref.node == STAGE_INPUT) ||
+        ((ref.node == limiterNode) && limiterSingle) ||
+        ((ref.node >= 0) && (graph.nodes[ref.node].type != System::StageType::STAGE_TYPE_XOVER_SPLIT) &&
+            !hasWooferInput(graph.nodes[ref.node].type)))
+    {
+      ref.band = 0;
+    }
+
+    return ref;
+  };
+
+  System::StageReference inputs[System::StageType::MAX_STAGE_TYPES];
+  System::StageReference auxInputs[System::StageType::MAX_STAGE_TYPES];
+
+  if ((limiterNode >= 0) && active[limiterNode] && (graph.nodes[limiterNode].aux.node != STAGE_NONE))
+  {
+    const System::StageReference tweeter = resolve(graph.nodes[limiterNode].input);
+    const System::StageReference woofer = resolve(graph.nodes[limiterNode].aux);
+
+    limiterSingle = (tweeter.node == woofer.node) && (tweeter.band == woofer.band);
+  }
+
+  uint32_t activeCount = 0;
+
+  for (uint32_t i = 0; i < nodeCount; i++)
+  {
+    inputs[i] = resolve(graph.nodes[i].input);
+    auxInputs[i].node = STAGE_NONE;
+    auxInputs[i].band = 0;
+
+    if (active[i] && ((int32_t) i == limiterNode) && !limiterSingle)
+    {
+      auxInputs[i] = resolve(graph.nodes[i].aux);
+    }
+    else if (active[i] && (graph.nodes[i].type == System::StageType::STAGE_TYPE_DELAY))
+    {
+      auxInputs[i] = (graph.nodes[i].aux.node == STAGE_NONE) ? inputs[i] : resolve(graph.nodes[i].aux);
+
+      if (auxInputs[i].node == STAGE_NONE)
+      {
+        return false;
+      }
+    }
+
+    if (active[i] && ((inputs[i].node == STAGE_NONE) || (inputs[i].node == (int32_t) i) || (auxInputs[i].node == (int32_t) i)))
+    {
+      return false;
+    }
+
+    activeCount += active[i] ? 1 : 0;
+  }
+
+  const System::StageReference outputs[MAX_STREAM_COUNT] = { resolve(graph.tweeter), resolve(graph.woofer) };
+
+  if ((outputs[STREAM_ID::STREAM_TWEETER].node == STAGE_NONE) || (outputs[STREAM_ID::STREAM_WOOFER].node == STAGE_NONE))
+  {
+    return false;
+  }
+
+  // Topological order
+  uint32_t order[System::StageType::MAX_STAGE_TYPES];
+  bool ordered[System::StageType::MAX_STAGE_TYPES] = { false };
+  uint32_t orderCount = 0;
+  auto isReady = [&ordered](const System::StageReference &ref)
+  {
+    return (ref.node < 0) || ordered[ref.node];
+  };
+
+  for (uint32_t i = 0; i < nodeCount; i++)
+  {
+    if (active[i] && !ordered[i] && isReady(inputs[i]) && isReady(auxInputs[i]))
+    {
+      order[orderCount++] = i;
+      ordered[i] = true;
+      i = (uint32_t) -1;
+    }
+  }
+
+  if (orderCount != activeCount)
+  {
+    return false;
+  }
+
+  // Readers of each value, the output streams being kept until the end
+  uint32_t readers[GRAPH_VALUES] = { 0 };
+  bool pinned[GRAPH_VALUES] = { false };
+
+  for (uint32_t i = 0; i < orderCount; i++)
+  {
+    readers[graphValue(inputs[order[i]])]++;
+
+    if (auxInputs[order[i]].node != STAGE_NONE)
+    {
+      readers[graphValue(auxInputs[order[i]])]++;
+    }
+  }
+
+  pinned[graphValue(outputs[STREAM_ID::STREAM_TWEETER])] = true;
+  pinned[graphValue(outputs[STREAM_ID::STREAM_WOOFER])] = true;
+
+  PlanBuffer valueBuffer[GRAPH_VALUES];
+  uint32_t bufferValue[PLAN_POOL_BUFFERS];
+  bool busy[PLAN_POOL_BUFFERS] = { false };
+
+  valueBuffer[GRAPH_INPUT_VALUE] = BUFFER_MAIN;
+  bufferValue[BUFFER_MAIN] = GRAPH_INPUT_VALUE;
+  busy[BUFFER_MAIN] = true;
+
+  auto allocate = [&]() -> PlanBuffer
+  {
+    for (uint32_t buffer = 0; buffer < PLAN_POOL_BUFFERS; buffer++)
+    {
+      if (!busy[buffer] && bindPoolBuffer(buffer))
+      {
+        busy[buffer] = true;
+        return (PlanBuffer) buffer;
+      }
+    }
+
+    return BUFFER_NONE;
+  };
+
+  // The buffer of a value, if this is its last reader, otherwise a free one
+  auto target = [&](uint32_t value) -> PlanBuffer
+  {
+    return ((readers[value] == 1) && !pinned[value]) ? valueBuffer[value] : allocate();
+  };
+
+  auto assign = [&](uint32_t value, PlanBuffer buffer)
+  {
+    valueBuffer[value] = buffer;
+
+    if (buffer < PLAN_POOL_BUFFERS)
+    {
+      bufferValue[buffer] = value;
+    }
+  };
+
+  auto release = [&](uint32_t value)
+  {
+    const PlanBuffer buffer = valueBuffer[value];
+
+    if ((readers[value] == 0) && !pinned[value] && (buffer < PLAN_POOL_BUFFERS) && (bufferValue[buffer] == value))
+    {
+      busy[buffer] = false;
+    }
+  };
+
+  const StageFunction biquadStage = q31 ? &AudioFilters::runBiquadQ31 :
+      (separate ? &AudioFilters::runBiquadSeparate : &AudioFilters::runBiquadStereo);
+  const StageFunction drcStage = q31 ? &AudioFilters::runDrcQ31 :
+      (separate ? &AudioFilters::runDrcSeparate : &AudioFilters::runDrcInterleaved);
+  const StageFunction crossoverStage = q31 ? &AudioFilters::runCrossoverQ31 :
+      (separate ? &AudioFilters::runCrossoverSeparate : &AudioFilters::runCrossoverInterleaved);
+  const StageFunction firStage = q31 ? &AudioFilters::runFirQ31 : &AudioFilters::runFir;
+  const StageFunction copyStage = q31 ? &AudioFilters::runCopyQ31 : &AudioFilters::runCopy;
+  const bool firCrossover = (filterConfig->firConfig.placement == System::FirPlacement::FIR_PLACEMENT_CROSSOVER);
+
+  for (uint32_t i = 0; i < orderCount; i++)
+  {
+    const uint32_t node = order[i];
+    const uint32_t input = graphValue(inputs[node]);
+    const uint32_t output = node * 2;
+    const PlanBuffer src = valueBuffer[input];
+    PlanBuffer dst = BUFFER_NONE;
+    PlanBuffer aux = BUFFER_NONE;
+    uint32_t auxInput = GRAPH_VALUES;
+
+    switch (graph.nodes[node].type)
+    {
+      case System::StageType::STAGE_TYPE_MASTER_EQ:
+      case System::StageType::STAGE_TYPE_WOOFER_EQ:
+      case System::StageType::STAGE_TYPE_TWEETER_EQ:
+        if ((dst = target(input)) != BUFFER_NONE)
+        {
+          BiquadFilters *filters = &masterEqFilters;
+
+          if (graph.nodes[node].type == System::StageType::STAGE_TYPE_WOOFER_EQ)
+          {
+            filters = &xoverWooferFilters;
+          }
+          else if (graph.nodes[node].type == System::StageType::STAGE_TYPE_TWEETER_EQ)
+          {
+            filters = &xoverTweeterFilters;
+          }
+
+          addStage(biquadStage, src, dst, BUFFER_NONE).filters = filters;
+        }
+        break;
+
+      case System::StageType::STAGE_TYPE_MASTER_FIR:
+        if ((dst = target(input)) != BUFFER_NONE)
+        {
+          addStage(firStage, src, dst, BUFFER_NONE);
+        }
+        break;
+
+      case System::StageType::STAGE_TYPE_LEVELER_DRC:
+      case System::StageType::STAGE_TYPE_LIMITER_DRC:
+        if ((dst = target(input)) != BUFFER_NONE)
+        {
+          if (dst != src)
+          {
+            addStage(copyStage, src, dst, BUFFER_NONE);
+          }
+
+          addStage(drcStage, dst, dst, BUFFER_NONE).drc =
+              (graph.nodes[node].type == System::StageType::STAGE_TYPE_LEVELER_DRC) ? &levelerDrc : &limiterDrc;
+        }
+        break;
+
+      case System::StageType::STAGE_TYPE_XOVER_SPLIT:
+        if (((dst = target(input)) != BUFFER_NONE) && ((aux = allocate()) != BUFFER_NONE))
+        {
+          addStage((firCrossover && !firConvolver.isBypassed()) ? firStage : crossoverStage, src, dst, aux);
+          assign(output + 1, aux);
+        }
+        break;
+
+      case System::StageType::STAGE_TYPE_PEAK_LIMITER:
+        if ((dst = target(input)) != BUFFER_NONE)
+        {
+          if (dst != src)
+          {
+            addStage(copyStage, src, dst, BUFFER_NONE);
+          }
+
+          if (auxInputs[node].node != STAGE_NONE)
+          {
+            auxInput = graphValue(auxInputs[node]);
+
+            if ((aux = target(auxInput)) == BUFFER_NONE)
+            {
+              dst = BUFFER_NONE;
+              break;
+            }
+
+            if (aux != valueBuffer[auxInput])
+            {
+              addStage(copyStage, valueBuffer[auxInput], aux, BUFFER_NONE);
+            }
+
+            assign(output + 1, aux);
+          }
+
+          addStage(q31 ? &AudioFilters::runPeakLimiterQ31 : &AudioFilters::runPeakLimiter, dst, dst, aux);
+        }
+        break;
+
+      case System::StageType::STAGE_TYPE_DELAY:
+        auxInput = graphValue(auxInputs[node]);
+
+        if ((dst = target(input)) != BUFFER_NONE)
+        {
+          if (dst != src)
+          {
+            addStage(copyStage, src, dst, BUFFER_NONE);
+          }
+
+          if ((aux = target(auxInput)) == BUFFER_NONE)
+          {
+            dst = BUFFER_NONE;
+            break;
+          }
+
+          if (aux != valueBuffer[auxInput])
+          {
+            addStage(copyStage, valueBuffer[auxInput], aux, BUFFER_NONE);
+          }
+
+          assign(output + 1, aux);
+          addStage(q31 ? &AudioFilters::runDelayQ31 : &AudioFilters::runDelay, dst, dst, aux);
+        }
+        break;
+
+      case System::StageType::STAGE_TYPE_ALA:
+        if (!separate && !q31)
+        {
+          dst = (readers[output] == 0) ? BUFFER_ALA : BUFFER_NONE;
+        }
+        else
+        {
+          dst = target(input);
+        }
+
+        if (dst != BUFFER_NONE)
+        {
+          addStage(q31 ? &AudioFilters::runAlaQ31 : &AudioFilters::runAla, src, dst, BUFFER_NONE);
+        }
+        break;
+
+      default:
+        break;
+    }
+
+    if (dst == BUFFER_NONE)
+    {
+      return false;
+    }
+
+    assign(output, dst);
+
+    readers[input]--;
+    release(input);
+
+    if (auxInput != GRAPH_VALUES)
+    {
+      readers[auxInput]--;
+      release(auxInput);
+    }
+
+    // Outputs nobody reads, such as an unused band of a split
+    release(output);
+
+    if (aux != BUFFER_NONE)
+    {
+      release(output + 1);
+    }
+  }
+
+  outputBuffer[STREAM_ID::STREAM_TWEETER] = valueBuffer[graphValue(outputs[STREAM_ID::STREAM_TWEETER])];
+  outputBuffer[STREAM_ID::STREAM_WOOFER] = valueBuffer[graphValue(outputs[STREAM_ID::STREAM_WOOFER])];
+  return true;
+}
+
+/**
+ * Appends a stage to the execution plan
+ * @param run the stage function
+ * @param src the input buffer
+ * @param dst the output buffer
+ * @param aux the woofer buffer of the x-over split and the peak limiter, BUFFER_NONE if unused
+ * @return the new stage, to bind the filter
+ */
+AudioFilters::FilterStage &AudioFilters::addStage(void (AudioFilters::*run)(const FilterStage &stage),
+    PlanBuffer src, PlanBuffer dst, PlanBuffer aux)
+{
+  FilterStage &stage = plan[planStages++];
+
+  stage.run = run;
+  stage.filters = nullptr;
+  stage.drc = nullptr;
+  stage.stride = bufferStride[src];
+
+  for (uint32_t num = 0; num < PcmChannel::MAX_CHANNELS; num++)
+  {
+    stage.pSrc[num] = bufferSamples[src][num];
+    stage.pDst[num] = bufferSamples[dst][num];
+    stage.pAux[num] = (aux != BUFFER_NONE) ? bufferSamples[aux][num] : nullptr;
+  }
+
+  stage.pQ31Src = q31BufferSamples[src];
+  stage.pQ31Dst = q31BufferSamples[dst];
+  stage.pQ31Aux = (aux != BUFFER_NONE) ? q31BufferSamples[aux] : nullptr;
+  return stage;
+}
+
+/**
+ * Runs the execution plan compiled by init().
+ * The input is converted in one pass and both output streams are written in one pass.
+ * In the fixed-point chain, the int16_t input is placed Q31_HEADROOM_BITS below the Q31 full scale,
+ * so that EQ boosts do not saturate before the output stage.
  * @param pSrc the input audio buffer with interleaved uint16_t samples
  * @param pDst the output audio buffer with interleaved uint16_t samples
  */
 void AudioFilters::run(int16_t *pSrc, int16_t *pDst[2])
 {
-#if SWAP_AUDIO_CHANNELS == 1
-	uint8_t leftChannelIndex = 1;
-#else
-	uint8_t leftChannelIndex = 0;
-#endif
+  if (filterEngine == System::FilterEngine::FILTER_ENGINE_Q31)
+  {
+    q31_t *samples = q31BufferSamples[BUFFER_MAIN];
+
+    for (uint32_t i = 0; i < 2 * blockSize; i++)
+    {
+      samples[i] = (q31_t) pSrc[i] << (16 - Q31_HEADROOM_BITS);
+    }
+  }
+  else
+  {
+    deinterlace16Tof32(pSrc, bufferSamples[BUFFER_MAIN][PcmChannel::LEFT], bufferSamples[BUFFER_MAIN][PcmChannel::RIGHT],
+        bufferStride[BUFFER_MAIN]);
+  }
+
+  for (uint32_t i = 0; i < planStages; i++)
+  {
+    (this->*plan[i].run)(plan[i]);
+  }
+
+  (this->*outputKernel)(pDst);
+}
+
+/**
+ * Biquad cascades on separate channel buffers, one DF1 cascade per channel
+ * @param stage
+ */
+void AudioFilters::runBiquadSeparate(const FilterStage &stage)
+{
+  stage.filters->run(PcmChannel::LEFT, stage.pSrc[PcmChannel::LEFT], stage.pDst[PcmChannel::LEFT]);
+  stage.filters->run(PcmChannel::RIGHT, stage.pSrc[PcmChannel::RIGHT], stage.pDst[PcmChannel::RIGHT]);
+}
+
+/**
+ * Biquad cascades on an interleaved stereo buffer (DF2T)
+ * @param stage
+ */
+void AudioFilters::runBiquadStereo(const FilterStage &stage)
+{
+  stage.filters->runStereo(stage.pSrc[PcmChannel::LEFT], stage.pDst[PcmChannel::LEFT]);
+}
+
+/**
+ * Biquad cascades on an interleaved Q31 buffer
+ * @param stage
+ */
+void AudioFilters::runBiquadQ31(const FilterStage &stage)
+{
+  stage.filters->runStereoQ31(stage.pQ31Src, stage.pQ31Dst);
+}
+
+/**
+ * DRC on separate channel buffers, in place
+ * @param stage
+ */
+void AudioFilters::runDrcSeparate(const FilterStage &stage)
+{
+  stage.drc->run(stage.pDst[PcmChannel::LEFT], stage.pDst[PcmChannel::RIGHT]);
+}
+
+/**
+ * DRC on an interleaved stereo buffer, in place
+ * @param stage
+ */
+void AudioFilters::runDrcInterleaved(const FilterStage &stage)
+{
+  stage.drc->runInterleaved(stage.pDst[PcmChannel::LEFT]);
+}
+
+/**
+ * DRC on an interleaved Q31 buffer, in place
+ * @param stage
+ */
+void AudioFilters::runDrcQ31(const FilterStage &stage)
+{
+  stage.drc->runInterleavedQ31(stage.pQ31Dst, q31SampleScale);
+}
 
-  deinterlace16Tof32(pSrc, channelSamples[PcmChannel::LEFT], 2);
-  deinterlace16Tof32(&pSrc[1], channelSamples[PcmChannel::RIGHT], 2);
+/**
+ * Complementary x-over split on separate channel buffers: high band to pDst, low band to pAux
+ * @param stage
+ */
+void AudioFilters::runCrossoverSeparate(const FilterStage &stage)
+{
+  crossover.run(stage.pSrc[PcmChannel::LEFT], stage.pSrc[PcmChannel::RIGHT],
+      stage.pAux[PcmChannel::LEFT], stage.pAux[PcmChannel::RIGHT],
+      stage.pDst[PcmChannel::LEFT], stage.pDst[PcmChannel::RIGHT]);
+}
 
-  // Master EQ filtering
-  if (filterConfig->masterEqEnabled)
+/**
+ * Complementary x-over split on an interleaved stereo buffer: high band to pDst, low band to pAux
+ * @param stage
+ */
+void AudioFilters::runCrossoverInterleaved(const FilterStage &stage)
+{
+  crossover.runInterleaved(stage.pSrc[PcmChannel::LEFT], stage.pAux[PcmChannel::LEFT], stage.pDst[PcmChannel::LEFT]);
+}
+
+/**
+ * Complementary x-over split on an interleaved Q31 buffer: high band to pQ31Dst, low band to pQ31Aux
+ * @param stage
+ */
+void AudioFilters::runCrossoverQ31(const FilterStage &stage)
+{
+  crossover.runInterleavedQ31(stage.pQ31Src, stage.pQ31Aux, stage.pQ31Dst);
+}
+
+/**
+ * FIR filters on separate or interleaved channel buffers. Without pAux, each channel is filtered to pDst.
+ * With pAux, it is the x-over split: the tweeter band goes to pDst and the woofer band to pAux.
+ * @param stage
+ */
+void AudioFilters::runFir(const FilterStage &stage)
+{
+  firConvolver.writeInput(PcmChannel::LEFT, stage.pSrc[PcmChannel::LEFT], stage.stride);
+  firConvolver.writeInput(PcmChannel::RIGHT, stage.pSrc[PcmChannel::RIGHT], stage.stride);
+
+  if (stage.pAux[PcmChannel::LEFT] == nullptr)
+  {
+    firConvolver.readOutput(System::MasterEqCoeffcientType::LEFT, stage.pDst[PcmChannel::LEFT], stage.stride);
+    firConvolver.readOutput(System::MasterEqCoeffcientType::RIGHT, stage.pDst[PcmChannel::RIGHT], stage.stride);
+  }
+  else
   {
-    masterEqFilters.run(PcmChannel::LEFT, channelSamples[PcmChannel::LEFT], channelSamples[PcmChannel::LEFT]);
-    masterEqFilters.run(PcmChannel::RIGHT, channelSamples[PcmChannel::RIGHT], channelSamples[PcmChannel::RIGHT]);
+    firConvolver.readOutput(System::XoverEqCoeffcientType::LEFT_WOOFER, stage.pAux[PcmChannel::LEFT], stage.stride);
+    firConvolver.readOutput(System::XoverEqCoeffcientType::LEFT_TWEETER, stage.pDst[PcmChannel::LEFT], stage.stride);
+    firConvolver.readOutput(System::XoverEqCoeffcientType::RIGHT_WOOFER, stage.pAux[PcmChannel::RIGHT], stage.stride);
+    firConvolver.readOutput(System::XoverEqCoeffcientType::RIGHT_TWEETER, stage.pDst[PcmChannel::RIGHT], stage.stride);
   }
 
-  // DRC processing
-  levelerDrc.run(channelSamples[PcmChannel::LEFT], channelSamples[PcmChannel::RIGHT]);
-  limiterDrc.run(channelSamples[PcmChannel::LEFT], channelSamples[PcmChannel::RIGHT]);
+  firConvolver.nextBlock();
+}
 
-  // X-over EQ
-  if (filterConfig->xoverEqEnabled)
+/**
+ * FIR filters on an interleaved Q31 buffer. Without pQ31Aux, each channel is filtered to pQ31Dst.
+ * With pQ31Aux, it is the x-over split: the tweeter band goes to pQ31Dst and the woofer band to pQ31Aux.
+ * @param stage
+ */
+void AudioFilters::runFirQ31(const FilterStage &stage)
+{
+  const float32_t fullScale = (float32_t) (1u << (31 - Q31_HEADROOM_BITS));
+
+  firConvolver.writeInput(PcmChannel::LEFT, stage.pQ31Src, 2, q31SampleScale);
+  firConvolver.writeInput(PcmChannel::RIGHT, stage.pQ31Src + 1, 2, q31SampleScale);
+
+  if (stage.pQ31Aux == nullptr)
+  {
+    firConvolver.readOutput(System::MasterEqCoeffcientType::LEFT, stage.pQ31Dst, 2, fullScale);
+    firConvolver.readOutput(System::MasterEqCoeffcientType::RIGHT, stage.pQ31Dst + 1, 2, fullScale);
+  }
+  else
   {
-    xoverWooferFilters.run(PcmChannel::LEFT, channelSamples[PcmChannel::LEFT], channelSamples[PcmChannel::LEFT + XOVER_SAMPLES]);
-    xoverWooferFilters.run(PcmChannel::RIGHT, channelSamples[PcmChannel::RIGHT], channelSamples[PcmChannel::RIGHT + XOVER_SAMPLES]);
+    firConvolver.readOutput(System::XoverEqCoeffcientType::LEFT_WOOFER, stage.pQ31Aux, 2, fullScale);
+    firConvolver.readOutput(System::XoverEqCoeffcientType::LEFT_TWEETER, stage.pQ31Dst, 2, fullScale);
+    firConvolver.readOutput(System::XoverEqCoeffcientType::RIGHT_WOOFER, stage.pQ31Aux + 1, 2, fullScale);
+    firConvolver.readOutput(System::XoverEqCoeffcientType::RIGHT_TWEETER, stage.pQ31Dst + 1, 2, fullScale);
+  }
 
-    xoverTweeterFilters.run(PcmChannel::LEFT, channelSamples[PcmChannel::LEFT], channelSamples[PcmChannel::LEFT]);
-    xoverTweeterFilters.run(PcmChannel::RIGHT, channelSamples[PcmChannel::RIGHT], channelSamples[PcmChannel::RIGHT]);
+  firConvolver.nextBlock();
+}
 
-    interlacef32To16(channelSamples[PcmChannel::LEFT + XOVER_SAMPLES], &pDst[STREAM_ID::STREAM_WOOFER][leftChannelIndex], 2, INVERT_LEFT_CHANNEL);
-    interlacef32To16(channelSamples[PcmChannel::RIGHT + XOVER_SAMPLES], &pDst[STREAM_ID::STREAM_WOOFER][!leftChannelIndex], 2, INVERT_RIGHT_CHANNEL);
+/**
+ * Copies pSrc to pDst, in front of the stages that only run in place when their input is still read by another stage
+ * @param stage
+ */
+void AudioFilters::runCopy(const FilterStage &stage)
+{
+  if (stage.stride == 2)
+  {
+    memcpy(stage.pDst[PcmChannel::LEFT], stage.pSrc[PcmChannel::LEFT], 2 * blockSize * sizeof(float32_t));
   }
   else
   {
-    interlacef32To16(channelSamples[PcmChannel::LEFT], &pDst[STREAM_ID::STREAM_WOOFER][leftChannelIndex], 2, INVERT_LEFT_CHANNEL);
-    interlacef32To16(channelSamples[PcmChannel::RIGHT], &pDst[STREAM_ID::STREAM_WOOFER][!leftChannelIndex], 2, INVERT_RIGHT_CHANNEL);
+    memcpy(stage.pDst[PcmChannel::LEFT], stage.pSrc[PcmChannel::LEFT], blockSize * sizeof(float32_t));
+    memcpy(stage.pDst[PcmChannel::RIGHT], stage.pSrc[PcmChannel::RIGHT], blockSize * sizeof(float32_t));
+  }
+}
+
+/**
+ * Copies the interleaved Q31 buffer pQ31Src to pQ31Dst
+ * @param stage
+ */
+void AudioFilters::runCopyQ31(const FilterStage &stage)
+{
+  memcpy(stage.pQ31Dst, stage.pQ31Src, 2 * blockSize * sizeof(q31_t));
+}
+
+/**
+ * Delays the tweeters in pDst and the woofers in pAux, in place
+ * @param stage
+ */
+void AudioFilters::runDelay(const FilterStage &stage)
+{
+  float32_t *pSamples[MAX_CHANNELS * MAX_STREAM_COUNT] = {
+      stage.pDst[PcmChannel::LEFT], stage.pDst[PcmChannel::RIGHT], stage.pAux[PcmChannel::LEFT], stage.pAux[PcmChannel::RIGHT]
+  };
+
+  for (uint32_t num = 0; num < MAX_CHANNELS * MAX_STREAM_COUNT; num++)
+  {
+    delayAlignment.writeInput(delayLines[num], pSamples[num], stage.stride);
+    delayAlignment.readOutput(delayLines[num], pSamples[num], stage.stride);
+  }
+
+  delayAlignment.nextBlock();
+}
+
+/**
+ * Delays the interleaved Q31 tweeters in pQ31Dst and woofers in pQ31Aux, in place
+ * @param stage
+ */
+void AudioFilters::runDelayQ31(const FilterStage &stage)
+{
+  const float32_t fullScale = (float32_t) (1u << (31 - Q31_HEADROOM_BITS));
+  q31_t *pSamples[MAX_CHANNELS * MAX_STREAM_COUNT] = { stage.pQ31Dst, stage.pQ31Dst + 1, stage.pQ31Aux, stage.pQ31Aux + 1 };
+
+  for (uint32_t num = 0; num < MAX_CHANNELS * MAX_STREAM_COUNT; num++)
+  {
+    delayAlignment.writeInput(delayLines[num], pSamples[num], 2, q31SampleScale);
+    delayAlignment.readOutput(delayLines[num], pSamples[num], 2, fullScale);
   }
 
+  delayAlignment.nextBlock();
+}
+
+/**
+ * Lookahead peak limiting of the tweeters in pDst and the woofers in pAux, with one gain for both streams
+ * @param stage
+ */
+void AudioFilters::runPeakLimiter(const FilterStage &stage)
+{
+  peakLimiter.run(stage.pDst[PcmChannel::LEFT], stage.pDst[PcmChannel::RIGHT],
+      stage.pAux[PcmChannel::LEFT], stage.pAux[PcmChannel::RIGHT], stage.stride);
+}
+
+/**
+ * Lookahead peak limiting of the interleaved Q31 tweeters in pQ31Dst and woofers in pQ31Aux
+ * @param stage
+ */
+void AudioFilters::runPeakLimiterQ31(const FilterStage &stage)
+{
+  peakLimiter.runInterleavedQ31(stage.pQ31Dst, stage.pQ31Aux, q31SampleScale);
+}
+
+/**
+ * ALA on separate channel buffers. The samples are copied (or split per channel) to pDst first, unless it is the source.
+ * @param stage
+ */
+void AudioFilters::runAla(const FilterStage &stage)
+{
 #if ALA_MODULE_ENABLED == 1
-  ala.run(
-      channelSamples[PcmChannel::LEFT],
-      channelSamples[PcmChannel::RIGHT]
-      );
+  float32_t *left = stage.pDst[PcmChannel::LEFT];
+  float32_t *right = stage.pDst[PcmChannel::RIGHT];
+
+  if (left != stage.pSrc[PcmChannel::LEFT])
+  {
+    for (uint32_t i = 0; i < blockSize; i++)
+    {
+      left[i] = stage.pSrc[PcmChannel::LEFT][i * stage.stride];
+      right[i] = stage.pSrc[PcmChannel::RIGHT][i * stage.stride];
+    }
+  }
+
+  ala.run(left, right);
 #endif
+}
+
+/**
+ * ALA in the fixed-point chain. ALA works in floating point, so the tweeter samples are converted
+ * to the ALA buffers and back to pQ31Dst.
+ * @param stage
+ */
+void AudioFilters::runAlaQ31(const FilterStage &stage)
+{
+#if ALA_MODULE_ENABLED == 1
+  float32_t *left = alaSamples[PcmChannel::LEFT];
+  float32_t *right = alaSamples[PcmChannel::RIGHT];
+  const q31_t *pSrc = stage.pQ31Src;
+  q31_t *pDst = stage.pQ31Dst;
 
-  interlacef32To16(channelSamples[PcmChannel::LEFT], &pDst[STREAM_ID::STREAM_TWEETER][leftChannelIndex], 2, INVERT_LEFT_CHANNEL);
-  interlacef32To16(channelSamples[PcmChannel::RIGHT], &pDst[STREAM_ID::STREAM_TWEETER][!leftChannelIndex], 2, INVERT_RIGHT_CHANNEL);
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    left[i] = (float32_t) pSrc[i * 2] * q31SampleScale;
+    right[i] = (float32_t) pSrc[i * 2 + 1] * q31SampleScale;
+  }
+
+  ala.run(left, right);
+
+  const float32_t fullScale = (float32_t) (1u << (31 - Q31_HEADROOM_BITS));
+
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    pDst[i * 2] = clip_q63_to_q31((q63_t) roundf(left[i] * fullScale));
+    pDst[i * 2 + 1] = clip_q63_to_q31((q63_t) roundf(right[i] * fullScale));
+  }
+#endif
 }
 
+/**
+ * Continues from the running state of another chain, so that a reconfiguration does not restart the filters
+ * and the gain smoothers. The filter histories are only taken over when both chains use the same engine.
+ * @param other
+ */
+void AudioFilters::inheritState(const AudioFilters &other)
+{
+  if (filterEngine == other.filterEngine)
+  {
+    masterEqFilters.inheritState(other.masterEqFilters);
+    xoverTweeterFilters.inheritState(other.xoverTweeterFilters);
+    xoverWooferFilters.inheritState(other.xoverWooferFilters);
+    crossover.inheritState(other.crossover);
+  }
+
+  firConvolver.inheritState(other.firConvolver);
+  delayAlignment.inheritState(other.delayAlignment);
 
+  levelerDrc.inheritState(other.levelerDrc);
+  limiterDrc.inheritState(other.limiterDrc);
+  peakLimiter.inheritState(other.peakLimiter);
+}
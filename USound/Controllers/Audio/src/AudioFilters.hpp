@@ -37,10 +37,18 @@
 #include "arm_math.h"
 #include "Controllers/System/pub/ModuleConfig.hpp"
 #include "Drc.hpp"
-#include "Controllers/System/pub/SystemConfiguration.hpp"
+#include "Controllers/System/pub/FilterConfiguration.hpp"
 #include "BiquadFilters.hpp"
+#include "Crossover.hpp"
+#include "DelayAlignment.hpp"
+#include "FirConvolver.hpp"
+#include "PeakLimiter.hpp"
 #include "USoundAla.hpp"
 
+#define Q31_HEADROOM_BITS   4       //!< Headroom of the fixed-point chain above the 16bit full scale (24 dB)
+#define PLAN_POOL_BUFFERS   4       //!< Stereo buffers the stage graph can use at the same time
+#define MAX_PLAN_STAGES     (2 * System::StageType::MAX_STAGE_TYPES + 2)   //!< Each stage, with copies of both inputs in front of the stages that only run in place
+
 
 /**
  * This class is a wrapper of the biquad filter operation
@@ -48,27 +56,166 @@
 class AudioFilters
 {
 private:
+  /**
+   * The sample buffers the plan stages are bound to: the stereo buffers of the pool, then the ALA buffers
+   */
+  enum PlanBuffer
+  {
+    BUFFER_MAIN,                      //!< First buffer of the pool, which takes the input
+    BUFFER_ALA = PLAN_POOL_BUFFERS,   //!< Separate channel buffers for ALA (interleaved float chain)
+    MAX_PLAN_BUFFERS,
+    BUFFER_NONE = MAX_PLAN_BUFFERS
+  };
+
+  /**
+   * One step of the execution plan: a stage function and the filter and buffers it is bound to.
+   * The float buffers are left/right pairs with a stride of 1 (separate) or 2 (interleaved).
+   */
+  struct FilterStage
+  {
+    void (AudioFilters::*run)(const FilterStage &stage);
+    BiquadFilters *filters;
+    Drc *drc;
+    float32_t *pSrc[MAX_CHANNELS];
+    float32_t *pDst[MAX_CHANNELS];    //!< May be the same as pSrc
+    float32_t *pAux[MAX_CHANNELS];    //!< Woofer band of the x-over splits, the delay and the peak limiter, nullptr if unused
+    uint32_t stride;                  //!< Stride of pSrc; pDst and pAux use the same stride, except for ALA
+    q31_t *pQ31Src;
+    q31_t *pQ31Dst;
+    q31_t *pQ31Aux;
+  };
+
+  uint32_t maxBlockSize;                      //!< The block size the buffers are allocated for
   uint32_t blockSize;
+  float32_t sampleRate = 0.0f;                //!< The audio sampling rate, 0 to run at the rates of the configuration
   BiquadFilters masterEqFilters;
   BiquadFilters xoverTweeterFilters;
   BiquadFilters xoverWooferFilters;
+  Crossover crossover;
+  FirConvolver firConvolver;
+  DelayAlignment delayAlignment;
 
 #if ALA_MODULE_ENABLED == 1
   USoundAla ala;
+  float32_t *alaSamples[MAX_CHANNELS] = { nullptr, nullptr };    //!< Separate channel buffers for ALA, when the chain runs interleaved
 #endif
 
   Drc levelerDrc;
   Drc limiterDrc;
-  float32_t *channelSamples[4] = { nullptr, nullptr, nullptr, nullptr };
+  PeakLimiter peakLimiter;
+  float32_t *poolSamples[PLAN_POOL_BUFFERS] = { nullptr };   //!< Stereo buffers of the float chains, left then right or interleaved
+  q31_t *q31PoolSamples[PLAN_POOL_BUFFERS] = { nullptr };    //!< Interleaved stereo buffers of the fixed-point chain
+  uint32_t poolBuffers = 0;                                  //!< Buffers of the pool allocated so far
   System::FilterConfiguration *filterConfig;
+  System::FilterEngine filterEngine;
+
+  float32_t outputGain = 1.0f;                //!< Digital volume of the first frame of the block
+  float32_t outputGainStep = 0.0f;            //!< Change of the digital volume per frame
+
+  /**
+   * The output routing, compiled by init() for the buffers that hold the tweeter and woofer streams at the end of the plan
+   */
+  const float32_t *routingSamples[System::MAX_ROUTING_CHANNELS];    //!< First sample of each source (float chains)
+  uint32_t routingStride[System::MAX_ROUTING_CHANNELS];
+  const q31_t *q31RoutingSamples[System::MAX_ROUTING_CHANNELS];     //!< First sample of each source (Q31 chain), with a stride of 2
+  float32_t routingGains[System::MAX_ROUTING_CHANNELS][System::MAX_ROUTING_CHANNELS];   //!< gains[output][source], clamped
+  uint32_t routingSource[System::MAX_ROUTING_CHANNELS];             //!< The only source of each output, for the routed kernels
+  void (AudioFilters::*outputKernel)(int16_t *pDst[2]);             //!< Converts the streams into the int16_t output buffers
+
+  void deinterlace16Tof32(const int16_t *pSrc, float32_t *pDstLeft, float32_t *pDstRight, uint32_t stride);
+  void compileOutput();
+  void routeStreamsf32To16(int16_t *pDst[2]);
+  void mixStreamsf32To16(int16_t *pDst[2]);
+  void routeStreamsQ31To16(int16_t *pDst[2]);
+  void mixStreamsQ31To16(int16_t *pDst[2]);
+  void muteStreams(int16_t *pDst[2]);
+
+  float32_t *bufferSamples[MAX_PLAN_BUFFERS][MAX_CHANNELS];    //!< Left/right samples of each PlanBuffer (float chains)
+  uint32_t bufferStride[MAX_PLAN_BUFFERS];
+  q31_t *q31BufferSamples[MAX_PLAN_BUFFERS];                   //!< Interleaved samples of each PlanBuffer (Q31 chain)
+
+  FilterStage plan[MAX_PLAN_STAGES];         //!< The stages of the active configuration, compiled by init()
+  uint32_t planStages = 0;
+  PlanBuffer outputBuffer[MAX_STREAM_COUNT];  //!< The buffers holding the tweeter and woofer streams at the end of the plan
 
-  void deinterlace16Tof32(const int16_t *pSrc, float32_t *pDst, uint32_t stride);
-  void interlacef32To16(const float32_t *pSrc, int16_t *pDst, uint32_t stride, bool invert);
+  bool graphCompiled = false;                 //!< True if the plan follows the stage graph of the configuration
+
+  void compilePlan();
+  bool compileGraph(const System::StageGraphConfiguration &graph);
+  void buildDefaultGraph(System::StageGraphConfiguration &graph) const;
+  bool isStageActive(System::StageType type) const;
+  bool bindPoolBuffer(uint32_t buffer);
+  FilterStage &addStage(void (AudioFilters::*run)(const FilterStage &stage), PlanBuffer src, PlanBuffer dst, PlanBuffer aux);
+
+  void runCopy(const FilterStage &stage);
+  void runCopyQ31(const FilterStage &stage);
+
+  void runBiquadSeparate(const FilterStage &stage);
+  void runBiquadStereo(const FilterStage &stage);
+  void runBiquadQ31(const FilterStage &stage);
+  void runDrcSeparate(const FilterStage &stage);
+  void runDrcInterleaved(const FilterStage &stage);
+  void runDrcQ31(const FilterStage &stage);
+  void runCrossoverSeparate(const FilterStage &stage);
+  void runCrossoverInterleaved(const FilterStage &stage);
+  void runCrossoverQ31(const FilterStage &stage);
+  void runFir(const FilterStage &stage);
+  void runFirQ31(const FilterStage &stage);
+  void runDelay(const FilterStage &stage);
+  void runDelayQ31(const FilterStage &stage);
+  void runPeakLimiter(const FilterStage &stage);
+  void runPeakLimiterQ31(const FilterStage &stage);
+  void runAla(const FilterStage &stage);
+  void runAlaQ31(const FilterStage &stage);
 
 public:
   AudioFilters(System::FilterConfiguration *filterConfig, uint32_t blockSize);
 
   void init();
+  void setSampleRate(float32_t sampleRateHz, uint32_t frames);
   void run(int16_t *pSrc, int16_t *pDst[2]);
+  void setOutputGain(float32_t gain, float32_t gainStep);
+  void inheritState(const AudioFilters &other);
+
+  /**
+   * @return the number of frames per block
+   */
+  uint32_t getBlockSize() const
+  {
+    return blockSize;
+  }
+
+  /**
+   * @return the audio sampling rate set by setSampleRate(), 0 if the chain runs at the rates of the configuration
+   */
+  float32_t getSampleRate() const
+  {
+    return sampleRate;
+  }
+
+  /**
+   * @return the number of stages in the compiled execution plan, without the format conversions
+   */
+  uint32_t getPlanStages() const
+  {
+    return planStages;
+  }
+
+  /**
+   * @return true if the plan follows the stage graph of the configuration, false for the default order
+   * (no graph, or a graph that could not be compiled)
+   */
+  bool isGraphCompiled() const
+  {
+    return graphCompiled;
+  }
+
+  /**
+   * @return true if an output slot of the routing takes more than one source, so that the output conversion mixes the streams
+   */
+  bool isOutputMixed() const
+  {
+    return (outputKernel == &AudioFilters::mixStreamsf32To16) || (outputKernel == &AudioFilters::mixStreamsQ31To16);
+  }
 };
 
@@ -31,6 +31,8 @@
 //
 //====================================================================
 
+#include <algorithm>
+#include <string.h>
 #include "cmsis_os.h"
 #include "../pub/AudioService.hpp"
 #include "OAL/pub/Oal.hpp"
@@ -38,8 +40,16 @@
 #include "Controllers/System/pub/SystemInterfaces.hpp"
 #include "Controllers/System/pub/SystemStatus.hpp"
 #include "Interfaces/pub/SystemControl.hpp"
-#include "AudioFilters.hpp"
+#include "DoubleBufferedFilters.hpp"
 #include "Drc.hpp"
+#include "Resampler.hpp"
+#include "SilenceDetector.hpp"
+#include "Utilities/MathUtils.hpp"
+
+#define OUTPUT_TAP_TIME 20              // ms of audio at the highest rate kept for the readers of the output taps
+#define WAKE_HOLD_BLOCKS 5              // Audio blocks at the highest rate held back while the output stages wake up
+#define WAKE_DRAIN_RATIO 32             // While the held audio drains, one frame in WAKE_DRAIN_RATIO is merged with the next
+#define CONTROL_RETRY_BLOCKS 25         // Audio blocks after which a request to the control task that has not taken effect is sent again
 
 namespace System
 {
@@ -50,10 +60,14 @@ enum AudioCommand
   CMD_VOL_UP_DOWN,
   CMD_SET_VOL,
   CMD_SET_MUTE,
+  CMD_SET_USB_VOL,
   CMD_SKIP_PREV,
   CMD_SKIP_NEXT,
   CMD_RECONF_FILTERS,
   CMD_RECONF_SINK,
+  CMD_SET_FREQUENCY,
+  CMD_CONFIGURE_RESAMPLER,
+  CMD_SET_STANDBY,
   CMD_COUNT
 };
 
@@ -116,6 +130,10 @@ void AudioService::init()
 
   initFilters();
 
+  uint32_t tapLen = SpscFifo<int16_t>::roundSize(MAX_AUDIO_FREQUENCY * OUTPUT_TAP_TIME / 1000 * 2);
+  outputTaps[SaiInterface::TWEETER] = new BroadcastFifo<int16_t>(new int16_t[tapLen], tapLen);
+  outputTaps[SaiInterface::WOOFER] = new BroadcastFifo<int16_t>(new int16_t[tapLen], tapLen);
+
   if ((audioMode == AudioMode::AM_MP3) || (audioMode == AudioMode::AM_I2S_SLAVE))
   {
     systemController->getGpio(System::GpioInterface::GPIO_JOYSTICK_NORTH)->setEventHandler([this](uint32_t gpioLevel, GpioEventType evType)
@@ -151,10 +169,12 @@ void AudioService::init()
 void AudioService::initFilters()
 {
   auto systemConfig = globalServices->getSystemConfiguration();
-  uint32_t bufferingTime = systemConfig->getBufferingTIme();
 
-  audioFilters = new AudioFilters(systemConfig->getFilterConfiguration(), 48 * bufferingTime);
+  audioFilters = new DoubleBufferedFilters(systemConfig->getFilterConfiguration(), systemConfig->getMaxBlockFrames(), FILTER_CROSSFADE_ENABLED);
+  audioFilters->setSampleRate((float32_t) systemConfig->getFrequency(), systemConfig->getBlockFrames());
   audioFilters->init();
+
+  silenceDetector = new SilenceDetector(&systemConfig->getFilterConfiguration()->silenceConfig);
 }
 
 void AudioService::startPlay(AudioChangeSrc acs)
@@ -224,6 +244,22 @@ void AudioService::setVolume(uint32_t level, AudioChangeSrc acs)
   globalServices->getOal()->sendMessageToQueue(controlMessageQueue, &cmd, 0);
 }
 
+/**
+ * Sets the volume requested by the USB host. The conversion to a volume level is left to the control task,
+ * as it is called from the USB interrupt.
+ * @param usbVolume the USB volume control value (-1024 to 1024)
+ */
+void AudioService::setUsbVolume(int16_t usbVolume)
+{
+  if (!isAudioCommandSupportedInCurrentMode(AudioChangeSrc::ACS_USB))
+  {
+    return;
+  }
+
+  AudioServiceCmd cmd = { CMD_SET_USB_VOL, 0, (uint16_t) usbVolume };
+  globalServices->getOal()->sendMessageToQueue(controlMessageQueue, &cmd, 0);
+}
+
 void AudioService::setMute(bool mute, AudioChangeSrc acs)
 {
   if (!isAudioCommandSupportedInCurrentMode(acs))
@@ -258,11 +294,102 @@ void AudioService::reconfigureSink()
   globalServices->getOal()->sendMessageToQueue(controlMessageQueue, &cmd, 0);
 }
 
+/**
+ * Switches the audio path to another sampling rate. It is called by the data out task, when the source changes its rate.
+ * @param frequency the sampling rate (Hz), a multiple of 10 Hz
+ * @return false if the request could not be queued
+ */
+bool AudioService::setFrequency(uint32_t frequency)
+{
+  AudioServiceCmd cmd = { CMD_SET_FREQUENCY, 0, (uint16_t) (frequency / 10) };
+  return globalServices->getOal()->sendMessageToQueue(controlMessageQueue, &cmd, 0);
+}
+
+/**
+ * Sets up the resampler for the rates of the current source and sink. It runs in the control task,
+ * as the filter table takes longer to calculate than an audio block lasts. A repeated request for the
+ * setup the resampler already has is skipped.
+ */
+void AudioService::configureResampler()
+{
+  auto systemConfig = globalServices->getSystemConfiguration();
+  auto filterConfig = systemConfig->getFilterConfiguration();
+
+  if (resamplerReady && audioSrc && audioSink && (resamplerSrc == audioSrc) && (resampler->getInputRate() == audioSrc->getFrequency())
+      && (resampler->getOutputRate() == audioSink->getFrequency()))
+  {
+    return;
+  }
+
+  resamplerReady = false;
+
+  if (audioSrc && audioSink)
+  {
+    if (!resampler)
+    {
+      resampler = new Resampler(&filterConfig->resamplerConfig, systemConfig->getMaxBlockFrames());
+    }
+
+    // Only sources with their own clock drift against the sink
+    bool tracking = filterConfig->resamplerConfig.driftTracking && (audioSrc->getBufferedSamples() >= 0);
+
+    resamplerSrc = audioSrc;
+    resamplerFillTarget = -1.0f;
+    resamplerReady = resampler->init(audioSrc->getFrequency(), audioSink->getFrequency(), tracking);
+  }
+}
+
 void AudioService::prevTrack(AudioChangeSrc acs)
 {
 //NOT SUPPORTED
 }
 
+/**
+ * Converts the USB volume control value to a volume level
+ * @param usbVolume -1024 to 1024
+ * @return 0 to 0xFF
+ */
+static int32_t usbVolumeToLevel(int16_t usbVolume)
+{
+#if LOGARITHMIC_GAIN_ENABLED == 1
+  // Received value is between -1024 to 1024, so we perform a log conversion
+  int32_t val = 0xFF;
+  if (usbVolume > -1024)
+  {
+    val = 2 * (int32_t) (0.5f + 60.0f * log10fApprox(2048.0f / (float32_t) (usbVolume + 1024)));
+  }
+  return 0xFF - std::min<int32_t>(0xFF, val);
+#else
+  // Received value is between -1024 to 1024, so we convert to 0 to 255
+  return std::min<int32_t>(0xFF, ((usbVolume + 1024) & 0xFFFF) >> 3);
+#endif
+}
+
+/**
+ * Checks if a command is dropped when it follows the previous one within 200 ms.
+ * Reconfigurations are never dropped and, when the volume is digital, neither are absolute volume and mute
+ * settings, so that the last one always takes effect.
+ * @param cmd
+ * @return
+ */
+static bool isDebounced(uint8_t cmd)
+{
+  if ((cmd == CMD_RECONF_SINK) || (cmd == CMD_RECONF_FILTERS) || (cmd == CMD_SET_FREQUENCY) || (cmd == CMD_CONFIGURE_RESAMPLER)
+      || (cmd == CMD_SET_STANDBY))
+  {
+    return false;
+  }
+
+#if DIGITAL_VOLUME_ENABLED == 1
+  if ((cmd == CMD_SET_VOL) || (cmd == CMD_SET_USB_VOL) || (cmd == CMD_SET_MUTE))
+  {
+    return false;
+  }
+#endif
+
+  return true;
+}
+
 /**
  * This is the audio control loop that handles the audio playback and volume commands
  */
@@ -287,7 +414,7 @@ void AudioService::taskControlLoop()
     }
 
     now = xTaskGetTickCount();
-    if ((cmd.cmd != CMD_RECONF_SINK) && ((now - 200) < lastActionTs))
+    if (isDebounced(cmd.cmd) && ((now - 200) < lastActionTs))
     {
       continue;
     }
@@ -301,6 +428,12 @@ void AudioService::taskControlLoop()
         audioSrc->doAction(audioActive ? Action::START : Action::STOP);
         audioSink->doAction(audioActive ? Action::START : Action::STOP);
 
+        // Starting the sink wakes the amps from a standby. The data out task starts its standby handling over,
+        // and requests the standby again if the input is still silent.
+        outputStandby = false;
+        standbyReset = true;
+        audioLoad.standby = false;
+
         if (audioMode == AudioMode::AM_I2S_SLAVE && audioActive)
         {
           osTimerStart(detectI2sStop, 200);
@@ -310,12 +443,17 @@ void AudioService::taskControlLoop()
 
       case CMD_VOL_UP_DOWN:
         case CMD_SET_VOL:
+        case CMD_SET_USB_VOL:
         globalServices->getSystemStatus()->reportStatus(OperationalStatus::OPS_AUDIO_VOL);
 
         if (cmd.cmd == CMD_VOL_UP_DOWN)
         {
           audioGain += (int16_t) cmd.arg;
         }
+        else if (cmd.cmd == CMD_SET_USB_VOL)
+        {
+          audioGain = usbVolumeToLevel((int16_t) cmd.arg);
+        }
         else
         {
           audioGain = (int16_t) cmd.arg;
@@ -329,12 +467,22 @@ void AudioService::taskControlLoop()
         {
           audioGain = 0xFF;
         }
+
+#if DIGITAL_VOLUME_ENABLED == 1
+        audioFilters->setVolume((uint8_t) audioGain);
+#else
         audioSink->setVolume((uint8_t) audioGain);
+#endif
         break;
 
       case CMD_SET_MUTE:
         globalServices->getSystemStatus()->reportStatus(OperationalStatus::OPS_AUDIO_VOL);
+
+#if DIGITAL_VOLUME_ENABLED == 1
+        audioFilters->setMute((bool) cmd.arg);
+#else
         audioSink->mute((bool) cmd.arg);
+#endif
         break;
 
       case CMD_SKIP_PREV:
@@ -345,12 +493,59 @@ void AudioService::taskControlLoop()
         break;
 
       case CMD_RECONF_FILTERS:
-        audioFilters->init();
+        audioFilters->reconfigure();
         break;
 
       case CMD_RECONF_SINK:
         audioSink->doAction(Action::RESET);
         break;
+
+      case CMD_SET_FREQUENCY:
+      {
+        // The sink restarts at the new rate and the filters are rebuilt for it. The new chain takes over with the first block.
+        // A repeated request for the rate the sink already runs at is skipped.
+        auto systemConfig = globalServices->getSystemConfiguration();
+        bool restartSink = audioActive && audioSink;
+
+        if (restartSink && (audioSink->getFrequency() == (uint32_t) cmd.arg * 10))
+        {
+          break;
+        }
+
+        if (restartSink)
+        {
+          audioSink->doAction(Action::STOP);
+        }
+
+        if (systemConfig->setFrequency((uint32_t) cmd.arg * 10))
+        {
+          audioFilters->setSampleRate((float32_t) systemConfig->getFrequency(), systemConfig->getBlockFrames());
+          audioFilters->reconfigure();
+        }
+
+        if (restartSink)
+        {
+          audioSink->doAction(Action::START);
+        }
+        break;
+      }
+
+      case CMD_CONFIGURE_RESAMPLER:
+        configureResampler();
+        break;
+
+      case CMD_SET_STANDBY:
+        // A stopped sink has its output stages down already. A standby that the data out task has taken back
+        // while the request was queued is skipped. The data out task sees the new state only once the output
+        // stages are switched, so that it does not play the held audio into amps that are still starting up.
+        if (audioActive && audioSink && ((bool) cmd.arg != outputStandby) && ((bool) cmd.arg == standbyRequested))
+        {
+          audioSink->standby((bool) cmd.arg);
+          outputStandby = (bool) cmd.arg;
+        }
+
+        audioLoad.standby = outputStandby;
+        break;
     }
   }
 }
@@ -395,35 +590,104 @@ void AudioService::notifyMoreDataAvailable()
 void AudioService::taskDataOutLoop()
 {
   auto oal = globalServices->getOal();
-  uint32_t bufferingTime = globalServices->getSystemConfiguration()->getBufferingTIme();
+  auto systemConfig = globalServices->getSystemConfiguration();
+  auto filterConfig = systemConfig->getFilterConfiguration();
+  uint32_t maxBlockFrames = systemConfig->getMaxBlockFrames();
   int16_t *scratchBuf[STREAM_ID::MAX_STREAM_COUNT];
-  scratchBuf[STREAM_ID::STREAM_TWEETER] = new int16_t[bufferingTime * 48 * 2];
-  scratchBuf[STREAM_ID::STREAM_WOOFER] = new int16_t[bufferingTime * 48 * 2];
-  uint32_t len = 0;
+  scratchBuf[STREAM_ID::STREAM_TWEETER] = new int16_t[maxBlockFrames * 2];
+  scratchBuf[STREAM_ID::STREAM_WOOFER] = new int16_t[maxBlockFrames * 2];
+  int16_t *resampledBuf = new int16_t[maxBlockFrames * 2];
+  int16_t *heldBuf[STREAM_ID::MAX_STREAM_COUNT];
+  heldBuf[STREAM_ID::STREAM_TWEETER] = new int16_t[(maxBlockFrames + maxBlockFrames / WAKE_DRAIN_RATIO) * 2];
+  heldBuf[STREAM_ID::STREAM_WOOFER] = new int16_t[(maxBlockFrames + maxBlockFrames / WAKE_DRAIN_RATIO) * 2];
+
+  uint32_t holdLen = SpscFifo<int16_t>::roundSize(maxBlockFrames * 2 * WAKE_HOLD_BLOCKS);
+  wakeHold[STREAM_ID::STREAM_TWEETER] = new SpscFifo<int16_t>(new int16_t[holdLen], holdLen);
+  wakeHold[STREAM_ID::STREAM_WOOFER] = new SpscFifo<int16_t>(new int16_t[holdLen], holdLen);
+
+  // The filter states of this task decay through the subnormal range after every song
+  enable_flush_to_zero();
+
+  // The cycle counter times the blocks for the load measurement
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->LAR = 0xC5ACCE55;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
   while (1)
   {
     rxTaskHandle = xTaskGetCurrentTaskHandle();
     oal->waitForTaskNotification(-1);
 
+    uint32_t startCycles = DWT->CYCCNT;
+
     if (audioSrc && audioSink)
     {
-      //TODO: We are assuming that both source and sink run at the same frequency. We need to make this dynamic.
-      if (!len)
+      uint32_t sinkFrequency = audioSink->getFrequency();
+      uint32_t srcFrequency = audioSrc->getFrequency();
+      uint32_t len = systemConfig->getBlockFrames(sinkFrequency) * 2;
+
+      bool resample = (srcFrequency != sinkFrequency) && (srcFrequency > 0)
+          && (!systemConfig->isFrequencySupported(srcFrequency) || filterConfig->resamplerConfig.resampleSupportedRates);
+      bool resamplerSetUp = resamplerReady && (resamplerSrc == audioSrc) && (resampler->getInputRate() == srcFrequency)
+          && (resampler->getOutputRate() == sinkFrequency);
+
+      // A source at another supported rate gets the sink switched over by the control task, a source at any other rate
+      // gets the resampler set up for it. Until then, the sink plays silence. Both are requested again every
+      // CONTROL_RETRY_BLOCKS blocks until they have happened, in case the request was lost in a full queue.
+      if ((srcFrequency != sinkFrequency) && (!resample || !resamplerSetUp))
       {
-        uint32_t sinkFrequency = audioSink->getFrequency();
-        len = sinkFrequency * bufferingTime * 2 / 1000;
+        if (resample && (!resamplerRequested || (++resamplerRetryBlocks >= CONTROL_RETRY_BLOCKS)))
+        {
+          AudioServiceCmd cmd = { CMD_CONFIGURE_RESAMPLER, 0, 0 };
+          resamplerRequested = oal->sendMessageToQueue(controlMessageQueue, &cmd, 0);
+          resamplerRetryBlocks = 0;
+        }
+        else if (!resample && ((srcFrequency != requestedFrequency) || (++frequencyRetryBlocks >= CONTROL_RETRY_BLOCKS)))
+        {
+          requestedFrequency = setFrequency(srcFrequency) ? srcFrequency : 0;
+          frequencyRetryBlocks = 0;
+        }
+
+        // Held blocks are of the old rate
+        wakeHold[STREAM_ID::STREAM_TWEETER]->reset(nullptr, 0);
+        wakeHold[STREAM_ID::STREAM_WOOFER]->reset(nullptr, 0);
+
+        memset(scratchBuf[STREAM_ID::STREAM_TWEETER], 0, len * sizeof(int16_t));
+        memset(scratchBuf[STREAM_ID::STREAM_WOOFER], 0, len * sizeof(int16_t));
+        audioSink->enqueueData((uint16_t*) scratchBuf[STREAM_ID::STREAM_TWEETER], len, (uint32_t) System::SaiInterface::TWEETER);
+        audioSink->enqueueData((uint16_t*) scratchBuf[STREAM_ID::STREAM_WOOFER], len, (uint32_t) System::SaiInterface::WOOFER);
+        publishOutput(scratchBuf, len);
+        updateAudioLoad(startCycles, len / 2, sinkFrequency, false);
+        continue;
       }
 
-      int16_t *dataIn = (int16_t*) audioSrc->getData(len);
+      requestedFrequency = sinkFrequency;
+      resamplerRequested = false;
+      audioSrc->setFillTracking(resample && resampler->isTracking());
+
+      int16_t *dataIn = resample ? resampleData(resampledBuf, len) : (int16_t*) audioSrc->getData(len);
       if (dataIn)
       {
-        audioFilters->run(dataIn, scratchBuf);
+        // Once the filters put out digital silence for a silent input, the scratch buffers keep it,
+        // and are played again without running the filters until the input has a sample that is not zero
+        bool bypassed = silenceDetector->processInput(dataIn, len / 2, (float32_t) sinkFrequency);
 
-        audioSink->enqueueData((uint16_t*) scratchBuf[STREAM_ID::STREAM_TWEETER], len, (uint32_t) System::SaiInterface::TWEETER);
-        audioSink->enqueueData((uint16_t*) scratchBuf[STREAM_ID::STREAM_WOOFER], len, (uint32_t) System::SaiInterface::WOOFER);
+        if (!bypassed)
+        {
+          audioFilters->run(dataIn, scratchBuf);
+          silenceDetector->processOutput(scratchBuf, len / 2);
+        }
+
+        enqueueOutput(scratchBuf, len, heldBuf, sinkFrequency);
 
-        audioSrc->consumedData(len);
+        if (!resample)
+        {
+          audioSrc->consumedData(len);
+        }
+
+        updateStandby();
+        updateAudioLoad(startCycles, len / 2, sinkFrequency, bypassed);
       }
       else
       {
@@ -433,6 +697,227 @@ void AudioService::taskDataOutLoop()
   }
 }
 
+/**
+ * Requests the standby of the output stages from the control task once the input has been silent
+ * for the standby delay, and the wake-up with the first block that is not silent. The request is level-triggered:
+ * until the control task reports the outputs in the wanted state, it is sent again every CONTROL_RETRY_BLOCKS
+ * blocks, so that a request lost in a full queue does not leave the amps shut down while the audio plays.
+ */
+void AudioService::updateStandby()
+{
+  bool standby = silenceDetector->isStandbyDue();
+
+  if (standbyReset)
+  {
+    standbyReset = false;
+    standbyRequested = false;
+    standbyRetryBlocks = 0;
+  }
+
+  if (standby == outputStandby)
+  {
+    standbyRequested = standby;
+    return;
+  }
+
+  standbyRetryBlocks++;
+
+  if ((standby != standbyRequested) || (standbyRetryBlocks >= CONTROL_RETRY_BLOCKS))
+  {
+    AudioServiceCmd cmd = { CMD_SET_STANDBY, 0, (uint16_t) standby };
+
+    standbyRequested = standby;
+    standbyRetryBlocks = globalServices->getOal()->sendMessageToQueue(controlMessageQueue, &cmd, 0) ? 0 : CONTROL_RETRY_BLOCKS;
+  }
+}
+
+/**
+ * Sends a block of the output streams to the sink and the output taps. When the audio returns while the output stages
+ * are in standby, the blocks are held back and the sink plays silence until the control task reports the outputs up;
+ * the held blocks are then played first, so that the onset is not clipped. The delay that this adds is drained again
+ * while the audio plays: blocks of digital silence are not held, and one frame in WAKE_DRAIN_RATIO is merged with the
+ * next, so the delay is gone after WAKE_DRAIN_RATIO times its length at the latest. A wake-up that takes longer than
+ * the hold loses the oldest blocks.
+ * @param pSrc the tweeter and woofer streams
+ * @param length samples of the block (for all channels)
+ * @param pHeld buffers for the tweeter and woofer blocks played out of the hold, with room for the merged frames
+ * @param frequency sampling rate of the block
+ */
+void AudioService::enqueueOutput(int16_t *pSrc[2], uint32_t length, int16_t *pHeld[2], uint32_t frequency)
+{
+  int16_t **pOut = pSrc;
+  bool standby = outputStandby;
+  bool holding = (wakeHold[STREAM_ID::STREAM_TWEETER]->getSampleCount() > 0);
+
+  if (!holding && standby && !silenceDetector->isStandbyDue())
+  {
+    holding = true;
+    waking = true;
+    wakeStartCycles = DWT->CYCCNT;
+  }
+
+  if (holding)
+  {
+    bool awake = !standby;
+    bool drop = awake && is_zero_pcm16_block(pSrc[STREAM_ID::STREAM_TWEETER], length)
+        && is_zero_pcm16_block(pSrc[STREAM_ID::STREAM_WOOFER], length);
+
+    for (uint32_t stream = 0; stream < STREAM_ID::MAX_STREAM_COUNT; stream++)
+    {
+      SpscFifo<int16_t> *hold = wakeHold[stream];
+
+      if (!drop)
+      {
+        if (hold->getCapacity() < length)
+        {
+          hold->consumeBuffer(length - hold->getCapacity());
+        }
+        hold->pushBuffer(pSrc[stream], length);
+      }
+
+      uint32_t held = hold->getSampleCount();
+      if (awake && waking)
+      {
+        audioLoad.wakeUpTime = (DWT->CYCCNT - wakeStartCycles) / (SystemCoreClock / 1000000);
+        audioLoad.wakeLatency = (uint32_t) (((uint64_t) held / 2) * 1000000 / frequency);
+        waking = false;
+      }
+
+      // Frames merged in this block, as far as the hold has frames beyond the block
+      uint32_t merged = awake ? std::min(length / 2 / WAKE_DRAIN_RATIO, (held - std::min(held, length)) / 2) : 0;
+      uint32_t played = awake ? hold->popBuffer(pHeld[stream], length + merged * 2) : 0;
+
+      int16_t *pDst = pHeld[stream];
+      int16_t *pHeldSrc = pHeld[stream];
+      for (uint32_t frame = 0; merged > 0; frame++)
+      {
+        if ((frame % WAKE_DRAIN_RATIO) == (WAKE_DRAIN_RATIO - 1))
+        {
+          pDst[0] = (int16_t) (((int32_t) pHeldSrc[0] + pHeldSrc[2]) >> 1);
+          pDst[1] = (int16_t) (((int32_t) pHeldSrc[1] + pHeldSrc[3]) >> 1);
+          pHeldSrc += 2;
+          played -= 2;
+          merged--;
+        }
+        else
+        {
+          pDst[0] = pHeldSrc[0];
+          pDst[1] = pHeldSrc[1];
+        }
+        pDst += 2;
+        pHeldSrc += 2;
+      }
+      if (pDst != pHeldSrc)
+      {
+        memmove(pDst, pHeldSrc, (played - (uint32_t) (pDst - pHeld[stream])) * sizeof(int16_t));
+      }
+
+      memset(&pHeld[stream][played], 0, (length - played) * sizeof(int16_t));
+    }
+
+    pOut = pHeld;
+  }
+
+  audioSink->enqueueData((uint16_t*) pOut[STREAM_ID::STREAM_TWEETER], length, (uint32_t) System::SaiInterface::TWEETER);
+  audioSink->enqueueData((uint16_t*) pOut[STREAM_ID::STREAM_WOOFER], length, (uint32_t) System::SaiInterface::WOOFER);
+  publishOutput(pOut, length);
+}
+
+/**
+ * Copies a block of the output streams into the output taps that have readers. The readers never hold the data
+ * out task up: one that falls behind loses the oldest samples.
+ * @param pSrc the tweeter and woofer streams
+ * @param length samples of the block (for all channels)
+ */
+void AudioService::publishOutput(int16_t *pSrc[2], uint32_t length)
+{
+  if (outputTaps[SaiInterface::TWEETER]->hasReaders())
+  {
+    outputTaps[SaiInterface::TWEETER]->pushBuffer(pSrc[STREAM_ID::STREAM_TWEETER], length);
+  }
+
+  if (outputTaps[SaiInterface::WOOFER]->hasReaders())
+  {
+    outputTaps[SaiInterface::WOOFER]->pushBuffer(pSrc[STREAM_ID::STREAM_WOOFER], length);
+  }
+}
+
+/**
+ * Adds a block to the load measurement, and publishes the measurement once it covers one second of audio
+ * @param startCycles the cycle counter when the task woke up for the block
+ * @param frames
+ * @param frequency the sampling rate of the block (Hz)
+ * @param bypassed true if the filters were skipped
+ */
+void AudioService::updateAudioLoad(uint32_t startCycles, uint32_t frames, uint32_t frequency, bool bypassed)
+{
+  uint32_t cycles = DWT->CYCCNT - startCycles;
+  uint64_t periodCycles = (uint64_t) SystemCoreClock * frames / frequency;
+
+  if (periodCycles == 0)
+  {
+    return;
+  }
+
+  loadCycles += cycles;
+  loadPeriodCycles += periodCycles;
+  loadPeak = std::max<uint32_t>(loadPeak, (uint32_t) ((uint64_t) cycles * 10000 / periodCycles));
+  loadBlocks++;
+  loadBypassedBlocks += bypassed;
+
+  if (loadPeriodCycles >= SystemCoreClock)
+  {
+    audioLoad.averageLoad = (uint32_t) (loadCycles * 10000 / loadPeriodCycles);
+    audioLoad.peakLoad = loadPeak;
+    audioLoad.blocks = loadBlocks;
+    audioLoad.bypassedBlocks = loadBypassedBlocks;
+
+    loadCycles = 0;
+    loadPeriodCycles = 0;
+    loadPeak = 0;
+    loadBlocks = 0;
+    loadBypassedBlocks = 0;
+  }
+}
+
+/**
+ * Converts one block from the rate of the source to the rate of the sink. The source is read in its own chunks,
+ * as many as the resampler needs, and its fill level trims the ratio of sources with their own clock.
+ * @param pDst the resampled block, interleaved stereo
+ * @param length samples of the block (for all channels)
+ * @return pDst, or nullptr if the source has stopped
+ */
+int16_t* AudioService::resampleData(int16_t *pDst, uint32_t length)
+{
+  uint32_t srcLength = globalServices->getSystemConfiguration()->getBlockFrames(audioSrc->getFrequency()) * 2;
+
+  while (resampler->getMissingFrames(length / 2) > 0)
+  {
+    int16_t *srcData = (int16_t*) audioSrc->getData(srcLength);
+
+    if (!srcData || !resampler->write(srcData, srcLength / 2))
+    {
+      return nullptr;
+    }
+
+    audioSrc->consumedData(srcLength);
+  }
+
+  if (resampler->isTracking())
+  {
+    float32_t bufferedFrames = (float32_t) audioSrc->getBufferedSamples() / 2.0f + resampler->getBufferedFrames();
+
+    if (resamplerFillTarget < 0.0f)
+    {
+      resamplerFillTarget = bufferedFrames;
+    }
+    resampler->trackFillLevel(bufferedFrames - resamplerFillTarget, length / 2);
+  }
+
+  resampler->run(pDst, length / 2);
+  return pDst;
+}
+
 /**
  * This is the audio data in loop that handles the audio data in processing
  */
@@ -494,20 +979,21 @@ void AudioService::timeoutEvent()
 }
 
 /**
- * Returns the audio out cycles
+ * Returns the number of frames played out, for the USB feedback. The rate must not change while they are counted,
+ * which holds for the USB input as it always runs at its descriptor rate.
  * @param resetCounter
  * @return
  */
-uint32_t AudioService::getAudioOutCycles(bool resetCounter)
+uint32_t AudioService::getAudioOutFrames(bool resetCounter)
 {
-  uint32_t samples = audioOutCycles;
+  uint32_t cycles = audioOutCycles;
 
   if (resetCounter)
   {
     audioOutCycles = 0;
   }
 
-  return samples;
+  return cycles * globalServices->getSystemConfiguration()->getBlockFrames();
 }
 
 }
@@ -31,7 +31,10 @@
 //
 //====================================================================
 
+#include <algorithm>
+#include <cmath>
 #include "BiquadFilters.hpp"
+#include "Utilities/MathUtils.hpp"
 
 /**
  * Initialises a 2-channel chain of biquad filters
@@ -47,47 +50,468 @@ BiquadFilters::BiquadFilters(float32_t *coeffLeft, float32_t *coeffRight, uint32
 }
 
 /**
- * Initialises the internal state of the filter chains
+ * Compiles a cascade into the stages that actually filter. Identity stages are dropped wherever they are,
+ * and gain-only stages (b1 = b2 = a1 = a2 = 0) are merged and folded into the numerator of the next
+ * biquad stage, or of the last one at the end of the cascade. A cascade of gain-only stages becomes a
+ * single stage.
+ * @param coeffs b0, b1, b2, a1, a2 per stage, may be nullptr
+ * @param compiled receives the remaining stages, in the same layout
+ * @param origin receives the index of the configured stage of each remaining stage
+ * @return the number of remaining stages
  */
-void BiquadFilters::init()
+uint32_t BiquadFilters::compileStages(const float32_t *coeffs, float32_t *compiled, uint8_t *origin)
 {
-  for (int num = 0; num < PcmChannel::MAX_CHANNELS; num++)
+  uint32_t stages = 0;
+  float32_t gain = 1.0f;
+
+  if (!coeffs)
+  {
+    return 0;
+  }
+
+  for (uint32_t i = 0; i < NUMSTAGES; i++)
   {
-    if (!coefficients[num])
+    const float32_t *c = &coeffs[i * 5];
+
+    if (c[1] == 0.0f && c[2] == 0.0f && c[3] == 0.0f && c[4] == 0.0f)
     {
+      gain *= c[0];
       continue;
     }
 
-    uint32_t stages = NUMSTAGES;
-    for (uint32_t i = 0; i < NUMSTAGES; i++)
+    float32_t *stage = &compiled[stages * 5];
+    stage[0] = c[0] * gain;
+    stage[1] = c[1] * gain;
+    stage[2] = c[2] * gain;
+    stage[3] = c[3];
+    stage[4] = c[4];
+    origin[stages] = (uint8_t) i;
+    gain = 1.0f;
+    stages++;
+  }
+
+  if (gain != 1.0f)
+  {
+    if (stages == 0)
+    {
+      compiled[0] = gain;
+      compiled[1] = compiled[2] = compiled[3] = compiled[4] = 0.0f;
+      origin[0] = NO_STAGE_ORIGIN;
+      return 1;
+    }
+
+    float32_t *last = &compiled[(stages - 1) * 5];
+    last[0] *= gain;
+    last[1] *= gain;
+    last[2] *= gain;
+  }
+
+  return stages;
+}
+
+/**
+ * Sets the sampling rate the filters run at. When it differs from the rate the coefficients were designed for,
+ * init() remaps the coefficients, so that the filters keep their response in Hz. It takes effect on the next init().
+ * @param designRateHz the rate of the configured coefficients
+ * @param sampleRateHz the audio sampling rate
+ */
+void BiquadFilters::setSampleRate(float32_t designRateHz, float32_t sampleRateHz)
+{
+  designRate = designRateHz;
+  sampleRate = sampleRateHz;
+}
+
+/**
+ * Remaps a compiled stage from the design rate to the sampling rate. The stage is taken back to the analog
+ * domain and discretised again (bilinear transform), prewarped at the angle of its poles so that the centre
+ * frequency of a peak/notch or the corner of a shelf stays in place. Stages with real poles (1st order, low/high
+ * pass with Q <= 0.5) are mapped without prewarping, which is exact up to a few kHz. The poles of low frequency
+ * stages sit close to z = 1, so the mapping is calculated in double precision.
+ * @param stage b0, b1, b2, a1, a2, with a1 and a2 negated (CMSIS convention)
+ */
+void BiquadFilters::remapStage(float32_t *stage) const
+{
+  const double ratio = (double) designRate / (double) sampleRate;
+  const double num[3] = { stage[0], stage[1], stage[2] };
+  const double den[3] = { 1.0, -stage[3], -stage[4] };
+  double r = 1.0 / ratio;
+
+  // Complex poles: keep the pole angle at the same frequency, unless it moves beyond the new Nyquist
+  if (den[1] * den[1] < 4.0 * den[2])
+  {
+    double angle = acos(std::min(std::max(-den[1] / (2.0 * sqrt(den[2])), -1.0), 1.0));
+    double mappedAngle = std::min(angle * ratio, 0.95 * M_PI);
+
+    r = tan(angle / 2.0) / tan(mappedAngle / 2.0);
+  }
+
+  // With u = z^-1 of the new rate, the old z^-1 becomes N / D, N = (1 - r) + (1 + r)u, D = (1 + r) + (1 - r)u.
+  // Both polynomials are multiplied by D^2, which cancels out.
+  const double p = 1.0 + r;
+  const double m = 1.0 - r;
+  double mappedNum[3];
+  double mappedDen[3];
+
+  for (uint32_t i = 0; i < 2; i++)
+  {
+    const double *c = (i == 0) ? num : den;
+    double *mapped = (i == 0) ? mappedNum : mappedDen;
+
+    mapped[0] = c[0] * p * p + c[1] * p * m + c[2] * m * m;
+    mapped[1] = 2.0 * (c[0] + c[2]) * p * m + c[1] * (p * p + m * m);
+    mapped[2] = c[0] * m * m + c[1] * p * m + c[2] * p * p;
+  }
+
+  stage[0] = (float32_t) (mappedNum[0] / mappedDen[0]);
+  stage[1] = (float32_t) (mappedNum[1] / mappedDen[0]);
+  stage[2] = (float32_t) (mappedNum[2] / mappedDen[0]);
+  stage[3] = (float32_t) (-mappedDen[1] / mappedDen[0]);
+  stage[4] = (float32_t) (-mappedDen[2] / mappedDen[0]);
+}
+
+/**
+ * Compiles the coefficients and initialises the internal state of the filter chains
+ * @param engine selects between separate DF1 cascades per channel and a single interleaved stereo cascade (DF2T or Q31)
+ */
+void BiquadFilters::init(System::FilterEngine engine)
+{
+  for (int num = 0; num < PcmChannel::MAX_CHANNELS; num++)
+  {
+    activeStages[num] = compileStages(coefficients[num], compiledCoefficients[num], stageOrigin[num]);
+
+    for (uint32_t stage = 0; stage < activeStages[num] && designRate > 0.0f && sampleRate > 0.0f && designRate != sampleRate; stage++)
+    {
+      float32_t *c = &compiledCoefficients[num][stage * 5];
+
+      // A gain-only stage is the same at any rate
+      if (c[1] != 0.0f || c[2] != 0.0f || c[3] != 0.0f || c[4] != 0.0f)
+      {
+        remapStage(c);
+      }
+    }
+
+    arm_biquad_cascade_df1_init_f32(&filter[num], activeStages[num], compiledCoefficients[num], filter_state[num]);
+    stateZero[num] = true;
+  }
+
+  stereoStages = 0;
+  q31Stages = 0;
+
+  if (engine == System::FilterEngine::FILTER_ENGINE_STEREO_DF2T)
+  {
+    initStereo();
+  }
+  else if (engine == System::FilterEngine::FILTER_ENGINE_Q31)
+  {
+    initStereo();
+    initQ31();
+  }
+}
+
+/**
+ * Packs the coefficients of both channels into left/right pairs. The shorter chain is
+ * padded with identity stages, so that both channels run through the same number of stages.
+ */
+void BiquadFilters::initStereo()
+{
+  const uint32_t *stages = activeStages;
+
+  stereoStages = std::max<uint32_t>(stages[PcmChannel::LEFT], stages[PcmChannel::RIGHT]);
+
+  for (uint32_t stage = 0; stage < NUMSTAGES; stage++)
+  {
+    for (int num = 0; num < PcmChannel::MAX_CHANNELS; num++)
     {
-      if (coefficients[num][i * 5] == 1.0f
-          && coefficients[num][i * 5 + 1] == 0.0f
-          && coefficients[num][i * 5 + 2] == 0.0f
-          && coefficients[num][i * 5 + 3] == 0.0f)
+      for (uint32_t coeff = 0; coeff < 5; coeff++)
       {
-        stages = i;
-        break;
+        float32_t identity = (coeff == 0) ? 1.0f : 0.0f;
+        stereoCoefficients[stage][coeff * 2 + num] = (stage < stages[num]) ? compiledCoefficients[num][stage * 5 + coeff] : identity;
       }
     }
+  }
 
-    arm_biquad_cascade_df1_init_f32(&filter[num], stages, coefficients[num], filter_state[num]);
+  memset(stereoState, 0, sizeof(stereoState));
+  stereoStateZero = true;
+}
+
+/**
+ * Converts the packed stereo coefficients to Q31. Each stage is scaled by the smallest power of two
+ * that brings all of its coefficients into the [-1, 1) range, e.g. b1 = -1.9 is stored as -0.95 with a
+ * shift of 30 instead of 31. Must be called after initStereo().
+ */
+void BiquadFilters::initQ31()
+{
+  q31Stages = stereoStages;
+  stereoStages = 0;
+
+  for (uint32_t stage = 0; stage < NUMSTAGES; stage++)
+  {
+    float32_t maxCoeff = 0.0f;
+
+    for (uint32_t coeff = 0; coeff < 10; coeff++)
+    {
+      maxCoeff = std::max(maxCoeff, std::abs(stereoCoefficients[stage][coeff]));
+    }
+
+    uint32_t postShift = 0;
+    while (maxCoeff >= (float32_t) (1 << postShift) && postShift < 8)
+    {
+      postShift++;
+    }
+
+    q31Shift[stage] = 31 - postShift;
+
+    for (uint32_t coeff = 0; coeff < 10; coeff++)
+    {
+      q63_t value = (q63_t) roundf(ldexpf(stereoCoefficients[stage][coeff], q31Shift[stage]));
+      q31Coefficients[stage][coeff] = clip_q63_to_q31(value);
+    }
   }
+
+  memset(q31State, 0, sizeof(q31State));
 }
 
 /**
- * Receives a stereo stream and applies the biquad filters to each channel
+ * Receives a stereo stream and applies the biquad filters to each channel.
+ * The state is snapped to zero when it decays below DENORMAL_SNAP_LEVEL, and silence through a settled
+ * cascade is passed on as silence without running it.
  * @param pSrc
  * @param pDst
  */
 void BiquadFilters::run(PcmChannel channel, float32_t *pSrc, float32_t *pDst)
 {
-  if (coefficients[channel] && filter[channel].numStages > 0)
+  if (activeStages[channel] > 0)
   {
+    if (stateZero[channel] && is_zero_block(pSrc, blockSize, 1))
+    {
+      if (pSrc != pDst)
+      {
+        memset(pDst, 0, blockSize * sizeof(float32_t));
+      }
+      return;
+    }
+
     arm_biquad_cascade_df1_f32(&filter[channel], pSrc, pDst, blockSize);
+    stateZero[channel] = snap_to_zero_block(filter_state[channel], 4 * activeStages[channel]);
   }
   else if (pSrc != pDst)
   {
 	memcpy(pDst, pSrc, blockSize * sizeof(float));
   }
 }
+
+/**
+ * Receives an interleaved stereo stream and applies the biquad filters of both channels in a
+ * single pass per stage (transposed direct form II). The feedback coefficients follow the CMSIS
+ * convention, i.e. a1 and a2 are already negated. Must be initialised with FILTER_ENGINE_STEREO_DF2T.
+ * The state is snapped to zero like in run().
+ * @param pSrc interleaved left/right samples
+ * @param pDst interleaved left/right samples, may be the same as pSrc
+ */
+void BiquadFilters::runStereo(const float32_t *pSrc, float32_t *pDst)
+{
+  if (stereoStages == 0)
+  {
+    if (pSrc != pDst)
+    {
+      memcpy(pDst, pSrc, 2 * blockSize * sizeof(float));
+    }
+    return;
+  }
+
+  if (stereoStateZero && is_zero_block(pSrc, 2 * blockSize, 1))
+  {
+    if (pSrc != pDst)
+    {
+      memset(pDst, 0, 2 * blockSize * sizeof(float32_t));
+    }
+    return;
+  }
+
+  const float32_t *pIn = pSrc;
+
+  for (uint32_t stage = 0; stage < stereoStages; stage++)
+  {
+    const float32_t *c = stereoCoefficients[stage];
+    float32_t b0L = c[0], b0R = c[1];
+    float32_t b1L = c[2], b1R = c[3];
+    float32_t b2L = c[4], b2R = c[5];
+    float32_t a1L = c[6], a1R = c[7];
+    float32_t a2L = c[8], a2R = c[9];
+
+    float32_t d1L = stereoState[stage][0];
+    float32_t d1R = stereoState[stage][1];
+    float32_t d2L = stereoState[stage][2];
+    float32_t d2R = stereoState[stage][3];
+
+    for (uint32_t i = 0; i < blockSize; i++)
+    {
+      float32_t xL = pIn[i * 2];
+      float32_t xR = pIn[i * 2 + 1];
+
+      float32_t yL = b0L * xL + d1L;
+      float32_t yR = b0R * xR + d1R;
+
+      d1L = b1L * xL + a1L * yL + d2L;
+      d1R = b1R * xR + a1R * yR + d2R;
+
+      d2L = b2L * xL + a2L * yL;
+      d2R = b2R * xR + a2R * yR;
+
+      pDst[i * 2] = yL;
+      pDst[i * 2 + 1] = yR;
+    }
+
+    stereoState[stage][0] = d1L;
+    stereoState[stage][1] = d1R;
+    stereoState[stage][2] = d2L;
+    stereoState[stage][3] = d2R;
+
+    pIn = pDst;
+  }
+
+  stereoStateZero = snap_to_zero_block(&stereoState[0][0], 4 * stereoStages);
+}
+
+/**
+ * Receives an interleaved stereo stream of Q31 samples and applies the biquad filters of both channels in a
+ * single pass per stage (direct form I, 64bit accumulator, truncated and saturated at the output of every stage).
+ * The bits that the truncation drops are added to the accumulator of the next sample (first-order error feedback).
+ * Plain rounding leaves the low-frequency sections stuck at a DC offset inside their deadband once the input
+ * is silent, which reached the woofer as a constant -2 LSB.
+ * Must be initialised with FILTER_ENGINE_Q31.
+ * @param pSrc interleaved left/right samples
+ * @param pDst interleaved left/right samples, may be the same as pSrc
+ */
+void BiquadFilters::runStereoQ31(const q31_t *pSrc, q31_t *pDst)
+{
+  if (q31Stages == 0)
+  {
+    if (pSrc != pDst)
+    {
+      memcpy(pDst, pSrc, 2 * blockSize * sizeof(q31_t));
+    }
+    return;
+  }
+
+  const q31_t *pIn = pSrc;
+
+  for (uint32_t stage = 0; stage < q31Stages; stage++)
+  {
+    const q31_t *c = q31Coefficients[stage];
+    const uint32_t shift = q31Shift[stage];
+    q31_t b0L = c[0], b0R = c[1];
+    q31_t b1L = c[2], b1R = c[3];
+    q31_t b2L = c[4], b2R = c[5];
+    q31_t a1L = c[6], a1R = c[7];
+    q31_t a2L = c[8], a2R = c[9];
+
+    q31_t *s = q31State[stage];
+    q31_t x1L = s[0], x1R = s[1], x2L = s[2], x2R = s[3];
+    q31_t y1L = s[4], y1R = s[5], y2L = s[6], y2R = s[7];
+    q31_t eL = s[8], eR = s[9];
+
+    for (uint32_t i = 0; i < blockSize; i++)
+    {
+      q31_t xL = pIn[i * 2];
+      q31_t xR = pIn[i * 2 + 1];
+
+      q63_t accL = eL + (q63_t) b0L * xL + (q63_t) b1L * x1L + (q63_t) b2L * x2L + (q63_t) a1L * y1L + (q63_t) a2L * y2L;
+      q63_t accR = eR + (q63_t) b0R * xR + (q63_t) b1R * x1R + (q63_t) b2R * x2R + (q63_t) a1R * y1R + (q63_t) a2R * y2R;
+
+      q31_t yL = clip_q63_to_q31(accL >> shift);
+      q31_t yR = clip_q63_to_q31(accR >> shift);
+
+      eL = (q31_t) (accL & (((q63_t) 1 << shift) - 1));
+      eR = (q31_t) (accR & (((q63_t) 1 << shift) - 1));
+
+      x2L = x1L;
+      x1L = xL;
+      y2L = y1L;
+      y1L = yL;
+
+      x2R = x1R;
+      x1R = xR;
+      y2R = y1R;
+      y1R = yR;
+
+      pDst[i * 2] = yL;
+      pDst[i * 2 + 1] = yR;
+    }
+
+    s[0] = x1L;
+    s[1] = x1R;
+    s[2] = x2L;
+    s[3] = x2R;
+    s[4] = y1L;
+    s[5] = y1R;
+    s[6] = y2L;
+    s[7] = y2R;
+    s[8] = eL;
+    s[9] = eR;
+
+    pIn = pDst;
+  }
+}
+
+/**
+ * Returns the compiled stage of a channel that comes from a configured stage
+ * @param channel
+ * @param origin index of the configured stage
+ * @return the index of the compiled stage, -1 if the configured stage was dropped
+ */
+int32_t BiquadFilters::findStage(PcmChannel channel, uint8_t origin) const
+{
+  for (uint32_t stage = 0; stage < activeStages[channel] && origin != NO_STAGE_ORIGIN; stage++)
+  {
+    if (stageOrigin[channel][stage] == origin)
+    {
+      return (int32_t) stage;
+    }
+  }
+
+  return -1;
+}
+
+/**
+ * Continues from the sample history of another filter chain, which may have different coefficients.
+ * The history follows the configured stages: identity and gain-only stages are dropped by compileStages(), so
+ * the same band may sit at another compiled stage in each chain. Stages that the other chain does not run start
+ * from zero. Both chains must use the same engine.
+ * @param other
+ */
+void BiquadFilters::inheritState(const BiquadFilters &other)
+{
+  memset(filter_state, 0, sizeof(filter_state));
+  memset(stereoState, 0, sizeof(stereoState));
+  memset(q31State, 0, sizeof(q31State));
+
+  for (int num = 0; num < PcmChannel::MAX_CHANNELS; num++)
+  {
+    for (uint32_t stage = 0; stage < activeStages[num]; stage++)
+    {
+      int32_t from = other.findStage((PcmChannel) num, stageOrigin[num][stage]);
+
+      if (from < 0)
+      {
+        continue;
+      }
+
+      memcpy(&filter_state[num][stage * 4], &other.filter_state[num][from * 4], 4 * sizeof(float32_t));
+
+      // The stereo engines keep the channels interleaved, left in the even and right in the odd entries
+      for (uint32_t i = num; i < 4; i += 2)
+      {
+        stereoState[stage][i] = other.stereoState[from][i];
+      }
+      for (uint32_t i = num; i < 10; i += 2)
+      {
+        q31State[stage][i] = other.q31State[from][i];
+      }
+    }
+  }
+
+  stateZero[PcmChannel::LEFT] = false;
+  stateZero[PcmChannel::RIGHT] = false;
+  stereoStateZero = false;
+}
@@ -34,8 +34,10 @@
 #pragma once
 
 #include "arm_math.h"
+#include "Controllers/System/pub/FilterConfiguration.hpp"
 
 #define NUMSTAGES 8
+#define NO_STAGE_ORIGIN 0xFF   //!< A compiled stage that is not one of the configured stages
 
 enum PcmChannel
 {
@@ -58,10 +60,54 @@ private:
   arm_biquad_casd_df1_inst_f32 filter[MAX_CHANNELS];
   float32_t filter_state[MAX_CHANNELS][4 * NUMSTAGES];
   float32_t *coefficients[MAX_CHANNELS];
+  float32_t compiledCoefficients[MAX_CHANNELS][5 * NUMSTAGES];    //!< The stages that remain after compileStages(), per channel
+  uint32_t activeStages[MAX_CHANNELS] = { 0, 0 };
+  uint8_t stageOrigin[MAX_CHANNELS][NUMSTAGES];   //!< The configured stage each compiled stage comes from, per channel
+  bool stateZero[MAX_CHANNELS] = { true, true };  //!< The DF1 state of the channel is all zero, so silence passes through as silence
+
+  uint32_t stereoStages = 0;
+  float32_t stereoCoefficients[NUMSTAGES][10];    //!< Left/right pairs of b0, b1, b2, a1, a2 per stage
+  float32_t stereoState[NUMSTAGES][4];            //!< Left/right pairs of d1, d2 per stage
+  bool stereoStateZero = true;
+
+  uint32_t q31Stages = 0;
+  q31_t q31Coefficients[NUMSTAGES][10];           //!< Left/right pairs of b0, b1, b2, a1, a2 per stage, scaled by q31Shift
+  uint32_t q31Shift[NUMSTAGES];                   //!< Right shift of the accumulator, restoring the coefficient scaling
+  q31_t q31State[NUMSTAGES][10];                  //!< Left/right pairs of x[n-1], x[n-2], y[n-1], y[n-2] and the accumulator error per stage
+
+  float32_t designRate = 0.0f;                    //!< The rate the coefficients were designed for, 0 if they are used as they are
+  float32_t sampleRate = 0.0f;                    //!< The rate the coefficients are remapped to
+
+  uint32_t compileStages(const float32_t *coeffs, float32_t *compiled, uint8_t *origin);
+  void remapStage(float32_t *stage) const;
+  void initStereo();
+  void initQ31();
+  int32_t findStage(PcmChannel channel, uint8_t origin) const;
 
 public:
   BiquadFilters(float32_t *coeffLeft, float32_t *coeffRight, uint32_t blockSize);
 
-  void init();
+  void init(System::FilterEngine engine = System::FilterEngine::FILTER_ENGINE_DF1);
+  void setSampleRate(float32_t designRateHz, float32_t sampleRateHz);
   void run(PcmChannel channel, float32_t *pSrc, float32_t *pDst);
+  void runStereo(const float32_t *pSrc, float32_t *pDst);
+  void runStereoQ31(const q31_t *pSrc, q31_t *pDst);
+  void inheritState(const BiquadFilters &other);
+
+  /**
+   * Sets the number of frames of the next blocks, up to the block size given to the constructor
+   * @param frames
+   */
+  void setBlockSize(uint32_t frames)
+  {
+    blockSize = frames;
+  }
+
+  /**
+   * @return true if no stage remains in either channel, i.e. the filters would only copy the samples
+   */
+  bool isBypassed() const
+  {
+    return activeStages[PcmChannel::LEFT] == 0 && activeStages[PcmChannel::RIGHT] == 0;
+  }
 };
@@ -0,0 +1,217 @@
+//====================================================================
+//
+// COPYRIGHT 2020 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: complementary Linkwitz-Riley crossover
+//  Filename: Crossover.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#include "Crossover.hpp"
+#include <algorithm>
+#include <cmath>
+#include "Utilities/MathUtils.hpp"
+
+#define Q31_COEFF_FRACTION_BITS   30      //!< The Q31 coefficients are in Q2.30, as |a1| may reach 2
+
+/**
+ * Default constructor of the crossover class
+ */
+Crossover::Crossover(System::CrossoverConfiguration *config, uint32_t blockSize) :
+    config(config),
+    blockSize(blockSize)
+{
+}
+
+/**
+ * Calculates the filter coefficients (bilinear transform with pre-warping) and resets the state
+ */
+void Crossover::init()
+{
+  float32_t frequency = std::min(std::max(config->frequencyHz, 10.0f), 0.45f * config->sampleRateHz);
+  float32_t k = tanf(PI * frequency / config->sampleRateHz);
+  float32_t norm = 1.0f / (1.0f + sqrtf(2.0f) * k + k * k);
+
+  gain = k * k * norm;
+  a1 = 2.0f * (k * k - 1.0f) * norm;
+  a2 = (1.0f - sqrtf(2.0f) * k + k * k) * norm;
+
+  q31Gain = (q31_t) roundf(ldexpf(gain, Q31_COEFF_FRACTION_BITS));
+  q31A1 = (q31_t) roundf(ldexpf(a1, Q31_COEFF_FRACTION_BITS));
+  q31A2 = (q31_t) roundf(ldexpf(a2, Q31_COEFF_FRACTION_BITS));
+
+  memset(state, 0, sizeof(state));
+  memset(q31State, 0, sizeof(q31State));
+  stateZero[PcmChannel::LEFT] = true;
+  stateZero[PcmChannel::RIGHT] = true;
+}
+
+/**
+ * Splits one channel. The high band may be written in place of the source.
+ * The state is snapped to zero when it decays below DENORMAL_SNAP_LEVEL, and silence through a settled
+ * channel is split into silence without running the sections.
+ * @param channel
+ * @param pSrc
+ * @param pLow receives the woofer band
+ * @param pHigh receives the tweeter band
+ * @param stride distance between consecutive samples of the channel (1 for separate buffers, 2 for interleaved)
+ */
+void Crossover::runChannel(PcmChannel channel, const float32_t *pSrc, float32_t *pLow, float32_t *pHigh, uint32_t stride)
+{
+  if (stateZero[channel] && is_zero_block(pSrc, blockSize, stride))
+  {
+    for (uint32_t i = 0; i < blockSize * stride; i += stride)
+    {
+      pLow[i] = 0.0f;
+      pHigh[i] = 0.0f;
+    }
+    return;
+  }
+
+  float32_t w1 = state[channel][0];
+  float32_t w2 = state[channel][1];
+  float32_t v1 = state[channel][2];
+  float32_t v2 = state[channel][3];
+
+  for (uint32_t i = 0; i < blockSize * stride; i += stride)
+  {
+    // Shared poles (direct form II): 1st low pass section and the allpass
+    float32_t w = pSrc[i] - a1 * w1 - a2 * w2;
+    float32_t low = gain * (w + 2.0f * w1 + w2);
+    float32_t allpass = a2 * w + a1 * w1 + w2;
+    w2 = w1;
+    w1 = w;
+
+    // 2nd low pass section
+    float32_t v = low - a1 * v1 - a2 * v2;
+    low = gain * (v + 2.0f * v1 + v2);
+    v2 = v1;
+    v1 = v;
+
+    pLow[i] = low;
+    pHigh[i] = allpass - low;
+  }
+
+  state[channel][0] = w1;
+  state[channel][1] = w2;
+  state[channel][2] = v1;
+  state[channel][3] = v2;
+  stateZero[channel] = snap_to_zero_block(state[channel], 4);
+}
+
+/**
+ * Splits one channel of an interleaved Q31 stream, using direct form I sections with a 64bit accumulator.
+ * The 2nd low pass section reads the output history of the 1st one, and the allpass reads the input history.
+ * @param channel
+ * @param pSrc
+ * @param pLow receives the woofer band
+ * @param pHigh receives the tweeter band
+ */
+void Crossover::runChannelQ31(PcmChannel channel, const q31_t *pSrc, q31_t *pLow, q31_t *pHigh)
+{
+  const q63_t round = (q63_t) 1 << (Q31_COEFF_FRACTION_BITS - 1);
+  q31_t *s = q31State[channel];
+  q31_t x1 = s[0], x2 = s[1];
+  q31_t m1 = s[2], m2 = s[3];
+  q31_t ap1 = s[4], ap2 = s[5];
+  q31_t y1 = s[6], y2 = s[7];
+
+  for (uint32_t i = 0; i < blockSize * 2; i += 2)
+  {
+    q31_t x = pSrc[i];
+
+    q63_t acc = round + (q63_t) q31Gain * ((q63_t) x + 2 * (q63_t) x1 + x2) - (q63_t) q31A1 * m1 - (q63_t) q31A2 * m2;
+    q31_t m = clip_q63_to_q31(acc >> Q31_COEFF_FRACTION_BITS);
+
+    acc = round + (q63_t) q31A2 * x + (q63_t) q31A1 * x1 + ((q63_t) x2 << Q31_COEFF_FRACTION_BITS) - (q63_t) q31A1 * ap1 - (q63_t) q31A2 * ap2;
+    q31_t ap = clip_q63_to_q31(acc >> Q31_COEFF_FRACTION_BITS);
+
+    acc = round + (q63_t) q31Gain * ((q63_t) m + 2 * (q63_t) m1 + m2) - (q63_t) q31A1 * y1 - (q63_t) q31A2 * y2;
+    q31_t y = clip_q63_to_q31(acc >> Q31_COEFF_FRACTION_BITS);
+
+    x2 = x1;
+    x1 = x;
+    m2 = m1;
+    m1 = m;
+    ap2 = ap1;
+    ap1 = ap;
+    y2 = y1;
+    y1 = y;
+
+    pLow[i] = y;
+    pHigh[i] = clip_q63_to_q31((q63_t) ap - y);
+  }
+
+  s[0] = x1;
+  s[1] = x2;
+  s[2] = m1;
+  s[3] = m2;
+  s[4] = ap1;
+  s[5] = ap2;
+  s[6] = y1;
+  s[7] = y2;
+}
+
+/**
+ * Splits separate left/right channel buffers into woofer and tweeter bands
+ */
+void Crossover::run(const float32_t *pSrcLeft, const float32_t *pSrcRight, float32_t *pLowLeft, float32_t *pLowRight,
+    float32_t *pHighLeft, float32_t *pHighRight)
+{
+  runChannel(PcmChannel::LEFT, pSrcLeft, pLowLeft, pHighLeft, 1);
+  runChannel(PcmChannel::RIGHT, pSrcRight, pLowRight, pHighRight, 1);
+}
+
+/**
+ * Splits an interleaved stereo stream into interleaved woofer and tweeter bands
+ */
+void Crossover::runInterleaved(const float32_t *pSrc, float32_t *pLow, float32_t *pHigh)
+{
+  runChannel(PcmChannel::LEFT, pSrc, pLow, pHigh, 2);
+  runChannel(PcmChannel::RIGHT, pSrc + 1, pLow + 1, pHigh + 1, 2);
+}
+
+/**
+ * Splits an interleaved stereo Q31 stream into interleaved woofer and tweeter bands
+ */
+void Crossover::runInterleavedQ31(const q31_t *pSrc, q31_t *pLow, q31_t *pHigh)
+{
+  runChannelQ31(PcmChannel::LEFT, pSrc, pLow, pHigh);
+  runChannelQ31(PcmChannel::RIGHT, pSrc + 1, pLow + 1, pHigh + 1);
+}
+
+/**
+ * Continues from the filter states of another crossover, which may split at a different frequency
+ * @param other
+ */
+void Crossover::inheritState(const Crossover &other)
+{
+  memcpy(state, other.state, sizeof(state));
+  memcpy(q31State, other.q31State, sizeof(q31State));
+  stateZero[PcmChannel::LEFT] = false;
+  stateZero[PcmChannel::RIGHT] = false;
+}
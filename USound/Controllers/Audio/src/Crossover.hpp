@@ -0,0 +1,84 @@
+//====================================================================
+//
+// COPYRIGHT 2020 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: complementary Linkwitz-Riley crossover
+//  Filename: Crossover.hpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#pragma once
+
+#include "arm_math.h"
+#include "Controllers/System/pub/FilterConfiguration.hpp"
+#include "BiquadFilters.hpp"
+
+/**
+ * This class splits a stereo stream into complementary woofer/tweeter bands in a single pass.
+ * The LR4 low pass is a cascade of two Butterworth sections, and the high pass is derived from it as
+ * the difference between a 2nd order allpass (the sum of both LR4 bands) and the low pass. The allpass
+ * shares the poles of the first section, so both bands cost about as much as one 4th order filter.
+ */
+class Crossover
+{
+private:
+  System::CrossoverConfiguration *config;
+  uint32_t blockSize;
+
+  float32_t gain = 0.0f;                          //!< Butterworth low pass numerator gain, i.e. g * (1 + 2z^-1 + z^-2)
+  float32_t a1 = 0.0f;                            //!< Butterworth denominator 1 + a1 z^-1 + a2 z^-2
+  float32_t a2 = 0.0f;
+  float32_t state[MAX_CHANNELS][4];               //!< w[n-1], w[n-2] of the shared section, v[n-1], v[n-2] of the second low pass section
+  bool stateZero[MAX_CHANNELS] = { true, true };  //!< The state of the channel is all zero, so silence splits into silence
+
+  q31_t q31Gain = 0;                              //!< The coefficients above, in Q2.30
+  q31_t q31A1 = 0;
+  q31_t q31A2 = 0;
+  q31_t q31State[MAX_CHANNELS][8];                //!< x, 1st low pass, allpass and low pass output history, [n-1] and [n-2] each
+
+  void runChannel(PcmChannel channel, const float32_t *pSrc, float32_t *pLow, float32_t *pHigh, uint32_t stride);
+  void runChannelQ31(PcmChannel channel, const q31_t *pSrc, q31_t *pLow, q31_t *pHigh);
+
+public:
+  Crossover(System::CrossoverConfiguration *config, uint32_t blockSize);
+
+  void init();
+  void run(const float32_t *pSrcLeft, const float32_t *pSrcRight, float32_t *pLowLeft, float32_t *pLowRight,
+      float32_t *pHighLeft, float32_t *pHighRight);
+  void runInterleaved(const float32_t *pSrc, float32_t *pLow, float32_t *pHigh);
+  void runInterleavedQ31(const q31_t *pSrc, q31_t *pLow, q31_t *pHigh);
+  void inheritState(const Crossover &other);
+
+  /**
+   * Sets the number of frames of the next blocks, up to the block size given to the constructor
+   * @param frames
+   */
+  void setBlockSize(uint32_t frames)
+  {
+    blockSize = frames;
+  }
+};
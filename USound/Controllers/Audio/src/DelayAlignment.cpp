@@ -0,0 +1,326 @@
+//====================================================================
+//
+// COPYRIGHT 2020 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: per-output delay for the time alignment of the drivers
+//  Filename: DelayAlignment.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+
+#include "DelayAlignment.hpp"
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+#include "Utilities/MathUtils.hpp"
+
+/**
+ * Default constructor of the delay class. The arena is allocated by init(), for the delays of the configuration.
+ * @param config
+ * @param blockSize the largest number of frames per block
+ */
+DelayAlignment::DelayAlignment(const System::DelayConfiguration *config, uint32_t blockSize) :
+    config(config),
+    maxBlockSize(blockSize),
+    blockSize(blockSize)
+{
+}
+
+/**
+ * Splits the delays of the configuration into whole samples and allpass fractions, and clears the lines.
+ * Delays of at least one sample keep a fraction between 0.5 and 1.5 samples, where the Thiran allpass is the most accurate.
+ * The arena is only reallocated when it grows, so it is called by the control task, on a chain the audio task does not run.
+ * @return false if the stage is bypassed: it is disabled or no line is delayed
+ */
+bool DelayAlignment::init()
+{
+  uint32_t longest = 0;
+
+  bypassed = true;
+
+  for (uint32_t line = 0; line < DELAY_LINES; line++)
+  {
+    float32_t samples = config->enabled ? config->delayDuration[line] * config->sampleRateHz : 0.0f;
+
+    samples = std::min(std::max(samples, 0.0f), (float32_t) DELAY_MAX_SAMPLES);
+
+    if (fabsf(samples - roundf(samples)) < DELAY_MIN_FRACTION)
+    {
+      delays[line] = (uint32_t) roundf(samples);
+      fractions[line] = 0.0f;
+    }
+    else
+    {
+      delays[line] = (samples < 1.5f) ? 0 : (uint32_t) floorf(samples - 0.5f);
+      fractions[line] = samples - (float32_t) delays[line];
+    }
+
+    allpassCoeffs[line] = (1.0f - fractions[line]) / (1.0f + fractions[line]);
+    longest = std::max(longest, delays[line]);
+    bypassed &= (delays[line] == 0) && (fractions[line] == 0.0f);
+  }
+
+  if (bypassed || blockSize == 0)
+  {
+    bypassed = true;
+    return false;
+  }
+
+  lineLength = longest + blockSize;
+
+  if (DELAY_LINES * lineLength > allocatedSize)
+  {
+    delete[] arena;
+
+    arena = new float32_t[DELAY_LINES * lineLength];
+    allocatedSize = DELAY_LINES * lineLength;
+  }
+
+  reset();
+  return true;
+}
+
+/**
+ * Clears the lines and the allpass states
+ */
+void DelayAlignment::reset()
+{
+  if (bypassed)
+  {
+    return;
+  }
+
+  memset(arena, 0, DELAY_LINES * lineLength * sizeof(float32_t));
+  memset(allpassInput, 0, sizeof(allpassInput));
+  memset(allpassOutput, 0, sizeof(allpassOutput));
+  writeIndex = 0;
+}
+
+/**
+ * Continues from the lines of another delay stage, which may have other delays: the newest samples of its lines
+ * are taken over, as far as both lines reach.
+ * @param other
+ */
+void DelayAlignment::inheritState(const DelayAlignment &other)
+{
+  if (bypassed || other.bypassed)
+  {
+    return;
+  }
+
+  const uint32_t count = std::min(lineLength, other.lineLength);
+
+  for (uint32_t line = 0; line < DELAY_LINES; line++)
+  {
+    float32_t *pDst = getLine(line);
+    const float32_t *pSrc = other.getLine(line);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+      pDst[(writeIndex + lineLength - count + i) % lineLength] = pSrc[(other.writeIndex + other.lineLength - count + i) % other.lineLength];
+    }
+  }
+
+  memcpy(allpassInput, other.allpassInput, sizeof(allpassInput));
+  memcpy(allpassOutput, other.allpassOutput, sizeof(allpassOutput));
+}
+
+/**
+ * Returns the first sample of a line in the arena
+ * @param line
+ */
+float32_t *DelayAlignment::getLine(uint32_t line) const
+{
+  return arena + line * lineLength;
+}
+
+/**
+ * Adds a block of float samples to a line
+ * @param line XoverEqCoeffcientType of the output
+ * @param pSrc
+ * @param stride 1 for separate channel buffers, 2 for interleaved ones
+ */
+void DelayAlignment::writeInput(uint32_t line, const float32_t *pSrc, uint32_t stride)
+{
+  if (getDelay(line) == 0.0f)
+  {
+    return;
+  }
+
+  float32_t *pLine = getLine(line);
+  const uint32_t first = std::min(blockSize, lineLength - writeIndex);
+
+  for (uint32_t i = 0; i < first; i++)
+  {
+    pLine[writeIndex + i] = pSrc[i * stride];
+  }
+
+  for (uint32_t i = first; i < blockSize; i++)
+  {
+    pLine[i - first] = pSrc[i * stride];
+  }
+}
+
+/**
+ * Adds a block of Q31 samples to a line
+ * @param line XoverEqCoeffcientType of the output
+ * @param pSrc
+ * @param stride 2 for interleaved buffers
+ * @param scale Q31 to float scaling
+ */
+void DelayAlignment::writeInput(uint32_t line, const q31_t *pSrc, uint32_t stride, float32_t scale)
+{
+  if (getDelay(line) == 0.0f)
+  {
+    return;
+  }
+
+  float32_t *pLine = getLine(line);
+  const uint32_t first = std::min(blockSize, lineLength - writeIndex);
+
+  for (uint32_t i = 0; i < first; i++)
+  {
+    pLine[writeIndex + i] = (float32_t) pSrc[i * stride] * scale;
+  }
+
+  for (uint32_t i = first; i < blockSize; i++)
+  {
+    pLine[i - first] = (float32_t) pSrc[i * stride] * scale;
+  }
+}
+
+/**
+ * Reads the delayed block of a line, in at most two spans, through the allpass if the delay has a fraction
+ * @param line
+ * @param store called with the frame index and the output sample
+ */
+template<typename Store>
+void DelayAlignment::readLine(uint32_t line, Store store)
+{
+  const float32_t *pLine = getLine(line);
+  const uint32_t start = (writeIndex + lineLength - delays[line]) % lineLength;
+  const uint32_t first = std::min(blockSize, lineLength - start);
+
+  if (fractions[line] == 0.0f)
+  {
+    for (uint32_t i = 0; i < first; i++)
+    {
+      store(i, pLine[start + i]);
+    }
+
+    for (uint32_t i = first; i < blockSize; i++)
+    {
+      store(i, pLine[i - first]);
+    }
+
+    return;
+  }
+
+  const float32_t a = allpassCoeffs[line];
+  float32_t x1 = allpassInput[line];
+  float32_t y1 = allpassOutput[line];
+
+  // y[n] = a * x[n] + x[n-1] - a * y[n-1], with a single multiply-subtract on the recursive path
+  auto allpass = [&](uint32_t i, float32_t x)
+  {
+    y1 = (a * x + x1) - a * y1;
+    x1 = x;
+    store(i, y1);
+  };
+
+  for (uint32_t i = 0; i < first; i++)
+  {
+    allpass(i, pLine[start + i]);
+  }
+
+  for (uint32_t i = first; i < blockSize; i++)
+  {
+    allpass(i, pLine[i - first]);
+  }
+
+  allpassInput[line] = x1;
+  allpassOutput[line] = y1;
+  snap_to_zero_block(&allpassOutput[line], 1);
+}
+
+/**
+ * Writes the delayed block of a line, after its input block was added by writeInput()
+ * @param line XoverEqCoeffcientType of the output
+ * @param pDst may be the source of writeInput()
+ * @param stride 1 for separate channel buffers, 2 for interleaved ones
+ */
+void DelayAlignment::readOutput(uint32_t line, float32_t *pDst, uint32_t stride)
+{
+  if (getDelay(line) == 0.0f)
+  {
+    return;
+  }
+
+  readLine(line, [pDst, stride](uint32_t i, float32_t value)
+  {
+    pDst[i * stride] = value;
+  });
+}
+
+/**
+ * Writes the delayed block of a line, saturated to Q31, after its input block was added by writeInput()
+ * @param line XoverEqCoeffcientType of the output
+ * @param pDst may be the source of writeInput()
+ * @param stride 2 for interleaved buffers
+ * @param fullScale float to Q31 scaling
+ */
+void DelayAlignment::readOutput(uint32_t line, q31_t *pDst, uint32_t stride, float32_t fullScale)
+{
+  if (getDelay(line) == 0.0f)
+  {
+    return;
+  }
+
+  readLine(line, [pDst, stride, fullScale](uint32_t i, float32_t value)
+  {
+    pDst[i * stride] = clip_q63_to_q31((q63_t) roundf(value * fullScale));
+  });
+}
+
+/**
+ * Moves the lines on by one block, after all the lines of the block are read
+ */
+void DelayAlignment::nextBlock()
+{
+  if (!bypassed)
+  {
+    writeIndex = (writeIndex + blockSize) % lineLength;
+  }
+}
+
+/**
+ * Returns the bytes of the arena
+ */
+uint32_t DelayAlignment::getMemorySize() const
+{
+  return allocatedSize * sizeof(float32_t);
+}
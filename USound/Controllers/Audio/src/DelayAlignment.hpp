@@ -0,0 +1,117 @@
+//====================================================================
+//
+// COPYRIGHT 2020 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: per-output delay for the time alignment of the drivers
+//  Filename: DelayAlignment.hpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+
+#pragma once
+
+#include "arm_math.h"
+#include "Controllers/System/pub/FilterConfiguration.hpp"
+
+#define DELAY_LINES           4         //!< One per output, in XoverEqCoeffcientType order
+#define DELAY_MAX_SAMPLES     1920      //!< 20 ms at 96 kHz, 40 ms at 48 kHz
+#define DELAY_MIN_FRACTION    0.001f    //!< Fractions of a sample below it are rounded away
+
+/**
+ * This class delays each output by a whole and a fractional number of samples, so that drivers with
+ * different acoustic centres (e.g. a MEMS tweeter in front of a dynamic woofer) are time aligned.
+ *
+ * The whole samples are circular delay lines. All the lines share one arena of DELAY_LINES lines of
+ * lineLength samples, the longest delay plus one block, so each block is written and read back in at
+ * most two contiguous spans. The fraction is a first order Thiran allpass, with a flat magnitude response
+ * and a maximally flat group delay, for one multiply and two additions per sample.
+ *
+ * A block is processed with writeInput() then readOutput() for each line, which may work in place, then nextBlock().
+ * Lines without a delay are skipped.
+ */
+class DelayAlignment
+{
+private:
+  const System::DelayConfiguration *config;
+  uint32_t maxBlockSize;
+  uint32_t blockSize;
+
+  uint32_t delays[DELAY_LINES] = { 0 };               //!< Whole samples of the delay of each line
+  float32_t fractions[DELAY_LINES] = { 0.0f };        //!< Fraction of the delay, done by the allpass. 0 for whole delays
+  float32_t allpassCoeffs[DELAY_LINES] = { 0.0f };    //!< (1 - fraction) / (1 + fraction)
+  float32_t allpassInput[DELAY_LINES] = { 0.0f };     //!< x[n-1] of the allpass
+  float32_t allpassOutput[DELAY_LINES] = { 0.0f };    //!< y[n-1] of the allpass
+
+  float32_t *arena = nullptr;                         //!< DELAY_LINES x lineLength samples
+  uint32_t allocatedSize = 0;                         //!< Samples of the arena
+  uint32_t lineLength = 0;
+  uint32_t writeIndex = 0;                            //!< Position of the current block in every line
+  bool bypassed = true;
+
+  float32_t *getLine(uint32_t line) const;
+  template<typename Store> void readLine(uint32_t line, Store store);
+
+public:
+  DelayAlignment(const System::DelayConfiguration *config, uint32_t blockSize);
+
+  bool init();
+  void reset();
+  void inheritState(const DelayAlignment &other);
+
+  void writeInput(uint32_t line, const float32_t *pSrc, uint32_t stride);
+  void writeInput(uint32_t line, const q31_t *pSrc, uint32_t stride, float32_t scale);
+  void readOutput(uint32_t line, float32_t *pDst, uint32_t stride);
+  void readOutput(uint32_t line, q31_t *pDst, uint32_t stride, float32_t fullScale);
+  void nextBlock();
+
+  uint32_t getMemorySize() const;
+
+  /**
+   * Sets the number of frames per block, up to the block size given to the constructor. It takes effect on the next init().
+   */
+  void setBlockSize(uint32_t frames)
+  {
+    blockSize = (frames < maxBlockSize) ? frames : maxBlockSize;
+  }
+
+  /**
+   * Returns true if no line is delayed, or the stage is disabled
+   */
+  bool isBypassed() const
+  {
+    return bypassed;
+  }
+
+  /**
+   * Returns the delay of a line in samples
+   * @param line XoverEqCoeffcientType of the output
+   */
+  float32_t getDelay(uint32_t line) const
+  {
+    return (float32_t) delays[line] + fractions[line];
+  }
+};
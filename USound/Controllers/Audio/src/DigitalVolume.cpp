@@ -0,0 +1,86 @@
+//====================================================================
+//
+// COPYRIGHT 2020 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: digital volume and mute
+//  Filename: DigitalVolume.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+
+#include "DigitalVolume.hpp"
+#include "Utilities/MathUtils.hpp"
+
+/**
+ * Default constructor of the digital volume class. The volume starts at 0 dB, like the DACs.
+ */
+DigitalVolume::DigitalVolume() :
+    level(DIGITAL_VOLUME_LEVELS - 1),
+    muted(false)
+{
+  for (uint32_t i = 0; i < DIGITAL_VOLUME_LEVELS; i++)
+  {
+    gainTable[i] = -DIGITAL_VOLUME_STEP_DB * (float32_t) (DIGITAL_VOLUME_LEVELS - 1 - i);
+  }
+
+  db_to_lin_block(gainTable, gainTable, DIGITAL_VOLUME_LEVELS);
+  gainTable[0] = 0.0f;
+  gainTable[DIGITAL_VOLUME_LEVELS - 1] = 1.0f;
+}
+
+/**
+ * Sets the volume. It is called by the control task and takes effect at the next block.
+ * @param level 0 (mute) to 255 (0 dB)
+ */
+void DigitalVolume::setLevel(uint8_t level)
+{
+  this->level.store(level, std::memory_order_relaxed);
+}
+
+/**
+ * Mutes/unmutes the audio, without changing the volume level
+ * @param mute
+ */
+void DigitalVolume::setMute(bool mute)
+{
+  muted.store(mute, std::memory_order_relaxed);
+}
+
+/**
+ * Calculates the gain ramp of the next block. It is called by the audio task.
+ * @param frames the number of frames in the block
+ * @param startGain receives the gain of the first frame
+ * @param gainStep receives the change of the gain per frame
+ */
+void DigitalVolume::nextBlock(uint32_t frames, float32_t &startGain, float32_t &gainStep)
+{
+  float32_t targetGain = muted.load(std::memory_order_relaxed) ? 0.0f : gainTable[level.load(std::memory_order_relaxed)];
+
+  startGain = gain;
+  gainStep = (targetGain - gain) / (float32_t) frames;
+  gain = targetGain;
+}
@@ -0,0 +1,62 @@
+//====================================================================
+//
+// COPYRIGHT 2020 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: digital volume and mute
+//  Filename: DigitalVolume.hpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+
+#pragma once
+
+#include <atomic>
+#include "arm_math.h"
+
+#define DIGITAL_VOLUME_LEVELS     256       //!< Same range as the DAC attenuation registers, 0 mutes and 255 is 0 dB
+#define DIGITAL_VOLUME_STEP_DB    0.5f      //!< Attenuation per level, as in the DAC
+
+/**
+ * This class turns the volume and mute settings into a gain ramp per audio block.
+ * The control task sets the level and the mute state, and the audio task ramps the gain linearly
+ * from its current value to the new one over the next block, so that changes are click-free.
+ */
+class DigitalVolume
+{
+private:
+  float32_t gainTable[DIGITAL_VOLUME_LEVELS];   //!< Linear gain per level
+  std::atomic<uint32_t> level;
+  std::atomic<bool> muted;
+  float32_t gain = 1.0f;                        //!< Gain at the end of the last block
+
+public:
+  DigitalVolume();
+
+  void setLevel(uint8_t level);
+  void setMute(bool mute);
+  void nextBlock(uint32_t frames, float32_t &startGain, float32_t &gainStep);
+};
@@ -0,0 +1,205 @@
+//====================================================================
+//
+// COPYRIGHT 2020 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: double-buffered filter chains
+//  Filename: DoubleBufferedFilters.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+
+#include <algorithm>
+#include <cmath>
+#include "DoubleBufferedFilters.hpp"
+
+/**
+ * Default constructor of the double-buffered filters class
+ * @param sourceConfig the shared configuration, updated in place by the telemetry and the console
+ * @param blockSize
+ * @param crossfade true to crossfade from the old to the new chain over one block
+ */
+DoubleBufferedFilters::DoubleBufferedFilters(System::FilterConfiguration *sourceConfig, uint32_t blockSize, bool crossfade) :
+    sourceConfig(sourceConfig),
+    blockSize(blockSize),
+    crossfade(crossfade),
+    chainBlockSize(blockSize),
+    swapState(0)
+{
+  chainConfigs[0] = *sourceConfig;
+  chainConfigs[1] = *sourceConfig;
+
+  chains[0] = new AudioFilters(&chainConfigs[0], blockSize);
+  chains[1] = new AudioFilters(&chainConfigs[1], blockSize);
+
+  fadeSamples[STREAM_ID::STREAM_TWEETER] = new int16_t[blockSize * 2];
+  fadeSamples[STREAM_ID::STREAM_WOOFER] = new int16_t[blockSize * 2];
+}
+
+/**
+ * Initialises the first chain. It must be called before the audio task is started.
+ */
+void DoubleBufferedFilters::init()
+{
+  chainConfigs[0] = *sourceConfig;
+  chains[0]->setSampleRate(sampleRate, chainBlockSize);
+  chains[0]->init();
+  swapState.store(0, std::memory_order_release);
+}
+
+/**
+ * Rebuilds the standby chain from the shared configuration and publishes it to the audio task.
+ * It is called by the control task. A chain that was published but not picked up yet is replaced.
+ */
+void DoubleBufferedFilters::reconfigure()
+{
+  uint32_t state = swapState.load(std::memory_order_acquire);
+
+  // Take the standby chain back from the audio task. It may only be busy for the rest of one block.
+  while ((state & SWAP_BUSY) || !swapState.compare_exchange_weak(state, state & SWAP_ACTIVE_MASK, std::memory_order_acquire))
+  {
+    state = swapState.load(std::memory_order_acquire);
+  }
+
+  uint32_t standby = (state & SWAP_ACTIVE_MASK) ^ 1;
+
+  chainConfigs[standby] = *sourceConfig;
+  chains[standby]->setSampleRate(sampleRate, chainBlockSize);
+  chains[standby]->init();
+
+  swapState.store((state & SWAP_ACTIVE_MASK) | SWAP_PUBLISHED, std::memory_order_release);
+}
+
+/**
+ * Sets the sampling rate and the block size of the chains. It takes effect with the next init() or reconfigure(),
+ * which must follow before the audio task runs blocks of the new size.
+ * @param sampleRateHz the audio sampling rate, 0 to run at the rates of the configuration
+ * @param frames number of samples to process as a block, up to the block size given to the constructor
+ */
+void DoubleBufferedFilters::setSampleRate(float32_t sampleRateHz, uint32_t frames)
+{
+  sampleRate = sampleRateHz;
+  chainBlockSize = std::min(frames, blockSize);
+}
+
+/**
+ * Mixes the old chain output into the new one with a linear ramp over the block
+ * @param pDst the output of the new chain, updated in place
+ * @param frames
+ */
+void DoubleBufferedFilters::crossfadeStreams(int16_t *pDst[2], uint32_t frames)
+{
+  const float32_t step = 1.0f / (float32_t) frames;
+
+  for (uint32_t stream = 0; stream < STREAM_ID::MAX_STREAM_COUNT; stream++)
+  {
+    const int16_t *pOld = fadeSamples[stream];
+    int16_t *pNew = pDst[stream];
+    float32_t weight = step;
+
+    for (uint32_t i = 0; i < frames * 2; i += 2)
+    {
+      pNew[i] = (int16_t) lrintf(pOld[i] + (pNew[i] - pOld[i]) * weight);
+      pNew[i + 1] = (int16_t) lrintf(pOld[i + 1] + (pNew[i + 1] - pOld[i + 1]) * weight);
+      weight += step;
+    }
+  }
+}
+
+/**
+ * Runs the active chain. A published chain takes over at the start of the block, from the state of the active chain.
+ * After a change of the sampling rate, the new chain starts from silence instead, without a crossfade.
+ * It is called by the audio task and never waits for the control task.
+ * @param pSrc the input audio buffer with interleaved uint16_t samples
+ * @param pDst the output audio buffer with interleaved uint16_t samples
+ */
+void DoubleBufferedFilters::run(int16_t *pSrc, int16_t *pDst[2])
+{
+  uint32_t state = swapState.load(std::memory_order_acquire);
+  uint32_t active = state & SWAP_ACTIVE_MASK;
+  bool swap = (state & SWAP_PUBLISHED) && swapState.compare_exchange_strong(state, state | SWAP_BUSY, std::memory_order_acquire);
+  uint32_t next = swap ? active ^ 1 : active;
+  float32_t gain;
+  float32_t gainStep;
+
+  volume.nextBlock(chains[next]->getBlockSize(), gain, gainStep);
+  chains[0]->setOutputGain(gain, gainStep);
+  chains[1]->setOutputGain(gain, gainStep);
+
+  if (!swap)
+  {
+    chains[active]->run(pSrc, pDst);
+    return;
+  }
+
+  bool sameRate = (chains[next]->getBlockSize() == chains[active]->getBlockSize())
+      && (chains[next]->getSampleRate() == chains[active]->getSampleRate());
+
+  if (sameRate)
+  {
+    chains[next]->inheritState(*chains[active]);
+  }
+
+  if (crossfade && sameRate)
+  {
+    chains[active]->run(pSrc, fadeSamples);
+    chains[next]->run(pSrc, pDst);
+    crossfadeStreams(pDst, chains[next]->getBlockSize());
+  }
+  else
+  {
+    chains[next]->run(pSrc, pDst);
+  }
+
+  swapCount++;
+  swapState.store(next, std::memory_order_release);
+}
+
+/**
+ * Sets the digital volume, which ramps to the new level over the next block
+ * @param level 0 (mute) to 255 (0 dB), in DIGITAL_VOLUME_STEP_DB steps
+ */
+void DoubleBufferedFilters::setVolume(uint8_t level)
+{
+  volume.setLevel(level);
+}
+
+/**
+ * Mutes/unmutes the digital volume, with a ramp over the next block
+ * @param mute
+ */
+void DoubleBufferedFilters::setMute(bool mute)
+{
+  volume.setMute(mute);
+}
+
+/**
+ * @return the number of chain swaps done by the audio task
+ */
+uint32_t DoubleBufferedFilters::getSwapCount() const
+{
+  return swapCount;
+}
@@ -0,0 +1,87 @@
+//====================================================================
+//
+// COPYRIGHT 2020 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: double-buffered filter chains
+//  Filename: DoubleBufferedFilters.hpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+
+#pragma once
+
+#include <atomic>
+#include "arm_math.h"
+#include "Controllers/System/pub/FilterConfiguration.hpp"
+#include "AudioFilters.hpp"
+#include "DigitalVolume.hpp"
+
+/**
+ * This class keeps two filter chains, each one on its own copy of the filter configuration.
+ * The audio task runs the active chain, while the control task rebuilds the standby chain from
+ * the shared configuration and publishes it. The audio task picks the published chain up at the
+ * next block boundary, optionally crossfading from the old chain over that block, so neither
+ * the coefficients nor the filter states it uses are ever written while a block is processed.
+ * The digital volume is applied by whichever chain is running.
+ */
+class DoubleBufferedFilters
+{
+private:
+  enum SwapState : uint32_t
+  {
+    SWAP_ACTIVE_MASK = 1,           //!< Index of the chain run by the audio task
+    SWAP_PUBLISHED = 2,             //!< The standby chain is ready to take over
+    SWAP_BUSY = 4                   //!< The audio task is switching to the standby chain
+  };
+
+  System::FilterConfiguration *sourceConfig;
+  uint32_t blockSize;
+  bool crossfade;
+  float32_t sampleRate = 0.0f;      //!< Applied to each chain when it is rebuilt
+  uint32_t chainBlockSize;
+
+  System::FilterConfiguration chainConfigs[2];
+  AudioFilters *chains[2] = { nullptr, nullptr };
+  int16_t *fadeSamples[STREAM_ID::MAX_STREAM_COUNT] = { nullptr, nullptr };   //!< Output of the old chain during a crossfade
+  std::atomic<uint32_t> swapState;
+  uint32_t swapCount = 0;
+  DigitalVolume volume;
+
+  void crossfadeStreams(int16_t *pDst[2], uint32_t frames);
+
+public:
+  DoubleBufferedFilters(System::FilterConfiguration *sourceConfig, uint32_t blockSize, bool crossfade);
+
+  void init();
+  void reconfigure();
+  void setSampleRate(float32_t sampleRateHz, uint32_t frames);
+  void run(int16_t *pSrc, int16_t *pDst[2]);
+  void setVolume(uint8_t level);
+  void setMute(bool mute);
+
+  uint32_t getSwapCount() const;
+};
@@ -38,6 +38,8 @@
 #include "cmath"
 #include "Utilities/MathUtils.hpp"
 
+#define Q31_GAIN_FRACTION_BITS   27     //!< Fixed-point format of the gain in the Q31 path, allowing up to +24 dB make-up gain
+
 /**
  * Default constructor of the Dynamic range compressor class
  */
@@ -64,10 +66,98 @@ void Drc::init()
   lowPassDuration = std::max(0.002f, lowPassDuration);
   levelLowPassConst = expf(-1.0f / (lowPassDuration * drcConfig->sampleRateHz));
 
+  controlInterval = (drcConfig->controlInterval > 1) ? drcConfig->controlInterval : 1;
+  controlAttackConst = expf(-(float32_t) controlInterval / (drcConfig->attackDuration * drcConfig->sampleRateHz));
+  controlReleaseConst = expf(-(float32_t) controlInterval / (drcConfig->releaseDuration * drcConfig->sampleRateHz));
+  controlPhase = 0;
+  controlGain = 1.0f;
+  controlTargetGain = 1.0f;
+  controlGainStep = 0.0f;
+
   previousLevelLowPassPower = 1.0f;
   previousGainIndB = 0.0f;
 }
 
+/**
+ * Returns the linear gain that was applied to each frame of the last block
+ */
+const float32_t* Drc::getGain() const
+{
+  return gain;
+}
+
+/**
+ * Calculates the gain of each frame, either per sample or at the configured control rate
+ * @param peakBlock holds the peak sample of each frame (it gets modified in the function)
+ * @param gainBlock receives the linear gain values
+ */
+void Drc::calcGainFromPeaks(float32_t *peakBlock, float32_t *gainBlock)
+{
+  if (controlInterval > 1)
+  {
+    calcGainAtControlRate(peakBlock, gainBlock);
+    return;
+  }
+
+  calcAudioLevelInDb(peakBlock);
+  calcGain(peakBlock, gainBlock);
+}
+
+/**
+ * Calculates the gain at a decimated control rate. The signal power is still smoothed per sample,
+ * but the conversions to and from dB, the static curve and the attack/release smoothing only run
+ * once every controlInterval samples. The linear gain is interpolated in between, so it reaches each
+ * new target one interval later than the per-sample calculation would.
+ *
+ * @param peakBlock holds the peak sample of each frame
+ * @param gainBlock receives the linear gain values
+ */
+void Drc::calcGainAtControlRate(float32_t *peakBlock, float32_t *gainBlock)
+{
+  float32_t c1 = levelLowPassConst;
+  float32_t c2 = 1.0f - c1;
+
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    // first-order low-pass filter to get a running estimate of the average power
+    previousLevelLowPassPower = c1 * previousLevelLowPassPower + c2 * peakBlock[i] * peakBlock[i];
+
+    if (controlPhase == 0)
+    {
+      float32_t levelDb = 10.0f * log10fApprox(previousLevelLowPassPower) + 3.0f;
+      float32_t aboveThreshold = levelDb - drcConfig->compressionThresholdFullScaleDb;
+      float32_t gainDb = std::min(0.0f, aboveThreshold / drcConfig->compressionRatio - aboveThreshold);
+
+      if (gainDb < previousGainIndB)
+      {
+        previousGainIndB = controlAttackConst * previousGainIndB + (1.0f - controlAttackConst) * gainDb;
+      }
+      else
+      {
+        previousGainIndB = controlReleaseConst * previousGainIndB + (1.0f - controlReleaseConst) * gainDb;
+      }
+
+      controlGain = controlTargetGain;
+      controlTargetGain = pow10f((previousGainIndB + drcConfig->postGain) * (1.0f / 20.0f));
+      controlGainStep = (controlTargetGain - controlGain) / controlInterval;
+      controlPhase = controlInterval;
+    }
+
+    controlPhase--;
+    controlGain += controlGainStep;
+    gainBlock[i] = controlGain;
+  }
+
+  // The smoothed gain decays towards 0 dB through the denormal range; stop it once it is inaudible
+  snap_to_zero_block(&previousGainIndB, 1);
+
+  // Never go less than -130 dBFS
+  if (previousLevelLowPassPower < (1.0E-13))
+  {
+    previousLevelLowPassPower = 1.0E-13;
+  }
+}
+
 /**
  * This function runs the DRC algorithm in-place, on the provided audio samples
  */
@@ -79,8 +169,13 @@ void Drc::run(float32_t *pSrcLeft, float32_t *pSrcRight)
     return;
   }
 
-  calcAudioLevelInDb(pSrcLeft, pSrcRight, audioLevelDb);
-  calcGain(audioLevelDb, gain);
+  // Find the peak sample of each frame
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    audioLevelDb[i] = (abs(pSrcLeft[i]) > abs(pSrcRight[i])) ? pSrcLeft[i] : pSrcRight[i];
+  }
+
+  calcGainFromPeaks(audioLevelDb, gain);
 
   //apply the desired gain...store the processed audio back into audio_block
   arm_mult_f32(pSrcLeft, gain, pSrcLeft, blockSize);
@@ -88,21 +183,75 @@ void Drc::run(float32_t *pSrcLeft, float32_t *pSrcRight)
 }
 
 /**
- * This function estimates the level of the audio (in dB).
- * It squares the signal and low-pass filters to get a time-averaged signal power.
- * It holds the results in audioLevelDb.
- *
- * @param audioSrc the audio samples to be compressed
- * @param audioLevelDbBlock the estimated audio levels
+ * This function runs the DRC algorithm in-place, on interleaved left/right audio samples
+ */
+void Drc::runInterleaved(float32_t *pSrc)
+{
+  if (!drcConfig->enabled)
+  {
+    return;
+  }
+
+  // Find the peak sample of each frame
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    float32_t left = pSrc[i * 2];
+    float32_t right = pSrc[i * 2 + 1];
+    audioLevelDb[i] = (abs(left) > abs(right)) ? left : right;
+  }
+
+  calcGainFromPeaks(audioLevelDb, gain);
+
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    pSrc[i * 2] *= gain[i];
+    pSrc[i * 2 + 1] *= gain[i];
+  }
+}
+
+/**
+ * This function runs the DRC algorithm in-place, on interleaved left/right fixed-point samples.
+ * The level detection and the gain calculation stay in floating point, the gain is applied in fixed point.
+ * @param pSrc the interleaved samples
+ * @param scale converts a sample to the floating point full scale range
  */
-void Drc::calcAudioLevelInDb(const float32_t *pSrcLeft, const float32_t *pSrcRight, float32_t *audioLevelDbBlock)
+void Drc::runInterleavedQ31(q31_t *pSrc, float32_t scale)
 {
-  // Find the sample
+  if (!drcConfig->enabled)
+  {
+    return;
+  }
+
+  // Find the peak sample of each frame
   for (uint32_t i = 0; i < blockSize; i++)
   {
-    audioLevelDbBlock[i] = (abs(pSrcLeft[i]) > abs(pSrcRight[i])) ? pSrcLeft[i] : pSrcRight[i];
+    q31_t left = pSrc[i * 2];
+    q31_t right = pSrc[i * 2 + 1];
+    audioLevelDb[i] = (float32_t) ((std::abs((q63_t) left) > std::abs((q63_t) right)) ? left : right) * scale;
   }
 
+  calcGainFromPeaks(audioLevelDb, gain);
+
+  const float32_t maxGain = (float32_t) (1 << (31 - Q31_GAIN_FRACTION_BITS)) - 1.0f;
+
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    q63_t gainQ = (q63_t) (std::min(gain[i], maxGain) * (1 << Q31_GAIN_FRACTION_BITS));
+
+    pSrc[i * 2] = clip_q63_to_q31(((q63_t) pSrc[i * 2] * gainQ) >> Q31_GAIN_FRACTION_BITS);
+    pSrc[i * 2 + 1] = clip_q63_to_q31(((q63_t) pSrc[i * 2 + 1] * gainQ) >> Q31_GAIN_FRACTION_BITS);
+  }
+}
+
+/**
+ * This function estimates the level of the audio (in dB).
+ * It squares the signal and low-pass filters to get a time-averaged signal power.
+ * It holds the results in audioLevelDb.
+ *
+ * @param audioLevelDbBlock holds the peak sample of each frame and receives the estimated audio levels
+ */
+void Drc::calcAudioLevelInDb(float32_t *audioLevelDbBlock)
+{
   // calculate the instantaneous signal power (square the signal)
   arm_mult_f32(audioLevelDbBlock, audioLevelDbBlock, audioLevelDbBlock, blockSize);
 
@@ -117,11 +266,11 @@ void Drc::calcAudioLevelInDb(const float32_t *pSrcLeft, const float32_t *pSrcRig
 
     // save the state of the first-order low-pass filter
     previousLevelLowPassPower = audioLevelDbBlock[i];
-
-    //now convert the signal power to dB (but not yet multiplied by 10.0)
-    audioLevelDbBlock[i] = log10fApprox(audioLevelDbBlock[i]);
   }
 
+  //now convert the signal power to dB (but not yet multiplied by 10.0)
+  log10f_block(audioLevelDbBlock, audioLevelDbBlock, blockSize);
+
   // Limit the amount that the state of the smoothing filter can go toward negative infinity
   // Never go less than -130 dBFS
   if (previousLevelLowPassPower < (1.0E-13))
@@ -155,12 +304,7 @@ void Drc::calcGain(float32_t *audioLevelDbBlock, float32_t *gainBlock)
   }
 
   // Convert from dB to linear gain: gain = 10^(gain_dB/20);  (ie this takes care of the sqrt, too!)
-  arm_scale_f32(gainBlock, 1.0f / 20.0f, gainBlock, blockSize);
-
-  for (uint32_t i = 0; i < blockSize; i++)
-  {
-    gainBlock[i] = pow10f(gainBlock[i]);
-  }
+  db_to_lin_block(gainBlock, gainBlock, blockSize);
 }
 
 /**
@@ -221,6 +365,21 @@ void Drc::calcSmoothedGainInDb(float32_t *gain)
     // Save value for the next time through this loop
     previousGainIndB = gain[i];
   }
-}
 
+  snap_to_zero_block(&previousGainIndB, 1);
+}
 
+/**
+ * Continues from the level and gain smoothers of another DRC, which may have a different static curve.
+ * The gain is recalculated at the next sample.
+ * @param other
+ */
+void Drc::inheritState(const Drc &other)
+{
+  previousLevelLowPassPower = other.previousLevelLowPassPower;
+  previousGainIndB = other.previousGainIndB;
+  controlPhase = 0;
+  controlGain = other.controlGain;
+  controlTargetGain = other.controlGain;
+  controlGainStep = 0.0f;
+}
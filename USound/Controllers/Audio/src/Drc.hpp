@@ -35,7 +35,7 @@
 #pragma once
 
 #include "arm_math.h"
-#include "Controllers/System/pub/SystemConfiguration.hpp"
+#include "Controllers/System/pub/FilterConfiguration.hpp"
 
 /**
  * This class is a wrapper of the Dynamic range compressor operation
@@ -55,8 +55,18 @@ private:
   float32_t levelLowPassConst = 0.0;
   float32_t compressionRatioConst = 0.0;
 
+  uint32_t controlInterval = 1;
+  uint32_t controlPhase = 0;            //!< Samples left until the next gain calculation
+  float32_t controlAttackConst = 0.0;   //!< Attack/release constants, corrected for the control rate
+  float32_t controlReleaseConst = 0.0;
+  float32_t controlGain = 1.0;          //!< Interpolated linear gain
+  float32_t controlTargetGain = 1.0;    //!< Linear gain at the end of the current interpolation segment
+  float32_t controlGainStep = 0.0;
+
 private:
-  void calcAudioLevelInDb(const float32_t *pSrcLeft, const float32_t *pSrcRight, float32_t *audioLevelDbBlock);
+  void calcGainFromPeaks(float32_t *peakBlock, float32_t *gainBlock);
+  void calcGainAtControlRate(float32_t *peakBlock, float32_t *gainBlock);
+  void calcAudioLevelInDb(float32_t *audioLevelDbBlock);
   void calcGain(float32_t *audioLevelDbBlock, float32_t *gainBlock);
   void calcInstantaneousTargetGain(float32_t *audioLevelDbBlock, float32_t *gainBlock);
   void calcSmoothedGainInDb(float32_t *inst_targ_gain_dB_block);
@@ -67,4 +77,19 @@ public:
 
   void init();
   void run(float32_t *pSrcLeft, float32_t *pSrcRight);
+  void runInterleaved(float32_t *pSrc);
+  void runInterleavedQ31(q31_t *pSrc, float32_t scale);
+
+  void inheritState(const Drc &other);
+
+  const float32_t* getGain() const;
+
+  /**
+   * Sets the number of frames of the next blocks, up to the block size given to the constructor
+   * @param frames
+   */
+  void setBlockSize(uint32_t frames)
+  {
+    blockSize = frames;
+  }
 };
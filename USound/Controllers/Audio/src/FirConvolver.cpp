@@ -0,0 +1,352 @@
+//====================================================================
+//
+// COPYRIGHT 2020 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: uniformly partitioned FIR convolution stage
+//  Filename: FirConvolver.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+
+
+#include "FirConvolver.hpp"
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
+/**
+ * Sets the product of two packed spectra, bin by bin
+ * @param pA
+ * @param pB
+ * @param pDst
+ * @param length number of real points of the transform
+ */
+static inline void multiplySpectra(const float32_t *pA, const float32_t *pB, float32_t *pDst, uint32_t length)
+{
+  // DC and Nyquist bins are real
+  pDst[0] = pA[0] * pB[0];
+  pDst[1] = pA[1] * pB[1];
+
+  for (uint32_t i = 2; i < length; i += 2)
+  {
+    pDst[i] = pA[i] * pB[i] - pA[i + 1] * pB[i + 1];
+    pDst[i + 1] = pA[i] * pB[i + 1] + pA[i + 1] * pB[i];
+  }
+}
+
+/**
+ * Adds the product of two packed spectra, bin by bin
+ * @param pA
+ * @param pB
+ * @param pDst
+ * @param length number of real points of the transform
+ */
+static inline void multiplyAccumulateSpectra(const float32_t *pA, const float32_t *pB, float32_t *pDst, uint32_t length)
+{
+  pDst[0] += pA[0] * pB[0];
+  pDst[1] += pA[1] * pB[1];
+
+  for (uint32_t i = 2; i < length; i += 2)
+  {
+    pDst[i] += pA[i] * pB[i] - pA[i + 1] * pB[i + 1];
+    pDst[i + 1] += pA[i] * pB[i + 1] + pA[i + 1] * pB[i];
+  }
+}
+
+/**
+ * Default constructor of the FIR convolution class. The buffers are allocated by init(), for the taps of the configuration.
+ * @param config
+ * @param blockSize the largest number of frames per block
+ */
+FirConvolver::FirConvolver(const System::FirConfiguration *config, uint32_t blockSize) :
+    config(config),
+    maxBlockSize(blockSize),
+    blockSize(blockSize)
+{
+}
+
+/**
+ * Transforms the taps of the configuration for the block size, and clears the delay line.
+ * The buffers are only reallocated when they grow, so it is called by the control task, on a chain the audio task does not run.
+ * @return false if the stage is bypassed: it is disabled, no taps are loaded or the block size is not supported
+ */
+bool FirConvolver::init()
+{
+  filters = 0;
+
+  if (!config->enabled || !config->coefficients || config->taps == 0 || config->taps > FIR_MAX_TAPS || blockSize == 0)
+  {
+    return false;
+  }
+
+  uint32_t length = REAL_FFT_MIN_LENGTH;
+
+  while (length < 2 * blockSize)
+  {
+    length *= 2;
+  }
+
+  if (!fft.init(length))
+  {
+    return false;
+  }
+
+  const uint32_t filterCount = config->getFilterCount();
+
+  fftLength = length;
+  partitions = (config->taps + blockSize - 1) / blockSize;
+  inputShift = (config->placement == System::FirPlacement::FIR_PLACEMENT_CROSSOVER) ? 1 : 0;
+
+  uint32_t spectraSize = (filterCount + FIR_INPUTS) * partitions * fftLength;
+
+  if (spectraSize > allocatedSpectra)
+  {
+    delete[] filterSpectra;
+
+    filterSpectra = new float32_t[spectraSize];
+    allocatedSpectra = spectraSize;
+  }
+
+  if (fftLength > allocatedLength)
+  {
+    delete[] inputHistory;
+
+    inputHistory = new float32_t[(FIR_INPUTS + 2) * fftLength];
+    allocatedLength = fftLength;
+  }
+
+  inputSpectra = filterSpectra + filterCount * partitions * fftLength;
+  work = inputHistory + FIR_INPUTS * fftLength;
+
+  // Each partition is one block of taps, zero padded to the transform length
+  const float32_t *pTaps = config->coefficients.get();
+  float32_t *pSamples = work + fftLength;
+
+  for (uint32_t filter = 0; filter < filterCount; filter++)
+  {
+    for (uint32_t part = 0; part < partitions; part++)
+    {
+      uint32_t first = part * blockSize;
+      uint32_t count = std::min(blockSize, config->taps - first);
+
+      memcpy(pSamples, pTaps + filter * config->taps + first, count * sizeof(float32_t));
+      memset(pSamples + count, 0, (fftLength - count) * sizeof(float32_t));
+      fft.transform(pSamples, filterSpectra + (filter * partitions + part) * fftLength, false);
+    }
+  }
+
+  filters = filterCount;
+  reset();
+  return true;
+}
+
+/**
+ * Clears the input history and the delay line
+ */
+void FirConvolver::reset()
+{
+  if (filters == 0)
+  {
+    return;
+  }
+
+  memset(inputHistory, 0, FIR_INPUTS * fftLength * sizeof(float32_t));
+  memset(inputSpectra, 0, FIR_INPUTS * partitions * fftLength * sizeof(float32_t));
+  newestSpectrum = 0;
+}
+
+/**
+ * Continues from the input history of another stage, so that a reconfiguration does not restart the filters.
+ * It is only taken over when both stages use the same transform, and for the partitions both stages have.
+ * @param other
+ */
+void FirConvolver::inheritState(const FirConvolver &other)
+{
+  if (filters == 0 || other.filters == 0 || fftLength != other.fftLength || blockSize != other.blockSize)
+  {
+    return;
+  }
+
+  memcpy(inputHistory, other.inputHistory, FIR_INPUTS * fftLength * sizeof(float32_t));
+
+  for (uint32_t input = 0; input < FIR_INPUTS; input++)
+  {
+    for (uint32_t delay = 0; delay < std::min(partitions, other.partitions); delay++)
+    {
+      memcpy(getInputSpectrum(input, delay), other.getInputSpectrum(input, delay), fftLength * sizeof(float32_t));
+    }
+  }
+}
+
+/**
+ * Returns the spectrum of an input block in the delay line
+ * @param input
+ * @param delay 0 for the current block, up to partitions - 1
+ */
+float32_t *FirConvolver::getInputSpectrum(uint32_t input, uint32_t delay) const
+{
+  uint32_t slot = (newestSpectrum + partitions - delay) % partitions;
+
+  return inputSpectra + (input * partitions + slot) * fftLength;
+}
+
+/**
+ * Drops the oldest block of the input history, to make room for the current one at the end
+ * @param input
+ */
+void FirConvolver::shiftHistory(uint32_t input)
+{
+  float32_t *pHistory = inputHistory + input * fftLength;
+
+  memmove(pHistory, pHistory + blockSize, (fftLength - blockSize) * sizeof(float32_t));
+}
+
+/**
+ * Transforms the input history into the current slot of the delay line
+ * @param input
+ */
+void FirConvolver::transformInput(uint32_t input)
+{
+  float32_t *pSamples = work + fftLength;
+
+  memcpy(pSamples, inputHistory + input * fftLength, fftLength * sizeof(float32_t));
+  fft.transform(pSamples, getInputSpectrum(input, 0), false);
+}
+
+/**
+ * Adds a block of float samples to an input channel
+ * @param input PcmChannel of the samples
+ * @param pSrc
+ * @param stride 1 for separate channel buffers, 2 for interleaved ones
+ */
+void FirConvolver::writeInput(uint32_t input, const float32_t *pSrc, uint32_t stride)
+{
+  shiftHistory(input);
+
+  float32_t *pDst = inputHistory + (input + 1) * fftLength - blockSize;
+
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    pDst[i] = pSrc[i * stride];
+  }
+
+  transformInput(input);
+}
+
+/**
+ * Adds a block of Q31 samples to an input channel
+ * @param input PcmChannel of the samples
+ * @param pSrc
+ * @param stride 2 for interleaved buffers
+ * @param scale Q31 to float scaling
+ */
+void FirConvolver::writeInput(uint32_t input, const q31_t *pSrc, uint32_t stride, float32_t scale)
+{
+  shiftHistory(input);
+
+  float32_t *pDst = inputHistory + (input + 1) * fftLength - blockSize;
+
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    pDst[i] = (float32_t) pSrc[i * stride] * scale;
+  }
+
+  transformInput(input);
+}
+
+/**
+ * Filters the delay line of the input of a filter. The first fftLength - blockSize samples of the
+ * circular convolution are aliased and dropped, which leaves the last block.
+ * @param filter
+ * @return the output block
+ */
+const float32_t *FirConvolver::convolve(uint32_t filter)
+{
+  const uint32_t input = filter >> inputShift;
+  const float32_t *pFilter = filterSpectra + filter * partitions * fftLength;
+  float32_t *pSum = work;
+  float32_t *pSamples = work + fftLength;
+
+  multiplySpectra(pFilter, getInputSpectrum(input, 0), pSum, fftLength);
+
+  for (uint32_t part = 1; part < partitions; part++)
+  {
+    multiplyAccumulateSpectra(pFilter + part * fftLength, getInputSpectrum(input, part), pSum, fftLength);
+  }
+
+  fft.transform(pSum, pSamples, true);
+  return pSamples + fftLength - blockSize;
+}
+
+/**
+ * Writes the output of a filter for the block given to writeInput()
+ * @param filter index of the filter, in the order of the placement
+ * @param pDst
+ * @param stride 1 for separate channel buffers, 2 for interleaved ones
+ */
+void FirConvolver::readOutput(uint32_t filter, float32_t *pDst, uint32_t stride)
+{
+  const float32_t *pSrc = convolve(filter);
+
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    pDst[i * stride] = pSrc[i];
+  }
+}
+
+/**
+ * Writes the output of a filter for the block given to writeInput(), saturated to Q31
+ * @param filter index of the filter, in the order of the placement
+ * @param pDst
+ * @param stride 2 for interleaved buffers
+ * @param fullScale float to Q31 scaling
+ */
+void FirConvolver::readOutput(uint32_t filter, q31_t *pDst, uint32_t stride, float32_t fullScale)
+{
+  const float32_t *pSrc = convolve(filter);
+
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    pDst[i * stride] = clip_q63_to_q31((q63_t) roundf(pSrc[i] * fullScale));
+  }
+}
+
+/**
+ * Moves the delay line on by one block, after all the outputs of the block are read
+ */
+void FirConvolver::nextBlock()
+{
+  newestSpectrum = (newestSpectrum + 1) % partitions;
+}
+
+/**
+ * Returns the bytes of the spectra, the buffers and the transform tables
+ */
+uint32_t FirConvolver::getMemorySize() const
+{
+  return (allocatedSpectra + (FIR_INPUTS + 2) * allocatedLength) * sizeof(float32_t) + fft.getMemorySize();
+}
@@ -0,0 +1,137 @@
+//====================================================================
+//
+// COPYRIGHT 2020 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: uniformly partitioned FIR convolution stage
+//  Filename: FirConvolver.hpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+
+#pragma once
+
+#include "arm_math.h"
+#include "Controllers/System/pub/FilterConfiguration.hpp"
+#include "RealFft.hpp"
+
+#define FIR_INPUTS        2       //!< Left and right channel
+#define FIR_MAX_FILTERS   4       //!< Woofer and tweeter of both channels with FIR_PLACEMENT_CROSSOVER
+
+/**
+ * This class runs the FIR filters of the configuration with a uniformly partitioned overlap-save convolution.
+ *
+ * The taps are cut in partitions of one block, and every partition is transformed once by init() into an
+ * FFT of fftLength points, the smallest power of two of at least two blocks. Per block, each input channel
+ * is transformed once into a frequency-domain delay line of the spectra of the last `partitions` blocks, and
+ * each filter output is the inverse transform of the sum of the products of the partitions with the delay line.
+ * No latency is added: the output of a block depends on the input of the same block.
+ *
+ * A block is processed with writeInput() for both channels, readOutput() for each filter, then nextBlock().
+ * The filters of FIR_PLACEMENT_MASTER read the channel of the same index, and the ones of
+ * FIR_PLACEMENT_CROSSOVER the channel of their XoverEqCoeffcientType.
+ */
+class FirConvolver
+{
+private:
+  const System::FirConfiguration *config;
+  uint32_t maxBlockSize;
+  uint32_t blockSize;
+  RealFft fft;
+
+  uint32_t fftLength = 0;
+  uint32_t partitions = 0;
+  uint32_t filters = 0;                 //!< Filters in use, 0 if the stage is bypassed
+  uint32_t newestSpectrum = 0;          //!< Slot of the current block in the delay line
+  uint32_t inputShift = 0;              //!< Input of a filter: filter >> inputShift
+
+  float32_t *filterSpectra = nullptr;   //!< filters x partitions spectra of fftLength
+  float32_t *inputSpectra = nullptr;    //!< FIR_INPUTS x partitions spectra of fftLength: the frequency-domain delay line
+  float32_t *inputHistory = nullptr;    //!< FIR_INPUTS x fftLength samples, the current block at the end
+  float32_t *work = nullptr;            //!< Accumulated spectrum and FFT buffer, fftLength each
+  uint32_t allocatedSpectra = 0;        //!< Samples of filterSpectra and inputSpectra, which are allocated together
+  uint32_t allocatedLength = 0;         //!< fftLength of inputHistory and work, which are allocated together
+
+  float32_t *getInputSpectrum(uint32_t input, uint32_t delay) const;
+  void shiftHistory(uint32_t input);
+  void transformInput(uint32_t input);
+  const float32_t *convolve(uint32_t filter);
+
+public:
+  FirConvolver(const System::FirConfiguration *config, uint32_t blockSize);
+
+  bool init();
+  void reset();
+  void inheritState(const FirConvolver &other);
+
+  void writeInput(uint32_t input, const float32_t *pSrc, uint32_t stride);
+  void writeInput(uint32_t input, const q31_t *pSrc, uint32_t stride, float32_t scale);
+  void readOutput(uint32_t filter, float32_t *pDst, uint32_t stride);
+  void readOutput(uint32_t filter, q31_t *pDst, uint32_t stride, float32_t fullScale);
+  void nextBlock();
+
+  uint32_t getMemorySize() const;
+
+  /**
+   * Sets the number of frames per block, up to the block size given to the constructor. It takes effect on the next init().
+   */
+  void setBlockSize(uint32_t frames)
+  {
+    blockSize = (frames < maxBlockSize) ? frames : maxBlockSize;
+  }
+
+  /**
+   * Returns true if no filter is loaded, or the stage is disabled
+   */
+  bool isBypassed() const
+  {
+    return filters == 0;
+  }
+
+  /**
+   * Returns the number of real points of the transforms
+   */
+  uint32_t getFftLength() const
+  {
+    return fftLength;
+  }
+
+  /**
+   * Returns the number of partitions of each filter
+   */
+  uint32_t getPartitions() const
+  {
+    return partitions;
+  }
+
+  /**
+   * Returns the number of filters in use
+   */
+  uint32_t getFilters() const
+  {
+    return filters;
+  }
+};
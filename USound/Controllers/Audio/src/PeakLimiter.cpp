@@ -0,0 +1,291 @@
+//====================================================================
+//
+// COPYRIGHT 2020 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: lookahead brickwall peak limiter
+//  Filename: PeakLimiter.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+
+#include "PeakLimiter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
+#define DEQUE_SIZE    (PEAK_LIMITER_MAX_LOOKAHEAD_SAMPLES + 1)
+
+/**
+ * Default constructor of the peak limiter class. The buffers are sized for the longest lookahead,
+ * so that the configuration can be reloaded without allocating.
+ */
+PeakLimiter::PeakLimiter(System::PeakLimiterConfiguration *config, uint32_t blockSize) :
+    config(config),
+    blockSize(blockSize)
+{
+  delayLine = new float32_t[PEAK_LIMITER_MAX_LOOKAHEAD_SAMPLES * PEAK_LIMITER_STREAMS];
+  holdGains = new float32_t[PEAK_LIMITER_MAX_LOOKAHEAD_SAMPLES];
+  dequePeaks = new float32_t[DEQUE_SIZE];
+  dequePositions = new uint32_t[DEQUE_SIZE];
+}
+
+/**
+ * Calculates the limiter constants and resets the delay line
+ */
+void PeakLimiter::init()
+{
+  float32_t frames = roundf(config->lookaheadDuration * config->sampleRateHz);
+
+  lookahead = (uint32_t) std::min(std::max(frames, 1.0f), (float32_t) PEAK_LIMITER_MAX_LOOKAHEAD_SAMPLES);
+  invLookahead = 1.0f / (float32_t) lookahead;
+  ceiling = powf(10.0f, std::min(config->thresholdFullScaleDb, 0.0f) / 20.0f);
+  releaseConst = expf(-1.0f / (std::max(config->releaseDuration, 0.001f) * config->sampleRateHz));
+  gain = 1.0f;
+  minGain = 1.0f;
+
+  memset(delayLine, 0, PEAK_LIMITER_MAX_LOOKAHEAD_SAMPLES * PEAK_LIMITER_STREAMS * sizeof(float32_t));
+  std::fill(holdGains, holdGains + PEAK_LIMITER_MAX_LOOKAHEAD_SAMPLES, 1.0f);
+  holdGainSum = (float32_t) lookahead;
+  writeIndex = 0;
+
+  dequeHead = 0;
+  dequeCount = 0;
+  position = 0;
+}
+
+/**
+ * Recalculates the sum of the smoothing filter, so that the rounding errors of the running sum do not accumulate
+ */
+void PeakLimiter::startBlock()
+{
+  float32_t sum = 0.0f;
+
+  for (uint32_t i = 0; i < lookahead; i++)
+  {
+    sum += holdGains[i];
+  }
+
+  holdGainSum = sum;
+  minGain = 1.0f;
+}
+
+/**
+ * Adds the peak of a new frame to the lookahead window and calculates the gain of the delayed frame
+ * @param peak the highest absolute sample of the new frame
+ * @return the gain to apply to the frame that leaves the delay line
+ */
+float32_t PeakLimiter::nextGain(float32_t peak)
+{
+  // Sliding window maximum over the last lookahead + 1 frames
+  while (dequeCount > 0)
+  {
+    uint32_t back = dequeHead + dequeCount - 1;
+
+    back = (back >= DEQUE_SIZE) ? back - DEQUE_SIZE : back;
+
+    if (dequePeaks[back] > peak)
+    {
+      break;
+    }
+
+    dequeCount--;
+  }
+
+  uint32_t tail = dequeHead + dequeCount;
+
+  tail = (tail >= DEQUE_SIZE) ? tail - DEQUE_SIZE : tail;
+  dequePeaks[tail] = peak;
+  dequePositions[tail] = position;
+  dequeCount++;
+
+  if (position - dequePositions[dequeHead] > lookahead)
+  {
+    dequeHead = (dequeHead + 1 == DEQUE_SIZE) ? 0 : dequeHead + 1;
+    dequeCount--;
+  }
+
+  position++;
+
+  // Gain required by the window, ramped in over the lookahead
+  float32_t holdGain = ceiling / std::max(dequePeaks[dequeHead], ceiling);
+
+  holdGainSum += holdGain - holdGains[writeIndex];
+  holdGains[writeIndex] = holdGain;
+
+  float32_t targetGain = holdGainSum * invLookahead;
+
+  // Instant attack (the ramp is already in the target), exponential release
+  gain = std::min(targetGain, targetGain + releaseConst * (gain - targetGain));
+  minGain = std::min(minGain, gain);
+
+  return gain;
+}
+
+/**
+ * Limits the tweeter and, optionally, the woofer samples in place
+ * @param pLeft
+ * @param pRight
+ * @param pWooferLeft nullptr when the woofers share the buffers with the tweeters
+ * @param pWooferRight
+ * @param stride distance between consecutive samples of a channel (1 for separate buffers, 2 for interleaved)
+ */
+void PeakLimiter::run(float32_t *pLeft, float32_t *pRight, float32_t *pWooferLeft, float32_t *pWooferRight, uint32_t stride)
+{
+  if (!config->enabled)
+  {
+    return;
+  }
+
+  startBlock();
+
+  for (uint32_t i = 0; i < blockSize * stride; i += stride)
+  {
+    float32_t *pDelayed = delayLine + writeIndex * PEAK_LIMITER_STREAMS;
+    float32_t left = pLeft[i];
+    float32_t right = pRight[i];
+    float32_t peak = std::max(fabsf(left), fabsf(right));
+
+    if (pWooferLeft != nullptr)
+    {
+      float32_t wooferLeft = pWooferLeft[i];
+      float32_t wooferRight = pWooferRight[i];
+      float32_t frameGain = nextGain(std::max(peak, std::max(fabsf(wooferLeft), fabsf(wooferRight))));
+
+      pWooferLeft[i] = pDelayed[2] * frameGain;
+      pWooferRight[i] = pDelayed[3] * frameGain;
+      pDelayed[2] = wooferLeft;
+      pDelayed[3] = wooferRight;
+      pLeft[i] = pDelayed[0] * frameGain;
+      pRight[i] = pDelayed[1] * frameGain;
+    }
+    else
+    {
+      float32_t frameGain = nextGain(peak);
+
+      pLeft[i] = pDelayed[0] * frameGain;
+      pRight[i] = pDelayed[1] * frameGain;
+    }
+
+    pDelayed[0] = left;
+    pDelayed[1] = right;
+    writeIndex = (writeIndex + 1 == lookahead) ? 0 : writeIndex + 1;
+  }
+}
+
+/**
+ * Limits the interleaved Q31 tweeter and, optionally, woofer buffers in place.
+ * The delay line holds float32_t samples, whose precision is well beyond the 16bit output.
+ * @param pTweeter
+ * @param pWoofer nullptr when the woofers share the buffer with the tweeters
+ * @param scale Q31 to float32_t scaling, where 1.0 is the 16bit full scale
+ */
+void PeakLimiter::runInterleavedQ31(q31_t *pTweeter, q31_t *pWoofer, float32_t scale)
+{
+  if (!config->enabled)
+  {
+    return;
+  }
+
+  const float32_t fullScale = 1.0f / scale;
+  const uint32_t streams = (pWoofer != nullptr) ? PEAK_LIMITER_STREAMS : 2;
+
+  startBlock();
+
+  for (uint32_t i = 0; i < blockSize * 2; i += 2)
+  {
+    float32_t *pDelayed = delayLine + writeIndex * PEAK_LIMITER_STREAMS;
+    float32_t frame[PEAK_LIMITER_STREAMS];
+    float32_t peak = 0.0f;
+
+    for (uint32_t j = 0; j < streams; j++)
+    {
+      frame[j] = (float32_t) ((j < 2) ? pTweeter[i + j] : pWoofer[i + j - 2]) * scale;
+      peak = std::max(peak, fabsf(frame[j]));
+    }
+
+    float32_t frameGain = nextGain(peak) * fullScale;
+
+    for (uint32_t j = 0; j < streams; j++)
+    {
+      q31_t *pSample = (j < 2) ? &pTweeter[i + j] : &pWoofer[i + j - 2];
+
+      *pSample = (q31_t) roundf(pDelayed[j] * frameGain);
+      pDelayed[j] = frame[j];
+    }
+
+    writeIndex = (writeIndex + 1 == lookahead) ? 0 : writeIndex + 1;
+  }
+}
+
+/**
+ * Continues from the gain of another limiter and, if both have the same lookahead, from its delay line and peak window
+ * @param other
+ */
+void PeakLimiter::inheritState(const PeakLimiter &other)
+{
+  gain = other.gain;
+
+  if (lookahead != other.lookahead)
+  {
+    return;
+  }
+
+  memcpy(delayLine, other.delayLine, lookahead * PEAK_LIMITER_STREAMS * sizeof(float32_t));
+  memcpy(holdGains, other.holdGains, lookahead * sizeof(float32_t));
+  memcpy(dequePeaks, other.dequePeaks, DEQUE_SIZE * sizeof(float32_t));
+  memcpy(dequePositions, other.dequePositions, DEQUE_SIZE * sizeof(uint32_t));
+  holdGainSum = other.holdGainSum;
+  writeIndex = other.writeIndex;
+  dequeHead = other.dequeHead;
+  dequeCount = other.dequeCount;
+  position = other.position;
+}
+
+/**
+ * @return the delay added by the limiter, in frames
+ */
+uint32_t PeakLimiter::getLatency() const
+{
+  return lookahead;
+}
+
+/**
+ * @return the memory allocated by the limiter, in bytes
+ */
+uint32_t PeakLimiter::getMemorySize() const
+{
+  return (PEAK_LIMITER_MAX_LOOKAHEAD_SAMPLES * (PEAK_LIMITER_STREAMS + 1) + DEQUE_SIZE) * sizeof(float32_t)
+      + DEQUE_SIZE * sizeof(uint32_t);
+}
+
+/**
+ * @return the lowest gain applied during the last block, 1.0 if the limiter did not engage
+ */
+float32_t PeakLimiter::getMinGain() const
+{
+  return minGain;
+}
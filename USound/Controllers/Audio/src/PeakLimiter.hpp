@@ -0,0 +1,101 @@
+//====================================================================
+//
+// COPYRIGHT 2020 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: lookahead brickwall peak limiter
+//  Filename: PeakLimiter.hpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+
+#pragma once
+
+#include "arm_math.h"
+#include "Controllers/System/pub/FilterConfiguration.hpp"
+
+#define PEAK_LIMITER_MAX_LOOKAHEAD_SAMPLES   192     //!< 2 ms at 96 kHz, 4 ms at 48 kHz
+#define PEAK_LIMITER_STREAMS                 4       //!< Tweeter left/right, woofer left/right
+
+/**
+ * This class is a brickwall limiter that delays the audio by a short lookahead, so that the gain
+ * is already down when a peak reaches the output. The gain is shared by all the streams it runs on,
+ * which keeps the stereo image and the sum of the x-over bands intact.
+ *
+ * The peak of the lookahead window is tracked with a monotonic deque (O(1) per frame), and the
+ * gain it requires is smoothed with a moving average over the lookahead. Every frame averaged
+ * is the minimum of a window that contains the delayed frame, so the smoothed gain never exceeds the gain
+ * that the delayed frame requires.
+ */
+class PeakLimiter
+{
+private:
+  System::PeakLimiterConfiguration *config;
+  uint32_t blockSize;
+
+  uint32_t lookahead = 1;             //!< Lookahead in frames, also the latency of the limiter
+  float32_t invLookahead = 1.0f;
+  float32_t ceiling = 1.0f;           //!< Linear output ceiling
+  float32_t releaseConst = 0.0f;
+  float32_t gain = 1.0f;              //!< Smoothed gain applied to the delayed frame
+  float32_t minGain = 1.0f;           //!< Lowest gain applied during the last block
+
+  float32_t *delayLine = nullptr;     //!< Frames of PEAK_LIMITER_STREAMS samples, lookahead frames long
+  float32_t *holdGains = nullptr;     //!< Window gains averaged by the smoothing filter, lookahead long
+  float32_t holdGainSum = 0.0f;
+  uint32_t writeIndex = 0;            //!< Position in delayLine and holdGains
+
+  float32_t *dequePeaks = nullptr;    //!< Decreasing peaks of the window, lookahead + 1 long at most
+  uint32_t *dequePositions = nullptr; //!< Frame positions of dequePeaks
+  uint32_t dequeHead = 0;
+  uint32_t dequeCount = 0;
+  uint32_t position = 0;              //!< Frame counter, may wrap around
+
+  void startBlock();
+  float32_t nextGain(float32_t peak);
+
+public:
+  PeakLimiter(System::PeakLimiterConfiguration *config, uint32_t blockSize);
+
+  void init();
+  void run(float32_t *pLeft, float32_t *pRight, float32_t *pWooferLeft, float32_t *pWooferRight, uint32_t stride);
+  void runInterleavedQ31(q31_t *pTweeter, q31_t *pWoofer, float32_t scale);
+
+  void inheritState(const PeakLimiter &other);
+
+  uint32_t getLatency() const;
+  uint32_t getMemorySize() const;
+  float32_t getMinGain() const;
+
+  /**
+   * Sets the number of frames of the next blocks, up to the block size given to the constructor
+   * @param frames
+   */
+  void setBlockSize(uint32_t frames)
+  {
+    blockSize = frames;
+  }
+};
@@ -0,0 +1,241 @@
+//====================================================================
+//
+// COPYRIGHT 2020 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: real FFT of the FIR convolution stage
+//  Filename: RealFft.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+
+
+#include "RealFft.hpp"
+#include <cmath>
+
+/**
+ * Sets the length of the transform and computes its tables. The tables are only reallocated when they grow.
+ * @param fftLength number of real points, a power of two between REAL_FFT_MIN_LENGTH and REAL_FFT_MAX_LENGTH
+ * @return false if the length is not supported
+ */
+bool RealFft::init(uint32_t fftLength)
+{
+  if (fftLength < REAL_FFT_MIN_LENGTH || fftLength > REAL_FFT_MAX_LENGTH || (fftLength & (fftLength - 1)) != 0)
+  {
+    return false;
+  }
+
+  if (fftLength > allocatedLength)
+  {
+    delete[] twiddles;
+    delete[] bitReversal;
+
+    twiddles = new float32_t[fftLength];
+    bitReversal = new uint16_t[fftLength / 2];
+    allocatedLength = fftLength;
+  }
+
+  length = fftLength;
+
+  for (uint32_t k = 0; k < length / 2; k++)
+  {
+    double angle = 2.0 * M_PI * (double) k / (double) length;
+
+    twiddles[k * 2] = (float32_t) cos(angle);
+    twiddles[k * 2 + 1] = (float32_t) sin(angle);
+  }
+
+  const uint32_t points = length / 2;
+  uint32_t bits = 0;
+
+  while ((1u << bits) < points)
+  {
+    bits++;
+  }
+
+  for (uint32_t i = 0; i < points; i++)
+  {
+    uint32_t reversed = 0;
+
+    for (uint32_t bit = 0; bit < bits; bit++)
+    {
+      reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+    }
+
+    bitReversal[i] = (uint16_t) reversed;
+  }
+
+  return true;
+}
+
+/**
+ * In place radix-2 complex FFT of length / 2 interleaved points, without scaling
+ * @param pData the complex points
+ * @param inverse false for the forward transform (e^-j), true for the inverse one (e^+j)
+ */
+void RealFft::complexTransform(float32_t *pData, bool inverse) const
+{
+  const uint32_t points = length / 2;
+  const float32_t sign = inverse ? 1.0f : -1.0f;
+
+  for (uint32_t i = 0; i < points; i++)
+  {
+    uint32_t j = bitReversal[i];
+
+    if (i < j)
+    {
+      float32_t re = pData[i * 2];
+      float32_t im = pData[i * 2 + 1];
+
+      pData[i * 2] = pData[j * 2];
+      pData[i * 2 + 1] = pData[j * 2 + 1];
+      pData[j * 2] = re;
+      pData[j * 2 + 1] = im;
+    }
+  }
+
+  // First stage, without twiddles
+  for (uint32_t i = 0; i < points * 2; i += 4)
+  {
+    float32_t re = pData[i + 2];
+    float32_t im = pData[i + 3];
+
+    pData[i + 2] = pData[i] - re;
+    pData[i + 3] = pData[i + 1] - im;
+    pData[i] += re;
+    pData[i + 1] += im;
+  }
+
+  // The twiddle of bin k of a stage with 2 * half points is the one of bin k * points / half of the table
+  for (uint32_t half = 2; half < points; half *= 2)
+  {
+    const uint32_t twiddleStep = (points / half) * 2;
+
+    for (uint32_t start = 0; start < points; start += half * 2)
+    {
+      float32_t *pA = pData + start * 2;
+      float32_t *pB = pA + half * 2;
+      const float32_t *pTwiddle = twiddles;
+
+      for (uint32_t k = 0; k < half; k++)
+      {
+        float32_t wr = pTwiddle[0];
+        float32_t wi = sign * pTwiddle[1];
+        float32_t re = pB[0] * wr - pB[1] * wi;
+        float32_t im = pB[0] * wi + pB[1] * wr;
+
+        pB[0] = pA[0] - re;
+        pB[1] = pA[1] - im;
+        pA[0] += re;
+        pA[1] += im;
+
+        pA += 2;
+        pB += 2;
+        pTwiddle += twiddleStep;
+      }
+    }
+  }
+}
+
+/**
+ * Computes the spectrum of a real sequence, or the sequence of a spectrum, like arm_rfft_fast_f32
+ * @param pIn the length samples, or the packed spectrum for the inverse transform. It is used as work buffer.
+ * @param pOut the packed spectrum, or the length samples for the inverse transform. It must not overlap pIn.
+ * @param inverse false for the forward transform, true for the inverse one
+ */
+void RealFft::transform(float32_t *pIn, float32_t *pOut, bool inverse) const
+{
+  const uint32_t points = length / 2;
+
+  if (!inverse)
+  {
+    // The even samples are the real parts and the odd samples the imaginary parts of a half length transform
+    complexTransform(pIn, false);
+
+    float32_t re = pIn[0];
+    float32_t im = pIn[1];
+
+    pOut[0] = re + im;
+    pOut[1] = re - im;
+
+    for (uint32_t k = 1; k < points; k++)
+    {
+      const float32_t *pA = pIn + k * 2;
+      const float32_t *pB = pIn + (points - k) * 2;
+      float32_t c = twiddles[k * 2];
+      float32_t s = twiddles[k * 2 + 1];
+
+      // Spectra of the even (e) and the odd (o) samples
+      float32_t er = 0.5f * (pA[0] + pB[0]);
+      float32_t ei = 0.5f * (pA[1] - pB[1]);
+      float32_t orr = 0.5f * (pA[1] + pB[1]);
+      float32_t oi = 0.5f * (pB[0] - pA[0]);
+
+      pOut[k * 2] = er + c * orr + s * oi;
+      pOut[k * 2 + 1] = ei + c * oi - s * orr;
+    }
+  }
+  else
+  {
+    pOut[0] = 0.5f * (pIn[0] + pIn[1]);
+    pOut[1] = 0.5f * (pIn[0] - pIn[1]);
+
+    for (uint32_t k = 1; k < points; k++)
+    {
+      const float32_t *pA = pIn + k * 2;
+      const float32_t *pB = pIn + (points - k) * 2;
+      float32_t c = twiddles[k * 2];
+      float32_t s = twiddles[k * 2 + 1];
+
+      float32_t er = 0.5f * (pA[0] + pB[0]);
+      float32_t ei = 0.5f * (pA[1] - pB[1]);
+      float32_t dr = 0.5f * (pA[0] - pB[0]);
+      float32_t di = 0.5f * (pA[1] + pB[1]);
+      float32_t orr = c * dr - s * di;
+      float32_t oi = c * di + s * dr;
+
+      pOut[k * 2] = er - oi;
+      pOut[k * 2 + 1] = ei + orr;
+    }
+
+    complexTransform(pOut, true);
+
+    const float32_t scale = 1.0f / (float32_t) points;
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+      pOut[i] *= scale;
+    }
+  }
+}
+
+/**
+ * Returns the bytes of the tables
+ */
+uint32_t RealFft::getMemorySize() const
+{
+  return allocatedLength * sizeof(float32_t) + (allocatedLength / 2) * sizeof(uint16_t);
+}
@@ -0,0 +1,72 @@
+//====================================================================
+//
+// COPYRIGHT 2020 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: real FFT of the FIR convolution stage
+//  Filename: RealFft.hpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+
+#pragma once
+
+#include "arm_math.h"
+
+#define REAL_FFT_MIN_LENGTH   32
+#define REAL_FFT_MAX_LENGTH   4096
+
+/**
+ * This class computes the FFT of a real sequence, with the interface and the packing of arm_rfft_fast_f32:
+ * the spectrum is stored as length / 2 complex bins, where the real part of the first bin is the DC bin and
+ * its imaginary part is the real Nyquist bin. The inverse transform is scaled by 1 / length.
+ *
+ * The transform sources of CMSIS-DSP are not part of this tree, so it is implemented here as a radix-2 complex
+ * FFT of length / 2 points with a split step. It can be replaced by arm_rfft_fast_f32 without changing the callers.
+ */
+class RealFft
+{
+private:
+  uint32_t length = 0;
+  uint32_t allocatedLength = 0;
+  float32_t *twiddles = nullptr;      //!< cos/sin of 2 * pi * k / length, for k < length / 2
+  uint16_t *bitReversal = nullptr;    //!< Permutation of the length / 2 complex points
+
+  void complexTransform(float32_t *pData, bool inverse) const;
+
+public:
+  bool init(uint32_t fftLength);
+  void transform(float32_t *pIn, float32_t *pOut, bool inverse) const;
+  uint32_t getMemorySize() const;
+
+  /**
+   * Returns the number of real points given to init()
+   */
+  uint32_t getLength() const
+  {
+    return length;
+  }
+};
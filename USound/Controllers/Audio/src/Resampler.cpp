@@ -0,0 +1,396 @@
+//====================================================================
+//
+// COPYRIGHT 2020 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: polyphase sample-rate converter between the audio source and the filter pipeline
+//  Filename: Resampler.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+
+#include "Resampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
+#define INTERPOLATED_ROW_SHIFT    25          //!< 32 - log2(RESAMPLER_INTERPOLATED_PHASES)
+#define INTERPOLATED_WEIGHT_MASK  ((1u << INTERPOLATED_ROW_SHIFT) - 1)
+
+// Drift tracking loop, for a time constant of a few seconds. The fill level is noisy (it moves by whole chunks),
+// so it is smoothed well below the loop bandwidth.
+#define DRIFT_FILL_SMOOTHING_S    0.5f        //!< Time constant of the fill level smoothing
+#define DRIFT_PROPORTIONAL_PPM    10.0f       //!< ppm per frame of fill error
+#define DRIFT_INTEGRAL_PPM_S      2.5f        //!< ppm per frame of fill error and second
+
+/**
+ * Length and shape of the windowed sinc of each quality
+ */
+struct ResamplerDesign
+{
+public:
+  uint32_t taps;
+  double rolloff;       //!< Cutoff, relative to the lower Nyquist frequency of both rates
+  double beta;          //!< Kaiser window parameter
+};
+
+static const ResamplerDesign resamplerDesigns[System::ResamplerQuality::MAX_RESAMPLER_QUALITIES] = {
+    { 16, 0.80, 5.0 },
+    { 32, 0.90, 7.5 },
+    { 64, 0.93, 10.0 }
+};
+
+/**
+ * Returns the taps per phase of the configuration: an even number between 4 and RESAMPLER_MAX_TAPS
+ */
+static uint32_t getConfiguredTaps(const System::ResamplerConfiguration *config)
+{
+  uint32_t taps = (config->taps > 0) ? config->taps : resamplerDesigns[config->quality].taps;
+
+  return std::min(std::max(taps & ~1u, 4u), (uint32_t) RESAMPLER_MAX_TAPS);
+}
+
+/**
+ * Zeroth order modified Bessel function of the first kind, for the Kaiser window
+ */
+static double besselI0(double x)
+{
+  double sum = 1.0;
+  double term = 1.0;
+  double halfX = x / 2.0;
+
+  for (uint32_t k = 1; k < 64 && term > sum * 1e-12; k++)
+  {
+    term *= (halfX / k) * (halfX / k);
+    sum += term;
+  }
+
+  return sum;
+}
+
+static uint32_t greatestCommonDivisor(uint32_t a, uint32_t b)
+{
+  while (b != 0)
+  {
+    uint32_t rest = a % b;
+    a = b;
+    b = rest;
+  }
+
+  return a;
+}
+
+/**
+ * Converts a float32_t sample to int16_t. Samples beyond full scale are saturated instead of wrapping around.
+ * @param value the sample, already scaled to the int16_t range
+ */
+static inline int16_t toPcm16(float32_t value)
+{
+  int32_t sample = (int32_t) roundf(value);
+
+  sample = (sample > INT16_MAX) ? INT16_MAX : sample;
+  sample = (sample < INT16_MIN) ? INT16_MIN : sample;
+  return (int16_t) sample;
+}
+
+/**
+ * Default constructor of the resampler class. The table is allocated for the taps of the configuration,
+ * and the input buffer for output blocks and input chunks of the same duration, of up to maxFrames frames each.
+ * @param config
+ * @param maxFrames
+ */
+Resampler::Resampler(const System::ResamplerConfiguration *config, uint32_t maxFrames) :
+    config(config)
+{
+  maxTaps = getConfiguredTaps(config);
+  capacity = 2 * (maxFrames + 1) + maxTaps;
+
+  coefficients = new float32_t[(RESAMPLER_MAX_PHASES + 1) * maxTaps];
+  history = new float32_t[capacity * 2];
+}
+
+/**
+ * Prepares the conversion between two rates. The table is calculated here, which takes a while:
+ * it should not be called from the audio task.
+ * @param inputRateHz the rate of the source
+ * @param outputRateHz the rate of the audio path
+ * @param trackingEnabled if true, the ratio can be trimmed by trackFillLevel()
+ * @return false if one of the rates is 0
+ */
+bool Resampler::init(uint32_t inputRateHz, uint32_t outputRateHz, bool trackingEnabled)
+{
+  if (inputRateHz == 0 || outputRateHz == 0)
+  {
+    return false;
+  }
+
+  uint32_t divisor = greatestCommonDivisor(inputRateHz, outputRateHz);
+
+  inputRate = inputRateHz;
+  outputRate = outputRateHz;
+  upFactor = outputRate / divisor;
+  downFactor = inputRate / divisor;
+  tracking = trackingEnabled;
+  interpolated = tracking || (upFactor > RESAMPLER_MAX_PHASES);
+  phases = interpolated ? RESAMPLER_INTERPOLATED_PHASES : upFactor;
+  taps = std::min(getConfiguredTaps(config), maxTaps);
+  nominalStep = ((uint64_t) inputRate << 32) / outputRate;
+
+  designTable();
+  reset();
+  return true;
+}
+
+/**
+ * Calculates the polyphase rows of the Kaiser windowed sinc. Row p holds the coefficients of an output
+ * frame at p / phases input frames after the centre of the window, each row normalised to unity gain.
+ */
+void Resampler::designTable()
+{
+  const ResamplerDesign &design = resamplerDesigns[config->quality];
+  const double cutoff = 0.5 * design.rolloff * std::min(1.0, (double) outputRate / (double) inputRate);
+  const double halfLength = (double) taps / 2.0;
+  const double windowScale = 1.0 / besselI0(design.beta);
+  double row[RESAMPLER_MAX_TAPS];
+
+  for (uint32_t p = 0; p <= phases; p++)
+  {
+    double sum = 0.0;
+
+    for (uint32_t k = 0; k < taps; k++)
+    {
+      double t = halfLength - 1.0 - (double) k + (double) p / (double) phases;
+      double x = t / halfLength;
+      double window = (fabs(x) < 1.0) ? besselI0(design.beta * sqrt(1.0 - x * x)) * windowScale : 0.0;
+      double sinc = (t == 0.0) ? 2.0 * cutoff : sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+
+      row[k] = sinc * window;
+      sum += row[k];
+    }
+
+    for (uint32_t k = 0; k < taps; k++)
+    {
+      coefficients[p * taps + k] = (float32_t) (row[k] / sum);
+    }
+  }
+}
+
+/**
+ * Clears the input buffer and the drift tracking, e.g. when the source starts over.
+ * The buffer starts with half a window of silence, so that the first output frame is the first input frame.
+ */
+void Resampler::reset()
+{
+  readIndex = 0;
+  writeIndex = taps / 2 - 1;
+  memset(history, 0, writeIndex * 2 * sizeof(float32_t));
+
+  phase = 0;
+  fraction = 0;
+  step = nominalStep;
+  driftPpm = 0.0f;
+  driftIntegral = 0.0f;
+  smoothedFillError = 0.0f;
+}
+
+/**
+ * Returns how far the window moves over the given number of output frames
+ */
+uint32_t Resampler::getConsumedFrames(uint32_t frames) const
+{
+  if (interpolated)
+  {
+    return (uint32_t) (((uint64_t) fraction + (uint64_t) frames * step) >> 32);
+  }
+
+  return (uint32_t) (((uint64_t) phase + (uint64_t) frames * downFactor) / upFactor);
+}
+
+/**
+ * Returns the number of input frames that have to be written before run() can produce the given number of frames
+ * @param frames output frames
+ */
+uint32_t Resampler::getMissingFrames(uint32_t frames) const
+{
+  if (frames == 0)
+  {
+    return 0;
+  }
+
+  uint32_t required = readIndex + getConsumedFrames(frames - 1) + taps;
+
+  return (required > writeIndex) ? required - writeIndex : 0;
+}
+
+/**
+ * Appends source frames to the input buffer
+ * @param pSrc interleaved stereo samples
+ * @param frames
+ * @return false if the frames do not fit (nothing is written)
+ */
+bool Resampler::write(const int16_t *pSrc, uint32_t frames)
+{
+  if (writeIndex + frames > capacity)
+  {
+    return false;
+  }
+
+  float32_t *pDst = &history[writeIndex * 2];
+
+  for (uint32_t i = 0; i < frames * 2; i++)
+  {
+    pDst[i] = (float32_t) pSrc[i];
+  }
+
+  writeIndex += frames;
+  return true;
+}
+
+/**
+ * Produces one block of output frames. getMissingFrames() must be 0 for the same number of frames.
+ * @param pDst interleaved stereo samples
+ * @param frames
+ */
+void Resampler::run(int16_t *pDst, uint32_t frames)
+{
+  for (uint32_t i = 0; i < frames; i++)
+  {
+    const float32_t *pIn = &history[readIndex * 2];
+    float32_t left;
+    float32_t right;
+
+    if (!interpolated)
+    {
+      const float32_t *pCoeffs = &coefficients[phase * taps];
+      float32_t accLeft = 0.0f;
+      float32_t accRight = 0.0f;
+
+      for (uint32_t k = 0; k < taps; k++)
+      {
+        accLeft += pCoeffs[k] * pIn[2 * k];
+        accRight += pCoeffs[k] * pIn[2 * k + 1];
+      }
+
+      left = accLeft;
+      right = accRight;
+
+      phase += downFactor;
+      readIndex += phase / upFactor;
+      phase %= upFactor;
+    }
+    else
+    {
+      // The same window through the two neighbouring rows, interpolated by the rest of the fraction
+      const float32_t *pCoeffs = &coefficients[(fraction >> INTERPOLATED_ROW_SHIFT) * taps];
+      const float32_t *pNextCoeffs = pCoeffs + taps;
+      const float32_t weight = (float32_t) (fraction & INTERPOLATED_WEIGHT_MASK) * (1.0f / (float32_t) (1u << INTERPOLATED_ROW_SHIFT));
+      float32_t accLeft = 0.0f;
+      float32_t accRight = 0.0f;
+      float32_t nextLeft = 0.0f;
+      float32_t nextRight = 0.0f;
+
+      for (uint32_t k = 0; k < taps; k++)
+      {
+        accLeft += pCoeffs[k] * pIn[2 * k];
+        accRight += pCoeffs[k] * pIn[2 * k + 1];
+        nextLeft += pNextCoeffs[k] * pIn[2 * k];
+        nextRight += pNextCoeffs[k] * pIn[2 * k + 1];
+      }
+
+      left = accLeft + weight * (nextLeft - accLeft);
+      right = accRight + weight * (nextRight - accRight);
+
+      uint64_t position = (uint64_t) fraction + step;
+      readIndex += (uint32_t) (position >> 32);
+      fraction = (uint32_t) position;
+    }
+
+    pDst[2 * i] = toPcm16(left);
+    pDst[2 * i + 1] = toPcm16(right);
+  }
+
+  // Moves the rest of the input to the start of the buffer, for the next write()
+  writeIndex -= readIndex;
+  memmove(history, &history[readIndex * 2], writeIndex * 2 * sizeof(float32_t));
+  readIndex = 0;
+}
+
+/**
+ * Trims the ratio to keep the fill level of a source with its own clock at its target, with a PI loop on the smoothed error.
+ * It is called once per output block, and only has an effect after init() with tracking enabled.
+ * @param fillError buffered frames of the source and of getBufferedFrames() minus their target,
+ *        positive when the source runs faster than the nominal ratio
+ * @param frames output frames of the block
+ * @return the ratio correction, in ppm
+ */
+float32_t Resampler::trackFillLevel(float32_t fillError, uint32_t frames)
+{
+  if (!tracking)
+  {
+    return 0.0f;
+  }
+
+  const float32_t blockDuration = (float32_t) frames / (float32_t) outputRate;
+  const float32_t smoothing = blockDuration / (DRIFT_FILL_SMOOTHING_S + blockDuration);
+
+  smoothedFillError += smoothing * (fillError - smoothedFillError);
+
+  driftIntegral += DRIFT_INTEGRAL_PPM_S * blockDuration * smoothedFillError;
+  driftIntegral = std::min(std::max(driftIntegral, -RESAMPLER_MAX_DRIFT_PPM), RESAMPLER_MAX_DRIFT_PPM);
+
+  driftPpm = DRIFT_PROPORTIONAL_PPM * smoothedFillError + driftIntegral;
+  driftPpm = std::min(std::max(driftPpm, -RESAMPLER_MAX_DRIFT_PPM), RESAMPLER_MAX_DRIFT_PPM);
+
+  step = (uint64_t) ((double) nominalStep * (1.0 + 1e-6 * (double) driftPpm));
+  return driftPpm;
+}
+
+/**
+ * Returns the input frames written but not consumed yet, up to the position of the next output frame.
+ * Added to the fill level of the source, it changes smoothly while the source is read in whole chunks.
+ */
+float32_t Resampler::getBufferedFrames() const
+{
+  float32_t position = interpolated ? (float32_t) fraction * (1.0f / 4294967296.0f) : (float32_t) phase / (float32_t) upFactor;
+
+  return (float32_t) (writeIndex - readIndex) - position;
+}
+
+/**
+ * Returns the delay of the conversion, in output frames
+ */
+uint32_t Resampler::getLatency() const
+{
+  return (inputRate > 0) ? (taps / 2 * outputRate + inputRate / 2) / inputRate : 0;
+}
+
+/**
+ * Returns the bytes allocated by the resampler
+ */
+uint32_t Resampler::getMemorySize() const
+{
+  return ((RESAMPLER_MAX_PHASES + 1) * maxTaps + capacity * 2) * sizeof(float32_t);
+}
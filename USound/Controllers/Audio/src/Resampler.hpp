@@ -0,0 +1,154 @@
+//====================================================================
+//
+// COPYRIGHT 2020 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: polyphase sample-rate converter between the audio source and the filter pipeline
+//  Filename: Resampler.hpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+
+#pragma once
+
+#include "arm_math.h"
+#include "Controllers/System/pub/FilterConfiguration.hpp"
+
+#define RESAMPLER_MAX_PHASES          160     //!< Rows of the rational table, enough for 147:160 and 160:147 (44.1 <-> 48 kHz)
+#define RESAMPLER_INTERPOLATED_PHASES 128     //!< Rows of the interpolated table, a power of two
+#define RESAMPLER_MAX_TAPS            64
+#define RESAMPLER_MAX_DRIFT_PPM       1000.0f //!< Largest ratio correction of the drift tracking
+
+/**
+ * This class converts an interleaved stereo int16_t stream from the rate of the source to the rate of the audio path.
+ *
+ * The anti-aliasing/anti-imaging filter is a Kaiser windowed sinc, stored as a table of polyphase rows of
+ * `taps` coefficients each. When the ratio reduces to L:M with L up to RESAMPLER_MAX_PHASES (e.g. 160:147 from
+ * 44.1 to 48 kHz), every output frame uses one exact row, and the phase steps by M rows per output frame.
+ * For the other ratios, and when the ratio is trimmed by the drift tracking, the position is kept in 32.32 fixed
+ * point and the output is interpolated linearly between the two neighbouring rows of a RESAMPLER_INTERPOLATED_PHASES table.
+ *
+ * The source is written in whole chunks, as many as getMissingFrames() asks for, and every run() produces one output block.
+ */
+class Resampler
+{
+private:
+  const System::ResamplerConfiguration *config;
+  uint32_t maxTaps;                   //!< Taps the table is allocated for
+  uint32_t capacity;                  //!< Frames of the input buffer
+
+  float32_t *coefficients = nullptr;  //!< phases + 1 rows of taps coefficients, the last one for the interpolation of the last phase
+  float32_t *history = nullptr;       //!< Interleaved stereo input frames, capacity long
+
+  uint32_t taps = 0;
+  uint32_t phases = 1;
+  uint32_t inputRate = 0;
+  uint32_t outputRate = 0;
+  bool interpolated = false;
+  bool tracking = false;
+
+  uint32_t upFactor = 1;              //!< L of the rational ratio
+  uint32_t downFactor = 1;            //!< M of the rational ratio
+  uint32_t phase = 0;                 //!< Row of the next output frame, rational ratio
+
+  uint64_t nominalStep = 0;           //!< Input frames per output frame, 32.32 fixed point
+  uint64_t step = 0;                  //!< nominalStep with the drift correction
+  uint32_t fraction = 0;              //!< Position of the next output frame between two input frames, interpolated ratio
+
+  uint32_t readIndex = 0;             //!< First input frame of the window of the next output frame
+  uint32_t writeIndex = 0;            //!< Input frames in history
+
+  float32_t driftPpm = 0.0f;
+  float32_t driftIntegral = 0.0f;
+  float32_t smoothedFillError = 0.0f;
+
+  void designTable();
+  uint32_t getConsumedFrames(uint32_t frames) const;
+
+public:
+  Resampler(const System::ResamplerConfiguration *config, uint32_t maxFrames);
+
+  bool init(uint32_t inputRateHz, uint32_t outputRateHz, bool trackingEnabled);
+  void reset();
+
+  uint32_t getMissingFrames(uint32_t frames) const;
+  bool write(const int16_t *pSrc, uint32_t frames);
+  void run(int16_t *pDst, uint32_t frames);
+
+  float32_t trackFillLevel(float32_t fillError, uint32_t frames);
+
+  float32_t getBufferedFrames() const;
+  uint32_t getLatency() const;
+  uint32_t getMemorySize() const;
+
+  /**
+   * Returns the source rate given to init(), 0 before the first init()
+   */
+  uint32_t getInputRate() const
+  {
+    return inputRate;
+  }
+
+  /**
+   * Returns the output rate given to init(), 0 before the first init()
+   */
+  uint32_t getOutputRate() const
+  {
+    return outputRate;
+  }
+
+  /**
+   * Returns the taps per phase in use
+   */
+  uint32_t getTaps() const
+  {
+    return taps;
+  }
+
+  /**
+   * Returns true if the output is interpolated between two rows, false for the exact rows of a rational ratio
+   */
+  bool isInterpolated() const
+  {
+    return interpolated;
+  }
+
+  /**
+   * Returns true if the ratio follows trackFillLevel()
+   */
+  bool isTracking() const
+  {
+    return tracking;
+  }
+
+  /**
+   * Returns the ratio correction of the drift tracking, in ppm
+   */
+  float32_t getDriftPpm() const
+  {
+    return driftPpm;
+  }
+};
@@ -0,0 +1,117 @@
+//====================================================================
+//
+// COPYRIGHT 2020 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: silence detection for the filter bypass and the output standby
+//  Filename: SilenceDetector.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+
+#include "SilenceDetector.hpp"
+#include "Utilities/MathUtils.hpp"
+#include "BiquadFilters.hpp"
+
+/**
+ * @param config the bypass and standby delays, read on every block so that a reconfiguration takes effect at once
+ */
+SilenceDetector::SilenceDetector(const System::SilenceConfiguration *config) :
+    config(config)
+{
+}
+
+/**
+ * Checks the next input block.
+ * @param pSrc interleaved stereo samples
+ * @param frames
+ * @param sampleRateHz the rate of the block. A change of rate starts the detection over, since the output
+ * buffers may not hold a whole silent block at the new rate.
+ * @return true if the filters can be skipped for this block, and the last output played again
+ */
+bool SilenceDetector::processInput(const int16_t *pSrc, uint32_t frames, float32_t sampleRateHz)
+{
+  if (sampleRateHz != sampleRate)
+  {
+    sampleRate = sampleRateHz;
+    reset();
+  }
+
+  if (!is_zero_pcm16_block(pSrc, frames * MAX_CHANNELS))
+  {
+    reset();
+    return false;
+  }
+
+  silentFrames = (silentFrames > UINT32_MAX - frames) ? UINT32_MAX : silentFrames + frames;
+  bypassed = bypassed && config->bypassEnabled;
+
+  return bypassed;
+}
+
+/**
+ * Checks the output of the filters for a silent input block. Once the input has been silent for the bypass delay,
+ * an output of digital silence means that the filter tails, the delay lines and the lookahead have decayed.
+ * @param pDst the tweeter and woofer output buffers
+ * @param frames
+ */
+void SilenceDetector::processOutput(int16_t *pDst[2], uint32_t frames)
+{
+  if ((silentFrames == 0) || !config->bypassEnabled || ((float32_t) silentFrames < config->bypassDelay * sampleRate))
+  {
+    return;
+  }
+
+  bypassed = is_zero_pcm16_block(pDst[STREAM_ID::STREAM_TWEETER], frames * MAX_CHANNELS)
+      && is_zero_pcm16_block(pDst[STREAM_ID::STREAM_WOOFER], frames * MAX_CHANNELS);
+}
+
+/**
+ * @return true once the input has been silent for the bypass delay, when the filter tails have decayed. It does not
+ * need the filter output to be digital silence, nor the bypass to be enabled.
+ */
+bool SilenceDetector::isInputSettled() const
+{
+  return (silentFrames > 0) && ((float32_t) silentFrames >= config->bypassDelay * sampleRate);
+}
+
+/**
+ * @return true once the input has been silent for the standby delay, and at least for the bypass delay. Whether
+ * the filters are bypassed does not matter, so the standby also works with the bypass disabled.
+ */
+bool SilenceDetector::isStandbyDue() const
+{
+  return config->standbyEnabled && isInputSettled() && ((float32_t) silentFrames >= config->standbyDelay * sampleRate);
+}
+
+/**
+ * Starts the detection over, as after a block of audio
+ */
+void SilenceDetector::reset()
+{
+  silentFrames = 0;
+  bypassed = false;
+}
@@ -0,0 +1,69 @@
+//====================================================================
+//
+// COPYRIGHT 2020 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: silence detection for the filter bypass and the output standby
+//  Filename: SilenceDetector.hpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#pragma once
+
+#include "arm_math.h"
+#include "Controllers/System/pub/FilterConfiguration.hpp"
+
+/**
+ * This class tracks the digital silence at the input of the audio path. Once the input has been silent for
+ * the bypass delay and the filters put out digital silence, their tails have decayed and the audio task can
+ * play the last (silent) output again instead of running them. After the standby delay, the output stages
+ * can be powered down. Any sample that is not zero ends both at once, within the same block.
+ */
+class SilenceDetector
+{
+private:
+  const System::SilenceConfiguration *config;
+  float32_t sampleRate = 0.0f;
+  uint32_t silentFrames = 0;            //!< Consecutive frames of digital silence at the input, saturated
+  bool bypassed = false;                //!< The filter output has decayed to digital silence
+
+public:
+  SilenceDetector(const System::SilenceConfiguration *config);
+
+  bool processInput(const int16_t *pSrc, uint32_t frames, float32_t sampleRateHz);
+  void processOutput(int16_t *pDst[2], uint32_t frames);
+  bool isInputSettled() const;
+  bool isStandbyDue() const;
+  void reset();
+
+  /**
+   * @return true while the filters are bypassed
+   */
+  bool isBypassed() const
+  {
+    return bypassed;
+  }
+};
@@ -31,7 +31,7 @@
 //
 //====================================================================
 
-#include "Controllers/System/pub/SystemConfiguration.hpp"
+#include "Controllers/System/pub/FilterConfiguration.hpp"
 #include "USoundAla.hpp"
 #include "cmath"
 
@@ -34,7 +34,7 @@
 
 #pragma once
 
-#include "Controllers/System/pub/SystemConfiguration.hpp"
+#include "Controllers/System/pub/FilterConfiguration.hpp"
 #include "BiquadFilters.hpp"
 
 #define CHANNEL_BUFFER_SIZE 432
@@ -55,4 +55,13 @@ public:
 
   void init();
   void run(float *pSrcLeft, float *pSrcRight);
+
+  /**
+   * Sets the number of frames of the next blocks, up to the block size given to the constructor
+   * @param frames
+   */
+  void setBlockSize(uint32_t frames)
+  {
+    blockSize = frames;
+  }
 };
@@ -39,9 +39,13 @@
 #include "vt100.hpp"
 #include "gpio.h"
 #include "Controllers/Filesystem/pub/Filesystem.hpp"
+#include "Utilities/MathUtils.hpp"
 #include <cstring>
 
 #define COUNT_OF(X) (sizeof(X) / sizeof(*X))
+
+#define LEVEL_POLL_TIME 5         // ms between the reads of the output taps, well within the 20 ms they hold
+#define LEVEL_POLLS_PER_LINE 20   // Reads of the output taps per update of the level line
 #if UART_CONSOLE_ENABLED == 1
 
 namespace cli
@@ -575,6 +579,225 @@ bool CliCommands::audioPlayerStatus(const CliCommand &cmd, StringTokenizer &toke
   return true;
 }
 
+/**
+ * Shows the processing load of the audio path once per second.
+ * The user can exit the loop by pressing any key
+ * @param cmd
+ * @param tokenizer
+ * @param print
+ * @param gets
+ * @return
+ */
+bool CliCommands::audioLoadStatus(const CliCommand &cmd, StringTokenizer &tokenizer, std::function<void(const char *text)> print,
+    std::function<void(char*, uint16_t*, uint32_t)> gets)
+{
+  auto audioService = globalServices->getAudioService();
+  std::string response;
+  uint32_t delay = 1000;
+  uint16_t size;
+  char ch;
+  char tmp[64];
+
+  response.reserve(128);
+  do
+  {
+    System::AudioLoadStats load = audioService->getAudioLoad();
+
+    response.clear();
+    response.append("\033[120D\033[2K");
+
+    sprintf(tmp, "LOAD %lu.%02lu %% PEAK %lu.%02lu %% ", load.averageLoad / 100, load.averageLoad % 100,
+        load.peakLoad / 100, load.peakLoad % 100);
+    response.append(ANSI_YELLOW_NORMAL).append(tmp).append(ANSI_RESET);
+
+    sprintf(tmp, "[ %lu of %lu blocks bypassed ] ", load.bypassedBlocks, load.blocks);
+    response.append(tmp);
+
+    if (load.standby)
+    {
+      response.append(ANSI_BLUE_NORMAL).append("STANDBY ").append(ANSI_RESET);
+    }
+
+    if (load.wakeUpTime > 0)
+    {
+      sprintf(tmp, "WAKE-UP %lu.%02lu ms DELAY %lu.%02lu ms", load.wakeUpTime / 1000, (load.wakeUpTime % 1000) / 10,
+          load.wakeLatency / 1000, (load.wakeLatency % 1000) / 10);
+      response.append(tmp);
+    }
+
+    print(response.c_str());
+    size = 1;
+    gets(&ch, &size, delay);
+    if (size > 0)
+    {
+      delay = 0;
+    }
+  }
+  while (delay > 0);
+
+  print("\n");
+  return true;
+}
+
+/**
+ * Shows the peak level of the output streams, as played out, ten times per second.
+ * It reads the output taps of the audio service, so the data out task only copies the streams while it runs.
+ * The taps are read every LEVEL_POLL_TIME ms, before they wrap, and each line shows the peak of the reads since
+ * the last one.
+ * The user can exit the loop by pressing any key
+ * @param cmd
+ * @param tokenizer
+ * @param print
+ * @param gets
+ * @return
+ */
+bool CliCommands::audioLevelStatus(const CliCommand &cmd, StringTokenizer &tokenizer, std::function<void(const char *text)> print,
+    std::function<void(char*, uint16_t*, uint32_t)> gets)
+{
+  static const char *streamNames[] = { "TWEETER", "WOOFER" };
+  static const System::SaiInterface streams[] = { System::SaiInterface::TWEETER, System::SaiInterface::WOOFER };
+
+  auto audioService = globalServices->getAudioService();
+  BroadcastReader readers[COUNT_OF(streams)];
+  int16_t samples[128];
+  std::string response;
+  int32_t peaks[COUNT_OF(streams)] = { 0, 0 };
+  uint32_t polls = 0;
+  uint32_t delay = LEVEL_POLL_TIME;
+  uint16_t size;
+  char ch;
+  char tmp[64];
+
+  for (uint32_t i = 0; i < COUNT_OF(streams); i++)
+  {
+    audioService->getOutputTap(streams[i])->attach(readers[i]);
+  }
+
+  response.reserve(128);
+  do
+  {
+    for (uint32_t i = 0; i < COUNT_OF(streams); i++)
+    {
+      BroadcastFifo<int16_t> *tap = audioService->getOutputTap(streams[i]);
+      uint32_t len;
+
+      while ((len = tap->read(readers[i], samples, COUNT_OF(samples))) > 0)
+      {
+        for (uint32_t j = 0; j < len; j++)
+        {
+          int32_t level = (samples[j] < 0) ? -samples[j] : samples[j];
+          peaks[i] = (level > peaks[i]) ? level : peaks[i];
+        }
+      }
+    }
+
+    if (++polls >= LEVEL_POLLS_PER_LINE)
+    {
+      response.clear();
+      response.append("\033[120D\033[2K");
+
+      for (uint32_t i = 0; i < COUNT_OF(streams); i++)
+      {
+        response.append(ANSI_YELLOW_NORMAL).append(streamNames[i]).append(ANSI_RESET);
+        if (peaks[i] > 0)
+        {
+          sprintf(tmp, " %4ld dBFS  ", (int32_t) (20.0f * log10fApprox(peaks[i] / 32768.0f)));
+        }
+        else
+        {
+          sprintf(tmp, "    - dBFS  ");
+        }
+        response.append(tmp);
+        peaks[i] = 0;
+      }
+
+      sprintf(tmp, "[ %lu samples lost ] ", readers[0].lostSamples + readers[1].lostSamples);
+      response.append(tmp);
+
+      print(response.c_str());
+      polls = 0;
+    }
+
+    size = 1;
+    gets(&ch, &size, delay);
+    if (size > 0)
+    {
+      delay = 0;
+    }
+  }
+  while (delay > 0);
+
+  for (uint32_t i = 0; i < COUNT_OF(streams); i++)
+  {
+    audioService->getOutputTap(streams[i])->detach(readers[i]);
+  }
+
+  print("\n");
+  return true;
+}
+
+/**
+ * Shows the fill level of the jitter buffers of the SAI and USB inputs once per second, in frames.
+ * The user can exit the loop by pressing any key
+ * @param cmd
+ * @param tokenizer
+ * @param print
+ * @param gets
+ * @return
+ */
+bool CliCommands::jitterBufferStatus(const CliCommand &cmd, StringTokenizer &tokenizer, std::function<void(const char *text)> print,
+    std::function<void(char*, uint16_t*, uint32_t)> gets)
+{
+  static const char *sourceNames[] = { "SAI", "USB" };
+  static const System::SystemAudioSource sources[] = { System::SystemAudioSource::AUDIO_SRC_SAI, System::SystemAudioSource::AUDIO_SRC_USB };
+
+  auto systemController = globalServices->getSystemController();
+  std::string response;
+  uint32_t delay = 1000;
+  uint16_t size;
+  char ch;
+  char tmp[96];
+
+  response.reserve(256);
+  do
+  {
+    response.clear();
+    response.append("\033[120D\033[2K");
+
+    for (uint32_t i = 0; i < COUNT_OF(sources); i++)
+    {
+      System::AudioSource<uint16_t> *audioSrc = systemController->getAudioSource(sources[i]);
+      System::JitterBufferStats stats;
+
+      if (!audioSrc || !audioSrc->getJitterBufferStats(stats))
+      {
+        continue;
+      }
+
+      response.append(ANSI_YELLOW_NORMAL).append(sourceNames[i]).append(ANSI_RESET);
+      sprintf(tmp, " FILL %lu/%lu/%lu DEPTH %lu JITTER %lu ", stats.minFill, stats.averageFill, stats.maxFill,
+          stats.targetDepth, stats.arrivalJitter);
+      response.append(tmp);
+
+      sprintf(tmp, "[ %lu underflows %lu overflows %lu concealed %lu dropped ] ", stats.underflows, stats.overflows,
+          stats.concealedFrames, stats.droppedFrames);
+      response.append(tmp);
+    }
+
+    print(response.c_str());
+    size = 1;
+    gets(&ch, &size, delay);
+    if (size > 0)
+    {
+      delay = 0;
+    }
+  }
+  while (delay > 0);
+
+  print("\n");
+  return true;
+}
+
 const CliCommand CliCommands::bistCommands[] =
     {
         { "status", "Shows BIST status", CliCommands::showBistStatus, 0 },
@@ -606,6 +829,9 @@ const CliCommand CliCommands::systemCommands[] =
         { "write", "Writes data to a bus", CliCommands::writeToBus, 0 },
         { "ls", "Lists sdcard files", CliCommands::listFiles, 0 },
         { "player", "Shows status of the audio player", CliCommands::audioPlayerStatus, 0 },
+        { "load", "Shows the processing load of the audio path. Press any key to exit", CliCommands::audioLoadStatus, 0 },
+        { "level", "Shows the peak level of the output streams. Press any key to exit", CliCommands::audioLevelStatus, 0 },
+        { "jitter", "Shows the fill, depth and arrival jitter of the input jitter buffers. Press any key to exit", CliCommands::jitterBufferStatus, 0 },
     };
 
 const CliCommand CliCommands::audioCommands[] =
@@ -75,6 +75,12 @@ private:
       std::function<void(char*, uint16_t*, uint32_t)> gets);
   static bool audioPlayerStatus(const CliCommand &cmd, StringTokenizer &tokenizer, std::function<void(const char *text)> print,
       std::function<void(char*, uint16_t*, uint32_t)> gets);
+  static bool audioLoadStatus(const CliCommand &cmd, StringTokenizer &tokenizer, std::function<void(const char *text)> print,
+      std::function<void(char*, uint16_t*, uint32_t)> gets);
+  static bool audioLevelStatus(const CliCommand &cmd, StringTokenizer &tokenizer, std::function<void(const char *text)> print,
+      std::function<void(char*, uint16_t*, uint32_t)> gets);
+  static bool jitterBufferStatus(const CliCommand &cmd, StringTokenizer &tokenizer, std::function<void(const char *text)> print,
+      std::function<void(char*, uint16_t*, uint32_t)> gets);
 
   static bool drcConfiguration(const CliCommand &cmd, StringTokenizer &tokenizer, std::function<void(const char *text)> print,
       std::function<void(char*, uint16_t*, uint32_t)> gets);
@@ -37,7 +37,7 @@
 #include "Controllers/Service/pub/Services.hpp"
 #include "Controllers/System/pub/SystemConfiguration.hpp"
 #include "Controllers/Filesystem/pub/Filesystem.hpp"
-#include "Utilities/Fifo/pub/Fifo.hpp"
+#include "Utilities/Fifo/pub/SpscFifo.hpp"
 
 
 namespace Controller
@@ -88,9 +88,13 @@ private:
   std::string filename;
   MediaFileReader *fileReaders[AudioFileReader::MAX_READERS];
   MediaFileReader *activeReader;
-  Fifo<int16_t> samplesFifo;
-  uint32_t audioBufferSize = 0;
+  SpscFifo<int16_t> samplesFifo;    //!< Decoded in place by the player task, read in place by the audio task
+  int16_t *chunkSamples = nullptr;   //!< A chunk that wraps around the end of the fifo, or silence
+  uint32_t readPending = 0;          //!< Samples handed out by getData(), released by consumedData()
+  uint32_t audioBufferSize = 0;      //!< Most samples the fifo is filled with
   uint32_t chunkSize = 0;
+  uint32_t longChunkCount = 0;       //!< Chunks decoded at once
+  uint32_t frequency = 0;            //!< The sampling rate of the samples in the fifo
 
 private:
   static void taskEntry(void *argument);
@@ -100,6 +104,8 @@ private:
   void pause();
   bool playFile(bool advanceNext);
   void silenceAudioSamples();
+  void configureFrequency(uint32_t fileFrequency);
+  void requestDecode(uint32_t length);
 
 public:
   AudioPlayer();
@@ -38,14 +38,15 @@
 #include "Controllers/System/pub/SystemController.hpp"
 #include "Controllers/System/pub/SystemStatus.hpp"
 #include "Interfaces/pub/SystemControl.hpp"
-#include "Utilities/Fifo/pub/Fifo.hpp"
+#include "Utilities/Fifo/pub/SpscFifo.hpp"
 #include "OAL/pub/Oal.hpp"
 #include "cmsis_os2.h"
 #include <string.h>
 #include <stdlib.h>
+#include <algorithm>
 
-#define PREBUFFERING 150
-#define LONG_CHUNK   50   // 200ms of audio
+#define PREBUFFERING     3     // Long chunks in the samples fifo
+#define LONG_CHUNK_TIME  200   // Milliseconds of audio decoded at once
 
 static uint8_t mediaPlayerBuffer[128 * 1024]__attribute__((section("._ram2"))) __attribute__ ((aligned (32)));
 
@@ -100,14 +101,9 @@ AudioPlayer::AudioPlayer() :
  */
 void AudioPlayer::init()
 {
-  uint32_t bufferTime = globalServices->getSystemConfiguration()->getBufferingTIme();
-
-  chunkSize = bufferTime * 2 * 48;
-  audioBufferSize = PREBUFFERING * chunkSize;
   audioSsamples = (int16_t*) mediaPlayerBuffer;
-  samplesFifo.reset(audioSsamples, audioBufferSize);
-
-  silenceAudioSamples();
+  chunkSamples = new int16_t[globalServices->getSystemConfiguration()->getMaxBlockFrames() * 2];
+  configureFrequency(globalServices->getSystemConfiguration()->getFrequency());
 
 #if MP3_READER_MODULE_ENABLED == 1
   fileReaders[AudioFileReader::MP3_READER] = new Mp3Reader();
@@ -125,9 +121,10 @@ void AudioPlayer::init()
 }
 
 /**
- * Returns the current data pointer
- * @param data
- * @param length
+ * Returns the next chunk of samples, in place in the fifo unless it wraps around the end of the fifo. The samples
+ * stay in the fifo until consumedData(). A fifo that runs short is padded with silence, and silence is returned
+ * while the player does not play.
+ * @param length number of samples (for all channels)
  */
 uint16_t* AudioPlayer::getData(uint32_t length)
 {
@@ -136,38 +133,58 @@ uint16_t* AudioPlayer::getData(uint32_t length)
     return nullptr;
   }
 
-  uint16_t *data = (uint16_t*) samplesFifo.getReadBufferPtr();
+  readPending = 0;
 
-  if (audioState == AudioPlayerState::AP_PLAYING)
+  if (audioState != AudioPlayerState::AP_PLAYING)
   {
-    samplesFifo.consumeBuffer(chunkSize);
+    memset(chunkSamples, 0, length * sizeof(int16_t));
+    return (uint16_t*) chunkSamples;
   }
 
-  return data;
+  FifoSpan<int16_t> span = samplesFifo.acquireRead(length);
+  readPending = span.getLength();
+
+  if (span.length[0] == length)
+  {
+    return (uint16_t*) span.data[0];
+  }
+
+  memcpy(chunkSamples, span.data[0], span.length[0] * sizeof(int16_t));
+  memcpy(&chunkSamples[span.length[0]], span.data[1], span.length[1] * sizeof(int16_t));
+  memset(&chunkSamples[readPending], 0, (length - readPending) * sizeof(int16_t));
+
+  return (uint16_t*) chunkSamples;
 }
 
 /**
- * Triggers the mp3 player to decode more data
+ * Releases the chunk returned by getData() and triggers the mp3 player to decode more data
  * @param length number of samples to generate (for all channels)
  */
 void AudioPlayer::consumedData(uint32_t length)
+{
+  samplesFifo.release(readPending);
+  readPending = 0;
+
+  requestDecode(length);
+}
+
+/**
+ * Triggers the mp3 player to decode more data
+ * @param length number of samples to generate (for all channels)
+ */
+void AudioPlayer::requestDecode(uint32_t length)
 {
   Mp3PlayerCmd cmd = { AP_CMD_DECODE_MORE, 0, (uint16_t) length };
   globalServices->getOal()->sendMessageToQueue(controlMessageQueue, &cmd, 0);
 }
 
 /**
- * Returns the configured operating frequency (in Hz)
+ * Returns the configured operating frequency (in Hz), i.e. the rate of the samples in the fifo
  * @return
  */
 uint32_t AudioPlayer::getFrequency()
 {
-  if (activeReader)
-  {
-    return activeReader->getFrequency();
-  }
-
-  return 48000;
+  return frequency;
 }
 
 /**
@@ -183,7 +200,42 @@ void AudioPlayer::notifyDataAvailable()
  */
 void AudioPlayer::silenceAudioSamples()
 {
-  memset(audioSsamples, 0, audioBufferSize * sizeof(int16_t));
+  memset(audioSsamples, 0, samplesFifo.getSize() * sizeof(int16_t));
+}
+
+/**
+ * Sizes the fifo for the sampling rate of a file, and empties it if the rate changes. The chunks are one audio
+ * block long, and the fifo is filled with up to 600ms of audio, as a whole number of long chunks, as long as it fits
+ * in the media player buffer (e.g. not at 96 kHz). The fifo itself spans the whole buffer, a power of two, so the
+ * chunks may wrap around its end. Files at rates the audio path does not support are resampled by the audio service,
+ * unless they are beyond the buffers (MIN_SOURCE_FREQUENCY to MAX_AUDIO_FREQUENCY): those are played at the current
+ * rate of the audio path.
+ * @param fileFrequency
+ */
+void AudioPlayer::configureFrequency(uint32_t fileFrequency)
+{
+  auto systemConfig = globalServices->getSystemConfiguration();
+
+  if ((fileFrequency < MIN_SOURCE_FREQUENCY) || (fileFrequency > MAX_AUDIO_FREQUENCY))
+  {
+    fileFrequency = systemConfig->getFrequency();
+  }
+
+  if (fileFrequency == frequency)
+  {
+    return;
+  }
+
+  uint32_t bufferTime = systemConfig->getBufferingTIme();
+  uint32_t maxLongChunkCount = (sizeof(mediaPlayerBuffer) / sizeof(int16_t)) / (PREBUFFERING * systemConfig->getBlockFrames(fileFrequency) * 2);
+
+  frequency = fileFrequency;
+  chunkSize = systemConfig->getBlockFrames(frequency) * 2;
+  longChunkCount = std::min<uint32_t>(LONG_CHUNK_TIME / bufferTime, maxLongChunkCount);
+  audioBufferSize = PREBUFFERING * longChunkCount * chunkSize;
+  samplesFifo.reset(audioSsamples, sizeof(mediaPlayerBuffer) / sizeof(int16_t));
+
+  silenceAudioSamples();
 }
 
 /**
@@ -284,11 +336,12 @@ bool AudioPlayer::playFile(bool advanceNext)
   }
 
   activeReader = reader;
+  configureFrequency(reader->getFrequency());
 
   // Prime the audio fifo
-  consumedData(chunkSize);
-  consumedData(chunkSize);
-  consumedData(chunkSize);
+  requestDecode(chunkSize);
+  requestDecode(chunkSize);
+  requestDecode(chunkSize);
 
   return true;
 }
@@ -363,13 +416,22 @@ void AudioPlayer::taskLoop()
           break;
         }
 
-        uint32_t readSampleCount = LONG_CHUNK * (uint32_t) cmd.arg;
-        if (samplesFifo.getCapacity() >= readSampleCount)
+        // The samples are decoded in place, in two parts when they wrap around the end of the fifo,
+        // as long as the fifo stays within audioBufferSize samples
+        uint32_t readSampleCount = longChunkCount * (uint32_t) cmd.arg;
+        if (samplesFifo.getCapacity() >= readSampleCount + samplesFifo.getSize() - audioBufferSize)
         {
-          uint16_t *dstPtr = (uint16_t*) samplesFifo.getWriteBufferPtr();
-          uint32_t allSamplesRead = activeReader->loadNextChunk((uint8_t*) dstPtr, readSampleCount);
+          FifoSpan<int16_t> span = samplesFifo.acquireWrite(readSampleCount);
+          uint32_t samplesRead = span.length[0];
+          bool allSamplesRead = activeReader->loadNextChunk((uint8_t*) span.data[0], span.length[0]);
+
+          if (allSamplesRead && (span.length[1] > 0))
+          {
+            allSamplesRead = activeReader->loadNextChunk((uint8_t*) span.data[1], span.length[1]);
+            samplesRead += span.length[1];
+          }
 
-          samplesFifo.incrementBufferWr(readSampleCount);
+          samplesFifo.commitWrite(samplesRead);
 
           if (!allSamplesRead)
           {
@@ -96,6 +96,12 @@ bool WavReader::init(System::File *wavFile)
 
   samples = *((uint32_t*) &buffer[40]) / sizeof(int16_t);
   channels = *((uint16_t*) &buffer[22]);
+  frequency = *((uint32_t*) &buffer[24]);
+
+  if (!channels || !frequency)
+  {
+    return false;
+  }
 
   return true;
 }
@@ -137,10 +143,13 @@ bool WavReader::loadNextChunk(uint8_t *buffer, uint32_t sampleCount)
   return 1;
 }
 
+/**
+ * Returns the sampling rate of the file, from the wav header
+ * @return
+ */
 uint32_t WavReader::getFrequency()
 {
-  //TODO: Read this from the wav header
-  return 48000;
+  return frequency;
 }
 
 void WavReader::getPlaybackInfo(uint32_t &trackTime, uint32_t &playbackTime)
@@ -148,8 +157,8 @@ void WavReader::getPlaybackInfo(uint32_t &trackTime, uint32_t &playbackTime)
   trackTime = 0;
   playbackTime = 0;
 
-  trackTime = (samples / (48000 * channels));
-  playbackTime = samplesConsumed / 48000;
+  trackTime = (samples / (frequency * channels));
+  playbackTime = samplesConsumed / frequency;
 }
 
 
@@ -48,6 +48,7 @@ protected:
   System::File *wavFile = nullptr;
   uint32_t samples = 0;
   uint32_t channels = 0;
+  uint32_t frequency = DEFAULT_AUDIO_FREQUENCY;
   uint32_t samplesConsumed = 0;
 
 public:
@@ -0,0 +1,79 @@
+//====================================================================
+//
+// COPYRIGHT 2026 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: Filter configuration parser. It transforms bson documents to filter configuration
+//  Filename: FilterConfigParser.hpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#pragma once
+#include "Controllers/System/pub/FilterConfiguration.hpp"
+#include <stdint.h>
+
+namespace System
+{
+
+/**
+ * Helper class that transforms Bson documents to filter configuration.
+ * It has no dependency on the filesystem or the hardware configuration, so it is also used by the host tools.
+ */
+class FilterConfigParser
+{
+private:
+  System::FilterConfiguration *filterConfig;
+
+  void extractDrcConfig(const uint8_t *data, const char *name, System::DrcConfiguration &drcConfig);
+  void extractAlaConfig(const uint8_t *data, const char *name, System::AlaConfiguration &alaConfig);
+  void extractPeakLimiterConfig(const uint8_t *data, const char *name, System::PeakLimiterConfiguration &limiterConfig);
+  void extractCrossoverConfig(const uint8_t *data, const char *name, System::CrossoverConfiguration &xoverConfig);
+  void extractResamplerConfig(const uint8_t *data, const char *name, System::ResamplerConfiguration &resamplerConfig);
+  void extractFirConfig(const uint8_t *data, const char *name, System::FirConfiguration &firConfig);
+  void extractDelayConfig(const uint8_t *data, const char *name, System::DelayConfiguration &delayConfig);
+  void extractOutputRouting(const uint8_t *data, const char *name, System::OutputRoutingConfiguration &routing);
+  void extractSilenceConfig(const uint8_t *data, const char *name, System::SilenceConfiguration &silenceConfig);
+  void extractJitterBufferConfig(const uint8_t *data, const char *name, System::JitterBufferConfiguration &jitterBufferConfig);
+  void extractStageGraph(const uint8_t *data, const char *name, System::StageGraphConfiguration &graph);
+  void loadStageReference(const uint8_t *data, const char *nodeName, const char *bandName, System::StageReference &ref);
+
+  uint32_t getArraySize(const uint8_t *data, const char *name);
+  uint32_t getFirTapCount(const uint8_t *data, const char *name);
+  void loadFirTaps(const uint8_t *data, const char *name, float32_t *taps, uint32_t maxCount);
+  void loadFloatArray(const uint8_t *data, const char *name, float32_t *coeffArray, uint32_t maxCount);
+  void loadIntArray(const uint8_t *data, const char *name, int32_t *coeffArray, uint32_t maxCount);
+  void loadInt(const uint8_t *data, const char *name, uint32_t *value);
+  void loadString(const uint8_t *data, const char *name, std::string &value);
+  void loadFloat32(const uint8_t *data, const char *name, float32_t *value);
+  void loadBool(const uint8_t *data, const char *name, bool *value);
+
+public:
+  FilterConfigParser(System::FilterConfiguration *filterConfig);
+
+  void extractConfig(const uint8_t *data);
+};
+
+}
@@ -0,0 +1,353 @@
+//====================================================================
+//
+// COPYRIGHT 2026 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: Filter pipeline configuration. It has no hardware dependencies
+//              so that the DSP code can also be built for the host.
+//  Filename: FilterConfiguration.hpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string.h>
+#include "Controllers/System/pub/ModuleConfig.hpp"
+#include "arm_math.h"
+
+#define MASTER_EQ_STAGES 8
+#define XOVER_EQ_STAGES 8
+#define ALA_COEFFICIENT_SIZE 84
+#define FIR_MAX_TAPS 4096
+#define STAGE_INPUT  -1         //!< StageReference to the input of the chain
+#define STAGE_NONE   -2         //!< StageReference that is not connected
+
+namespace System
+{
+
+/**
+ * Selects the implementation of the biquad filter chains
+ */
+enum FilterEngine
+{
+  FILTER_ENGINE_DF1,              //!< One DF1 cascade per channel, working on separate channel buffers
+  FILTER_ENGINE_STEREO_DF2T,      //!< One transposed DF2 cascade for both channels, working on interleaved buffers
+  FILTER_ENGINE_Q31,              //!< Fixed-point chain, with one Q31 DF1 cascade for both channels, working on interleaved buffers
+  MAX_FILTER_ENGINES
+};
+
+/**
+ * Defines the system configuration attributes of a DRC block
+ */
+struct DrcConfiguration
+{
+public:
+  float32_t attackDuration = 0.2f;                      // 200 ms
+  float32_t releaseDuration = 1.0f;                     // 1 sec
+  float32_t compressionThresholdFullScaleDb = 20.0f;    //!< Threshold for compression, relative to digital full scale
+  float32_t compressionRatio = 2.0f;                    //<! Compression ratio
+  float32_t sampleRateHz = 48000;                       //!< The audio sampling rate
+  float32_t postGain = 0.0f;                            //!< Make-up gain to adjust the DRC result
+  uint32_t controlInterval = 1;                         //!< Samples per gain calculation. Above 1, the gain is interpolated in between
+  bool enabled = false;                                 //!< If false, the DRC block is bypassed
+};
+
+/**
+ * Defines the configuration attributes of the lookahead peak limiter
+ */
+struct PeakLimiterConfiguration
+{
+public:
+  float32_t thresholdFullScaleDb = -1.0f;               //!< Output ceiling, relative to digital full scale
+  float32_t lookaheadDuration = 0.0015f;                //!< 1.5 ms, also the latency added by the limiter
+  float32_t releaseDuration = 0.05f;                    //!< 50 ms
+  float32_t sampleRateHz = 48000;                       //!< The audio sampling rate
+  bool enabled = false;                                 //!< If true, it replaces the limiter DRC
+};
+
+/**
+ * Selects how the x-over splits the signal into the woofer and tweeter bands
+ */
+enum CrossoverType
+{
+  CROSSOVER_RAW_COEFFICIENTS,     //!< Two independent biquad cascades per channel, from xoverEqCoeffs
+  CROSSOVER_LR4,                  //!< Complementary 4th order Linkwitz-Riley split, computed in one pass
+  MAX_CROSSOVER_TYPES
+};
+
+/**
+ * Defines the x-over configuration attributes
+ */
+struct CrossoverConfiguration
+{
+public:
+  CrossoverType type = CrossoverType::CROSSOVER_RAW_COEFFICIENTS;
+  float32_t frequencyHz = 2500.0f;                      //!< Crossover frequency (-6 dB point of both bands)
+  float32_t sampleRateHz = 48000;                       //!< The audio sampling rate
+};
+
+/**
+ * Selects the length and the stopband of the resampler filter
+ */
+enum ResamplerQuality
+{
+  RESAMPLER_QUALITY_LOW,          //!< 16 taps per phase
+  RESAMPLER_QUALITY_MEDIUM,       //!< 32 taps per phase
+  RESAMPLER_QUALITY_HIGH,         //!< 64 taps per phase
+  MAX_RESAMPLER_QUALITIES
+};
+
+/**
+ * Defines the configuration attributes of the sample-rate converter between the audio source and the filter pipeline
+ */
+struct ResamplerConfiguration
+{
+public:
+  ResamplerQuality quality = ResamplerQuality::RESAMPLER_QUALITY_MEDIUM;
+  uint32_t taps = 0;                                    //!< Taps per phase (even, up to 64), 0 for the length of the quality
+  bool resampleSupportedRates = false;                  //!< If true, sources at other supported rates are resampled instead of switching the audio rate
+  bool driftTracking = true;                            //!< If true, the ratio follows the fill level of sources with their own clock
+};
+
+/**
+ * Defines the pre-distortion configuration attributes
+ */
+struct AlaConfiguration
+{
+public:
+  int32_t coefficients[ALA_COEFFICIENT_SIZE];
+  bool enabled;
+};
+
+enum MasterEqCoeffcientType
+{
+  LEFT,
+  RIGHT,
+  MAX_MASTER_EQ_COEFF_TYPES
+};
+
+enum XoverEqCoeffcientType
+{
+  LEFT_WOOFER,
+  LEFT_TWEETER,
+  RIGHT_WOOFER,
+  RIGHT_TWEETER,
+  MAX_XOVER_EQ_COEFF_TYPES
+};
+
+
+/**
+ * Selects where the FIR filters are placed in the pipeline
+ */
+enum FirPlacement
+{
+  FIR_PLACEMENT_MASTER,           //!< One filter per channel after the master EQ, in MasterEqCoeffcientType order (e.g. room correction)
+  FIR_PLACEMENT_CROSSOVER,        //!< The x-over split, one filter per band and channel in XoverEqCoeffcientType order (e.g. linear-phase x-over)
+  MAX_FIR_PLACEMENTS
+};
+
+/**
+ * Defines the configuration attributes of the FIR convolution stage
+ */
+struct FirConfiguration
+{
+public:
+  FirPlacement placement = FirPlacement::FIR_PLACEMENT_MASTER;
+  uint32_t taps = 0;                                    //!< Taps per filter (up to FIR_MAX_TAPS), 0 if no filter is loaded
+  std::shared_ptr<const float32_t> coefficients;        //!< The taps of all the filters, one filter after the other. Shared by the copies of the configuration
+  std::string fileName;                                 //!< The file on the SD card the taps are loaded from, empty if they come with the Bson configuration
+  bool enabled = false;
+
+  /**
+   * Returns the number of filters of the placement
+   */
+  uint32_t getFilterCount() const
+  {
+    return (placement == FirPlacement::FIR_PLACEMENT_CROSSOVER) ?
+        (uint32_t) XoverEqCoeffcientType::MAX_XOVER_EQ_COEFF_TYPES : (uint32_t) MasterEqCoeffcientType::MAX_MASTER_EQ_COEFF_TYPES;
+  }
+};
+
+/**
+ * Defines the configuration attributes of the time alignment of the output streams
+ */
+struct DelayConfiguration
+{
+public:
+  float32_t delayDuration[XoverEqCoeffcientType::MAX_XOVER_EQ_COEFF_TYPES] = { 0.0f };    //!< Delay of each output in seconds, fractions of a sample included
+  float32_t sampleRateHz = 48000;                       //!< The audio sampling rate
+  bool enabled = false;
+};
+
+/**
+ * Defines the power saving of the audio path while the source plays digital silence
+ */
+struct SilenceConfiguration
+{
+public:
+  float32_t bypassDelay = 0.5f;                         //!< Silence in seconds before the filters stop running, once their output has decayed to zero
+  float32_t standbyDelay = 60.0f;                       //!< Silence in seconds before the amplifiers go to standby
+  bool bypassEnabled = true;
+  bool standbyEnabled = true;                           //!< Independent of bypassEnabled
+};
+
+/**
+ * Defines the jitter buffer of the inputs with their own clock (SAI slave and USB). The depth is the margin of
+ * frames the buffer keeps, at its lowest, beyond the block being read.
+ */
+struct JitterBufferConfiguration
+{
+public:
+  float32_t targetDepth = 0.002f;                       //!< Depth in seconds the buffer starts with, and keeps if it does not adapt
+  float32_t minDepth = 0.0005f;                         //!< Lowest depth in seconds the adaptation goes down to
+  float32_t maxDepth = 0.005f;                          //!< Highest depth in seconds the adaptation goes up to
+  bool adaptive = true;                                 //!< If true, the depth follows the arrival jitter of the input
+};
+
+/**
+ * The channels of the output routing. As sources, the tweeter and woofer streams at the end of the pipeline.
+ * As outputs, the two slots of the interleaved tweeter and woofer output frames, in the same order.
+ */
+enum RoutingChannel
+{
+  ROUTING_TWEETER_LEFT,           //!< Output: first slot of the tweeter frame
+  ROUTING_TWEETER_RIGHT,          //!< Output: second slot of the tweeter frame
+  ROUTING_WOOFER_LEFT,
+  ROUTING_WOOFER_RIGHT,
+  MAX_ROUTING_CHANNELS
+};
+
+/**
+ * Defines the output routing matrix: each output slot is the sum of the sources, each with its gain.
+ * A negative gain inverts the polarity. The default routes each channel to one slot, as set up by
+ * SWAP_AUDIO_CHANNELS, INVERT_LEFT_CHANNEL and INVERT_RIGHT_CHANNEL.
+ */
+struct OutputRoutingConfiguration
+{
+public:
+  float32_t gains[RoutingChannel::MAX_ROUTING_CHANNELS][RoutingChannel::MAX_ROUTING_CHANNELS];    //!< gains[output][source], linear
+
+  OutputRoutingConfiguration()
+  {
+    const uint32_t leftSlot = (SWAP_AUDIO_CHANNELS == 1) ? 1 : 0;
+
+    memset(gains, 0, sizeof(gains));
+
+    for (uint32_t stream = 0; stream < RoutingChannel::MAX_ROUTING_CHANNELS; stream += 2)
+    {
+      gains[stream + leftSlot][stream] = INVERT_LEFT_CHANNEL ? -1.0f : 1.0f;
+      gains[stream + 1 - leftSlot][stream + 1] = INVERT_RIGHT_CHANNEL ? -1.0f : 1.0f;
+    }
+  }
+};
+
+/**
+ * Selects the processing of a node of the stage graph. Each type can be used once per graph.
+ */
+enum StageType
+{
+  STAGE_TYPE_MASTER_EQ,           //!< masterEqCoeffs cascades
+  STAGE_TYPE_MASTER_FIR,          //!< FIR filters of FIR_PLACEMENT_MASTER
+  STAGE_TYPE_LEVELER_DRC,
+  STAGE_TYPE_LIMITER_DRC,
+  STAGE_TYPE_XOVER_SPLIT,         //!< LR4 or FIR_PLACEMENT_CROSSOVER split: tweeter band on band 0, woofer band on band 1
+  STAGE_TYPE_WOOFER_EQ,           //!< xoverEqCoeffs woofer cascades
+  STAGE_TYPE_TWEETER_EQ,          //!< xoverEqCoeffs tweeter cascades
+  STAGE_TYPE_PEAK_LIMITER,        //!< Tweeters from input and woofers from aux, with one gain. Tweeters on band 0, woofers on band 1
+  STAGE_TYPE_ALA,
+  STAGE_TYPE_DELAY,               //!< Tweeters from input and woofers from aux (or input), each output delayed. Tweeters on band 0, woofers on band 1
+  MAX_STAGE_TYPES
+};
+
+/**
+ * Connects a node of the stage graph to the output of another node
+ */
+struct StageReference
+{
+public:
+  int32_t node = STAGE_INPUT;     //!< Index of the node, STAGE_INPUT or STAGE_NONE
+  uint32_t band = 0;              //!< 1 for the woofer band of a split or a peak limiter. Other nodes have one output on both bands
+};
+
+/**
+ * Defines one node of the stage graph
+ */
+struct StageNodeConfiguration
+{
+public:
+  StageType type = StageType::STAGE_TYPE_MASTER_EQ;
+  StageReference input;
+  StageReference aux = { STAGE_NONE, 0 };   //!< Woofer input of the peak limiter and the delay, STAGE_NONE for the other stages
+};
+
+/**
+ * Defines the order and the connections of the pipeline stages. The nodes may be listed in any order, the
+ * pipeline runs them in a topological order. Nodes of disabled or bypassed stages pass their input through.
+ * Without nodes, the pipeline runs the stages in the default order: master EQ, master FIR, leveler, limiter
+ * (unless the peak limiter is enabled), x-over split, woofer and tweeter EQ, delay, peak limiter and ALA.
+ */
+struct StageGraphConfiguration
+{
+public:
+  StageNodeConfiguration nodes[StageType::MAX_STAGE_TYPES];
+  uint32_t nodeCount = 0;         //!< 0 for the default order
+  StageReference tweeter;         //!< The node of the tweeter stream
+  StageReference woofer;          //!< The node of the woofer stream
+};
+
+/**
+ * Defines the system configuration attributes of the filter pipeline (per target speaker)
+ */
+struct FilterConfiguration
+{
+public:
+  std::string name;
+  bool masterEqEnabled = true;
+  bool xoverEqEnabled = true;
+  FilterEngine filterEngine = FilterEngine::FILTER_ENGINE_STEREO_DF2T;
+  float32_t eqSampleRateHz = 48000;                   //!< The rate the EQ coefficients were designed for, remapped to the audio sampling rate
+  float32_t masterEqCoeffs[MasterEqCoeffcientType::MAX_MASTER_EQ_COEFF_TYPES][MASTER_EQ_STAGES * 5];    //!< Left/right channel coefficients
+  float32_t xoverEqCoeffs[XoverEqCoeffcientType::MAX_XOVER_EQ_COEFF_TYPES][XOVER_EQ_STAGES * 5];      //!< Left/right channel coefficients for tweeter/woofer
+  DrcConfiguration levelerDrcConfig;
+  DrcConfiguration limiterDrcConfig;
+  PeakLimiterConfiguration peakLimiterConfig;
+  CrossoverConfiguration xoverConfig;                 //!< With CROSSOVER_LR4, xoverEqCoeffs are applied as EQ on each band after the split
+  ResamplerConfiguration resamplerConfig;            //!< Used when the source runs at another rate than the audio path
+  FirConfiguration firConfig;                         //!< With FIR_PLACEMENT_CROSSOVER, xoverEqCoeffs are applied as EQ on each band after the split
+  DelayConfiguration delayConfig;                     //!< Time alignment of the tweeters and woofers
+  OutputRoutingConfiguration outputRouting;           //!< Channel order, polarity and mix of the output streams
+  SilenceConfiguration silenceConfig;                 //!< Filter bypass and output standby on silence
+  JitterBufferConfiguration jitterBufferConfig;       //!< Input buffering of the SAI slave and USB sources
+  StageGraphConfiguration stageGraph;                 //!< Order of the stages
+
+#if ALA_MODULE_ENABLED == 1
+  AlaConfiguration alaConfig;
+#endif
+};
+
+}
@@ -33,7 +33,7 @@
 
 #pragma once
 #include "Controllers/Service/pub/Services.hpp"
-#include "Controllers/System/pub/SystemConfiguration.hpp"
+#include "Controllers/System/pub/FilterConfiguration.hpp"
 #include <stdint.h>
 
 namespace System
@@ -47,17 +47,8 @@ class FilterReader: public GlobalServiceConsumer
 private:
   System::FilterConfiguration *filterConfig;
 
-  void extractDrcConfig(const uint8_t *data, const char *name, System::DrcConfiguration &drcConfig);
-  void extractAlaConfig(const uint8_t *data, const char *name, System::AlaConfiguration &alaConfig);
   void extractDacAmpConfig(const uint8_t *data);
-
-  uint32_t getArraySize(const uint8_t *data, const char *name);
-  void loadFloatArray(const uint8_t *data, const char *name, float32_t *coeffArray, uint32_t maxCount);
-  void loadIntArray(const uint8_t *data, const char *name, int32_t *coeffArray, uint32_t maxCount);
-  void loadInt(const uint8_t *data, const char *name, uint32_t *value);
-  void loadString(const uint8_t *data, const char *name, std::string &value);
-  void loadFloat32(const uint8_t *data, const char *name, float32_t *value);
-  void loadBool(const uint8_t *data, const char *name, bool *value);
+  void loadFirFile();
 
 public:
   FilterReader(System::FilterConfiguration *filterConfig);
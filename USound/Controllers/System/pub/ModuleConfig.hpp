@@ -54,10 +54,18 @@
 //!< When set to 1, it converts the host gain to the DAC value using a logarithmic scale
 #define LOGARITHMIC_GAIN_ENABLED 1
 
-//!< When set to 1, it maps theft audio channel to right and vice-versa
+//!< When set to 1, the volume and mute are applied by the DSP chain and the DACs stay at 0 dB
+#define DIGITAL_VOLUME_ENABLED 1
+
+//!< When set to 1, a filter reconfiguration crossfades from the old to the new filter chain over one audio block
+#define FILTER_CROSSFADE_ENABLED 1
+
+//!< When set to 1, it maps theft audio channel to right and vice-versa.
+//!< Default of the output routing, for filter configurations without an outputRouting document
 #define SWAP_AUDIO_CHANNELS 1
 
 // When set to true, the audio channel is inverted just before DAC for both Tweeter and Woofer
-// (to compensate for accidental phase inversion in Hardware)
+// (to compensate for accidental phase inversion in Hardware).
+// Default of the output routing, for filter configurations without an outputRouting document
 #define INVERT_LEFT_CHANNEL true
 #define INVERT_RIGHT_CHANNEL false
@@ -41,11 +41,12 @@
 #include "Interfaces/pub/SystemControl.hpp"
 #include "stm32h7xx_hal.h"
 #include "SystemInterfaces.hpp"
+#include "FilterConfiguration.hpp"
 #include "arm_math.h"
 
-#define MASTER_EQ_STAGES 8
-#define XOVER_EQ_STAGES 8
-#define ALA_COEFFICIENT_SIZE 84
+#define DEFAULT_AUDIO_FREQUENCY   48000     //!< The sampling rate of the audio path until a source requests another one
+#define MAX_AUDIO_FREQUENCY       96000     //!< The highest supported sampling rate, which sizes the audio buffers
+#define MIN_SOURCE_FREQUENCY      8000      //!< The lowest rate of a source, which is resampled to the audio rate
 
 namespace System
 {
@@ -147,67 +148,6 @@ public:
   }
 };
 
-/**
- * Defines the system configuration attributes of a DRC block
- */
-struct DrcConfiguration
-{
-public:
-  float32_t attackDuration = 0.2f;                      // 200 ms
-  float32_t releaseDuration = 1.0f;                     // 1 sec
-  float32_t compressionThresholdFullScaleDb = 20.0f;    //!< Threshold for compression, relative to digital full scale
-  float32_t compressionRatio = 2.0f;                    //<! Compression ratio
-  float32_t sampleRateHz = 48000;                       //!< The audio sampling rate
-  float32_t postGain = 0.0f;                            //!< Make-up gain to adjust the DRC result
-  bool enabled = false;                                 //!< If false, the DRC block is bypassed
-};
-
-/**
- * Defines the pre-distortion configuration attributes
- */
-struct AlaConfiguration
-{
-public:
-  int32_t coefficients[ALA_COEFFICIENT_SIZE];
-  bool enabled;
-};
-
-enum MasterEqCoeffcientType
-{
-  LEFT,
-  RIGHT,
-  MAX_MASTER_EQ_COEFF_TYPES
-};
-
-enum XoverEqCoeffcientType
-{
-  LEFT_WOOFER,
-  LEFT_TWEETER,
-  RIGHT_WOOFER,
-  RIGHT_TWEETER,
-  MAX_XOVER_EQ_COEFF_TYPES
-};
-
-
-/**
- * Defines the system configuration attributes of the filter pipeline (per target speaker)
- */
-struct FilterConfiguration
-{
-public:
-  std::string name;
-  bool masterEqEnabled = true;
-  bool xoverEqEnabled = true;
-  float32_t masterEqCoeffs[MasterEqCoeffcientType::MAX_MASTER_EQ_COEFF_TYPES][MASTER_EQ_STAGES * 5];    //!< Left/right channel coefficients
-  float32_t xoverEqCoeffs[XoverEqCoeffcientType::MAX_XOVER_EQ_COEFF_TYPES][XOVER_EQ_STAGES * 5];      //!< Left/right channel coefficients for tweeter/woofer
-  DrcConfiguration levelerDrcConfig;
-  DrcConfiguration limiterDrcConfig;
-
-#if ALA_MODULE_ENABLED == 1
-  AlaConfiguration alaConfig;
-#endif
-};
-
 /**
  * Defines the SAI mode of operation
  */
@@ -268,21 +208,31 @@ private:
   ConsoleConfiguration *consoleConfig[2];
   GpioConfiguration *gpioConfig[23];
   AmpConfiguration *ampConfig[4];
-  SaiConfiguration *saiConfig[3];
+  SaiConfiguration *saiConfig[3] = { nullptr, nullptr, nullptr };
   MclkPllConfiguration *mclkConfig = nullptr;
   FilterConfiguration *filterConfig = nullptr;
   UsbConfiguration *usbConfig = nullptr;
 
   uint32_t peripheralAvailability;
-  uint32_t audioBufferingTime;        //!< Audio buffering time in milliseconds
+  uint32_t audioBufferingTime;        //!< Audio buffering time in milliseconds, i.e. the block duration of the latency profile
+  uint32_t audioFrequency;            //!< The sampling rate of the audio path (Hz)
   AudioMode audioMode;
   uint32_t targetSpeakerSwitches = 0;
+  bool latencyProfileLocked = false;
+
+  void updateSaiInBufferingTime();
 
 public:
   SystemConfiguration();
 
   void init();
   void updateConfigFromDipSwitches(uint32_t dipSwitchState);
+  void setLatencyProfile(LatencyProfile profile);
+  bool setBufferingTime(uint32_t bufferingTime);
+  void lockLatencyProfile();
+  bool isFrequencySupported(uint32_t frequency) const;
+  bool setFrequency(uint32_t frequency);
+  uint32_t getBlockFrames(uint32_t frequency) const;
   void updateFilterConfiguration();
 
   void* getHandleForSystemBus(SystemBus bus) const;
@@ -310,6 +260,31 @@ public:
     return audioBufferingTime;
   }
 
+  /**
+   * Returns the sampling rate of the audio path (Hz)
+   */
+  uint32_t getFrequency() const
+  {
+    return audioFrequency;
+  }
+
+  /**
+   * Returns the number of frames of an audio block at the current sampling rate
+   */
+  uint32_t getBlockFrames() const
+  {
+    return getBlockFrames(audioFrequency);
+  }
+
+  /**
+   * Returns the number of frames of the longest audio block, i.e. at MAX_AUDIO_FREQUENCY.
+   * The audio buffers are allocated with this size, so that the rate can change without allocating.
+   */
+  uint32_t getMaxBlockFrames() const
+  {
+    return getBlockFrames(MAX_AUDIO_FREQUENCY);
+  }
+
   /**
    * Returns the configured audio mode
    */
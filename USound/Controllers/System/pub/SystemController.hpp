@@ -75,6 +75,7 @@ private:
   Controller::Telemetry *telemetry = nullptr;
 
   void initBuses();
+  void initAudioBuses();
   void initPeripherals();
   void initFilesystem();
   void initConsoles();
@@ -140,4 +140,16 @@ enum AudioMode
   AM_USB
 };
 
+/**
+ * Defines the latency profiles, i.e. the duration of an audio block, in the order of the CFG_1/CFG_2 dip switch code
+ */
+enum LatencyProfile
+{
+  LATENCY_4MS,              //!< Default
+  LATENCY_1MS,              //!< Low latency, e.g. for USB monitoring
+  LATENCY_2MS,
+  LATENCY_10MS,             //!< Fewer wakeups per second, e.g. for battery operation
+  MAX_LATENCY_PROFILES
+};
+
 }
@@ -48,6 +48,9 @@ namespace System
 {
 #define NO_EXTI_PIN 0
 
+static const uint32_t latencyProfileTimes[LatencyProfile::MAX_LATENCY_PROFILES] = { 4, 1, 2, 10 };   //!< Block duration (ms) per LatencyProfile
+static const uint32_t supportedFrequencies[] = { 44100, 48000, 96000 };                              //!< Sampling rates the SAI clocks can be derived for
+
 #if CONFIG_POS == 0
 extern FilterConfiguration passthroughConfiguration;
 #else
@@ -60,6 +63,7 @@ extern FilterConfiguration audioEyewearConfiguration;
 SystemConfiguration::SystemConfiguration() :
     peripheralAvailability(0),
     audioBufferingTime(0),
+    audioFrequency(DEFAULT_AUDIO_FREQUENCY),
     audioMode(AudioMode::AM_MP3)
 {
 
@@ -83,7 +87,7 @@ void SystemConfiguration::init()
   peripheralAvailability |= (1 << (SystemAudioSource::AUDIO_SRC_GENERATOR + 16));
 #endif
 
-  audioBufferingTime = 4; // 4ms buffering time
+  audioBufferingTime = latencyProfileTimes[LatencyProfile::LATENCY_4MS];
 
   dacConfig[DacInterface::DAC_TWEETER_IFACE] = new DacConfiguration(0x20, SystemBus::I2C_TWEETER, GpioInterface::GPIO_DAC_TWEETER);
   dacConfig[DacInterface::DAC_WOOFER_IFACE] = new DacConfiguration(0x22, SystemBus::I2C_WOOFER, GpioInterface::GPIO_DAC_WOOFER);
@@ -127,7 +131,7 @@ void SystemConfiguration::init()
   gpioConfig[GpioInterface::GPIO_DIPSWITCH_CFG_3] = new GpioConfiguration(GPIOC, GPIO_PIN_3, NO_EXTI_PIN, false);
   gpioConfig[GpioInterface::GPIO_DIPSWITCH_CFG_4] = new GpioConfiguration(GPIOC, GPIO_PIN_2, NO_EXTI_PIN, false);
 
-  usbConfig = new UsbConfiguration(audioBufferingTime, 48000);
+  usbConfig = new UsbConfiguration(audioBufferingTime, DEFAULT_AUDIO_FREQUENCY);
 }
 
 /**
@@ -360,9 +364,9 @@ void SystemConfiguration::updateConfigFromDipSwitches(uint32_t dipSwitchState)
       peripheralAvailability |= (1 << (SystemAudioSource::AUDIO_SRC_FILE + 16));
       audioMode = AudioMode::AM_MP3;
 
-      saiConfig[SaiInterface::TWEETER] = new SaiConfiguration(audioBufferingTime, 48000, &hsai_BlockA3, SaiInterface::TWEETER,
+      saiConfig[SaiInterface::TWEETER] = new SaiConfiguration(audioBufferingTime, audioFrequency, &hsai_BlockA3, SaiInterface::TWEETER,
           SaiMode::SAI_MODE_TX_MASTER);
-      saiConfig[SaiInterface::WOOFER] = new SaiConfiguration(audioBufferingTime, 48000, &hsai_BlockB3, SaiInterface::WOOFER,
+      saiConfig[SaiInterface::WOOFER] = new SaiConfiguration(audioBufferingTime, audioFrequency, &hsai_BlockB3, SaiInterface::WOOFER,
           SaiMode::SAI_MODE_TX_SLAVE_INTERNAL);
       saiConfig[SaiInterface::IN] = nullptr;
       break;
@@ -374,11 +378,11 @@ void SystemConfiguration::updateConfigFromDipSwitches(uint32_t dipSwitchState)
 
       audioMode = AudioMode::AM_I2S_SLAVE;
 
-      saiConfig[SaiInterface::TWEETER] = new SaiConfiguration(audioBufferingTime, 48000, &hsai_BlockA3, SaiInterface::TWEETER,
+      saiConfig[SaiInterface::TWEETER] = new SaiConfiguration(audioBufferingTime, audioFrequency, &hsai_BlockA3, SaiInterface::TWEETER,
           SaiMode::SAI_MODE_TX_SLAVE_EXTERNAL);
-      saiConfig[SaiInterface::WOOFER] = new SaiConfiguration(audioBufferingTime, 48000, &hsai_BlockB3, SaiInterface::WOOFER,
+      saiConfig[SaiInterface::WOOFER] = new SaiConfiguration(audioBufferingTime, audioFrequency, &hsai_BlockB3, SaiInterface::WOOFER,
           SaiMode::SAI_MODE_TX_SLAVE_INTERNAL);
-      saiConfig[SaiInterface::IN] = new SaiConfiguration(2, 48000, &hsai_BlockA2, SaiInterface::IN, SaiMode::SAI_MODE_RX_SLAVE_EXTERNAL);
+      saiConfig[SaiInterface::IN] = new SaiConfiguration(audioBufferingTime, audioFrequency, &hsai_BlockA2, SaiInterface::IN, SaiMode::SAI_MODE_RX_SLAVE_EXTERNAL);
       break;
 
     case (1 << GpioInterface::GPIO_DIPSWITCH_CFG_3):
@@ -386,9 +390,9 @@ void SystemConfiguration::updateConfigFromDipSwitches(uint32_t dipSwitchState)
       peripheralAvailability |= (1 << (SystemAudioSource::AUDIO_SRC_USB + 16));
       audioMode = AudioMode::AM_USB;
 
-      saiConfig[SaiInterface::TWEETER] = new SaiConfiguration(audioBufferingTime, 48000, &hsai_BlockA3, SaiInterface::TWEETER,
+      saiConfig[SaiInterface::TWEETER] = new SaiConfiguration(audioBufferingTime, audioFrequency, &hsai_BlockA3, SaiInterface::TWEETER,
           SaiMode::SAI_MODE_TX_MASTER);
-      saiConfig[SaiInterface::WOOFER] = new SaiConfiguration(audioBufferingTime, 48000, &hsai_BlockB3, SaiInterface::WOOFER,
+      saiConfig[SaiInterface::WOOFER] = new SaiConfiguration(audioBufferingTime, audioFrequency, &hsai_BlockB3, SaiInterface::WOOFER,
           SaiMode::SAI_MODE_TX_SLAVE_INTERNAL);
       saiConfig[SaiInterface::IN] = nullptr;
       break;
@@ -398,6 +402,10 @@ void SystemConfiguration::updateConfigFromDipSwitches(uint32_t dipSwitchState)
       break;
   }
 
+  uint32_t latencySwitches = ((dipSwitchState & (1 << GpioInterface::GPIO_DIPSWITCH_CFG_1)) ? 0x01 : 0)
+      | ((dipSwitchState & (1 << GpioInterface::GPIO_DIPSWITCH_CFG_2)) ? 0x02 : 0);
+  setLatencyProfile((LatencyProfile) latencySwitches);
+
   targetSpeakerSwitches = 0;
 
 #if CONFIG_POS == 1
@@ -412,6 +420,138 @@ void SystemConfiguration::updateConfigFromDipSwitches(uint32_t dipSwitchState)
 #endif
 }
 
+/**
+ * Selects the latency profile. The audio blocks, the SAI DMA buffers and the USB fifo are all sized from its
+ * block duration, so it must be selected before the audio buses and the audio engine are initialised.
+ * @param profile
+ */
+void SystemConfiguration::setLatencyProfile(LatencyProfile profile)
+{
+  audioBufferingTime = latencyProfileTimes[profile];
+
+  if (saiConfig[SaiInterface::TWEETER])
+  {
+    saiConfig[SaiInterface::TWEETER]->bufferingTime = audioBufferingTime;
+  }
+
+  if (saiConfig[SaiInterface::WOOFER])
+  {
+    saiConfig[SaiInterface::WOOFER]->bufferingTime = audioBufferingTime;
+  }
+
+  updateSaiInBufferingTime();
+
+  // The USB fifo is drained once per 1 ms USB frame, so it must hold at least two frames
+  if (usbConfig)
+  {
+    usbConfig->bufferingTime = (audioBufferingTime > 2) ? audioBufferingTime : 2;
+  }
+}
+
+/**
+ * Selects the latency profile with the given block duration
+ * @param bufferingTime the block duration in milliseconds
+ * @return false if there is no such profile, or if the audio path has already been sized
+ */
+bool SystemConfiguration::setBufferingTime(uint32_t bufferingTime)
+{
+  if (latencyProfileLocked)
+  {
+    return false;
+  }
+
+  for (uint32_t profile = 0; profile < LatencyProfile::MAX_LATENCY_PROFILES; profile++)
+  {
+    if (latencyProfileTimes[profile] == bufferingTime)
+    {
+      setLatencyProfile((LatencyProfile) profile);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Freezes the latency profile once the audio buses have allocated their buffers.
+ * Later configuration updates (e.g. from the telemetry) can no longer change it.
+ */
+void SystemConfiguration::lockLatencyProfile()
+{
+  latencyProfileLocked = true;
+}
+
+/**
+ * Returns true if the audio path can run at the given sampling rate
+ * @param frequency the sampling rate (Hz)
+ */
+bool SystemConfiguration::isFrequencySupported(uint32_t frequency) const
+{
+  for (uint32_t i = 0; i < sizeof(supportedFrequencies) / sizeof(supportedFrequencies[0]); i++)
+  {
+    if (supportedFrequencies[i] == frequency)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Sets the sampling rate of the SAI buses, and so of the whole audio path except for the USB input,
+ * which always runs at its descriptor rate. The SAI buses pick it up the next time they are enabled.
+ * @param frequency the sampling rate (Hz)
+ * @return false if the rate is not supported
+ */
+bool SystemConfiguration::setFrequency(uint32_t frequency)
+{
+  if (!isFrequencySupported(frequency))
+  {
+    return false;
+  }
+
+  audioFrequency = frequency;
+
+  for (uint32_t i = 0; i < sizeof(saiConfig) / sizeof(saiConfig[0]); i++)
+  {
+    if (saiConfig[i])
+    {
+      saiConfig[i]->frequency = frequency;
+    }
+  }
+
+  updateSaiInBufferingTime();
+  return true;
+}
+
+/**
+ * The SAI input notifies twice per block, as long as the half block is a whole number of milliseconds,
+ * and exactly half of the block frames (e.g. not at 44.1 kHz, where 4 ms are 177 frames). Otherwise it notifies once per block.
+ */
+void SystemConfiguration::updateSaiInBufferingTime()
+{
+  if (!saiConfig[SaiInterface::IN])
+  {
+    return;
+  }
+
+  uint32_t halfTime = audioBufferingTime / 2;
+  bool halves = (audioBufferingTime % 2 == 0) && (getBlockFrames() == 2 * ((audioFrequency * halfTime + 999) / 1000));
+
+  saiConfig[SaiInterface::IN]->bufferingTime = halves ? halfTime : audioBufferingTime;
+}
+
+/**
+ * Returns the number of frames of an audio block, rounded up to a whole frame (e.g. 177 frames for 4 ms at 44.1 kHz).
+ * The SAI DMA buffers use the same rounding, so that each half of them holds exactly one block.
+ * @param frequency the sampling rate (Hz)
+ */
+uint32_t SystemConfiguration::getBlockFrames(uint32_t frequency) const
+{
+  return (frequency * audioBufferingTime + 999) / 1000;
+}
+
 void SystemConfiguration::updateFilterConfiguration()
 {
 #if CONFIG_POS == 0
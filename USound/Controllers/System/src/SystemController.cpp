@@ -83,6 +83,7 @@ void SystemController::init()
   auto systemConfiguration = globalServices->getSystemConfiguration();
   systemConfiguration->updateFilterConfiguration();
 
+  initAudioBuses();
   initPeripherals();
   initAudioEngine();
 }
@@ -113,8 +114,20 @@ void SystemController::initBuses()
   systemBuses[SystemBus::CTRL_UART] = nullptr;
   systemBuses[SystemBus::DEBUG_UART] = nullptr;
 #endif
+}
+
+/**
+ * Initialises the audio buses. Their DMA buffers and fifos are sized from the latency profile, so this step must be done
+ * after the filter configuration has been read, as it can override the profile of the dip switches.
+ */
+void SystemController::initAudioBuses()
+{
+  HalFactory halFactory;
+
+  auto systemConfiguration = globalServices->getSystemConfiguration();
+  systemConfiguration->lockLatencyProfile();
 
-  handle = systemConfiguration->getHandleForSystemBus(SystemBus::SAI_TWEETER);
+  void *handle = systemConfiguration->getHandleForSystemBus(SystemBus::SAI_TWEETER);
   SaiConfiguration *saiConfiguration = systemConfiguration->getSaiInterfaceConfiguration(SaiInterface::TWEETER);
   systemBuses[SystemBus::SAI_TWEETER] = handle ? halFactory.getSaiOut(handle, saiConfiguration) : nullptr;
 
@@ -0,0 +1,539 @@
+//====================================================================
+//
+// COPYRIGHT 2026 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: Filter configuration parser. It transforms bson documents to filter configuration
+//  Filename: FilterConfigParser.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#include "../../pub/FilterConfigParser.hpp"
+#include "Utilities/BsonReader/pub/BsonReader.hpp"
+#include "Controllers/System/pub/ModuleConfig.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace System
+{
+
+FilterConfigParser::FilterConfigParser(System::FilterConfiguration *filterConfig) :
+    filterConfig(filterConfig)
+{
+
+}
+
+void FilterConfigParser::loadFloatArray(const uint8_t *data, const char *name, float32_t *coeffArray, uint32_t maxCount)
+{
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (bson.findField(data, name, arrayElem))
+  {
+    bson.getFloatArray(coeffArray, arrayElem.data, maxCount);
+  }
+}
+
+void FilterConfigParser::loadIntArray(const uint8_t *data, const char *name, int32_t *coeffArray, uint32_t maxCount)
+{
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (bson.findField(data, name, arrayElem))
+  {
+    bson.getInt32Array(coeffArray, arrayElem.data, maxCount);
+  }
+}
+
+uint32_t FilterConfigParser::getArraySize(const uint8_t *data, const char *name)
+{
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (bson.findField(data, name, arrayElem))
+  {
+    return bson.getArrayCount(arrayElem.data);
+  }
+
+  return 0;
+}
+
+/**
+ * Returns the number of taps of a FIR filter, given as an array of numbers or as binary little endian float32 values
+ */
+uint32_t FilterConfigParser::getFirTapCount(const uint8_t *data, const char *name)
+{
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (!bson.findField(data, name, arrayElem))
+  {
+    return 0;
+  }
+
+  if (arrayElem.type == BSON_TYPE_BINARY)
+  {
+    return arrayElem.dataLen / sizeof(float32_t);
+  }
+
+  return (arrayElem.type == BSON_TYPE_ARRAY) ? bson.getArrayCount(arrayElem.data) : 0;
+}
+
+void FilterConfigParser::loadFirTaps(const uint8_t *data, const char *name, float32_t *taps, uint32_t maxCount)
+{
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (!bson.findField(data, name, arrayElem))
+  {
+    return;
+  }
+
+  if (arrayElem.type == BSON_TYPE_BINARY)
+  {
+    memcpy(taps, arrayElem.data, std::min(arrayElem.dataLen / (uint32_t) sizeof(float32_t), maxCount) * sizeof(float32_t));
+  }
+  else if (arrayElem.type == BSON_TYPE_ARRAY)
+  {
+    bson.getFloatArray(taps, arrayElem.data, maxCount);
+  }
+}
+
+void FilterConfigParser::loadInt(const uint8_t *data, const char *name, uint32_t *value)
+{
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (bson.findField(data, name, arrayElem) && arrayElem.type == BSON_TYPE_INT32)
+  {
+    memcpy(value, arrayElem.data, sizeof(uint32_t));
+  }
+}
+
+void FilterConfigParser::loadFloat32(const uint8_t *data, const char *name, float32_t *value)
+{
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (bson.findField(data, name, arrayElem))
+  {
+    if (arrayElem.type == BSON_TYPE_NUMBER)
+    {
+      double tmp;
+      memcpy(&tmp, arrayElem.data, 8);
+      *value = (float32_t) tmp;
+    }
+    else if (arrayElem.type == BSON_TYPE_INT32)
+    {
+      int32_t tmp;
+      memcpy(&tmp, arrayElem.data, 4);
+      *value = (float32_t) tmp;
+    }
+  }
+}
+
+void FilterConfigParser::loadString(const uint8_t *data, const char *name, std::string &value)
+{
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (bson.findField(data, name, arrayElem))
+  {
+    value.append((const char*) arrayElem.data);
+  }
+}
+
+void FilterConfigParser::loadBool(const uint8_t *data, const char *name, bool *value)
+{
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (bson.findField(data, name, arrayElem))
+  {
+    *value = arrayElem.data[0];
+  }
+}
+
+void FilterConfigParser::extractConfig(const uint8_t *data)
+{
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (bson.findField(data, "name", arrayElem))
+  {
+    filterConfig->name = (const char*) arrayElem.data;
+  }
+
+  if (bson.findField(data, "masterEqCoeffs", arrayElem))
+  {
+    loadFloatArray(arrayElem.data, "leftMasterEqCoefficients", filterConfig->masterEqCoeffs[System::MasterEqCoeffcientType::LEFT], MASTER_EQ_STAGES * 5);
+    loadFloatArray(arrayElem.data, "rightMasterEqCoefficients", filterConfig->masterEqCoeffs[System::MasterEqCoeffcientType::RIGHT], MASTER_EQ_STAGES * 5);
+  }
+
+  if (bson.findField(data, "xoverEqCoeffs", arrayElem))
+  {
+    loadFloatArray(arrayElem.data, "xoverWooferLeft", filterConfig->xoverEqCoeffs[System::XoverEqCoeffcientType::LEFT_WOOFER], MASTER_EQ_STAGES * 5);
+    loadFloatArray(arrayElem.data, "xoverTweeterLeft", filterConfig->xoverEqCoeffs[System::XoverEqCoeffcientType::LEFT_TWEETER], MASTER_EQ_STAGES * 5);
+    loadFloatArray(arrayElem.data, "xoverWooferRight", filterConfig->xoverEqCoeffs[System::XoverEqCoeffcientType::RIGHT_WOOFER], MASTER_EQ_STAGES * 5);
+    loadFloatArray(arrayElem.data, "xoverTweeterRight", filterConfig->xoverEqCoeffs[System::XoverEqCoeffcientType::RIGHT_TWEETER], MASTER_EQ_STAGES * 5);
+  }
+
+  loadFloat32(data, "eqSampleRateHz", &filterConfig->eqSampleRateHz);
+
+  extractDrcConfig(data, "levelerDrcConfig", filterConfig->levelerDrcConfig);
+  extractDrcConfig(data, "limiterDrcConfig", filterConfig->limiterDrcConfig);
+  extractPeakLimiterConfig(data, "peakLimiterConfig", filterConfig->peakLimiterConfig);
+  extractCrossoverConfig(data, "xoverConfig", filterConfig->xoverConfig);
+  extractResamplerConfig(data, "resamplerConfig", filterConfig->resamplerConfig);
+  extractFirConfig(data, "firConfig", filterConfig->firConfig);
+  extractDelayConfig(data, "delayConfig", filterConfig->delayConfig);
+  extractOutputRouting(data, "outputRouting", filterConfig->outputRouting);
+  extractSilenceConfig(data, "silenceConfig", filterConfig->silenceConfig);
+  extractJitterBufferConfig(data, "jitterBufferConfig", filterConfig->jitterBufferConfig);
+  extractStageGraph(data, "stageGraph", filterConfig->stageGraph);
+
+  loadBool(data, "masterEqEnabled", &filterConfig->masterEqEnabled);
+  loadBool(data, "xoverEqEnabled", &filterConfig->xoverEqEnabled);
+
+  uint32_t filterEngine = filterConfig->filterEngine;
+  loadInt(data, "filterEngine", &filterEngine);
+  if (filterEngine < System::FilterEngine::MAX_FILTER_ENGINES)
+  {
+    filterConfig->filterEngine = (System::FilterEngine) filterEngine;
+  }
+
+  loadBool(data, "levelerDrcEnabled", &filterConfig->levelerDrcConfig.enabled);
+  loadBool(data, "limiterDrcEnabled", &filterConfig->limiterDrcConfig.enabled);
+  loadBool(data, "peakLimiterEnabled", &filterConfig->peakLimiterConfig.enabled);
+  loadBool(data, "firEnabled", &filterConfig->firConfig.enabled);
+  loadBool(data, "delayEnabled", &filterConfig->delayConfig.enabled);
+  loadBool(data, "silenceBypassEnabled", &filterConfig->silenceConfig.bypassEnabled);
+  loadBool(data, "silenceStandbyEnabled", &filterConfig->silenceConfig.standbyEnabled);
+
+#if ALA_MODULE_ENABLED == 1
+  loadBool(data, "alaEnabled", &filterConfig->alaConfig.enabled);
+  extractAlaConfig(data, "alaConfig", filterConfig->alaConfig);
+#endif
+}
+
+void FilterConfigParser::extractDrcConfig(const uint8_t *data, const char *name, System::DrcConfiguration &drcConfig)
+{
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (bson.findField(data, name, arrayElem))
+  {
+    loadFloat32(arrayElem.data, "attackDuration", &drcConfig.attackDuration);
+    loadFloat32(arrayElem.data, "releaseDuration", &drcConfig.releaseDuration);
+    loadFloat32(arrayElem.data, "compressionThresholdFullScaleDb", &drcConfig.compressionThresholdFullScaleDb);
+    loadFloat32(arrayElem.data, "compressionRatio", &drcConfig.compressionRatio);
+    loadFloat32(arrayElem.data, "sampleRateHz", &drcConfig.sampleRateHz);
+    loadFloat32(arrayElem.data, "postGain", &drcConfig.postGain);
+    loadInt(arrayElem.data, "controlInterval", &drcConfig.controlInterval);
+  }
+}
+
+void FilterConfigParser::extractPeakLimiterConfig(const uint8_t *data, const char *name, System::PeakLimiterConfiguration &limiterConfig)
+{
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (bson.findField(data, name, arrayElem))
+  {
+    loadFloat32(arrayElem.data, "thresholdFullScaleDb", &limiterConfig.thresholdFullScaleDb);
+    loadFloat32(arrayElem.data, "lookaheadDuration", &limiterConfig.lookaheadDuration);
+    loadFloat32(arrayElem.data, "releaseDuration", &limiterConfig.releaseDuration);
+    loadFloat32(arrayElem.data, "sampleRateHz", &limiterConfig.sampleRateHz);
+  }
+}
+
+void FilterConfigParser::extractCrossoverConfig(const uint8_t *data, const char *name, System::CrossoverConfiguration &xoverConfig)
+{
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (bson.findField(data, name, arrayElem))
+  {
+    uint32_t type = xoverConfig.type;
+    loadInt(arrayElem.data, "type", &type);
+    if (type < System::CrossoverType::MAX_CROSSOVER_TYPES)
+    {
+      xoverConfig.type = (System::CrossoverType) type;
+    }
+
+    loadFloat32(arrayElem.data, "frequencyHz", &xoverConfig.frequencyHz);
+    loadFloat32(arrayElem.data, "sampleRateHz", &xoverConfig.sampleRateHz);
+  }
+}
+
+/**
+ * Extracts the delays of the outputs, in seconds
+ */
+void FilterConfigParser::extractDelayConfig(const uint8_t *data, const char *name, System::DelayConfiguration &delayConfig)
+{
+  static const char *delayNames[System::XoverEqCoeffcientType::MAX_XOVER_EQ_COEFF_TYPES] = {
+      "delayWooferLeft",
+      "delayTweeterLeft",
+      "delayWooferRight",
+      "delayTweeterRight"
+  };
+
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (bson.findField(data, name, arrayElem))
+  {
+    for (uint32_t type = 0; type < System::XoverEqCoeffcientType::MAX_XOVER_EQ_COEFF_TYPES; type++)
+    {
+      loadFloat32(arrayElem.data, delayNames[type], &delayConfig.delayDuration[type]);
+    }
+
+    loadFloat32(arrayElem.data, "sampleRateHz", &delayConfig.sampleRateHz);
+  }
+}
+
+/**
+ * Extracts the output routing matrix: one array per output slot, with the gains of the tweeter left, tweeter right,
+ * woofer left and woofer right streams. The slots that are not in the document keep the default routing.
+ */
+void FilterConfigParser::extractOutputRouting(const uint8_t *data, const char *name, System::OutputRoutingConfiguration &routing)
+{
+  static const char *outputNames[System::RoutingChannel::MAX_ROUTING_CHANNELS] = {
+      "tweeter0",
+      "tweeter1",
+      "woofer0",
+      "woofer1"
+  };
+
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (bson.findField(data, name, arrayElem))
+  {
+    for (uint32_t output = 0; output < System::RoutingChannel::MAX_ROUTING_CHANNELS; output++)
+    {
+      loadFloatArray(arrayElem.data, outputNames[output], routing.gains[output], System::RoutingChannel::MAX_ROUTING_CHANNELS);
+    }
+  }
+}
+
+/**
+ * Extracts the delays of the filter bypass and the output standby on silence, in seconds
+ */
+void FilterConfigParser::extractSilenceConfig(const uint8_t *data, const char *name, System::SilenceConfiguration &silenceConfig)
+{
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (bson.findField(data, name, arrayElem))
+  {
+    loadFloat32(arrayElem.data, "bypassDelay", &silenceConfig.bypassDelay);
+    loadFloat32(arrayElem.data, "standbyDelay", &silenceConfig.standbyDelay);
+  }
+}
+
+void FilterConfigParser::extractJitterBufferConfig(const uint8_t *data, const char *name, System::JitterBufferConfiguration &jitterBufferConfig)
+{
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (bson.findField(data, name, arrayElem))
+  {
+    loadFloat32(arrayElem.data, "targetDepth", &jitterBufferConfig.targetDepth);
+    loadFloat32(arrayElem.data, "minDepth", &jitterBufferConfig.minDepth);
+    loadFloat32(arrayElem.data, "maxDepth", &jitterBufferConfig.maxDepth);
+    loadBool(arrayElem.data, "adaptive", &jitterBufferConfig.adaptive);
+  }
+}
+
+void FilterConfigParser::extractResamplerConfig(const uint8_t *data, const char *name, System::ResamplerConfiguration &resamplerConfig)
+{
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (bson.findField(data, name, arrayElem))
+  {
+    uint32_t quality = resamplerConfig.quality;
+    loadInt(arrayElem.data, "quality", &quality);
+    if (quality < System::ResamplerQuality::MAX_RESAMPLER_QUALITIES)
+    {
+      resamplerConfig.quality = (System::ResamplerQuality) quality;
+    }
+
+    loadInt(arrayElem.data, "taps", &resamplerConfig.taps);
+    loadBool(arrayElem.data, "resampleSupportedRates", &resamplerConfig.resampleSupportedRates);
+    loadBool(arrayElem.data, "driftTracking", &resamplerConfig.driftTracking);
+  }
+}
+
+/**
+ * Extracts the FIR filters. A firConfig document replaces all the filters: the taps come either with the document,
+ * or from the file it names, which is loaded by the FilterReader. Shorter filters are padded with zeros.
+ */
+void FilterConfigParser::extractFirConfig(const uint8_t *data, const char *name, System::FirConfiguration &firConfig)
+{
+  static const char *masterNames[System::MasterEqCoeffcientType::MAX_MASTER_EQ_COEFF_TYPES] = {
+      "firLeft",
+      "firRight"
+  };
+
+  static const char *xoverNames[System::XoverEqCoeffcientType::MAX_XOVER_EQ_COEFF_TYPES] = {
+      "firWooferLeft",
+      "firTweeterLeft",
+      "firWooferRight",
+      "firTweeterRight"
+  };
+
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (!bson.findField(data, name, arrayElem))
+  {
+    return;
+  }
+
+  uint32_t placement = firConfig.placement;
+  loadInt(arrayElem.data, "placement", &placement);
+  if (placement < System::FirPlacement::MAX_FIR_PLACEMENTS)
+  {
+    firConfig.placement = (System::FirPlacement) placement;
+  }
+
+  firConfig.taps = 0;
+  firConfig.coefficients.reset();
+  firConfig.fileName.clear();
+  loadString(arrayElem.data, "file", firConfig.fileName);
+
+  const char **filterNames = (firConfig.placement == System::FirPlacement::FIR_PLACEMENT_CROSSOVER) ? xoverNames : masterNames;
+  const uint32_t filterCount = firConfig.getFilterCount();
+  uint32_t taps = 0;
+
+  for (uint32_t filter = 0; filter < filterCount; filter++)
+  {
+    taps = std::max(taps, getFirTapCount(arrayElem.data, filterNames[filter]));
+  }
+
+  if (taps == 0 || taps > FIR_MAX_TAPS)
+  {
+    return;
+  }
+
+  float32_t *coefficients = new float32_t[filterCount * taps]();
+
+  for (uint32_t filter = 0; filter < filterCount; filter++)
+  {
+    loadFirTaps(arrayElem.data, filterNames[filter], coefficients + filter * taps, taps);
+  }
+
+  firConfig.coefficients = std::shared_ptr<const float32_t>(coefficients, std::default_delete<const float32_t[]>());
+  firConfig.taps = taps;
+}
+
+/**
+ * Extracts the stage graph. A stageGraph document replaces the graph; without stages, the default order is used.
+ * Each stage names its "type", and its "input" (and "band") node, the previous stage by default, -1 for the input
+ * of the chain. The peak limiter takes the woofers from its "aux" (and "auxBand") node. The "tweeter" and
+ * "woofer" nodes (and "tweeterBand" and "wooferBand") select the output streams, by default both bands of the last stage.
+ */
+void FilterConfigParser::extractStageGraph(const uint8_t *data, const char *name, System::StageGraphConfiguration &graph)
+{
+  BsonReader bson;
+  BsonElem graphElem;
+  BsonElem stagesElem;
+
+  if (!bson.findField(data, name, graphElem))
+  {
+    return;
+  }
+
+  graph.nodeCount = 0;
+
+  if (bson.findField(graphElem.data, "stages", stagesElem))
+  {
+    const uint32_t count = std::min(bson.getArrayCount(stagesElem.data), (uint32_t) System::StageType::MAX_STAGE_TYPES);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+      char key[4];
+      System::StageNodeConfiguration &node = graph.nodes[i];
+      BsonElem stageElem;
+
+      snprintf(key, sizeof(key), "%lu", (unsigned long) i);
+
+      if (!bson.findField(stagesElem.data, key, stageElem))
+      {
+        break;
+      }
+
+      uint32_t type = System::StageType::MAX_STAGE_TYPES;
+      loadInt(stageElem.data, "type", &type);
+      node.type = (System::StageType) type;
+
+      node.input.node = (int32_t) i - 1;
+      node.input.band = 0;
+      loadStageReference(stageElem.data, "input", "band", node.input);
+
+      node.aux.node = STAGE_NONE;
+      node.aux.band = 0;
+      loadStageReference(stageElem.data, "aux", "auxBand", node.aux);
+
+      graph.nodeCount++;
+    }
+  }
+
+  graph.tweeter.node = (int32_t) graph.nodeCount - 1;
+  graph.tweeter.band = 0;
+  graph.woofer.node = graph.tweeter.node;
+  graph.woofer.band = 1;
+
+  loadStageReference(graphElem.data, "tweeter", "tweeterBand", graph.tweeter);
+  loadStageReference(graphElem.data, "woofer", "wooferBand", graph.woofer);
+}
+
+void FilterConfigParser::loadStageReference(const uint8_t *data, const char *nodeName, const char *bandName, System::StageReference &ref)
+{
+  uint32_t node = (uint32_t) ref.node;
+
+  loadInt(data, nodeName, &node);
+  loadInt(data, bandName, &ref.band);
+  ref.node = (int32_t) node;
+}
+
+void FilterConfigParser::extractAlaConfig(const uint8_t *data, const char *name, System::AlaConfiguration &alaConfig)
+{
+#if ALA_MODULE_ENABLED == 1
+  BsonReader bson;
+  BsonElem arrayElem;
+
+  if (bson.findField(data, name, arrayElem))
+  {
+    loadIntArray(arrayElem.data, "coefficients", alaConfig.coefficients, sizeof(AlaConfiguration::coefficients) / sizeof(int32_t));
+  }
+#endif
+}
+
+}
@@ -32,6 +32,8 @@
 //====================================================================
 
 #include "../../pub/FilterReader.hpp"
+#include "../../pub/FilterConfigParser.hpp"
+#include "../../pub/SystemConfiguration.hpp"
 #include <memory>
 #include "Controllers/Filesystem/pub/Filesystem.hpp"
 #include "Utilities/BsonReader/pub/BsonReader.hpp"
@@ -116,164 +118,69 @@ void FilterReader::persistConfig(const uint8_t *data, uint32_t size)
   filterFile->close();
 }
 
-void FilterReader::loadFloatArray(const uint8_t *data, const char *name, float32_t *coeffArray, uint32_t maxCount)
-{
-  BsonReader bson;
-  BsonElem arrayElem;
-
-  if (bson.findField(data, name, arrayElem))
-  {
-    bson.getFloatArray(coeffArray, arrayElem.data, maxCount);
-  }
-}
-
-void FilterReader::loadIntArray(const uint8_t *data, const char *name, int32_t *coeffArray, uint32_t maxCount)
-{
-  BsonReader bson;
-  BsonElem arrayElem;
-
-  if (bson.findField(data, name, arrayElem))
-  {
-    bson.getInt32Array(coeffArray, arrayElem.data, maxCount);
-  }
-}
-
-uint32_t FilterReader::getArraySize(const uint8_t *data, const char *name)
+void FilterReader::extractConfig(const uint8_t *data)
 {
-  BsonReader bson;
-  BsonElem arrayElem;
+  FilterConfigParser filterParser(filterConfig);
+  filterParser.extractConfig(data);
 
-  if (bson.findField(data, name, arrayElem))
+  if (!filterConfig->firConfig.fileName.empty() && !filterConfig->firConfig.coefficients)
   {
-    return bson.getArrayCount(arrayElem.data);
+    loadFirFile();
   }
 
-  return 0;
-}
-
-void FilterReader::loadInt(const uint8_t *data, const char *name, uint32_t *value)
-{
-  BsonReader bson;
-  BsonElem arrayElem;
-
-  if (bson.findField(data, name, arrayElem))
-  {
-    memcpy(value, arrayElem.data, sizeof(uint32_t));
-  }
+  extractDacAmpConfig(data);
 }
 
-void FilterReader::loadFloat32(const uint8_t *data, const char *name, float32_t *value)
+/**
+ * Loads the taps of the FIR filters from the file named by the configuration. The file holds little endian
+ * float32 taps, all the taps of one filter after the other, in the order of the placement. The filter
+ * length is the file size divided by the number of filters.
+ */
+void FilterReader::loadFirFile()
 {
-  BsonReader bson;
-  BsonElem arrayElem;
+  auto fs = globalServices->getFilesystem();
+  System::FirConfiguration &firConfig = filterConfig->firConfig;
 
-  if (bson.findField(data, name, arrayElem))
+  if (!fs->isMounted())
   {
-    if (arrayElem.type == BSON_TYPE_NUMBER)
-    {
-      double tmp;
-      memcpy(&tmp, arrayElem.data, 8);
-      *value = (float32_t) tmp;
-    }
-    else if (arrayElem.type == BSON_TYPE_INT32)
-    {
-      int32_t tmp;
-      memcpy(&tmp, arrayElem.data, 4);
-      *value = (float32_t) tmp;
-    }
+    return;
   }
-}
 
-void FilterReader::loadString(const uint8_t *data, const char *name, std::string &value)
-{
-  BsonReader bson;
-  BsonElem arrayElem;
+  uint32_t size;
+  uint8_t attrs;
 
-  if (bson.findField(data, name, arrayElem))
+  if (!fs->statFile(firConfig.fileName.c_str(), &size, &attrs))
   {
-    value.append((const char*) arrayElem.data);
+    return;
   }
-}
 
-void FilterReader::loadBool(const uint8_t *data, const char *name, bool *value)
-{
-  BsonReader bson;
-  BsonElem arrayElem;
+  const uint32_t filterCount = firConfig.getFilterCount();
+  const uint32_t taps = size / (filterCount * sizeof(float32_t));
 
-  if (bson.findField(data, name, arrayElem))
+  if (taps == 0 || taps > FIR_MAX_TAPS || size != taps * filterCount * sizeof(float32_t))
   {
-    *value = arrayElem.data[0];
+    return;
   }
-}
-
-void FilterReader::extractConfig(const uint8_t *data)
-{
-  BsonReader bson;
-  BsonElem arrayElem;
 
-  if (bson.findField(data, "name", arrayElem))
-  {
-    filterConfig->name = (const char*) arrayElem.data;
-  }
+  std::unique_ptr<System::File> firFile(fs->getFile());
 
-  if (bson.findField(data, "masterEqCoeffs", arrayElem))
+  if (!firFile->open(firConfig.fileName.c_str(), false))
   {
-    loadFloatArray(arrayElem.data, "leftMasterEqCoefficients", filterConfig->masterEqCoeffs[System::MasterEqCoeffcientType::LEFT], MASTER_EQ_STAGES * 5);
-    loadFloatArray(arrayElem.data, "rightMasterEqCoefficients", filterConfig->masterEqCoeffs[System::MasterEqCoeffcientType::RIGHT], MASTER_EQ_STAGES * 5);
+    return;
   }
 
-  if (bson.findField(data, "xoverEqCoeffs", arrayElem))
+  float32_t *coefficients = new float32_t[taps * filterCount];
+  if (firFile->read((uint8_t*) coefficients, size) == size)
   {
-    loadFloatArray(arrayElem.data, "xoverWooferLeft", filterConfig->xoverEqCoeffs[System::XoverEqCoeffcientType::LEFT_WOOFER], MASTER_EQ_STAGES * 5);
-    loadFloatArray(arrayElem.data, "xoverTweeterLeft", filterConfig->xoverEqCoeffs[System::XoverEqCoeffcientType::LEFT_TWEETER], MASTER_EQ_STAGES * 5);
-    loadFloatArray(arrayElem.data, "xoverWooferRight", filterConfig->xoverEqCoeffs[System::XoverEqCoeffcientType::RIGHT_WOOFER], MASTER_EQ_STAGES * 5);
-    loadFloatArray(arrayElem.data, "xoverTweeterRight", filterConfig->xoverEqCoeffs[System::XoverEqCoeffcientType::RIGHT_TWEETER], MASTER_EQ_STAGES * 5);
+    firConfig.coefficients = std::shared_ptr<const float32_t>(coefficients, std::default_delete<const float32_t[]>());
+    firConfig.taps = taps;
   }
-
-  extractDrcConfig(data, "levelerDrcConfig", filterConfig->levelerDrcConfig);
-  extractDrcConfig(data, "limiterDrcConfig", filterConfig->limiterDrcConfig);
-
-  loadBool(data, "masterEqEnabled", &filterConfig->masterEqEnabled);
-  loadBool(data, "xoverEqEnabled", &filterConfig->xoverEqEnabled);
-
-  loadBool(data, "levelerDrcEnabled", &filterConfig->levelerDrcConfig.enabled);
-  loadBool(data, "limiterDrcEnabled", &filterConfig->limiterDrcConfig.enabled);
-
-#if ALA_MODULE_ENABLED == 1
-  loadBool(data, "alaEnabled", &filterConfig->alaConfig.enabled);
-  extractAlaConfig(data, "alaConfig", filterConfig->alaConfig);
-#endif
-
-  extractDacAmpConfig(data);
-}
-
-void FilterReader::extractDrcConfig(const uint8_t *data, const char *name, System::DrcConfiguration &drcConfig)
-{
-  BsonReader bson;
-  BsonElem arrayElem;
-
-  if (bson.findField(data, name, arrayElem))
+  else
   {
-    loadFloat32(arrayElem.data, "attackDuration", &drcConfig.attackDuration);
-    loadFloat32(arrayElem.data, "releaseDuration", &drcConfig.releaseDuration);
-    loadFloat32(arrayElem.data, "compressionThresholdFullScaleDb", &drcConfig.compressionThresholdFullScaleDb);
-    loadFloat32(arrayElem.data, "compressionRatio", &drcConfig.compressionRatio);
-    loadFloat32(arrayElem.data, "sampleRateHz", &drcConfig.sampleRateHz);
-    loadFloat32(arrayElem.data, "postGain", &drcConfig.postGain);
+    delete[] coefficients;
   }
-}
-
-void FilterReader::extractAlaConfig(const uint8_t *data, const char *name, System::AlaConfiguration &alaConfig)
-{
-#if ALA_MODULE_ENABLED == 1
-  BsonReader bson;
-  BsonElem arrayElem;
 
-  if (bson.findField(data, name, arrayElem))
-  {
-    loadIntArray(arrayElem.data, "coefficients", alaConfig.coefficients, sizeof(AlaConfiguration::coefficients) / sizeof(int32_t));
-  }
-#endif
+  firFile->close();
 }
 
 void FilterReader::extractDacAmpConfig(const uint8_t *data)
@@ -309,6 +216,22 @@ void FilterReader::extractDacAmpConfig(const uint8_t *data)
       auto ampConfig = sysConfig->getAmpInterfaceConfiguration(System::AmpInterface::AMP_WOOFER_R);
       ampConfig->registerValueOverrideCount = bson.getIntPairArray(ampConfig->registerValues, subobjElem.data, 16);
     }
+
+    // Overrides the latency profile of the dip switches
+    if (bson.findField(objElem.data, "latencyMs", subobjElem) && subobjElem.type == BSON_TYPE_INT32)
+    {
+      uint32_t bufferingTime;
+      memcpy(&bufferingTime, subobjElem.data, sizeof(uint32_t));
+      sysConfig->setBufferingTime(bufferingTime);
+    }
+
+    // The sampling rate to start with, e.g. the rate of an external I2S master
+    if (bson.findField(objElem.data, "sampleRateHz", subobjElem) && subobjElem.type == BSON_TYPE_INT32)
+    {
+      uint32_t frequency;
+      memcpy(&frequency, subobjElem.data, sizeof(uint32_t));
+      sysConfig->setFrequency(frequency);
+    }
   }
 }
 
@@ -79,7 +79,8 @@ enum TelemetryBistCmdCode
   TELEMETRY_GET_SPI_REG,
   TELEMETRY_GET_STATUS,
   TELEMETRY_SET_GPIO_PORT,
-  TELEMETRY_GET_GPIO_PORT
+  TELEMETRY_GET_GPIO_PORT,
+  TELEMETRY_GET_AUDIO_LOAD
 };
 
 enum TelemetryFilterCmdCode
@@ -113,6 +114,7 @@ private:
   uint8_t getPeripheralStatus(System::SystemPeripheral systemPeripheral, uint8_t okResponse);
   GPIO_TypeDef* getGpioPort(uint8_t port);
   uint8_t getBistStatus(TelemetryCmd &cmd);
+  uint8_t getAudioLoad(TelemetryCmd &cmd);
   void halfMemcpy(volatile uint16_t *dst, const uint16_t *src, uint8_t len);
 
   uint8_t initBsonTx(TelemetryCmd &cmd);
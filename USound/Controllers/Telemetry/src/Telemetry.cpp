@@ -415,6 +415,37 @@ uint8_t Telemetry::getBistStatus(TelemetryCmd &cmd)
   return 0;
 }
 
+/**
+ * Returns the processing load of the audio path over the last second.
+ * Reply format: [32b: average load][32b: peak load][32b: blocks][32b: bypassed blocks][8b: standby][8b: reserved]
+ * [32b: wake-up time][32b: wake-up delay], with the loads in 0.01 % of the block period, the time of the last
+ * wake-up of the output stages and the delay it added to the audio in us
+ *
+ * @param cmd
+ * @return
+ */
+uint8_t Telemetry::getAudioLoad(TelemetryCmd &cmd)
+{
+  System::AudioLoadStats load = globalServices->getAudioService()->getAudioLoad();
+
+  TelemetryCmd reply;
+  memset(&reply.data, 0, 30);
+
+  reply.res = 2;
+  reply.cmd = GET_TELEMETRY;
+
+  halfMemcpy((volatile uint16_t*) &reply.data[4], (uint16_t*) &load.averageLoad, 4);
+  halfMemcpy((volatile uint16_t*) &reply.data[8], (uint16_t*) &load.peakLoad, 4);
+  halfMemcpy((volatile uint16_t*) &reply.data[12], (uint16_t*) &load.blocks, 4);
+  halfMemcpy((volatile uint16_t*) &reply.data[16], (uint16_t*) &load.bypassedBlocks, 4);
+  reply.data[20] = load.standby;
+  halfMemcpy((volatile uint16_t*) &reply.data[22], (uint16_t*) &load.wakeUpTime, 4);
+  halfMemcpy((volatile uint16_t*) &reply.data[26], (uint16_t*) &load.wakeLatency, 4);
+
+  globalServices->getOal()->sendMessageToQueue(replyMessageQueue, &reply, 0);
+  return 0;
+}
+
 uint8_t Telemetry::cmdHandler(TelemetryCmd &cmd)
 {
   switch (HID_SUB_CMD(cmd.cmd))
@@ -458,6 +489,9 @@ uint8_t Telemetry::cmdHandler(TelemetryCmd &cmd)
 
     case TelemetryBistCmdCode::TELEMETRY_GET_STATUS:
       return getBistStatus(cmd);
+
+    case TelemetryBistCmdCode::TELEMETRY_GET_AUDIO_LOAD:
+      return getAudioLoad(cmd);
   }
 
   return 0;
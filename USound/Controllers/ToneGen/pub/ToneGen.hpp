@@ -53,7 +53,7 @@ private:
   uint16_t *data;
   PatternType pattern;
   uint32_t sineFreq;
-  uint16_t currentOffset;
+  uint32_t currentOffset;
 
 public:
   ToneGen();
@@ -55,10 +55,8 @@ ToneGen::ToneGen() :
 
 void ToneGen::init()
 {
-  uint32_t bufferTime = globalServices->getSystemConfiguration()->getBufferingTIme();
-
   //TODO: Allocate buffer
-  data = new uint16_t[bufferTime * 2 * 48];
+  data = new uint16_t[globalServices->getSystemConfiguration()->getMaxBlockFrames() * 2];
 }
 
 /**
@@ -68,11 +66,13 @@ void ToneGen::init()
  */
 uint16_t* ToneGen::getData(uint32_t length)
 {
+  const uint32_t frequency = getFrequency();
+
   for (uint32_t i = 0; i < length; i += 2)
   {
     if (pattern == PatternType::PATTERN_SINE)
     {
-      data[i] = (int32_t) (32767.0f * sinf(2.0f * PI * currentOffset * sineFreq / 48000.0f));
+      data[i] = (int32_t) (32767.0f * sinf(2.0f * PI * currentOffset * sineFreq / (float32_t) frequency));
     }
     else if (pattern == PatternType::PATTERN_RAMP)
     {
@@ -81,7 +81,7 @@ uint16_t* ToneGen::getData(uint32_t length)
 
     data[i + 1] = data[i];
     currentOffset++;
-    if (currentOffset >= 48000)
+    if (currentOffset >= frequency)
     {
       currentOffset = 0;
     }
@@ -100,12 +100,12 @@ void ToneGen::consumedData(uint32_t length)
 }
 
 /**
- * Returns the configured operating frequency (in Hz)
+ * Returns the configured operating frequency (in Hz). The tones are generated at the rate of the audio path.
  * @return
  */
 uint32_t ToneGen::getFrequency()
 {
-  return 48000;
+  return globalServices->getSystemConfiguration()->getFrequency();
 }
 
 /**
@@ -67,6 +67,7 @@ private:
   void configure();
   void setAgcRatio(AmpAgcRatio agcRatio);
   void setFixedGain(int8_t fixedGain);
+  void setShutdown(bool enable);
 
 public:
 
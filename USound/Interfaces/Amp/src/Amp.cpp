@@ -45,6 +45,8 @@
 #define REG_AGC_CTRL_0        0x06
 #define REG_AGC_CTRL_1        0x07
 
+#define REG_FUNCTION_CTRL_SWS 0x20    //!< Software shutdown: the registers are kept, the control, bias and oscillator stop
+
 namespace PeripheralInterface
 {
 
@@ -117,11 +119,57 @@ void Amp::doAction(System::Action action)
       }
       break;
 
+    case System::Action::START:
+      // Only an amp in software shutdown needs waking, so starting the audio path costs no I2C transfers
+      if (state == System::State::PAUSED)
+      {
+        setShutdown(false);
+      }
+      break;
+
+    case System::Action::STOP:
+      setShutdown(true);
+      break;
+
     default:
       break;
   }
 }
 
+/**
+ * Enters or leaves the software shutdown of the amp. Unlike a reset, it keeps the configuration,
+ * so the amp is back within its start-up time.
+ * @param enable true to shut the amp down
+ */
+void Amp::setShutdown(bool enable)
+{
+  if (!bus || (state == System::State::UNINITIALISED) || (state == System::State::ERROR))
+  {
+    return;
+  }
+
+  uint32_t readVal = 0;
+  uint16_t size = 1;
+
+  auto status = bus->read(deviceAddress, REG_FUNCTION_CTRL, I2C_MEMADD_SIZE_8BIT, (uint8_t*) &readVal, &size, 100);
+  if (status != System::Status::STATUS_OK)
+  {
+    state = System::State::ERROR;
+    return;
+  }
+
+  readVal = (enable) ? readVal | REG_FUNCTION_CTRL_SWS : readVal & ~REG_FUNCTION_CTRL_SWS;
+
+  status = bus->write(deviceAddress, REG_FUNCTION_CTRL, I2C_MEMADD_SIZE_8BIT, (uint8_t*) &readVal, 1, 100);
+  if (status != System::Status::STATUS_OK)
+  {
+    state = System::State::ERROR;
+    return;
+  }
+
+  state = (enable) ? System::State::PAUSED : System::State::ENABLED;
+}
+
 bool Amp::verifyVersion()
 {
   if (!bus)
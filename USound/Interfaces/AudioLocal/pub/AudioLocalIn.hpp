@@ -38,6 +38,7 @@
 #include "Controllers/Service/pub/Services.hpp"
 #include "Controllers/System/pub/SystemConfiguration.hpp"
 #include "Controllers/Audio/pub/AudioService.hpp"
+#include "Interfaces/AudioLocal/pub/JitterBuffer.hpp"
 
 namespace PeripheralInterface
 {
@@ -51,19 +52,17 @@ class AudioLocalIn: public GlobalServiceConsumer, public System::AudioSource<uin
 {
 private:
   uint32_t frequency;
-  uint32_t chunkSizePerTransfer = 0;
-  uint32_t audioBufferLength = 0;
-  uint16_t *rxSamples = nullptr;
-  uint16_t *silenceSamples = nullptr;
-  uint32_t wr = 0;
-  uint32_t rd = 0;
+  uint32_t samplesPerNotification = 0;     //!< Samples received by the bus between two notifications
+  JitterBuffer *jitterBuffer = nullptr;
+  int16_t *blockSamples = nullptr;         //!< The block returned by getData()
+  int16_t *droppedSamples = nullptr;       //!< Receives the samples that do not fit in the jitter buffer
   System::SystemBus systemBus;
 
 private:
   void enable();
+  void configureFrequency();
   void start();
   void stop();
-  uint32_t getAvailableSampleCount();
 
 public:
   AudioLocalIn(System::SystemBus systemBus);
@@ -80,6 +79,9 @@ public:
   bool skipNext() override;
   bool skipPrev() override;
   uint32_t getFrequency() override;
+  int32_t getBufferedSamples() override;
+  void setFillTracking(bool enable) override;
+  bool getJitterBufferStats(System::JitterBufferStats &stats) override;
 };
 
 
@@ -80,6 +80,7 @@ public:
 
   void mute(bool enable) override;
   void setVolume(uint8_t vol) override;
+  void standby(bool enable) override;
 };
 
 
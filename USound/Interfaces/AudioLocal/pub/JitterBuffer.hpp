@@ -0,0 +1,138 @@
+//====================================================================
+//
+// COPYRIGHT 2026 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: Jitter buffer of the inputs with their own clock
+//  Filename: JitterBuffer.hpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#pragma once
+
+#include <stdint.h>
+#include "Utilities/Fifo/pub/SpscFifo.hpp"
+#include "Controllers/System/pub/FilterConfiguration.hpp"
+#include "Interfaces/pub/SystemControl.hpp"
+
+/**
+ * This class buffers an interleaved stereo input that arrives on its own clock (SAI slave or USB) for the audio task,
+ * which reads it in blocks on the clock of the outputs.
+ *
+ * The writer (the data in task) stores each notification of the bus with a timestamp, and the spread of the arrival
+ * times against the number of frames they brought is the arrival jitter. The reader (the audio task) always gets a
+ * whole block. The buffer starts reading once it holds a block and the target depth, and keeps the lowest fill before
+ * a read, over one second, at a block and the target depth: it repeats or merges one frame per block until it gets
+ * there, which also absorbs the drift between the clocks unless a resampler tracks it. When the depth adapts, it
+ * covers one notification, as the lowest fill drops by one each time the two clocks slide past each other, and the
+ * peak of the arrival jitter on top of it. Any underflow raises it at once.
+ *
+ * Missing frames are concealed: the last frame fades out, and the input fades back in from the last output frame
+ * once it returns. A buffer that runs empty starts over, and one that has grown far beyond its depth (e.g. when the
+ * reader stalled) skips the extra frames with the same fade.
+ *
+ * The writer and the reader may run in tasks of any priority. reset() is not safe while either of them runs.
+ */
+class JitterBuffer
+{
+private:
+  const System::JitterBufferConfiguration *config;
+  SpscFifo<int16_t> fifo;
+  uint32_t reservedFrames = 0;          //!< Frames of the fifo kept for the block being read and one notification
+  uint32_t frequency = 0;
+  uint32_t clockHz = 0;                 //!< Rate of the timestamps
+
+  // Writer side
+  uint32_t windowStart = 0;             //!< Timestamp of the first notification of the jitter measurement
+  uint32_t windowArrivedFrames = 0;     //!< Frames arrived since then
+  float32_t minOffset = 0.0f;           //!< Earliest arrival against the frames arrived, in frames
+  float32_t maxOffset = 0.0f;           //!< Latest arrival against the frames arrived, in frames
+  uint32_t windowNotificationFrames = 0;
+  bool windowStarted = false;
+  uint32_t pauseFrames = 0;             //!< A notification later than this, in frames, ends the measurement
+  volatile uint32_t arrivalJitter = 0;  //!< Spread of the arrivals of the last measurement, in frames
+  volatile uint32_t notificationFrames = 0;   //!< Largest notification of the last measurement
+  volatile uint32_t lastNotificationFrames = 0;
+  volatile uint32_t overflows = 0;
+  volatile uint32_t overflowFrames = 0;
+
+  // Reader side
+  uint32_t targetDepth = 0;             //!< In frames
+  uint32_t trackedDepth = 0;            //!< The target depth when the reader started to track the fill level
+  float32_t jitterPeak = 0.0f;          //!< Decaying peak of the arrival jitter, in frames
+  uint32_t lastRaise = 0;               //!< Frames the last underflow added to the depth
+  bool fillTracking = false;
+  bool primed = false;                  //!< Reading, or waiting for the buffer to fill up to its depth
+  uint32_t lastReadFrames = 0;
+  int16_t lastFrame[2] = { 0, 0 };      //!< The last output frame
+  uint32_t fadeInFrames = 0;            //!< Frames left of the fade from lastFrame to the input
+  uint32_t fadeOutFrames = 0;           //!< Frames concealed since the input ran short
+  int16_t concealedFrame[2] = { 0, 0 }; //!< The frame that fades out
+  uint32_t insertFrames = 0;            //!< Frames to repeat to bring the buffer to its depth
+  uint32_t dropFrames = 0;              //!< Frames to merge to bring the buffer to its depth
+
+  uint32_t windowFrames = 0;            //!< Frames read in the fill measurement
+  uint32_t windowReads = 0;
+  uint64_t windowFillSum = 0;
+  uint32_t windowMinFill = 0;
+  uint32_t windowMaxFill = 0;
+  int32_t windowMinHeadroom = 0;        //!< Lowest fill before a read beyond the block read
+  uint32_t underflows = 0;
+  uint32_t concealedFrames = 0;
+  uint32_t droppedFrames = 0;
+  System::JitterBufferStats stats;      //!< Published by the reader at the end of each fill measurement
+
+  uint32_t getDepthFrames(float32_t seconds) const;
+  void updateDepth();
+  void measureFill(uint32_t fill, uint32_t frames);
+  void conceal(int16_t *pDst, uint32_t frames);
+  void fadeIn(int16_t *pDst, uint32_t frames);
+  void insertFrame(int16_t *pDst, uint32_t frames);
+  void mergeFrame(int16_t *pDst, uint32_t frames, const int16_t *pNext);
+
+public:
+  JitterBuffer(const System::JitterBufferConfiguration *config);
+
+  void init(uint32_t maxBlockFrames, uint32_t maxFrequency);
+  void reset(uint32_t frequency, uint32_t clockHz);
+
+  /**
+   * Writer side: returns up to samples free slots, to be filled in place and published with commitWrite()
+   * @param samples
+   * @return
+   */
+  FifoSpan<int16_t> acquireWrite(uint32_t samples)
+  {
+    return fifo.acquireWrite(samples);
+  }
+
+  void commitWrite(uint32_t samples, uint32_t droppedSamples, uint32_t timestamp);
+
+  void read(int16_t *pDst, uint32_t frames);
+  void setFillTracking(bool enable);
+  int32_t getBufferedSamples() const;
+  void getStats(System::JitterBufferStats &stats) const;
+};
@@ -42,14 +42,13 @@
 #include "sai.h"
 
 
-//TODO: Add input jitter buffer
 //TODO: Add rate calculation on dma end
 
 namespace PeripheralInterface
 {
 
 AudioLocalIn::AudioLocalIn(System::SystemBus systemBus) :
-    frequency(48000),
+    frequency(DEFAULT_AUDIO_FREQUENCY),
     systemBus(systemBus)
 {
 
@@ -61,21 +60,43 @@ AudioLocalIn::~AudioLocalIn()
 }
 
 /**
- * Initialises the SAI input
+ * Initialises the SAI input. The buffers are allocated for the highest sampling rate.
  */
 void AudioLocalIn::init()
 {
-  uint32_t bufferTime = globalServices->getSystemConfiguration()->getBufferingTIme();
-  chunkSizePerTransfer = bufferTime * 2 * 48;
+  auto systemConfig = globalServices->getSystemConfiguration();
+  uint32_t maxChunkSize = systemConfig->getMaxBlockFrames() * 2;
 
-  // We make the fifo 4x longer than the DMA time, to allow start and stop conditions.
-  // We need to revise that, as it adds more latency
-  audioBufferLength = chunkSizePerTransfer * 2;
-  rxSamples = new uint16_t[audioBufferLength];
-  memset(rxSamples, 0, audioBufferLength * sizeof(uint16_t));
+  jitterBuffer = new JitterBuffer(&systemConfig->getFilterConfiguration()->jitterBufferConfig);
+  jitterBuffer->init(systemConfig->getMaxBlockFrames(), MAX_AUDIO_FREQUENCY);
+  blockSamples = new int16_t[maxChunkSize];
+  droppedSamples = new int16_t[maxChunkSize];
 
-  silenceSamples = new uint16_t[chunkSizePerTransfer];
-  memset(silenceSamples, 0, chunkSizePerTransfer * sizeof(uint16_t));
+  configureFrequency();
+}
+
+/**
+ * Sets the jitter buffer up for the sampling rate of the input bus, and empties it
+ */
+void AudioLocalIn::configureFrequency()
+{
+  auto systemConfig = globalServices->getSystemConfiguration();
+
+  // The USB notifies once per 1 ms frame, the SAI once per half of its DMA buffer
+  if (systemBus == System::SystemBus::USB)
+  {
+    frequency = systemConfig->getUsbConfiguration()->frequency;
+    samplesPerNotification = (frequency / 1000) * 2;
+  }
+  else
+  {
+    auto saiConfig = systemConfig->getSaiInterfaceConfiguration(System::SaiInterface::IN);
+    frequency = saiConfig->frequency;
+    samplesPerNotification = ((frequency * saiConfig->bufferingTime + 999) / 1000) * 2;
+  }
+
+  // The notifications are timed with the cycle counter, which the audio task runs
+  jitterBuffer->reset(frequency, SystemCoreClock);
 }
 
 void AudioLocalIn::deinit()
@@ -105,7 +126,6 @@ void AudioLocalIn::doAction(System::Action action)
 
     case System::Action::STOP:
       globalServices->getSystemStatus()->reportStatus(System::OperationalStatus::OPS_AUDIO_PAUSE);
-      memset(rxSamples, 0, audioBufferLength * sizeof(uint16_t));
       break;
 
     default:
@@ -119,47 +139,20 @@ void AudioLocalIn::doAction(System::Action action)
 void AudioLocalIn::enable()
 {
   auto systemController = globalServices->getSystemController();
-  frequency = globalServices->getSystemConfiguration()->getSaiInterfaceConfiguration(System::SaiInterface::TWEETER)->frequency;
+
+  configureFrequency();
 
   auto saiInBus = systemController->getBus(systemBus);
   saiInBus->enable();
 }
 
 /**
- * Returns the number of available samples.
- * It cannot distinguish between a full buffer and an empty buffer - it'll return 0 samples in both cases.
- */
-uint32_t AudioLocalIn::getAvailableSampleCount()
-{
-  if (wr >= rd)
-  {
-    return wr - rd;
-  }
-  else
-  {
-    return wr + audioBufferLength - rd;
-  }
-}
-
-/**
- * Returns a pointer to the oldest received sample.
+ * Returns the next block of received samples. Samples that have not arrived are concealed by the jitter buffer.
  */
 uint16_t* AudioLocalIn::getData(uint32_t length)
 {
-  if (getAvailableSampleCount() < length)
-  {
-    return silenceSamples;
-  }
-
-  uint16_t *buffer = &rxSamples[rd];
-
-  rd += length;
-  if (rd >= audioBufferLength)
-  {
-    rd = 0;
-  }
-
-  return buffer;
+  jitterBuffer->read(blockSamples, length / 2);
+  return (uint16_t*) blockSamples;
 }
 
 void AudioLocalIn::consumedData(uint32_t length)
@@ -175,26 +168,63 @@ void AudioLocalIn::notifyDataAvailable()
   auto systemController = globalServices->getSystemController();
   System::Bus *bus = systemController->getBus(systemBus);
 
-  // The DMA actually runs twice as fast as the rest of the audio, so it has half the data to send
-  uint16_t samplesToRead = chunkSizePerTransfer / (systemBus == System::SystemBus::USB ? 4 : 2);
-  bus->read(0, 0, 0, (uint8_t*) &rxSamples[wr], &samplesToRead, 0);
+  uint32_t timestamp = DWT->CYCCNT;
+
+  // The samples go straight into the free slots of the jitter buffer, which may wrap around its end
+  FifoSpan<int16_t> span = jitterBuffer->acquireWrite(samplesPerNotification);
+  uint32_t received = 0;
 
-  wr += samplesToRead;
-  if (wr >= audioBufferLength)
+  for (uint32_t i = 0; (i < 2) && (span.length[i] > 0); i++)
   {
-    wr = 0;
+    uint16_t samplesToRead = (uint16_t) span.length[i];
+    bus->read(0, 0, 0, (uint8_t*) span.data[i], &samplesToRead, 0);
+    received += samplesToRead;
+
+    // The bus had fewer samples
+    if (samplesToRead < span.length[i])
+    {
+      break;
+    }
+  }
+
+  // The rest of a notification that does not fit is still read, so the bus does not fall behind
+  uint16_t dropped = 0;
+  if ((received == span.getLength()) && (received < samplesPerNotification))
+  {
+    dropped = (uint16_t) (samplesPerNotification - received);
+    bus->read(0, 0, 0, (uint8_t*) droppedSamples, &dropped, 0);
   }
+
+  jitterBuffer->commitWrite(received, dropped, timestamp);
 }
 
 /**
- * Returns the source frequency.
- * In this version only 48 kHz is supported.
+ * Returns the source frequency, i.e. the rate of the input bus (Hz)
  */
 uint32_t AudioLocalIn::getFrequency()
 {
   return frequency;
 }
 
+/**
+ * Returns the number of received samples waiting to be read. The bus runs on its own clock.
+ */
+int32_t AudioLocalIn::getBufferedSamples()
+{
+  return jitterBuffer->getBufferedSamples();
+}
+
+void AudioLocalIn::setFillTracking(bool enable)
+{
+  jitterBuffer->setFillTracking(enable);
+}
+
+bool AudioLocalIn::getJitterBufferStats(System::JitterBufferStats &stats)
+{
+  jitterBuffer->getStats(stats);
+  return true;
+}
+
 bool AudioLocalIn::skipNext()
 {
   //NOT SUPPORTED
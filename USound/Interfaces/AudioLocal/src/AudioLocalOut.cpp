@@ -31,6 +31,7 @@
 //
 //====================================================================
 
+#include "OAL/pub/Oal.hpp"
 #include "Interfaces/Dac/pub/Dac.hpp"
 #include "Interfaces/AudioLocal/pub/AudioLocalOut.hpp"
 #include "Controllers/System/pub/SystemConfiguration.hpp"
@@ -40,6 +41,7 @@
 #include "Utilities/Fifo/pub/Fifo.hpp"
 #include "sai.h"
 
+#define AMP_START_UP_TIME 5             // ms, TPA2016 start-up time out of software shutdown
 
 //TODO: Add input jitter buffer
 //TODO: Add rate calculation on dma end
@@ -154,17 +156,8 @@ void AudioLocalOut::stop()
   auto saiWooferBus = systemController->getBus(System::SystemBus::SAI_WOOFER);
   auto dacTweeter = systemController->getPeripheral(System::SystemPeripheral::DAC_TWEETER);
   auto dacWoofer = systemController->getPeripheral(System::SystemPeripheral::DAC_WOOFER);
-  auto ampTweeterR = systemController->getPeripheral(System::SystemPeripheral::TWEETER_AMP_R);
-  //auto ampTweeterL = systemController->getPeripheral(System::SystemPeripheral::TWEETER_AMP_L);
-  auto ampWooferR = systemController->getPeripheral(System::SystemPeripheral::WOOFER_AMP_R);
-  auto ampWooferL = systemController->getPeripheral(System::SystemPeripheral::WOOFER_AMP_L);
-
-  ampWooferR->doAction(System::Action::STOP);
-  ampWooferL->doAction(System::Action::STOP);
-
-  ampTweeterR->doAction(System::Action::STOP);
-  //ampTweeterL->doAction(System::Action::STOP);
 
+  // The amps stay up: their STOP is the software shutdown of the standby, see standby()
   dacTweeter->doAction(System::Action::STOP);
   dacWoofer->doAction(System::Action::STOP);
 
@@ -250,4 +243,30 @@ void AudioLocalOut::setVolume(uint8_t vol)
   dacWoofer->setVolume(vol);
 }
 
+/**
+ * Puts the amps in standby, or wakes them up. The SAI and the DACs keep running, so the wake-up is only the release
+ * of the software shutdown and the start-up time of the amps, and the audio path resumes with the next block.
+ * Returns once the amps are up.
+ * @param enable
+ */
+void AudioLocalOut::standby(bool enable)
+{
+  auto systemController = globalServices->getSystemController();
+  auto ampTweeterR = systemController->getPeripheral(System::SystemPeripheral::TWEETER_AMP_R);
+  //auto ampTweeterL = systemController->getPeripheral(System::SystemPeripheral::TWEETER_AMP_L);
+  auto ampWooferR = systemController->getPeripheral(System::SystemPeripheral::WOOFER_AMP_R);
+  auto ampWooferL = systemController->getPeripheral(System::SystemPeripheral::WOOFER_AMP_L);
+  System::Action action = enable ? System::Action::STOP : System::Action::START;
+
+  ampWooferR->doAction(action);
+  ampWooferL->doAction(action);
+  ampTweeterR->doAction(action);
+  //ampTweeterL->doAction(action);
+
+  if (!enable)
+  {
+    globalServices->getOal()->delay(AMP_START_UP_TIME);
+  }
+}
+
 }
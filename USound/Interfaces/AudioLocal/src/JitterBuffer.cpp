@@ -0,0 +1,503 @@
+//====================================================================
+//
+// COPYRIGHT 2026 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: Jitter buffer of the inputs with their own clock
+//  Filename: JitterBuffer.cpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#include "Interfaces/AudioLocal/pub/JitterBuffer.hpp"
+#include <algorithm>
+#include <string.h>
+
+#define JITTER_FADE_FRAMES        32          //!< Length of the fades around the concealed frames
+#define JITTER_PEAK_RELEASE       0.03125f    //!< Share of the jitter peak released per second, for a half-life of about 20 s
+#define JITTER_DEPTH_TOLERANCE    8           //!< The depth is corrected once it is off by more than 1/8th of the target, and a frame
+
+#define NO_HEADROOM               INT32_MAX   //!< No read since the last underflow or skip
+
+/**
+ * @param config the depths, read at every fill measurement so that a reconfiguration takes effect within a second
+ */
+JitterBuffer::JitterBuffer(const System::JitterBufferConfiguration *config) :
+    config(config),
+    fifo(nullptr, 0)
+{
+}
+
+/**
+ * Allocates the buffer. It holds the longest block, one notification and twice the maximum depth at the highest rate:
+ * the depth and the growth beyond it that is left to the frame merges before the extra frames are skipped.
+ * @param maxBlockFrames the longest block of the reader, or notification of the writer
+ * @param maxFrequency the highest sampling rate
+ */
+void JitterBuffer::init(uint32_t maxBlockFrames, uint32_t maxFrequency)
+{
+  uint32_t maxDepthFrames = (uint32_t) (config->maxDepth * (float32_t) maxFrequency + 0.5f);
+  uint32_t samples = SpscFifo<int16_t>::roundSize((2 * maxBlockFrames + 2 * maxDepthFrames) * 2);
+
+  reservedFrames = 2 * maxBlockFrames;
+  fifo.reset(new int16_t[samples], samples);
+}
+
+/**
+ * Empties the buffer for an input at a new rate, and starts the statistics over
+ * @param frequency the sampling rate of the input (Hz)
+ * @param clockHz the rate of the timestamps of commitWrite()
+ */
+void JitterBuffer::reset(uint32_t frequency, uint32_t clockHz)
+{
+  this->frequency = frequency;
+  this->clockHz = clockHz;
+  fifo.reset(nullptr, 0);
+
+  windowStarted = false;
+  arrivalJitter = 0;
+  notificationFrames = 0;
+  lastNotificationFrames = 0;
+  overflows = 0;
+  overflowFrames = 0;
+
+  pauseFrames = getDepthFrames(config->maxDepth);
+  targetDepth = getDepthFrames(config->targetDepth);
+  trackedDepth = targetDepth;
+  jitterPeak = 0.0f;
+  lastRaise = 0;
+  primed = false;
+  lastReadFrames = 0;
+  memset(lastFrame, 0, sizeof(lastFrame));
+  memset(concealedFrame, 0, sizeof(concealedFrame));
+  fadeInFrames = 0;
+  fadeOutFrames = 0;
+  insertFrames = 0;
+  dropFrames = 0;
+
+  windowFrames = 0;
+  windowReads = 0;
+  windowFillSum = 0;
+  windowMinHeadroom = NO_HEADROOM;
+  underflows = 0;
+  concealedFrames = 0;
+  droppedFrames = 0;
+  stats = System::JitterBufferStats();
+  stats.targetDepth = targetDepth;
+}
+
+/**
+ * Converts a depth to frames at the current rate, up to what the buffer holds
+ */
+uint32_t JitterBuffer::getDepthFrames(float32_t seconds) const
+{
+  uint32_t limit = (fifo.getSize() / 2 - reservedFrames) / 2;
+  float32_t frames = seconds * (float32_t) frequency + 0.5f;
+
+  return (frames < 1.0f) ? 0 : std::min((uint32_t) frames, limit);
+}
+
+/**
+ * Writer side: publishes the first samples of the span returned by acquireWrite(), and takes the arrival time
+ * of the notification for the jitter measurement.
+ * @param samples samples written in the span
+ * @param droppedSamples samples of the notification that did not fit in the buffer
+ * @param timestamp the arrival time, at clockHz
+ */
+void JitterBuffer::commitWrite(uint32_t samples, uint32_t droppedSamples, uint32_t timestamp)
+{
+  fifo.commitWrite(samples);
+
+  if (droppedSamples > 0)
+  {
+    overflows++;
+    overflowFrames += droppedSamples / 2;
+  }
+
+  // Each notification brings the frames received since the previous one, so the time elapsed since the first one
+  // of the measurement, in frames, runs ahead of the frames arrived by how late the notification is
+  uint32_t frames = (samples + droppedSamples) / 2;
+  lastNotificationFrames = frames;
+
+  if (windowStarted)
+  {
+    windowArrivedFrames += frames;
+    windowNotificationFrames = std::max(windowNotificationFrames, frames);
+    float32_t offset = (float32_t) (timestamp - windowStart) * (float32_t) frequency / (float32_t) clockHz
+        - (float32_t) windowArrivedFrames;
+
+    if (offset > (float32_t) pauseFrames)
+    {
+      // Later than the buffer can hold out: the input has paused, and the gap is no jitter
+      windowStarted = false;
+    }
+    else
+    {
+      minOffset = std::min(minOffset, offset);
+      maxOffset = std::max(maxOffset, offset);
+
+      if (windowArrivedFrames >= frequency)
+      {
+        arrivalJitter = (uint32_t) (maxOffset - minOffset + 0.5f);
+        notificationFrames = windowNotificationFrames;
+        windowStarted = false;
+      }
+    }
+  }
+
+  if (!windowStarted)
+  {
+    windowStart = timestamp;
+    windowArrivedFrames = 0;
+    minOffset = 0.0f;
+    maxOffset = 0.0f;
+    windowNotificationFrames = frames;
+    windowStarted = true;
+  }
+}
+
+/**
+ * Reader side: copies a block out of the buffer. Missing frames are concealed, so the block is always whole.
+ * @param pDst interleaved stereo samples
+ * @param frames
+ */
+void JitterBuffer::read(int16_t *pDst, uint32_t frames)
+{
+  uint32_t fill = fifo.getSampleCount() / 2;
+
+  lastReadFrames = frames;
+  measureFill(fill, frames);
+
+  if (!primed)
+  {
+    // Until the first measurement, the depth covers the notifications seen so far
+    if (config->adaptive)
+    {
+      targetDepth = std::max(targetDepth, std::min((uint32_t) lastNotificationFrames, getDepthFrames(config->maxDepth)));
+    }
+
+    if (fill < frames + targetDepth)
+    {
+      conceal(pDst, frames);
+      return;
+    }
+
+    primed = true;
+    fadeInFrames = JITTER_FADE_FRAMES;
+    windowMinHeadroom = NO_HEADROOM;
+  }
+
+  // Far beyond its depth, e.g. after the reader stalled: skip back to it at once
+  if (fill > frames + targetDepth + getDepthFrames(config->maxDepth))
+  {
+    uint32_t skipped = fill - frames - targetDepth;
+
+    fifo.consumeBuffer(skipped * 2);
+    fill -= skipped;
+    droppedFrames += skipped;
+    fadeInFrames = JITTER_FADE_FRAMES;
+    windowMinHeadroom = NO_HEADROOM;
+    insertFrames = 0;
+    dropFrames = 0;
+  }
+
+  if (fill < frames)
+  {
+    // The frames there are, then the last one fades out. An empty buffer starts over.
+    fifo.popBuffer(pDst, fill * 2);
+    fadeIn(pDst, fill);
+    if (fill > 0)
+    {
+      memcpy(lastFrame, &pDst[(fill - 1) * 2], sizeof(lastFrame));
+      fadeOutFrames = 0;
+    }
+    conceal(&pDst[fill * 2], frames - fill);
+
+    underflows++;
+    concealedFrames += frames - fill;
+    primed = (fill > 0);
+    fadeInFrames = JITTER_FADE_FRAMES;
+    windowMinHeadroom = NO_HEADROOM;
+    insertFrames = 0;
+    dropFrames = 0;
+
+    // A late notification raises the depth by what it lacked. An empty buffer is a pause of the input rather
+    // than jitter: the raise of the underflow that led into it is taken back.
+    if (config->adaptive && (fill > 0))
+    {
+      lastRaise = std::min(frames - fill, getDepthFrames(config->maxDepth) - targetDepth);
+      jitterPeak += (float32_t) lastRaise;
+      targetDepth += lastRaise;
+    }
+    else if (config->adaptive)
+    {
+      jitterPeak = std::max(jitterPeak - (float32_t) lastRaise, 0.0f);
+      targetDepth -= std::min(lastRaise, targetDepth);
+      lastRaise = 0;
+    }
+    return;
+  }
+
+  lastRaise = 0;
+
+  if ((insertFrames > 0) && (frames >= 4))
+  {
+    fifo.popBuffer(pDst, (frames - 1) * 2);
+    insertFrame(pDst, frames);
+    insertFrames--;
+    concealedFrames++;
+
+    // The lowest fill is measured again once the depth has been corrected
+    windowMinHeadroom = (insertFrames == 0) ? NO_HEADROOM : windowMinHeadroom;
+  }
+  else if ((dropFrames > 0) && (fill > frames) && (frames >= 4))
+  {
+    int16_t nextFrame[2];
+
+    fifo.popBuffer(pDst, frames * 2);
+    fifo.popBuffer(nextFrame, 2);
+    mergeFrame(pDst, frames, nextFrame);
+    dropFrames--;
+    droppedFrames++;
+    windowMinHeadroom = (dropFrames == 0) ? NO_HEADROOM : windowMinHeadroom;
+  }
+  else
+  {
+    fifo.popBuffer(pDst, frames * 2);
+  }
+
+  fadeIn(pDst, frames);
+  memcpy(lastFrame, &pDst[(frames - 1) * 2], sizeof(lastFrame));
+  fadeOutFrames = 0;
+}
+
+/**
+ * Adds the fill before a read to the measurement, and at the end of it publishes the statistics and updates
+ * the depth
+ * @param fill frames in the buffer
+ * @param frames frames of the read
+ */
+void JitterBuffer::measureFill(uint32_t fill, uint32_t frames)
+{
+  windowMinFill = (windowReads == 0) ? fill : std::min(windowMinFill, fill);
+  windowMaxFill = (windowReads == 0) ? fill : std::max(windowMaxFill, fill);
+  windowFillSum += fill;
+  windowReads++;
+  windowFrames += frames;
+
+  if (primed)
+  {
+    windowMinHeadroom = std::min(windowMinHeadroom, (int32_t) fill - (int32_t) frames);
+  }
+
+  if (windowFrames >= frequency)
+  {
+    updateDepth();
+
+    stats.targetDepth = targetDepth;
+    stats.arrivalJitter = arrivalJitter;
+    stats.minFill = windowMinFill;
+    stats.averageFill = (uint32_t) (windowFillSum / windowReads);
+    stats.maxFill = windowMaxFill;
+
+    windowFrames = 0;
+    windowReads = 0;
+    windowFillSum = 0;
+    windowMinHeadroom = NO_HEADROOM;
+  }
+}
+
+/**
+ * Sets the target depth for the next second, and the frames to repeat or merge to get there
+ */
+void JitterBuffer::updateDepth()
+{
+  if (config->adaptive)
+  {
+    // Fast attack, slow release
+    uint32_t notification = std::max((uint32_t) notificationFrames, (uint32_t) lastNotificationFrames);
+    jitterPeak = std::max((float32_t) arrivalJitter, jitterPeak - jitterPeak * JITTER_PEAK_RELEASE);
+    targetDepth = std::min(std::max(notification + (uint32_t) (jitterPeak + 0.5f), getDepthFrames(config->minDepth)),
+        getDepthFrames(config->maxDepth));
+  }
+  else
+  {
+    targetDepth = getDepthFrames(config->targetDepth);
+  }
+
+  insertFrames = 0;
+  dropFrames = 0;
+
+  // A reader that tracks the fill level moves it to the depth itself
+  if (primed && !fillTracking && (windowMinHeadroom != NO_HEADROOM))
+  {
+    int32_t error = windowMinHeadroom - (int32_t) targetDepth;
+    int32_t tolerance = 1 + (int32_t) (targetDepth / JITTER_DEPTH_TOLERANCE);
+
+    if (error < -tolerance)
+    {
+      insertFrames = (uint32_t) -error;
+    }
+    else if (error > tolerance)
+    {
+      dropFrames = (uint32_t) error;
+    }
+  }
+}
+
+/**
+ * Fades the last output frame out, and plays silence after it
+ * @param pDst
+ * @param frames
+ */
+void JitterBuffer::conceal(int16_t *pDst, uint32_t frames)
+{
+  if (frames == 0)
+  {
+    return;
+  }
+
+  if (fadeOutFrames == 0)
+  {
+    memcpy(concealedFrame, lastFrame, sizeof(concealedFrame));
+  }
+
+  for (uint32_t i = 0; i < frames; i++)
+  {
+    float32_t gain = 0.0f;
+
+    if (fadeOutFrames < JITTER_FADE_FRAMES)
+    {
+      fadeOutFrames++;
+      gain = (float32_t) (JITTER_FADE_FRAMES - fadeOutFrames) / JITTER_FADE_FRAMES;
+    }
+
+    pDst[2 * i] = (int16_t) ((float32_t) concealedFrame[0] * gain);
+    pDst[2 * i + 1] = (int16_t) ((float32_t) concealedFrame[1] * gain);
+  }
+
+  memcpy(lastFrame, &pDst[(frames - 1) * 2], sizeof(lastFrame));
+}
+
+/**
+ * Fades from the last output frame into the input, once it returns after a concealment or a skip
+ * @param pDst
+ * @param frames
+ */
+void JitterBuffer::fadeIn(int16_t *pDst, uint32_t frames)
+{
+  for (uint32_t i = 0; (i < frames) && (fadeInFrames > 0); i++, fadeInFrames--)
+  {
+    float32_t gain = (float32_t) (JITTER_FADE_FRAMES - fadeInFrames + 1) / JITTER_FADE_FRAMES;
+
+    for (uint32_t ch = 0; ch < 2; ch++)
+    {
+      pDst[2 * i + ch] = (int16_t) ((float32_t) lastFrame[ch] + (float32_t) (pDst[2 * i + ch] - lastFrame[ch]) * gain);
+    }
+  }
+}
+
+/**
+ * Stretches a block of frames - 1 frames to frames, with a frame in the middle interpolated between its neighbours
+ * @param pDst
+ * @param frames
+ */
+void JitterBuffer::insertFrame(int16_t *pDst, uint32_t frames)
+{
+  uint32_t mid = frames / 2;
+
+  memmove(&pDst[(mid + 1) * 2], &pDst[mid * 2], (frames - 1 - mid) * 2 * sizeof(int16_t));
+
+  for (uint32_t ch = 0; ch < 2; ch++)
+  {
+    pDst[mid * 2 + ch] = (int16_t) (((int32_t) pDst[(mid - 1) * 2 + ch] + pDst[(mid + 1) * 2 + ch]) / 2);
+  }
+}
+
+/**
+ * Shrinks a block of frames + 1 frames to frames, with the two frames in the middle replaced by their average
+ * @param pDst the first frames
+ * @param frames
+ * @param pNext the last frame
+ */
+void JitterBuffer::mergeFrame(int16_t *pDst, uint32_t frames, const int16_t *pNext)
+{
+  uint32_t mid = frames / 2;
+
+  for (uint32_t ch = 0; ch < 2; ch++)
+  {
+    pDst[mid * 2 + ch] = (int16_t) (((int32_t) pDst[mid * 2 + ch] + pDst[(mid + 1) * 2 + ch]) / 2);
+  }
+
+  memmove(&pDst[(mid + 1) * 2], &pDst[(mid + 2) * 2], (frames - mid - 2) * 2 * sizeof(int16_t));
+  memcpy(&pDst[(frames - 1) * 2], pNext, 2 * sizeof(int16_t));
+}
+
+/**
+ * Reader side: tells whether the reader tracks the fill level (a resampler that follows the drift). The buffer then
+ * leaves the depth to it, and getBufferedSamples() hides the depth changes, so the reader moves the fill by as much.
+ * @param enable
+ */
+void JitterBuffer::setFillTracking(bool enable)
+{
+  if (enable && !fillTracking)
+  {
+    trackedDepth = targetDepth;
+    insertFrames = 0;
+    dropFrames = 0;
+  }
+
+  fillTracking = enable;
+}
+
+/**
+ * Reader side: returns the samples in the buffer, as the reader tracking the fill level should see them. While the
+ * buffer fills up to its depth, it returns the fill it starts reading at.
+ * @return
+ */
+int32_t JitterBuffer::getBufferedSamples() const
+{
+  int32_t samples = primed ? (int32_t) fifo.getSampleCount() : (int32_t) (lastReadFrames + targetDepth) * 2;
+
+  if (fillTracking)
+  {
+    samples -= 2 * ((int32_t) targetDepth - (int32_t) trackedDepth);
+  }
+
+  return std::max(samples, (int32_t) 0);
+}
+
+/**
+ * Returns the statistics of the last fill measurement, and the counters so far
+ * @param stats
+ */
+void JitterBuffer::getStats(System::JitterBufferStats &stats) const
+{
+  stats = this->stats;
+  stats.underflows = underflows;
+  stats.overflows = overflows;
+  stats.concealedFrames = concealedFrames;
+  stats.droppedFrames = droppedFrames + overflowFrames;
+}
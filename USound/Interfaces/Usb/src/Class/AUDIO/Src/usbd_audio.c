@@ -122,7 +122,7 @@
 #define MIC_EP_SIZE_CFG ((uint8_t)MIC_EP_SIZE), ((uint8_t)(MIC_EP_SIZE>>8))
 
 extern void USB_IN_RxData(USBD_HandleTypeDef *pdev, int16_t *usb_buffer, uint32_t rxBytes);
-extern uint32_t USB_IN_GetSaiReadCycles(USBD_HandleTypeDef *pdev, uint32_t reset);
+extern uint32_t USB_IN_GetSaiReadFrames(USBD_HandleTypeDef *pdev, uint32_t reset);
 extern void USB_IN_SetMute(USBD_HandleTypeDef *pdev, uint32_t mute);
 extern void USB_IN_SetVolume(USBD_HandleTypeDef *pdev, uint32_t level);
 
@@ -342,7 +342,7 @@ __ALIGN_BEGIN static uint8_t USBD_AUDIO_DeviceQualifierDesc[USB_LEN_DEV_QUALIFIE
 volatile uint32_t SOF_num_feedback = 0;
 volatile uint32_t lockedSampling = 0;
 volatile uint32_t lockedCount = 0;
-volatile uint32_t usb_cycles = 0;   // counts cycles of 8ms
+volatile uint32_t usb_cycles = 0;   // counts milliseconds (SOFs)
 volatile uint32_t first_sync_with_sai = 0;   // detects first sai dma end
 static uint32_t mute = 0;
 static int16_t curvol = DEFAULT_OUT_VOLUME;
@@ -488,13 +488,13 @@ static uint8_t USBD_AUDIO_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *
           if ((uint8_t) (req->wIndex) < USBD_MAX_NUM_INTERFACES)
           {
             haudio->alt_setting = (uint8_t) (req->wValue);
-            lockedSampling = (int32_t) (48 << 13);
+            lockedSampling = (int32_t) ((USBD_AUDIO_FREQ << 13) / 1000);
             lockedCount = 0;
             usb_cycles = 0;
 
             if (haudio->alt_setting)
             {
-              USB_IN_GetSaiReadCycles(pdev, 1);
+              USB_IN_GetSaiReadFrames(pdev, 1);
               first_sync_with_sai = 1;
               SOF_num_feedback = 0;
 
@@ -587,19 +587,8 @@ static uint8_t USBD_AUDIO_EP0_RxReady(USBD_HandleTypeDef *pdev)
           {
             curvol = haudio->control.data[0] | ((uint16_t) haudio->control.data[1] << 8);
 
-#if LOGARITHMIC_GAIN_ENABLED == 1
-            // Received value is between -1024 to 1024, so we perform a log conversion
-            uint16_t val = 0xFF;
-            if(curvol > -1024)
-            {
-              val = 2 * (uint16_t)(0.5f + 60.0f * log10fApprox(2048.0f / (float32_t) (curvol + 1024)));
-            }
-            USB_IN_SetVolume(pdev, 0xFF - MIN(0xFF, val));
-#else
-            // Received value is between -1024 to 1024, so we convert to 0 to 255
-            uint16_t val = (((curvol + 1024) & 0xFFFF) >> 3);
-            USB_IN_SetVolume(pdev, MIN(0xFF, val));
-#endif
+            // The value (-1024 to 1024) is converted to a volume level by the audio control task, outside of the ISR
+            USB_IN_SetVolume(pdev, (uint16_t) curvol);
           }
           break;
       }
@@ -645,7 +634,7 @@ static uint8_t USBD_AUDIO_SOF(USBD_HandleTypeDef *pdev)
 
     if (first_sync_with_sai)
     {
-      uint32_t sai_samples = USB_IN_GetSaiReadCycles(pdev, 0);
+      uint32_t sai_samples = USB_IN_GetSaiReadFrames(pdev, 0);
       if (sai_samples)
       {
         lockedCount = 0;
@@ -658,11 +647,11 @@ static uint8_t USBD_AUDIO_SOF(USBD_HandleTypeDef *pdev)
     {
       lockedCount = 0;
 
-      uint32_t dma_cycles = USB_IN_GetSaiReadCycles(pdev, 0);    // Each cycle corresponds to 4ms (plus the drift)
-      usb_cycles += 250;
+      uint32_t dma_frames = USB_IN_GetSaiReadFrames(pdev, 0);    // Frames played out, whatever the block duration (plus the drift)
+      usb_cycles += 1000;
 
-      float32_t fract_cycles = ((dma_cycles * 48.0f) / usb_cycles) * 8192.0f;
-      lockedSampling = (uint32_t) fract_cycles;
+      float32_t fract_frames = ((float32_t) dma_frames / usb_cycles) * 8192.0f;    // Frames per 1 ms frame, scaled by 2^13 like the initial value of SET_INTERFACE
+      lockedSampling = (uint32_t) fract_frames;
 
     }
 
@@ -255,11 +255,37 @@ public:
   virtual void mute(bool enable) = 0;
   virtual void setVolume(uint8_t vol) = 0;
 
+  /**
+   * Powers the output stages down, or back up, while the sink keeps its clocks and data stream running.
+   * Sinks without output stages ignore it.
+   */
+  virtual void standby(bool enable)
+  {
+  }
+
   virtual ~AudioSink()
   {
   }
 };
 
+/**
+ * The fill level of the jitter buffer of a source with its own clock. The fill is sampled before each read,
+ * in frames, over about one second. The counters run from the last time the source was enabled.
+ */
+struct JitterBufferStats
+{
+public:
+  uint32_t targetDepth = 0;         //!< Frames the buffer aims to keep, at its lowest, beyond the block being read
+  uint32_t arrivalJitter = 0;       //!< Spread of the arrival times of the input, in frames
+  uint32_t minFill = 0;
+  uint32_t averageFill = 0;
+  uint32_t maxFill = 0;
+  uint32_t underflows = 0;          //!< Reads that found fewer frames than the block
+  uint32_t overflows = 0;           //!< Notifications that did not fit in the buffer
+  uint32_t concealedFrames = 0;     //!< Frames repeated or faded out in place of missing input
+  uint32_t droppedFrames = 0;       //!< Frames left out to bring the buffer back to its depth, or that did not fit
+};
+
 /**
  * This abstract class defines an audio source interface
  * @tparam T
@@ -276,6 +302,32 @@ public:
   virtual bool skipNext() = 0;
   virtual bool skipPrev() = 0;
 
+  /**
+   * Returns the number of received samples waiting to be read, for sources with their own clock.
+   * Sources that produce their samples on demand return -1.
+   */
+  virtual int32_t getBufferedSamples()
+  {
+    return -1;
+  }
+
+  /**
+   * Tells a source with its own clock that the reader follows its fill level (a resampler that tracks the drift),
+   * so the source leaves the fill level to it.
+   */
+  virtual void setFillTracking(bool enable)
+  {
+  }
+
+  /**
+   * Returns the jitter buffer statistics of a source with its own clock.
+   * @return false if the source has no jitter buffer
+   */
+  virtual bool getJitterBufferStats(JitterBufferStats &stats)
+  {
+    return false;
+  }
+
   virtual ~AudioSource()
   {
   }
@@ -41,6 +41,7 @@
 #include "Controllers/Service/pub/Services.hpp"
 #include "Controllers/System/pub/ModuleConfig.hpp"
 #include "Utilities/Fifo/pub/Fifo.hpp"
+#include "Utilities/Fifo/pub/SpscFifo.hpp"
 #include "Interfaces/Usb/src/Core/Inc/usbd_def.h"
 #include <functional>
 
@@ -183,8 +184,11 @@ private:
 
   uint8_t *saiDmaBuffer;        //!< The DMA buffer to be sent out over the SAI interface
   uint32_t dmaBufferLen;
+  uint32_t activeFrequency = 0;   //!< The sampling rate the SAI block and dmaBufferLen are set up for
   bool isDmaHalf = false;
 
+  void configureFrequency();
+
 public:
   FreeRtosSaiOut(void *handle, SaiConfiguration *saiConfiguration);
 
@@ -210,8 +214,11 @@ private:
 
   uint8_t *saiDmaBuffer;        //!< The DMA buffer to be sent out over the SAI interface
   uint32_t dmaBufferLen;
+  uint32_t activeFrequency = 0;   //!< The sampling rate the SAI block and dmaBufferLen are set up for
   bool isDmaHalf = false;
 
+  void configureFrequency();
+
 public:
   FreeRtosSaiIn(void *handle, SaiConfiguration *saiConfiguration);
 
@@ -231,7 +238,7 @@ public:
 class FreeRtosUsbIn: public Bus, public GlobalServiceConsumer
 {
 private:
-  Fifo<int16_t> usbInFifo;
+  SpscFifo<int16_t> usbInFifo;       //!< Pushed by the USB ISR, popped by the audio task
   UsbConfiguration *usbConfiguration;
   int16_t *usbBuffer = nullptr;
   USBD_HandleTypeDef *handle;
@@ -248,7 +255,7 @@ public:
   Status disable() override;
 
   void rxDone(int16_t *usb_buffer, uint32_t rxBytes);
-  uint32_t getReadCycles(bool reset);
+  uint32_t getReadFrames(bool reset);
   void setVolume(uint32_t level);
   void setMute(bool mute);
 };
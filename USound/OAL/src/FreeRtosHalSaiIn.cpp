@@ -62,19 +62,36 @@ FreeRtosSaiIn::FreeRtosSaiIn(void *handle, SaiConfiguration *saiConfiguration) :
  */
 void FreeRtosSaiIn::init()
 {
-  // We need to allocate 2 buffers for DMA (ping-pong)
+  // We need to allocate 2 buffers for DMA (ping-pong), long enough for a block at the highest sampling rate (the input notifies once or twice per block)
+  uint32_t maxDmaBufferLen = globalServices->getSystemConfiguration()->getMaxBlockFrames() * 2 * CHANNEL_COUNT;
+  saiDmaBuffer = globalServices->getMemAllocator()->alloc(maxDmaBufferLen * sizeof(uint16_t));
+
+  // Register priv data for DMA callback
+  handle = static_cast<SAI_HandleTypeDef*>(saiConfiguration->handle);
+  handle->priv = this;
+
+  configureFrequency();
+}
+
+/**
+ * Sizes the DMA buffer for the configured sampling rate, and sets the SAI block up again when the rate has changed.
+ * The SAI must be stopped.
+ */
+void FreeRtosSaiIn::configureFrequency()
+{
   dmaBufferLen = (((saiConfiguration->frequency * saiConfiguration->bufferingTime) + 999) / 1000) * 2 * CHANNEL_COUNT;
-  saiDmaBuffer = globalServices->getMemAllocator()->alloc(dmaBufferLen * sizeof(uint16_t));
 
   memset(saiDmaBuffer, 0, dmaBufferLen * sizeof(uint16_t));
-
   saiInFifo.reset((uint16_t*) saiDmaBuffer, dmaBufferLen);
+  isDmaHalf = false;
 
-  // Register priv data for DMA callback
-  handle = static_cast<SAI_HandleTypeDef*>(saiConfiguration->handle);
-  handle->priv = this;
+  if (activeFrequency == saiConfiguration->frequency)
+  {
+    return;
+  }
 
-  MX_SAI2_InitBlockA((int) saiConfiguration->saiMode);
+  activeFrequency = saiConfiguration->frequency;
+  MX_SAI2_InitBlockA((int) saiConfiguration->saiMode, activeFrequency);
 }
 
 /**
@@ -112,11 +129,13 @@ Status FreeRtosSaiIn::write(uint32_t deviceAddress, uint16_t registerAddress, ui
 }
 
 /**
- * Starts the SAI DMA
+ * Starts the SAI DMA, at the sampling rate currently configured
  * @return
  */
 Status FreeRtosSaiIn::enable()
 {
+  configureFrequency();
+
   __HAL_SAI_ENABLE(handle);
 
   if (HAL_SAI_Receive_DMA(handle, saiDmaBuffer, dmaBufferLen) != HAL_OK)
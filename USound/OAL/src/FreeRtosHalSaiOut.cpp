@@ -62,13 +62,9 @@ FreeRtosSaiOut::FreeRtosSaiOut(void *handle, SaiConfiguration *saiConfiguration)
  */
 void FreeRtosSaiOut::init()
 {
-  // We need to allocate 2 buffers for DMA (ping-pong)
-  dmaBufferLen = (((saiConfiguration->frequency * saiConfiguration->bufferingTime) + 999) / 1000) * 2 * CHANNEL_COUNT;
-  saiDmaBuffer = globalServices->getMemAllocator()->alloc(dmaBufferLen * sizeof(uint16_t));
-
-  memset(saiDmaBuffer, 0, dmaBufferLen * sizeof(uint16_t));
-
-  saiOutFifo.reset((uint16_t*) saiDmaBuffer, dmaBufferLen);
+  // We need to allocate 2 buffers for DMA (ping-pong), long enough for a block at the highest sampling rate
+  uint32_t maxDmaBufferLen = globalServices->getSystemConfiguration()->getMaxBlockFrames() * 2 * CHANNEL_COUNT;
+  saiDmaBuffer = globalServices->getMemAllocator()->alloc(maxDmaBufferLen * sizeof(uint16_t));
 
   //TODO: Check if this should only be done in main, as it should be done prior to the DAC config
   //systemConfiguration->configureSaiOutInterface(saiInterface, System::PeripheralConfiguration::PERIPH_ENABLE);
@@ -77,13 +73,41 @@ void FreeRtosSaiOut::init()
   handle = static_cast<SAI_HandleTypeDef*>(saiConfiguration->handle);
   handle->priv = this;
 
+  configureFrequency();
+}
+
+/**
+ * Sizes the DMA buffer for the configured sampling rate, and sets the SAI block up again when the rate has changed.
+ * The master block also switches the SAI kernel clock between the 44.1 kHz and the 48 kHz family.
+ * The SAI must be stopped.
+ */
+void FreeRtosSaiOut::configureFrequency()
+{
+  dmaBufferLen = (((saiConfiguration->frequency * saiConfiguration->bufferingTime) + 999) / 1000) * 2 * CHANNEL_COUNT;
+
+  memset(saiDmaBuffer, 0, dmaBufferLen * sizeof(uint16_t));
+  saiOutFifo.reset((uint16_t*) saiDmaBuffer, dmaBufferLen);
+  isDmaHalf = false;
+
+  if (activeFrequency == saiConfiguration->frequency)
+  {
+    return;
+  }
+
+  activeFrequency = saiConfiguration->frequency;
+
+  if (saiConfiguration->saiMode == SaiMode::SAI_MODE_TX_MASTER)
+  {
+    MX_SAI_ConfigKernelClock(activeFrequency);
+  }
+
   if (saiConfiguration->saiInterface == SaiInterface::TWEETER)
   {
-    MX_SAI3_InitBlockA(saiConfiguration->saiMode);
+    MX_SAI3_InitBlockA(saiConfiguration->saiMode, activeFrequency);
   }
   else
   {
-    MX_SAI3_InitBlockB(saiConfiguration->saiMode);
+    MX_SAI3_InitBlockB(saiConfiguration->saiMode, activeFrequency);
   }
 }
 
@@ -128,11 +152,13 @@ Status FreeRtosSaiOut::write(uint32_t deviceAddress, uint16_t registerAddress, u
 }
 
 /**
- * Starts the SAI DMA
+ * Starts the SAI DMA, at the sampling rate currently configured
  * @return
  */
 Status FreeRtosSaiOut::enable()
 {
+  configureFrequency();
+
   __HAL_SAI_ENABLE(handle);
 
   if (HAL_SAI_Transmit_DMA(handle, saiDmaBuffer, dmaBufferLen) != HAL_OK)
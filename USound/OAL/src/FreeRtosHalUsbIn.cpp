@@ -34,7 +34,7 @@
 #include "Controllers/Audio/pub/AudioService.hpp"
 #include "FreeRtosHal.hpp"
 #include "Controllers/System/pub/SystemConfiguration.hpp"
-#include "Utilities/Fifo/pub/Fifo.hpp"
+#include "Utilities/Fifo/pub/SpscFifo.hpp"
 #include "Interfaces/pub/SystemControl.hpp"
 
 namespace System
@@ -60,6 +60,9 @@ void FreeRtosUsbIn::init()
 {
   uint32_t usbBufferLen = (((usbConfiguration->frequency * usbConfiguration->bufferingTime) + 999) / 1000) * CHANNEL_COUNT;
 
+  // The lock-free fifo needs a power of two
+  usbBufferLen = SpscFifo<int16_t>::roundSize(usbBufferLen);
+
   usbBuffer = new int16_t[usbBufferLen];
   memset(usbBuffer, 0, usbBufferLen * sizeof(uint16_t));
 
@@ -125,7 +128,8 @@ Status FreeRtosUsbIn::disable()
 
 /**
  * This callback runs inside interrupt context and notifies the Audio controller that more data
- * can be processed.
+ * can be processed. Samples that do not fit in the fifo are dropped, rather than overwriting the ones the audio
+ * task has not read yet.
  *
  * @param dmaType
  */
@@ -137,25 +141,25 @@ void FreeRtosUsbIn::rxDone(int16_t *usbBuffer, uint32_t rxBytes)
 }
 
 /**
- * Returns the number of audio out cycles
+ * Returns the number of frames played out
  *
- * @param reset if 1 it resets the read cycles
+ * @param reset if 1 it resets the frame counter
  * @return
  */
-uint32_t FreeRtosUsbIn::getReadCycles(bool resetCycles)
+uint32_t FreeRtosUsbIn::getReadFrames(bool resetFrames)
 {
-  return globalServices->getAudioService()->getAudioOutCycles(resetCycles);
+  return globalServices->getAudioService()->getAudioOutFrames(resetFrames);
 }
 
 /**
  * Sets audio engine volume
  *
- * @param level the audio level (0-0xFF)
+ * @param level the USB volume control value (-1024 to 1024, in the low 16 bits)
  * @return
  */
 void FreeRtosUsbIn::setVolume(uint32_t level)
 {
-  globalServices->getAudioService()->setVolume(level, AudioChangeSrc::ACS_USB);
+  globalServices->getAudioService()->setUsbVolume((int16_t) level);
 }
 
 /**
@@ -182,13 +186,13 @@ extern "C" void USB_IN_RxData(USBD_HandleTypeDef *pdev, int16_t *usbBuffer, uint
 }
 
 /**
- * Returns the number of audio out cycles
+ * Returns the number of frames played out
  * @return
  */
-extern "C" uint32_t USB_IN_GetSaiReadCycles(USBD_HandleTypeDef *pdev, uint32_t reset)
+extern "C" uint32_t USB_IN_GetSaiReadFrames(USBD_HandleTypeDef *pdev, uint32_t reset)
 {
   FreeRtosUsbIn *usbIn = static_cast<FreeRtosUsbIn*>(pdev->priv);
-  return usbIn->getReadCycles(reset == 1);
+  return usbIn->getReadFrames(reset == 1);
 }
 
 /**
@@ -39,9 +39,9 @@
 namespace System
 {
 
-void FreeRtosOal::sendMessageToQueue(void *queue, const void *msg_ptr, uint32_t timeout)
+uint32_t FreeRtosOal::sendMessageToQueue(void *queue, const void *msg_ptr, uint32_t timeout)
 {
-  osMessageQueuePut(queue, msg_ptr, 0, timeout);
+  return osMessageQueuePut(queue, msg_ptr, 0, timeout) == osOK;
 }
 
 uint32_t FreeRtosOal::popMessageFromQueue(void *queue, void *msg_ptr, uint32_t timeout)
@@ -47,7 +47,7 @@ class FreeRtosOal: public Oal
 {
 public:
   void* createMessageQueue(uint32_t msg_count, uint32_t msg_size) override;
-  void sendMessageToQueue(void *queue, const void *msg_ptr, uint32_t timeout) override;
+  uint32_t sendMessageToQueue(void *queue, const void *msg_ptr, uint32_t timeout) override;
   uint32_t popMessageFromQueue(void *queue, void *msg_ptr, uint32_t timeout) override;
   uint32_t popMessageFromQueueFromISR(void *queue, void *msg_ptr, uint32_t timeout) override;
 
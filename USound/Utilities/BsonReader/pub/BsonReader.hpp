@@ -67,6 +67,7 @@
 #define BSON_TYPE_INT32         0x10 // \x10 int32 - 32-bit integer
 #define BSON_TYPE_TIMESTAMP     0x11 // \x11
 #define BSON_TYPE_INT64         0x12 // \x12 int64 - 64-bit integer.
+#define BSON_TYPE_DECIMAL128    0x13 // \x13 decimal128 - 128-bit decimal floating point
 
 /**
  * Helper struct to reference Bson elements
@@ -74,11 +75,11 @@
 struct BsonElem
 {
 public:
-  uint8_t type;
-  uint32_t dataLen;
-  uint32_t elemLen;
-  const uint8_t* data;
-  const uint8_t* name;
+  uint8_t type = 0;
+  uint32_t dataLen = 0;
+  uint32_t elemLen = 0;
+  const uint8_t* data = nullptr;
+  const uint8_t* name = nullptr;
 
   BsonElem& operator=(const BsonElem &a)
   {
@@ -101,7 +102,7 @@ public:
 class BsonReader
 {
 private:
-  void getField(const uint8_t* data, BsonElem& elem);
+  bool getField(const uint8_t* data, BsonElem& elem);
 
 public:
 
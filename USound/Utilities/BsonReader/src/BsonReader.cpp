@@ -58,9 +58,8 @@ uint32_t BsonReader::getFloatArray(float32_t *dst, const uint8_t *data, uint32_t
   uint32_t len;
   memcpy(&len, data, sizeof(uint32_t));
 
-  while (((off + 1) < len) && (count < maxCount))
+  while (((off + 1) < len) && (count < maxCount) && getField(&data[off], arrayElem))
   {
-    getField(&data[off], arrayElem);
 
     if (arrayElem.type == BSON_TYPE_NUMBER)
     {
@@ -99,9 +98,8 @@ uint32_t BsonReader::getInt32Array(int32_t *dst, const uint8_t *data, uint32_t m
 
   uint32_t len = *((uint32_t*)data);
 
-  while (((off + 1) < len) && (count < maxCount))
+  while (((off + 1) < len) && (count < maxCount) && getField(&data[off], arrayElem))
   {
-    getField(&data[off], arrayElem);
 
     if (arrayElem.type == BSON_TYPE_INT32)
     {
@@ -134,9 +132,8 @@ uint32_t BsonReader::getIntPairArray(std::pair<uint8_t, uint8_t> *dst, const uin
   uint32_t len;
   memcpy(&len, data, sizeof(uint32_t));
 
-  while (((off + 1) < len) && (count < maxCount))
+  while (((off + 1) < len) && (count < maxCount) && getField(&data[off], arrayElem))
   {
-    getField(&data[off], arrayElem);
 
     dst[count].first = (uint8_t)strtoul((const char*)arrayElem.name, nullptr, 0);
 
@@ -174,9 +171,8 @@ uint32_t BsonReader::getArrayCount(const uint8_t *data)
   uint32_t len;
   memcpy(&len, data, sizeof(uint32_t));
 
-  while ((off + 1) < len)
+  while (((off + 1) < len) && getField(&data[off], arrayElem))
   {
-    getField(&data[off], arrayElem);
 
     count++;
     off += arrayElem.elemLen;
@@ -189,8 +185,10 @@ uint32_t BsonReader::getArrayCount(const uint8_t *data)
  * Returns the current Bson field that begins at the provided data pointer
  * @param data the beginning of the Bson element
  * @param elem the element object to store the Bson element attributes
+ * @return false if the element is of a type that the reader cannot size, so that the rest of the document
+ * cannot be parsed
  */
-void BsonReader::getField(const uint8_t *data, BsonElem &elem)
+bool BsonReader::getField(const uint8_t *data, BsonElem &elem)
 {
   elem.type = *data++;
   elem.name = data;
@@ -222,6 +220,37 @@ void BsonReader::getField(const uint8_t *data, BsonElem &elem)
       elem.dataLen = sizeof(char);
       break;
 
+    case BSON_TYPE_DATE:
+    case BSON_TYPE_TIMESTAMP:
+    case BSON_TYPE_INT64:
+      elem.dataLen = sizeof(int64_t);
+      break;
+
+    case BSON_TYPE_OID:
+      elem.dataLen = 12;
+      break;
+
+    case BSON_TYPE_DECIMAL128:
+      elem.dataLen = 16;
+      break;
+
+    case BSON_TYPE_UNDEFINED:
+    case BSON_TYPE_NULL:
+    case BSON_MINKEY:
+    case BSON_MAXKEY:
+      elem.dataLen = 0;
+      break;
+
+    case BSON_TYPE_BINARY: {
+      // Length, subtype and the bytes
+      uint32_t sz;
+      memcpy(&sz, data, sizeof(uint32_t));
+      data += sizeof(uint32_t) + 1;
+      elem.dataLen = sz;
+      elem.elemLen += sizeof(uint32_t) + 1;
+    }
+      break;
+
     case BSON_TYPE_OBJECT:
       case BSON_TYPE_ARRAY: {
       uint32_t sz;
@@ -231,11 +260,16 @@ void BsonReader::getField(const uint8_t *data, BsonElem &elem)
       break;
 
     default:
-      break;
+      // The other types are not used by the configurations
+      elem.dataLen = 0;
+      elem.elemLen = 0;
+      elem.data = nullptr;
+      return false;
   }
 
   elem.elemLen += elem.dataLen;
   elem.data = data;
+  return true;
 }
 
 /**
@@ -245,7 +279,8 @@ void BsonReader::getField(const uint8_t *data, BsonElem &elem)
  * @param data the beginning of the Bson document
  * @param fieldName the name of the field to be located
  * @param elem the element object to hold the fount element attributes
- * @return true if the element was found, false otherwise
+ * @return true if the element was found, false otherwise, also when an element before it is of a type that
+ * cannot be sized
  */
 bool BsonReader::findField(const uint8_t *data, const char *fieldName, BsonElem &elem)
 {
@@ -256,9 +291,8 @@ bool BsonReader::findField(const uint8_t *data, const char *fieldName, BsonElem
   uint32_t off = sizeof(uint32_t);
   elem.data = nullptr;
 
-  while ((off + 1) < len)
+  while (((off + 1) < len) && getField(&data[off], searchElem))
   {
-    getField(&data[off], searchElem);
 
     if (strcmp((const char*) searchElem.name, fieldName) == 0)
     {
@@ -0,0 +1,275 @@
+//====================================================================
+//
+// COPYRIGHT 2026 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: Lock-free single-writer/multi-reader broadcast fifo
+//  Filename: BroadcastFifo.hpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <cstring>
+#include <atomic>
+#include "SpscFifo.hpp"
+
+/**
+ * The read position of one reader of a BroadcastFifo. Each reader owns its cursor, the fifo does not track them.
+ */
+struct BroadcastReader
+{
+public:
+  uint32_t rd = 0;                    //!< Free running index of the next sample to read
+  uint32_t overruns = 0;              //!< Reads that found samples overwritten by the writer
+  uint32_t lostSamples = 0;           //!< Samples the reader never got because of the overruns
+};
+
+/**
+ * A lock-free fifo for one writer and any number of readers, each reading every sample at its own pace.
+ *
+ * The writer never waits for the readers: it always writes, over the oldest samples when the fifo is full, and a
+ * reader that falls more than the fifo size behind loses the samples that were overwritten. The indices run freely
+ * like in SpscFifo. Before writing, the writer announces the end of the samples it is about to write (wrReserved),
+ * and publishes them with wr afterwards. A reader copies the samples below wr, then reads wrReserved again: the
+ * samples that the writer may have overwritten in between (more than the fifo size below wrReserved) are dropped
+ * from the copy and counted as an overrun. A reader thus never returns a torn sample, whatever its priority, and
+ * the writer does the same work with one reader or ten.
+ *
+ * reset() is not safe while the writer or a reader is running.
+ *
+ * @tparam T
+ */
+template<typename T>
+class BroadcastFifo
+{
+protected:
+  T *data;
+  uint32_t size;                      //!< Number of slots, a power of two
+  uint32_t mask;                      //!< size - 1
+  std::atomic<uint32_t> wr;           //!< Free running index past the last published sample
+  std::atomic<uint32_t> wrReserved;   //!< Free running index past the last sample that may have been written
+  std::atomic<uint32_t> readerCount;
+
+  /**
+   * Returns the span of count slots from the slot of an index
+   */
+  FifoSpan<T> getSpan(uint32_t index, uint32_t count) const
+  {
+    uint32_t offset = index & mask;
+    uint32_t firstLen = (count < (size - offset)) ? count : (size - offset);
+
+    return { { &data[offset], data }, { firstLen, count - firstLen } };
+  }
+
+public:
+  BroadcastFifo(T *data, uint32_t size) :
+      data(nullptr),
+      size(0),
+      mask(0),
+      wr(0),
+      wrReserved(0),
+      readerCount(0)
+  {
+    reset(data, size);
+  }
+
+  /**
+   * Empties the fifo and, when data is provided, moves it onto a new buffer. A buffer length that is not a power
+   * of two is rounded down, like in SpscFifo. The attached readers have to attach again.
+   * @param data
+   * @param samples length of the buffer
+   */
+  void reset(T *data, uint32_t samples)
+  {
+    if (data != nullptr)
+    {
+      uint32_t rounded = SpscFifo<T>::roundSize(samples);
+
+      this->data = data;
+      this->size = (rounded > samples) ? (rounded >> 1) : rounded;
+      this->mask = this->size - 1;
+    }
+
+    wr.store(0, std::memory_order_relaxed);
+    wrReserved.store(0, std::memory_order_relaxed);
+  }
+
+  /**
+   * Reader side: starts reading at the next sample the writer publishes
+   * @param reader
+   */
+  void attach(BroadcastReader &reader)
+  {
+    reader.rd = wr.load(std::memory_order_acquire);
+    reader.overruns = 0;
+    reader.lostSamples = 0;
+    readerCount.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Reader side: stops reading. The writer may skip writing once no reader is attached.
+   * @param reader
+   */
+  void detach(BroadcastReader &reader)
+  {
+    readerCount.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Writer side: tells if any reader is attached
+   * @return
+   */
+  bool hasReaders() const
+  {
+    return readerCount.load(std::memory_order_relaxed) > 0;
+  }
+
+  /**
+   * Writer side: returns up to samples slots (at most the fifo size) to be written in place and published with
+   * commitWrite(). From then on, the readers treat the oldest samples in those slots as overwritten.
+   * @param samples
+   * @return
+   */
+  FifoSpan<T> acquireWrite(uint32_t samples)
+  {
+    uint32_t wrIndex = wr.load(std::memory_order_relaxed);
+
+    if (samples > size)
+    {
+      samples = size;
+    }
+
+    wrReserved.store(wrIndex + samples, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return getSpan(wrIndex, samples);
+  }
+
+  /**
+   * Writer side: publishes the first samples of the span returned by acquireWrite(), at most its length.
+   * @param samples
+   */
+  void commitWrite(uint32_t samples)
+  {
+    wr.store(wr.load(std::memory_order_relaxed) + samples, std::memory_order_release);
+  }
+
+  /**
+   * Writer side: copies samples into the fifo, over the oldest ones. Of a buffer longer than the fifo,
+   * only the first size samples are written.
+   * @param srcBuffer
+   * @param bufferSize
+   * @return the number of samples written
+   */
+  uint32_t pushBuffer(const T *srcBuffer, uint32_t bufferSize)
+  {
+    FifoSpan<T> span = acquireWrite(bufferSize);
+
+    memcpy(span.data[0], srcBuffer, span.length[0] * sizeof(T));
+    memcpy(span.data[1], &srcBuffer[span.length[0]], span.length[1] * sizeof(T));
+    commitWrite(span.getLength());
+
+    return span.getLength();
+  }
+
+  /**
+   * Reader side: returns the number of samples the reader can read, at most the fifo size. Once it is the fifo size,
+   * the next sample the writer publishes overwrites the oldest one.
+   * @param reader
+   * @return
+   */
+  uint32_t getSampleCount(const BroadcastReader &reader) const
+  {
+    uint32_t available = wr.load(std::memory_order_acquire) - reader.rd;
+    return (available < size) ? available : size;
+  }
+
+  /**
+   * Reader side: copies up to requestedSamples samples, from the position of the reader. A reader that has fallen
+   * behind skips the samples that were overwritten, or that may have been overwritten while they were copied,
+   * and gets the ones after them.
+   * @param reader
+   * @param dstBuffer
+   * @param requestedSamples
+   * @return the number of samples read
+   */
+  uint32_t read(BroadcastReader &reader, T *dstBuffer, uint32_t requestedSamples)
+  {
+    uint32_t wrIndex = wr.load(std::memory_order_acquire);
+
+    if ((wrIndex - reader.rd) > size)
+    {
+      reader.overruns++;
+      reader.lostSamples += wrIndex - size - reader.rd;
+      reader.rd = wrIndex - size;
+    }
+
+    uint32_t available = wrIndex - reader.rd;
+    if (requestedSamples > available)
+    {
+      requestedSamples = available;
+    }
+
+    FifoSpan<T> span = getSpan(reader.rd, requestedSamples);
+    memcpy(dstBuffer, span.data[0], span.length[0] * sizeof(T));
+    memcpy(&dstBuffer[span.length[0]], span.data[1], span.length[1] * sizeof(T));
+
+    // The samples more than the fifo size below wrReserved may have been written over during the copy
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint32_t reservedIndex = wrReserved.load(std::memory_order_relaxed);
+
+    if ((reservedIndex - reader.rd) > size)
+    {
+      uint32_t overwritten = reservedIndex - size - reader.rd;
+      if (overwritten > requestedSamples)
+      {
+        overwritten = requestedSamples;
+      }
+
+      memmove(dstBuffer, &dstBuffer[overwritten], (requestedSamples - overwritten) * sizeof(T));
+
+      reader.overruns++;
+      reader.lostSamples += overwritten;
+      reader.rd += overwritten;
+      requestedSamples -= overwritten;
+    }
+
+    reader.rd += requestedSamples;
+
+    return requestedSamples;
+  }
+
+  /**
+   * Returns the number of slots
+   * @return
+   */
+  uint32_t getSize() const
+  {
+    return size;
+  }
+};
@@ -152,9 +152,9 @@ public:
     }
   }
 
-  void push(const T data)
+  void push(const T sample)
   {
-    data[wr++] = data;
+    data[wr++] = sample;
     if (wr >= maxSamples)
     {
       wr = 0;
@@ -170,9 +170,20 @@ public:
       requestedSamples = fifoDataLen;
     }
 
-    for (uint32_t i = 0; i < requestedSamples; i++)
+    uint32_t dst_idx = 0;
+    uint32_t bufferSize = requestedSamples;
+
+    while (bufferSize)
     {
-      dstBuffer[i] = data[rd++];
+      uint32_t capacity = maxSamples - rd;
+      uint32_t cp_len = capacity >= bufferSize ? bufferSize : capacity;
+
+      memcpy(&dstBuffer[dst_idx], &data[rd], cp_len * sizeof(T));
+
+      bufferSize -= cp_len;
+      dst_idx += cp_len;
+
+      rd += cp_len;
       if (rd >= maxSamples)
       {
         rd = 0;
@@ -228,6 +239,7 @@ public:
 
   /**
    * Transfers data from one fifo to the other, until the number of requested samples is transfered or the source fifo is drained.
+   * The samples are copied straight from the source buffer, one contiguous segment of the source at a time.
    *
    * @param srcFifo
    * @param len
@@ -235,20 +247,20 @@ public:
    */
   uint32_t transferFromFifo(Fifo<T> *srcFifo, uint32_t len)
   {
-    T sample;
+    uint32_t fifoDataLen = srcFifo->getSampleCount();
+    uint32_t bufferSize = fifoDataLen < len ? fifoDataLen : len;
 
-    while (len)
+    len -= bufferSize;
+
+    while (bufferSize)
     {
-      if (srcFifo->getSampleCount() > 0)
-      {
-        sample = srcFifo->pop();
-        push(sample);
-        len--;
-      }
-      else
-      {
-        break;
-      }
+      uint32_t capacity = srcFifo->maxSamples - srcFifo->rd;
+      uint32_t cp_len = capacity >= bufferSize ? bufferSize : capacity;
+
+      pushBuffer(&srcFifo->data[srcFifo->rd], cp_len);
+      srcFifo->consumeBuffer(cp_len);
+
+      bufferSize -= cp_len;
     }
 
     return len;
@@ -0,0 +1,292 @@
+//====================================================================
+//
+// COPYRIGHT 2026 All rights reserved.
+//       USound
+//
+//====================================================================
+//
+//                          DISCLAIMER
+// NO WARRANTIES
+// USound expressly disclaims any warranty for the SOFTWARE
+// PRODUCT. The SOFTWARE PRODUCT and any related documentation is
+// provided "as is" without warranty of any kind, either expressed or
+// implied, including, without limitation, the implied warranties or
+// merchantability, fitness for a particular purpose, or noninfringe-
+// ment. The entire risk arising out of the use or performance of the
+// SOFTWARE PRODUCT remains with the user.
+//
+// NO LIABILITY FOR DAMAGES.
+// Under no circumstances is USound liable for any damages
+// whatsoever (including, without limitation, damages for loss of busi-
+// ness profits, business interruption, loss of business information,
+// or any other pecuniary loss) arising out of the use of or inability
+// to use this product.
+//
+//====================================================================
+//
+//  Description: Lock-free single-producer/single-consumer fifo
+//  Filename: SpscFifo.hpp
+//  Author(s): Nik Kostaras (nk@socfpga.io)
+//  Date: 16-October-2026
+//
+//====================================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <cstring>
+#include <atomic>
+
+/**
+ * Up to two contiguous runs of fifo slots: the first one from the index to at most the end of the buffer,
+ * the second one from the beginning of the buffer. Unused runs have a length of 0.
+ * @tparam T
+ */
+template<typename T>
+struct FifoSpan
+{
+public:
+  T *data[2];
+  uint32_t length[2];
+
+  /**
+   * Returns the number of slots of both runs
+   * @return
+   */
+  uint32_t getLength() const
+  {
+    return length[0] + length[1];
+  }
+};
+
+/**
+ * A lock-free fifo for one producer and one consumer, e.g. an ISR that pushes and a task that pops.
+ *
+ * The size is a power of two and the wr and rd indices run freely, wrapping at 2^32: the slot of an index is
+ * the index masked with size - 1, the fill level is wr - rd, and a full fifo (wr - rd == size) is told apart
+ * from an empty one (wr == rd) without leaving a slot unused. Only the producer writes wr and only the consumer
+ * writes rd. Each side publishes its index with a release store after it has copied the samples, and reads the
+ * index of the other side with an acquire load before it touches them; on the Cortex-M7 these compile to a DMB
+ * before the store and after the load, so the samples are in memory before the other side sees the new index,
+ * whatever the priority of either side.
+ *
+ * Neither side ever blocks or overwrites: pushing to a full fifo stores what fits and popping from an empty one
+ * returns what there is. reset() is not safe while either side is running.
+ *
+ * Besides the copies, each side can work in place on the fifo memory: acquireWrite() returns the free slots as up
+ * to two spans, which a decoder or a DMA fills before commitWrite() publishes them, and acquireRead() returns the
+ * stored samples, which stay valid until release() hands them back to the producer.
+ *
+ * @tparam T
+ */
+template<typename T>
+class SpscFifo
+{
+protected:
+  T *data;
+  uint32_t size;                      //!< Number of slots, a power of two
+  uint32_t mask;                      //!< size - 1
+  std::atomic<uint32_t> wr;           //!< Free running write index, written by the producer only
+  std::atomic<uint32_t> rd;           //!< Free running read index, written by the consumer only
+
+  /**
+   * Returns the span of count slots from the slot of an index
+   */
+  FifoSpan<T> getSpan(uint32_t index, uint32_t count) const
+  {
+    uint32_t offset = index & mask;
+    uint32_t firstLen = (count < (size - offset)) ? count : (size - offset);
+
+    return { { &data[offset], data }, { firstLen, count - firstLen } };
+  }
+
+public:
+  /**
+   * Returns the smallest power of two that holds the given number of samples, i.e. the buffer length to allocate
+   * for a fifo of at least that size
+   * @param samples
+   * @return
+   */
+  static uint32_t roundSize(uint32_t samples)
+  {
+    uint32_t rounded = 1;
+
+    while (rounded < samples)
+    {
+      rounded <<= 1;
+    }
+
+    return rounded;
+  }
+
+  SpscFifo(T *data, uint32_t size) :
+      data(nullptr),
+      size(0),
+      mask(0),
+      wr(0),
+      rd(0)
+  {
+    reset(data, size);
+  }
+
+  /**
+   * Empties the fifo and, when data is provided, moves it onto a new buffer. A buffer length that is not a power
+   * of two is rounded down, so the fifo never goes past the end of the buffer.
+   * @param data
+   * @param samples length of the buffer
+   */
+  void reset(T *data, uint32_t samples)
+  {
+    if (data != nullptr)
+    {
+      uint32_t rounded = roundSize(samples);
+
+      this->data = data;
+      this->size = (rounded > samples) ? (rounded >> 1) : rounded;
+      this->mask = this->size - 1;
+    }
+
+    wr.store(0, std::memory_order_relaxed);
+    rd.store(0, std::memory_order_relaxed);
+  }
+
+  /**
+   * Producer side: returns up to samples free slots, to be written in place and published with commitWrite().
+   * @param samples
+   * @return the free slots, fewer than samples when the fifo is nearly full
+   */
+  FifoSpan<T> acquireWrite(uint32_t samples)
+  {
+    uint32_t wrIndex = wr.load(std::memory_order_relaxed);
+    uint32_t freeSlots = size - (wrIndex - rd.load(std::memory_order_acquire));
+
+    return getSpan(wrIndex, (samples < freeSlots) ? samples : freeSlots);
+  }
+
+  /**
+   * Producer side: publishes the first samples of the span returned by acquireWrite(), at most its length.
+   * @param samples
+   */
+  void commitWrite(uint32_t samples)
+  {
+    wr.store(wr.load(std::memory_order_relaxed) + samples, std::memory_order_release);
+  }
+
+  /**
+   * Producer side: copies up to bufferSize samples into the fifo.
+   * @param srcBuffer
+   * @param bufferSize
+   * @return the number of samples stored, less than bufferSize when the fifo is full
+   */
+  uint32_t pushBuffer(const T *srcBuffer, uint32_t bufferSize)
+  {
+    FifoSpan<T> span = acquireWrite(bufferSize);
+
+    memcpy(span.data[0], srcBuffer, span.length[0] * sizeof(T));
+    memcpy(span.data[1], &srcBuffer[span.length[0]], span.length[1] * sizeof(T));
+    commitWrite(span.getLength());
+
+    return span.getLength();
+  }
+
+  /**
+   * Producer side: stores one sample.
+   * @param sample
+   * @return false if the fifo is full
+   */
+  bool push(const T sample)
+  {
+    return pushBuffer(&sample, 1) == 1;
+  }
+
+  /**
+   * Consumer side: returns up to samples stored samples, to be read (or processed) in place and handed back
+   * with release().
+   * @param samples
+   * @return the stored samples, fewer than samples when the fifo runs empty
+   */
+  FifoSpan<T> acquireRead(uint32_t samples)
+  {
+    uint32_t rdIndex = rd.load(std::memory_order_relaxed);
+    uint32_t fifoDataLen = wr.load(std::memory_order_acquire) - rdIndex;
+
+    return getSpan(rdIndex, (samples < fifoDataLen) ? samples : fifoDataLen);
+  }
+
+  /**
+   * Consumer side: hands the first samples of the span returned by acquireRead() back to the producer, at most
+   * its length.
+   * @param samples
+   */
+  void release(uint32_t samples)
+  {
+    rd.store(rd.load(std::memory_order_relaxed) + samples, std::memory_order_release);
+  }
+
+  /**
+   * Consumer side: copies up to requestedSamples samples out of the fifo.
+   * @param dstBuffer
+   * @param requestedSamples
+   * @return the number of samples read, less than requestedSamples when the fifo runs empty
+   */
+  uint32_t popBuffer(T *dstBuffer, uint32_t requestedSamples)
+  {
+    FifoSpan<T> span = acquireRead(requestedSamples);
+
+    memcpy(dstBuffer, span.data[0], span.length[0] * sizeof(T));
+    memcpy(&dstBuffer[span.length[0]], span.data[1], span.length[1] * sizeof(T));
+    release(span.getLength());
+
+    return span.getLength();
+  }
+
+  /**
+   * Consumer side: reads one sample.
+   * @param sample
+   * @return false if the fifo is empty
+   */
+  bool pop(T &sample)
+  {
+    return popBuffer(&sample, 1) == 1;
+  }
+
+  /**
+   * Consumer side: drops up to bufferSize samples.
+   * @param bufferSize
+   * @return the number of samples dropped
+   */
+  uint32_t consumeBuffer(uint32_t bufferSize)
+  {
+    uint32_t dropped = acquireRead(bufferSize).getLength();
+
+    release(dropped);
+    return dropped;
+  }
+
+  /**
+   * Consumer side: returns the number of samples stored in the fifo. More may arrive meanwhile.
+   * @return
+   */
+  uint32_t getSampleCount() const
+  {
+    return wr.load(std::memory_order_acquire) - rd.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Producer side: returns the number of free slots in the fifo. More may be freed meanwhile.
+   * @return
+   */
+  uint32_t getCapacity() const
+  {
+    return size - (wr.load(std::memory_order_relaxed) - rd.load(std::memory_order_acquire));
+  }
+
+  /**
+   * Returns the number of slots
+   * @return
+   */
+  uint32_t getSize() const
+  {
+    return size;
+  }
+};
@@ -34,6 +34,17 @@
 
 #include "MathUtils.hpp"
 #include "cmath"
+#include <string.h>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#define LOG10_2     0.30102999566398120f
+#define LOG2_10     3.32192809488736235f
+
+#define FPSCR_FZ    (1UL << 24)     //!< Flush-to-zero mode of the Cortex-M7 FPU
+#define MXCSR_DAZ   0x0040          //!< Denormals-are-zero mode of the SSE unit
+#define MXCSR_FTZ   0x8000          //!< Flush-to-zero mode of the SSE unit
 
 /**
  *  Fast approximation to the log2() function. It uses a two step
@@ -85,3 +96,180 @@ float32_t log10fApprox(float32_t x)
   //return log10f(x);   //standard, but slower
   return log2fApprox(x) * 0.3010299956639812f; //faster:  log2(x)/log2(10)
 }
+
+/**
+ * Reinterprets the bits of a float32_t as an integer
+ */
+static inline uint32_t floatToBits(float32_t x)
+{
+  uint32_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  return bits;
+}
+
+/**
+ * Reinterprets the bits of an integer as a float32_t
+ */
+static inline float32_t bitsToFloat(uint32_t bits)
+{
+  float32_t x;
+  memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+
+/**
+ * log2(x) for positive x. The exponent is taken from the float bits and log2(1 + t), t in [0, 1),
+ * from a 5th order minimax polynomial (max error 1.5e-5). Zero and denormal inputs return -127.
+ * There are no library calls or branches, so the loops around it can be pipelined.
+ */
+static inline float32_t log2Kernel(float32_t x)
+{
+  uint32_t bits = floatToBits(x);
+  float32_t exponent = (float32_t) ((int32_t) ((bits >> 23) & 0xFF) - 127);
+  float32_t t = bitsToFloat((bits & 0x007FFFFF) | 0x3F800000) - 1.0f;
+
+  float32_t y = 0.046384691260298365f;
+  y = y * t - 0.19626800977723596f;
+  y = y * t + 0.4175944182098687f;
+  y = y * t - 0.7096623685355673f;
+  y = y * t + 1.4419655694823028f;
+
+  return exponent + y * t;
+}
+
+/**
+ * 2^y. The integer part of y goes to the exponent bits and 2^f, f in [0, 1), comes from a
+ * 5th order minimax polynomial (max relative error 7.5e-8). y is saturated to the normal range.
+ */
+static inline float32_t exp2Kernel(float32_t y)
+{
+  y = (y < -126.0f) ? -126.0f : y;
+  y = (y > 127.99f) ? 127.99f : y;
+
+  int32_t integer = (int32_t) y;
+  integer -= (y < (float32_t) integer);     // floor for negative values
+  float32_t f = y - (float32_t) integer;
+
+  float32_t p = 0.001877576077011959f;
+  p = p * f + 0.008989341533503245f;
+  p = p * f + 0.05582631684735373f;
+  p = p * f + 0.2401536174495606f;
+  p = p * f + 0.6931530731536175f;
+  p = p * f + 0.9999999250643506f;
+
+  return bitsToFloat(floatToBits(p) + ((uint32_t) integer << 23));
+}
+
+/**
+ * Block version of log10(x), for positive inputs. Max absolute error: LOG10F_BLOCK_MAX_ABS_ERROR.
+ * It may work in place.
+ */
+extern "C"
+void log10f_block(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    pDst[i] = log2Kernel(pSrc[i]) * LOG10_2;
+  }
+}
+
+/**
+ * Block version of 10^x. Max relative error: POW10F_BLOCK_MAX_REL_ERROR. The results saturate
+ * at about 1e-38 and 3e38. It may work in place.
+ */
+extern "C"
+void pow10f_block(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    pDst[i] = exp2Kernel(pSrc[i] * LOG2_10);
+  }
+}
+
+/**
+ * Converts a block of dB values to linear amplitude gains, i.e. 10^(x/20).
+ * Max relative error: DB_TO_LIN_BLOCK_MAX_REL_ERROR. It may work in place.
+ */
+extern "C"
+void db_to_lin_block(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    pDst[i] = exp2Kernel(pSrc[i] * (LOG2_10 / 20.0f));
+  }
+}
+
+/**
+ * Makes the FPU treat subnormal results (and, on the host, operands) as zero, so that decaying filter states
+ * never take the slow subnormal path. The mode belongs to the calling thread (the FPSCR is part of the FreeRTOS
+ * task context), so each task that runs the DSP calls it once at its start.
+ */
+extern "C"
+void enable_flush_to_zero(void)
+{
+#if defined(__ARM_FP)
+  __set_FPSCR(__get_FPSCR() | FPSCR_FZ);
+#elif defined(__SSE__)
+  _mm_setcsr(_mm_getcsr() | MXCSR_FTZ | MXCSR_DAZ);
+#endif
+}
+
+/**
+ * Sets the values below DENORMAL_SNAP_LEVEL in magnitude to zero. Used on the recursive filter states at the end
+ * of each block, so that they settle at an exact zero in silence, even without flush-to-zero.
+ * @return true if all the values are zero
+ */
+extern "C"
+bool snap_to_zero_block(float32_t *pData, uint32_t blockSize)
+{
+  bool zero = true;
+
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    if (fabsf(pData[i]) < DENORMAL_SNAP_LEVEL)
+    {
+      pData[i] = 0.0f;
+    }
+
+    zero &= (pData[i] == 0.0f);
+  }
+
+  return zero;
+}
+
+/**
+ * Tells if a block of samples is digital silence. It returns at the first non-zero sample, so it costs
+ * next to nothing on audio.
+ * @param stride distance between consecutive samples (1 for separate buffers, 2 for a channel of an interleaved one)
+ */
+extern "C"
+bool is_zero_block(const float32_t *pSrc, uint32_t blockSize, uint32_t stride)
+{
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    if (pSrc[i * stride] != 0.0f)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Tells if a block of int16_t samples is digital silence, returning at the first non-zero sample
+ * @param blockSize number of samples, for all the channels of an interleaved block
+ */
+extern "C"
+bool is_zero_pcm16_block(const int16_t *pSrc, uint32_t blockSize)
+{
+  for (uint32_t i = 0; i < blockSize; i++)
+  {
+    if (pSrc[i] != 0)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
@@ -36,6 +36,13 @@
 
 #include "arm_math.h"
 
+// Maximum errors of the block functions, over their documented input ranges
+#define LOG10F_BLOCK_MAX_ABS_ERROR        1.0e-5f     //!< log10f_block, any positive normal input
+#define POW10F_BLOCK_MAX_REL_ERROR        5.0e-6f     //!< pow10f_block, -30 <= x <= 30
+#define DB_TO_LIN_BLOCK_MAX_REL_ERROR     2.0e-6f     //!< db_to_lin_block, -200 dB <= x <= 200 dB
+
+#define DENORMAL_SNAP_LEVEL               1.0e-15f    //!< Filter states below it (-300 dBFS) are set to zero, long before they turn subnormal
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -44,6 +51,15 @@ float32_t pow10f(float32_t x);
 float32_t log2fApprox(float32_t X);
 float32_t log10fApprox(float32_t x);
 
+void log10f_block(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+void pow10f_block(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+void db_to_lin_block(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+
+void enable_flush_to_zero(void);
+bool snap_to_zero_block(float32_t *pData, uint32_t blockSize);
+bool is_zero_block(const float32_t *pSrc, uint32_t blockSize, uint32_t stride);
+bool is_zero_pcm16_block(const int16_t *pSrc, uint32_t blockSize);
+
 #ifdef __cplusplus
 }
 #endif